@@ -0,0 +1,155 @@
+//===- llvm/benchmarks/ADT/DenseMapBench.cpp - Pointer map benchmarks -----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Compares DenseMap, GroupedDenseMap and SmallPtrSet on pointer keys, the
+// most common keys of the maps of passes.
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/Benchmark.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/GroupedDenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+
+using namespace llvm;
+using namespace llvm::benchmark;
+
+namespace {
+
+/// The keys of a benchmark, and as many other pointers to look up misses.
+struct Keys {
+  BumpPtrAllocator Alloc;
+  std::vector<void *> Present;
+  std::vector<void *> Absent;
+
+  explicit Keys(unsigned N) {
+    std::vector<void *> All = makePointerKeys(Alloc, 2 * N);
+    Present.assign(All.begin(), All.begin() + N);
+    Absent.assign(All.begin() + N, All.end());
+  }
+};
+
+template <typename MapT> void insert(State &S) {
+  Keys K(S.getArg());
+  while (S.keepRunning()) {
+    MapT Map;
+    for (void *P : K.Present)
+      Map[P] = 1;
+    doNotOptimize(Map);
+  }
+  S.setItemsProcessed(S.getIterations() * K.Present.size());
+}
+
+template <typename MapT> void lookupHit(State &S) {
+  Keys K(S.getArg());
+  MapT Map;
+  for (void *P : K.Present)
+    Map[P] = 1;
+  while (S.keepRunning()) {
+    unsigned Sum = 0;
+    for (void *P : K.Present)
+      Sum += Map.find(P)->second;
+    doNotOptimize(Sum);
+  }
+  S.setItemsProcessed(S.getIterations() * K.Present.size());
+}
+
+template <typename MapT> void lookupMiss(State &S) {
+  Keys K(S.getArg());
+  MapT Map;
+  for (void *P : K.Present)
+    Map[P] = 1;
+  while (S.keepRunning()) {
+    unsigned Count = 0;
+    for (void *P : K.Absent)
+      Count += Map.count(P);
+    doNotOptimize(Count);
+  }
+  S.setItemsProcessed(S.getIterations() * K.Absent.size());
+}
+
+template <typename MapT> void iterate(State &S) {
+  Keys K(S.getArg());
+  MapT Map;
+  for (void *P : K.Present)
+    Map[P] = 1;
+  while (S.keepRunning()) {
+    unsigned Sum = 0;
+    for (const auto &KV : Map)
+      Sum += KV.second;
+    doNotOptimize(Sum);
+  }
+  S.setItemsProcessed(S.getIterations() * K.Present.size());
+}
+
+template <typename MapT> void eraseAndReinsert(State &S) {
+  Keys K(S.getArg());
+  MapT Map;
+  for (void *P : K.Present)
+    Map[P] = 1;
+  while (S.keepRunning()) {
+    for (unsigned I = 0, E = K.Present.size(); I < E; I += 2)
+      Map.erase(K.Present[I]);
+    for (unsigned I = 0, E = K.Present.size(); I < E; I += 2)
+      Map[K.Present[I]] = 1;
+    doNotOptimize(Map);
+  }
+  S.setItemsProcessed(S.getIterations() * K.Present.size());
+}
+
+template <typename SetT> void setInsert(State &S) {
+  Keys K(S.getArg());
+  while (S.keepRunning()) {
+    SetT Set;
+    for (void *P : K.Present)
+      Set.insert(P);
+    doNotOptimize(Set);
+  }
+  S.setItemsProcessed(S.getIterations() * K.Present.size());
+}
+
+template <typename SetT> void setLookup(State &S) {
+  Keys K(S.getArg());
+  SetT Set;
+  for (void *P : K.Present)
+    Set.insert(P);
+  while (S.keepRunning()) {
+    unsigned Count = 0;
+    for (unsigned I = 0, E = K.Present.size(); I != E; ++I)
+      Count += Set.count(K.Present[I]) + Set.count(K.Absent[I]);
+    doNotOptimize(Count);
+  }
+  S.setItemsProcessed(S.getIterations() * 2 * K.Present.size());
+}
+
+typedef DenseMap<void *, unsigned> DenseMapT;
+typedef GroupedDenseMap<void *, unsigned> GroupedDenseMapT;
+typedef SmallPtrSet<void *, 16> SmallPtrSetT;
+
+#define MAP_BENCHMARKS(Map, Bench)                                             \
+  Registration Map##Bench##Registration(#Map "/" #Bench, Bench<Map##T>,       \
+                                        {16, 1024, 65536, 1 << 20})
+
+MAP_BENCHMARKS(DenseMap, insert);
+MAP_BENCHMARKS(DenseMap, lookupHit);
+MAP_BENCHMARKS(DenseMap, lookupMiss);
+MAP_BENCHMARKS(DenseMap, iterate);
+MAP_BENCHMARKS(DenseMap, eraseAndReinsert);
+MAP_BENCHMARKS(GroupedDenseMap, insert);
+MAP_BENCHMARKS(GroupedDenseMap, lookupHit);
+MAP_BENCHMARKS(GroupedDenseMap, lookupMiss);
+MAP_BENCHMARKS(GroupedDenseMap, iterate);
+MAP_BENCHMARKS(GroupedDenseMap, eraseAndReinsert);
+
+Registration SmallPtrSetInsert("SmallPtrSet/insert", setInsert<SmallPtrSetT>,
+                               {8, 16, 1024, 65536});
+Registration SmallPtrSetLookup("SmallPtrSet/lookup", setLookup<SmallPtrSetT>,
+                               {8, 16, 1024, 65536});
+
+} // end anonymous namespace
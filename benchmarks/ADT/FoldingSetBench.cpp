@@ -0,0 +1,91 @@
+//===- llvm/benchmarks/ADT/FoldingSetBench.cpp - FoldingSet benchmarks ----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// FoldingSet benchmarks on nodes profiled like the uniqued types, attributes
+// and SelectionDAG nodes: an opcode and a few operand pointers.
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/Benchmark.h"
+#include "llvm/ADT/FoldingSet.h"
+
+using namespace llvm;
+using namespace llvm::benchmark;
+
+namespace {
+
+class Node : public FoldingSetNode {
+  unsigned Opcode;
+  void *Ops[3];
+
+public:
+  Node(unsigned Opcode, void *Op0, void *Op1, void *Op2) : Opcode(Opcode) {
+    Ops[0] = Op0;
+    Ops[1] = Op1;
+    Ops[2] = Op2;
+  }
+
+  static void Profile(FoldingSetNodeID &ID, unsigned Opcode, void *const *Ops) {
+    ID.AddInteger(Opcode);
+    for (unsigned I = 0; I != 3; ++I)
+      ID.AddPointer(Ops[I]);
+  }
+  void Profile(FoldingSetNodeID &ID) const { Profile(ID, Opcode, Ops); }
+};
+
+/// The operands of the nodes of a benchmark.
+struct Operands {
+  BumpPtrAllocator Alloc;
+  std::vector<void *> Ptrs;
+
+  explicit Operands(unsigned N) : Ptrs(makePointerKeys(Alloc, N + 2)) {}
+  void *const *get(unsigned I) const { return &Ptrs[I]; }
+};
+
+/// Find or insert each node, as getOrCreate methods do.
+void FoldingSetGetOrInsert(State &S) {
+  Operands Ops(S.getArg());
+  while (S.keepRunning()) {
+    BumpPtrAllocator NodeAlloc;
+    FoldingSet<Node> Set;
+    // Every node is looked up twice, the second time being a hit.
+    for (unsigned Round = 0; Round != 2; ++Round)
+      for (unsigned I = 0, E = S.getArg(); I != E; ++I) {
+        FoldingSetNodeID ID;
+        Node::Profile(ID, I % 7, Ops.get(I));
+        void *InsertPos;
+        if (Set.FindNodeOrInsertPos(ID, InsertPos))
+          continue;
+        void *const *O = Ops.get(I);
+        Node *N = new (NodeAlloc.Allocate<Node>()) Node(I % 7, O[0], O[1], O[2]);
+        Set.InsertNode(N, InsertPos);
+      }
+    doNotOptimize(Set);
+  }
+  S.setItemsProcessed(S.getIterations() * 2 * S.getArg());
+}
+BENCHMARK_ARGS(FoldingSetGetOrInsert, 16, 1024, 65536);
+
+/// Compute the profile of a node without looking it up.
+void FoldingSetNodeIDHash(State &S) {
+  Operands Ops(S.getArg());
+  while (S.keepRunning()) {
+    unsigned Hash = 0;
+    for (unsigned I = 0, E = S.getArg(); I != E; ++I) {
+      FoldingSetNodeID ID;
+      Node::Profile(ID, I % 7, Ops.get(I));
+      Hash ^= ID.ComputeHash();
+    }
+    doNotOptimize(Hash);
+  }
+  S.setItemsProcessed(S.getIterations() * S.getArg());
+}
+BENCHMARK_ARGS(FoldingSetNodeIDHash, 1024);
+
+} // end anonymous namespace
@@ -0,0 +1,81 @@
+//===- llvm/benchmarks/ADT/SmallVectorBench.cpp - SmallVector benchmarks --===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/Benchmark.h"
+#include "llvm/ADT/SmallVector.h"
+
+using namespace llvm;
+using namespace llvm::benchmark;
+
+namespace {
+
+/// Fill a vector with 8 inline elements, which spills to the heap for the
+/// larger arguments.
+void SmallVectorPushBack(State &S) {
+  while (S.keepRunning()) {
+    SmallVector<void *, 8> V;
+    for (int64_t I = 0; I != S.getArg(); ++I)
+      V.push_back(&V);
+    doNotOptimize(V.data());
+  }
+  S.setItemsProcessed(S.getIterations() * S.getArg());
+}
+BENCHMARK_ARGS(SmallVectorPushBack, 4, 8, 64, 4096);
+
+/// Build operand lists as worklist algorithms do: clear the vector and append
+/// a range to it.
+void SmallVectorClearAppend(State &S) {
+  BumpPtrAllocator Alloc;
+  std::vector<void *> Keys = makePointerKeys(Alloc, S.getArg());
+  SmallVector<void *, 16> V;
+  while (S.keepRunning()) {
+    V.clear();
+    V.append(Keys.begin(), Keys.end());
+    doNotOptimize(V.data());
+  }
+  S.setItemsProcessed(S.getIterations() * S.getArg());
+}
+BENCHMARK_ARGS(SmallVectorClearAppend, 4, 16, 1024);
+
+/// Use the vector as a worklist stack.
+void SmallVectorWorklist(State &S) {
+  BumpPtrAllocator Alloc;
+  std::vector<void *> Keys = makePointerKeys(Alloc, S.getArg());
+  while (S.keepRunning()) {
+    SmallVector<void *, 16> Worklist;
+    uintptr_t Sum = 0;
+    for (void *K : Keys) {
+      Worklist.push_back(K);
+      if (reinterpret_cast<uintptr_t>(K) & 8)
+        Sum += reinterpret_cast<uintptr_t>(Worklist.pop_back_val());
+    }
+    while (!Worklist.empty())
+      Sum += reinterpret_cast<uintptr_t>(Worklist.pop_back_val());
+    doNotOptimize(Sum);
+  }
+  S.setItemsProcessed(S.getIterations() * S.getArg());
+}
+BENCHMARK_ARGS(SmallVectorWorklist, 16, 1024, 65536);
+
+/// Insert and erase in the middle of a vector of strings.
+void SmallVectorInsertErase(State &S) {
+  std::vector<std::string> Names = makeSymbolNames(S.getArg());
+  while (S.keepRunning()) {
+    SmallVector<std::string, 4> V;
+    for (const std::string &N : Names)
+      V.insert(V.begin() + V.size() / 2, N);
+    while (!V.empty())
+      V.erase(V.begin() + V.size() / 2);
+    doNotOptimize(V.data());
+  }
+  S.setItemsProcessed(S.getIterations() * S.getArg());
+}
+BENCHMARK_ARGS(SmallVectorInsertErase, 4, 64, 1024);
+
+} // end anonymous namespace
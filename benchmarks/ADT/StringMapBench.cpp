@@ -0,0 +1,242 @@
+//===- llvm/benchmarks/ADT/StringMapBench.cpp - StringMap benchmarks ------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// StringMap benchmarks on symbol names, as in symbol tables and the
+// uniquing maps of LLVMContext.
+//
+// The SymbolTable benchmarks measure the memory of the tables of a large C++
+// module, which name each global both in the IR and in the MC layer, with the
+// names stored per table or once in a CompactStringPool. They and the lookup
+// benchmarks comparing the keys run on the distinct names listed one per line
+// in -benchmark-symbol-file if given, e.g. by llvm-nm -just-symbol-name.
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/Benchmark.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/CompactStringPool.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/LineIterator.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+using namespace llvm::benchmark;
+
+static cl::opt<std::string>
+    SymbolFile("benchmark-symbol-file",
+               cl::desc("Use the symbol names in this file, one per line"),
+               cl::value_desc("filename"), cl::init(""));
+
+namespace {
+
+/// Return the first \p N names of -benchmark-symbol-file, or \p N synthetic
+/// names without it.
+std::vector<std::string> getSymbolNames(unsigned N) {
+  if (SymbolFile.empty())
+    return makeSymbolNames(N);
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufOrErr =
+      MemoryBuffer::getFile(SymbolFile);
+  if (std::error_code EC = BufOrErr.getError())
+    report_fatal_error("Can't read '" + SymbolFile + "': " + EC.message());
+  std::vector<std::string> Names;
+  for (line_iterator I(**BufOrErr); !I.is_at_end() && Names.size() != N; ++I)
+    Names.push_back(*I);
+  return Names;
+}
+
+void StringMapInsert(State &S) {
+  std::vector<std::string> Names = makeSymbolNames(S.getArg());
+  while (S.keepRunning()) {
+    StringMap<unsigned> Map;
+    for (const std::string &N : Names)
+      Map.insert(std::make_pair(N, 1u));
+    doNotOptimize(Map);
+  }
+  S.setItemsProcessed(S.getIterations() * S.getArg());
+}
+BENCHMARK_ARGS(StringMapInsert, 16, 1024, 65536);
+
+void StringMapLookupHit(State &S) {
+  std::vector<std::string> Names = getSymbolNames(S.getArg());
+  StringMap<unsigned> Map;
+  for (const std::string &N : Names)
+    Map[N] = 1;
+  while (S.keepRunning()) {
+    unsigned Sum = 0;
+    for (const std::string &N : Names)
+      Sum += Map.find(N)->second;
+    doNotOptimize(Sum);
+  }
+  S.setItemsProcessed(S.getIterations() * Names.size());
+}
+BENCHMARK_ARGS(StringMapLookupHit, 16, 1024, 65536);
+
+void StringMapLookupMiss(State &S) {
+  std::vector<std::string> Names = makeSymbolNames(2 * S.getArg());
+  StringMap<unsigned> Map;
+  for (unsigned I = 0, E = S.getArg(); I != E; ++I)
+    Map[Names[I]] = 1;
+  while (S.keepRunning()) {
+    unsigned Count = 0;
+    for (unsigned I = S.getArg(), E = Names.size(); I != E; ++I)
+      Count += Map.count(Names[I]);
+    doNotOptimize(Count);
+  }
+  S.setItemsProcessed(S.getIterations() * S.getArg());
+}
+BENCHMARK_ARGS(StringMapLookupMiss, 16, 1024, 65536);
+
+void StringMapIterate(State &S) {
+  std::vector<std::string> Names = makeSymbolNames(S.getArg());
+  StringMap<unsigned> Map;
+  for (const std::string &N : Names)
+    Map[N] = 1;
+  while (S.keepRunning()) {
+    size_t Length = 0;
+    for (const auto &E : Map)
+      Length += E.getKeyLength();
+    doNotOptimize(Length);
+  }
+  S.setItemsProcessed(S.getIterations() * S.getArg());
+}
+BENCHMARK_ARGS(StringMapIterate, 1024, 65536);
+
+/// A MallocAllocator that keeps track of the heap memory it uses.
+class CountingMallocAllocator : public AllocatorBase<CountingMallocAllocator> {
+public:
+  size_t HeapBytes = 0;
+
+  /// Return the size of the chunk malloc carves out for \p Size bytes,
+  /// assuming an 8-byte header and 16-byte granularity as in glibc.
+  static size_t getChunkSize(size_t Size) {
+    return std::max<size_t>(32, (Size + 8 + 15) & ~size_t(15));
+  }
+
+  void *Allocate(size_t Size, size_t /*Alignment*/) {
+    HeapBytes += getChunkSize(Size);
+    return malloc(Size);
+  }
+  using AllocatorBase<CountingMallocAllocator>::Allocate;
+
+  void Deallocate(const void *Ptr, size_t Size) {
+    HeapBytes -= getChunkSize(Size);
+    free(const_cast<void *>(Ptr));
+  }
+  using AllocatorBase<CountingMallocAllocator>::Deallocate;
+};
+
+void setMemoryLabel(State &S, size_t Bytes, size_t NumNames) {
+  std::string Label;
+  raw_string_ostream OS(Label);
+  const char *Fmt = "%.1f bytes/name";
+  OS << format(Fmt, double(Bytes) / NumNames);
+  S.setLabel(OS.str());
+}
+
+void SymbolTableMalloc(State &S) {
+  std::vector<std::string> Names = getSymbolNames(S.getArg());
+  size_t Bytes = 0;
+  while (S.keepRunning()) {
+    StringMap<void *, CountingMallocAllocator> IR, MC;
+    for (const std::string &N : Names) {
+      IR.insert(std::make_pair(N, nullptr));
+      MC.insert(std::make_pair(N, nullptr));
+    }
+    Bytes = IR.getMemorySize() + IR.getAllocator().HeapBytes +
+            MC.getMemorySize() + MC.getAllocator().HeapBytes;
+    doNotOptimize(IR);
+    doNotOptimize(MC);
+  }
+  S.setItemsProcessed(S.getIterations() * Names.size());
+  setMemoryLabel(S, Bytes, Names.size());
+}
+BENCHMARK_ARGS(SymbolTableMalloc, 1024, 65536, 1 << 20);
+
+void SymbolTableArena(State &S) {
+  std::vector<std::string> Names = getSymbolNames(S.getArg());
+  size_t Bytes = 0;
+  while (S.keepRunning()) {
+    StringMap<void *, BumpPtrAllocator> IR, MC;
+    for (const std::string &N : Names) {
+      IR.insert(std::make_pair(N, nullptr));
+      MC.insert(std::make_pair(N, nullptr));
+    }
+    Bytes = IR.getMemorySize() + IR.getAllocator().getTotalMemory() +
+            MC.getMemorySize() + MC.getAllocator().getTotalMemory();
+    doNotOptimize(IR);
+    doNotOptimize(MC);
+  }
+  S.setItemsProcessed(S.getIterations() * Names.size());
+  setMemoryLabel(S, Bytes, Names.size());
+}
+BENCHMARK_ARGS(SymbolTableArena, 1024, 65536, 1 << 20);
+
+void SymbolTablePooled(State &S) {
+  std::vector<std::string> Names = getSymbolNames(S.getArg());
+  size_t Bytes = 0;
+  while (S.keepRunning()) {
+    CompactStringPool Pool;
+    DenseMap<InternedString, void *> IR, MC;
+    for (const std::string &N : Names) {
+      InternedString Name = Pool.intern(N);
+      IR.insert(std::make_pair(Name, nullptr));
+      MC.insert(std::make_pair(Name, nullptr));
+    }
+    Bytes = Pool.getMemorySize() + IR.getMemorySize() + MC.getMemorySize();
+    doNotOptimize(IR);
+    doNotOptimize(MC);
+  }
+  S.setItemsProcessed(S.getIterations() * Names.size());
+  setMemoryLabel(S, Bytes, Names.size());
+}
+BENCHMARK_ARGS(SymbolTablePooled, 1024, 65536, 1 << 20);
+
+void StringMapLookupPrecomputedHash(State &S) {
+  std::vector<std::string> Names = getSymbolNames(S.getArg());
+  CompactStringPool Pool;
+  std::vector<InternedString> Interned;
+  StringMap<unsigned> Map;
+  for (const std::string &N : Names) {
+    Interned.push_back(Pool.intern(N));
+    Map.insert(std::make_pair(N, 1u), Interned.back().hash());
+  }
+  while (S.keepRunning()) {
+    unsigned Sum = 0;
+    for (InternedString N : Interned)
+      Sum += Map.find(N.str(), N.hash())->second;
+    doNotOptimize(Sum);
+  }
+  S.setItemsProcessed(S.getIterations() * Names.size());
+}
+BENCHMARK_ARGS(StringMapLookupPrecomputedHash, 16, 1024, 65536);
+
+void InternedStringMapLookup(State &S) {
+  std::vector<std::string> Names = getSymbolNames(S.getArg());
+  CompactStringPool Pool;
+  std::vector<InternedString> Interned;
+  DenseMap<InternedString, unsigned> Map;
+  for (const std::string &N : Names) {
+    Interned.push_back(Pool.intern(N));
+    Map[Interned.back()] = 1;
+  }
+  while (S.keepRunning()) {
+    unsigned Sum = 0;
+    for (InternedString N : Interned)
+      Sum += Map.find(N)->second;
+    doNotOptimize(Sum);
+  }
+  S.setItemsProcessed(S.getIterations() * Names.size());
+}
+BENCHMARK_ARGS(InternedStringMapLookup, 16, 1024, 65536);
+
+} // end anonymous namespace
@@ -0,0 +1,83 @@
+//===- llvm/benchmarks/IR/AsmWriterBench.cpp - Textual IR output ----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Measures the throughput of the AsmWriter of llvm-dis on a large module full
+// of integer constants and arithmetic.
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/Benchmark.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+using namespace llvm::benchmark;
+
+namespace {
+
+/// Build a module with \p N functions, each with a constant table, some
+/// arithmetic and a call to the previous function.
+std::unique_ptr<Module> makeModule(LLVMContext &Context, unsigned N) {
+  std::unique_ptr<Module> M(new Module("bench", Context));
+  std::vector<std::string> Names = makeSymbolNames(N);
+  Type *I32 = Type::getInt32Ty(Context);
+  Type *I64 = Type::getInt64Ty(Context);
+  FunctionType *FTy = FunctionType::get(I64, {I64, I32}, false);
+  ArrayType *TableTy = ArrayType::get(I64, 16);
+
+  uint64_t Seed = 0x9E3779B97F4A7C15ULL;
+  Function *Prev = nullptr;
+  for (const std::string &Name : Names) {
+    std::vector<Constant *> Elts;
+    for (unsigned I = 0; I != 16; ++I) {
+      Elts.push_back(ConstantInt::get(I64, Seed >> (I * 4)));
+      Seed = Seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    }
+    auto *Table = new GlobalVariable(*M, TableTy, true,
+                                     GlobalValue::InternalLinkage,
+                                     ConstantArray::get(TableTy, Elts),
+                                     Name + ".table");
+
+    Function *F =
+        Function::Create(FTy, GlobalValue::ExternalLinkage, Name, M.get());
+    IRBuilder<> B(BasicBlock::Create(Context, "entry", F));
+    auto AI = F->arg_begin();
+    Value *X = &*AI++;
+    Value *Idx = B.CreateZExt(&*AI, I64);
+    Value *Elt = B.CreateLoad(B.CreateInBoundsGEP(
+        TableTy, Table, {ConstantInt::get(I64, 0), Idx}));
+    Value *R = B.CreateAdd(B.CreateMul(X, Elt), ConstantInt::get(I64, Seed));
+    R = B.CreateXor(R, ConstantInt::get(I64, Seed >> 17));
+    if (Prev)
+      R = B.CreateCall(Prev, {R, ConstantInt::get(I32, Seed & 15)});
+    B.CreateRet(R);
+    Prev = F;
+  }
+  return M;
+}
+
+void AsmWriterModule(State &S) {
+  LLVMContext Context;
+  std::unique_ptr<Module> M = makeModule(Context, S.getArg());
+  std::string Buffer;
+  while (S.keepRunning()) {
+    Buffer.clear();
+    raw_string_ostream OS(Buffer);
+    M->print(OS, nullptr);
+    OS.flush();
+  }
+  S.setItemsProcessed(S.getIterations() * Buffer.size());
+}
+BENCHMARK_ARGS(AsmWriterModule, 256, 4096);
+
+} // end anonymous namespace
@@ -0,0 +1,82 @@
+//===- llvm/benchmarks/IR/CloneModuleBench.cpp - Module cloning -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Compares cloning a whole module with cloning it lazily and materializing
+// only a few of its functions, as speculative optimization does.
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/Benchmark.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+
+using namespace llvm;
+using namespace llvm::benchmark;
+
+namespace {
+
+/// Build a module with \p N functions of about 40 instructions, each calling
+/// the previous one.
+std::unique_ptr<Module> makeModule(LLVMContext &Context, unsigned N) {
+  std::unique_ptr<Module> M(new Module("bench", Context));
+  std::vector<std::string> Names = makeSymbolNames(N);
+  Type *I64 = Type::getInt64Ty(Context);
+  FunctionType *FTy = FunctionType::get(I64, {I64, I64}, false);
+
+  Function *Prev = nullptr;
+  for (const std::string &Name : Names) {
+    Function *F =
+        Function::Create(FTy, GlobalValue::ExternalLinkage, Name, M.get());
+    IRBuilder<> B(BasicBlock::Create(Context, "entry", F));
+    auto AI = F->arg_begin();
+    Value *X = &*AI++;
+    Value *Y = &*AI;
+    for (unsigned I = 0; I != 12; ++I) {
+      X = B.CreateAdd(B.CreateMul(X, ConstantInt::get(I64, I * 7 + 3)), Y);
+      Y = B.CreateXor(Y, B.CreateLShr(X, ConstantInt::get(I64, I + 1)));
+    }
+    if (Prev)
+      X = B.CreateCall(Prev, {X, Y});
+    B.CreateRet(X);
+    Prev = F;
+  }
+  return M;
+}
+
+void CloneModuleEager(State &S) {
+  LLVMContext Context;
+  std::unique_ptr<Module> M = makeModule(Context, S.getArg());
+  while (S.keepRunning())
+    doNotOptimize(CloneModule(M.get()));
+  S.setItemsProcessed(S.getIterations() * S.getArg());
+}
+BENCHMARK_ARGS(CloneModuleEager, 64, 4096);
+
+/// Clone lazily and materialize four functions.
+void CloneModuleLazy(State &S) {
+  LLVMContext Context;
+  std::unique_ptr<Module> M = makeModule(Context, S.getArg());
+  while (S.keepRunning()) {
+    std::unique_ptr<Module> Clone = CloneModuleLazily(M.get());
+    unsigned I = 0;
+    for (Function &F : *Clone) {
+      if (I++ == 4)
+        break;
+      F.materialize();
+    }
+    doNotOptimize(Clone);
+  }
+  S.setItemsProcessed(S.getIterations() * S.getArg());
+}
+BENCHMARK_ARGS(CloneModuleLazy, 64, 4096);
+
+} // end anonymous namespace
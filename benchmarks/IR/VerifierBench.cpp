@@ -0,0 +1,84 @@
+//===- llvm/benchmarks/IR/VerifierBench.cpp - Module verification ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Compares verifying a whole module with verifying only the function a pass
+// changed, as -verify-each -verify-incremental does between passes. Run with
+// -verify-threads=N to measure verifyModule checking functions on N threads.
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/Benchmark.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Verifier.h"
+
+using namespace llvm;
+using namespace llvm::benchmark;
+
+namespace {
+
+/// Build a module with \p N functions of about 40 instructions in a few
+/// blocks, each calling the previous one.
+std::unique_ptr<Module> makeModule(LLVMContext &Context, unsigned N) {
+  std::unique_ptr<Module> M(new Module("bench", Context));
+  std::vector<std::string> Names = makeSymbolNames(N);
+  Type *I64 = Type::getInt64Ty(Context);
+  FunctionType *FTy = FunctionType::get(I64, {I64, I64}, false);
+
+  Function *Prev = nullptr;
+  for (const std::string &Name : Names) {
+    Function *F =
+        Function::Create(FTy, GlobalValue::ExternalLinkage, Name, M.get());
+    IRBuilder<> B(BasicBlock::Create(Context, "entry", F));
+    auto AI = F->arg_begin();
+    Value *X = &*AI++;
+    Value *Y = &*AI;
+    for (unsigned I = 0; I != 4; ++I) {
+      for (unsigned J = 0; J != 3; ++J) {
+        X = B.CreateAdd(B.CreateMul(X, ConstantInt::get(I64, J * 7 + 3)), Y);
+        Y = B.CreateXor(Y, B.CreateLShr(X, ConstantInt::get(I64, J + 1)));
+      }
+      BasicBlock *Next = BasicBlock::Create(Context, "next", F);
+      B.CreateBr(Next);
+      B.SetInsertPoint(Next);
+    }
+    if (Prev)
+      X = B.CreateCall(Prev, {X, Y});
+    B.CreateRet(X);
+    Prev = F;
+  }
+  return M;
+}
+
+void VerifyModuleFull(State &S) {
+  LLVMContext Context;
+  std::unique_ptr<Module> M = makeModule(Context, S.getArg());
+  while (S.keepRunning())
+    doNotOptimize(verifyModule(*M));
+  S.setItemsProcessed(S.getIterations() * S.getArg());
+}
+BENCHMARK_ARGS(VerifyModuleFull, 64, 4096);
+
+/// Verify incrementally after one function changed.
+void VerifyModuleOneChanged(State &S) {
+  LLVMContext Context;
+  std::unique_ptr<Module> M = makeModule(Context, S.getArg());
+  verifyModule(*M);
+  Function &F = M->getFunctionList().back();
+  while (S.keepRunning()) {
+    F.markChanged();
+    doNotOptimize(verifyModule(*M, nullptr, /*OnlyChanged=*/true));
+  }
+  S.setItemsProcessed(S.getIterations() * S.getArg());
+}
+BENCHMARK_ARGS(VerifyModuleOneChanged, 64, 4096);
+
+} // end anonymous namespace
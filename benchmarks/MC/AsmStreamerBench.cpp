@@ -0,0 +1,67 @@
+//===- llvm/benchmarks/MC/AsmStreamerBench.cpp - Assembly output ----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Measures the throughput of the assembly printer of llc -filetype=asm on the
+// data sections of a large module: labels, integer and string directives, and
+// padding.
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/Benchmark.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/MC/MCAsmInfoELF.h"
+#include "llvm/MC/MCContext.h"
+#include "llvm/MC/MCSectionELF.h"
+#include "llvm/MC/MCStreamer.h"
+#include "llvm/Support/ELF.h"
+#include "llvm/Support/FormattedStream.h"
+#include "llvm/Support/TargetRegistry.h"
+
+using namespace llvm;
+using namespace llvm::benchmark;
+
+namespace {
+
+struct BenchmarkAsmInfo : public MCAsmInfoELF {};
+
+void AsmStreamerData(State &S) {
+  std::vector<std::string> Names = makeSymbolNames(S.getArg());
+  BenchmarkAsmInfo MAI;
+  std::string Buffer;
+  uint64_t Bytes = 0;
+  while (S.keepRunning()) {
+    Buffer.clear();
+    MCContext Ctx(&MAI, nullptr, nullptr);
+    raw_string_ostream OS(Buffer);
+    std::unique_ptr<MCStreamer> Streamer(createAsmStreamer(
+        Ctx, make_unique<formatted_raw_ostream>(OS), /*isVerboseAsm=*/false,
+        /*useDwarfDirectory=*/false, nullptr, nullptr, nullptr,
+        /*ShowInst=*/false));
+    Streamer->SwitchSection(Ctx.getELFSection(
+        ".data", ELF::SHT_PROGBITS, ELF::SHF_ALLOC | ELF::SHF_WRITE));
+
+    uint64_t Seed = 0x9E3779B97F4A7C15ULL;
+    for (const std::string &N : Names) {
+      Streamer->EmitLabel(Ctx.getOrCreateSymbol(N));
+      for (unsigned I = 0; I != 4; ++I) {
+        Streamer->EmitIntValue(Seed, 8);
+        Streamer->EmitIntValue(Seed >> 40, 4);
+        Seed = Seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      }
+      Streamer->EmitBytes(N);
+      Streamer->EmitZeros(Seed % 32);
+    }
+    Streamer.reset();
+    Bytes = OS.str().size();
+  }
+  S.setItemsProcessed(S.getIterations() * Bytes);
+}
+BENCHMARK_ARGS(AsmStreamerData, 1024, 65536);
+
+} // end anonymous namespace
@@ -0,0 +1,109 @@
+//===- llvm/benchmarks/Support/APIntBench.cpp - APInt benchmarks ----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// APInt arithmetic on the bit widths constant folding and InstCombine see.
+// The argument of each benchmark is the bit width.
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/Benchmark.h"
+#include "llvm/ADT/APInt.h"
+#include <random>
+
+using namespace llvm;
+using namespace llvm::benchmark;
+
+namespace {
+
+const unsigned NumValues = 256;
+
+/// Return NumValues random, non-zero values of the given bit width.
+std::vector<APInt> makeValues(unsigned BitWidth) {
+  std::mt19937_64 RNG(BitWidth);
+  std::vector<APInt> Values;
+  for (unsigned I = 0; I != NumValues; ++I) {
+    SmallVector<uint64_t, 4> Words;
+    for (unsigned W = 0; W < BitWidth; W += 64)
+      Words.push_back(RNG());
+    APInt V(BitWidth, Words);
+    if (!V)
+      V = 1;
+    Values.push_back(V);
+  }
+  return Values;
+}
+
+template <typename OpT> void binaryOp(State &S, OpT Op) {
+  std::vector<APInt> Values = makeValues(S.getArg());
+  while (S.keepRunning()) {
+    APInt Acc = Values[0];
+    for (unsigned I = 1; I != NumValues; ++I)
+      Acc = Op(Values[I - 1], Values[I]) ^ Acc;
+    doNotOptimize(Acc);
+  }
+  S.setItemsProcessed(S.getIterations() * (NumValues - 1));
+}
+
+void APIntAdd(State &S) {
+  binaryOp(S, [](const APInt &A, const APInt &B) { return A + B; });
+}
+BENCHMARK_ARGS(APIntAdd, 32, 64, 128, 256);
+
+void APIntMul(State &S) {
+  binaryOp(S, [](const APInt &A, const APInt &B) { return A * B; });
+}
+BENCHMARK_ARGS(APIntMul, 32, 64, 128, 256);
+
+void APIntUDiv(State &S) {
+  binaryOp(S, [](const APInt &A, const APInt &B) { return A.udiv(B); });
+}
+BENCHMARK_ARGS(APIntUDiv, 32, 64, 128, 256);
+
+void APIntShl(State &S) {
+  binaryOp(S, [](const APInt &A, const APInt &B) {
+    return A.shl(B.getLoBits(6).getZExtValue() % A.getBitWidth());
+  });
+}
+BENCHMARK_ARGS(APIntShl, 32, 64, 128, 256);
+
+void APIntCompare(State &S) {
+  std::vector<APInt> Values = makeValues(S.getArg());
+  while (S.keepRunning()) {
+    unsigned Count = 0;
+    for (unsigned I = 1; I != NumValues; ++I)
+      Count += Values[I - 1].ult(Values[I]) + (Values[I - 1] == Values[I]);
+    doNotOptimize(Count);
+  }
+  S.setItemsProcessed(S.getIterations() * (NumValues - 1));
+}
+BENCHMARK_ARGS(APIntCompare, 32, 64, 128, 256);
+
+/// Evaluate binomial coefficients the way ScalarEvolution evaluates add
+/// recurrences at an iteration: a product of consecutive integers, divided by
+/// a factorial, at a width wider than the recurrence.
+void APIntSCEVBinomial(State &S) {
+  unsigned Width = S.getArg();
+  const unsigned NumIterations = 64, Order = 5;
+  while (S.keepRunning()) {
+    APInt Sum(Width, 0);
+    for (uint64_t It = 1; It != NumIterations; ++It) {
+      APInt Dividend(Width, It), Factorial(Width, 1);
+      for (unsigned K = 1; K != Order; ++K) {
+        Dividend *= APInt(Width, It + K);
+        Factorial *= APInt(Width, K + 1);
+      }
+      Sum += Dividend.udiv(Factorial);
+    }
+    doNotOptimize(Sum);
+  }
+  S.setItemsProcessed(S.getIterations() * (NumIterations - 1));
+}
+BENCHMARK_ARGS(APIntSCEVBinomial, 64, 96, 128);
+
+} // end anonymous namespace
@@ -0,0 +1,126 @@
+//===- llvm/benchmarks/Support/AllocatorBench.cpp - Allocator benchmarks --===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/Benchmark.h"
+#include "llvm/Support/Allocator.h"
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+
+using namespace llvm;
+using namespace llvm::benchmark;
+
+namespace {
+
+/// Allocate objects of the sizes of IR objects and free them all at once.
+void BumpPtrAllocatorSmall(State &S) {
+  while (S.keepRunning()) {
+    BumpPtrAllocator Alloc;
+    for (int64_t I = 0; I != S.getArg(); ++I)
+      doNotOptimize(Alloc.Allocate(16 + (I % 8) * 8, 8));
+  }
+  S.setItemsProcessed(S.getIterations() * S.getArg());
+}
+BENCHMARK_ARGS(BumpPtrAllocatorSmall, 64, 4096, 1 << 20);
+
+/// Reuse one allocator, as the per-function allocators of the code generator
+/// do.
+void BumpPtrAllocatorReset(State &S) {
+  BumpPtrAllocator Alloc;
+  while (S.keepRunning()) {
+    for (int64_t I = 0; I != S.getArg(); ++I)
+      doNotOptimize(Alloc.Allocate(16 + (I % 8) * 8, 8));
+    Alloc.Reset();
+  }
+  S.setItemsProcessed(S.getIterations() * S.getArg());
+}
+BENCHMARK_ARGS(BumpPtrAllocatorReset, 64, 4096, 1 << 20);
+
+/// The same allocations with malloc, as a baseline.
+void MallocSmall(State &S) {
+  std::vector<void *> Ptrs(S.getArg());
+  while (S.keepRunning()) {
+    for (int64_t I = 0; I != S.getArg(); ++I)
+      Ptrs[I] = std::malloc(16 + (I % 8) * 8);
+    doNotOptimize(Ptrs.data());
+    for (void *P : Ptrs)
+      std::free(P);
+  }
+  S.setItemsProcessed(S.getIterations() * S.getArg());
+}
+BENCHMARK_ARGS(MallocSmall, 64, 4096, 1 << 20);
+
+/// Allocate objects that get their own slab.
+void BumpPtrAllocatorLarge(State &S) {
+  while (S.keepRunning()) {
+    BumpPtrAllocator Alloc;
+    for (int64_t I = 0; I != S.getArg(); ++I)
+      doNotOptimize(Alloc.Allocate(8192, 16));
+  }
+  S.setItemsProcessed(S.getIterations() * S.getArg());
+}
+BENCHMARK_ARGS(BumpPtrAllocatorLarge, 16, 256);
+
+/// Selects a slab backing for the duration of a benchmark.
+struct ScopedSlabBacking {
+  explicit ScopedSlabBacking(SlabAllocator::BackingKind Kind) {
+    SlabAllocator::setBacking(Kind);
+  }
+  ~ScopedSlabBacking() { SlabAllocator::setBacking(SlabAllocator::Malloc); }
+};
+
+/// Create and destroy an allocator per iteration, as the code generator does
+/// for each MachineFunction.
+template <SlabAllocator::BackingKind Kind> void SlabChurn(State &S) {
+  ScopedSlabBacking Backing(Kind);
+  while (S.keepRunning()) {
+    BumpPtrAllocator Alloc;
+    for (int64_t I = 0; I != S.getArg(); ++I)
+      doNotOptimize(Alloc.Allocate(16 + (I % 8) * 8, 8));
+  }
+  S.setItemsProcessed(S.getIterations() * S.getArg());
+}
+
+/// Follow a chain of nodes spread over a large allocator in a random order,
+/// like a traversal of the use-lists of a large module.
+template <SlabAllocator::BackingKind Kind> void SlabTraverse(State &S) {
+  struct Node {
+    Node *Next;
+    char Payload[56];
+  };
+  ScopedSlabBacking Backing(Kind);
+  BumpPtrAllocator Alloc;
+  std::vector<Node *> Nodes;
+  for (int64_t I = 0; I != S.getArg(); ++I)
+    Nodes.push_back(new (Alloc.Allocate<Node>()) Node());
+  std::shuffle(Nodes.begin(), Nodes.end(), std::mt19937(S.getArg()));
+  for (size_t I = 0, E = Nodes.size(); I != E; ++I)
+    Nodes[I]->Next = Nodes[(I + 1) % E];
+
+  while (S.keepRunning()) {
+    Node *N = Nodes.front();
+    for (int64_t I = 0; I != S.getArg(); ++I)
+      N = N->Next;
+    doNotOptimize(N);
+  }
+  S.setItemsProcessed(S.getIterations() * S.getArg());
+}
+
+#define SLAB_BENCHMARKS(Bench, Kind, Name, ...)                                \
+  Registration Bench##Kind##Registration(                                      \
+      #Bench "/" Name, Bench<SlabAllocator::Kind>, {__VA_ARGS__})
+
+SLAB_BENCHMARKS(SlabChurn, Malloc, "malloc", 4096, 1 << 16);
+SLAB_BENCHMARKS(SlabChurn, Pages, "pages", 4096, 1 << 16);
+SLAB_BENCHMARKS(SlabChurn, TransparentHugePages, "thp", 4096, 1 << 16);
+SLAB_BENCHMARKS(SlabTraverse, Malloc, "malloc", 1 << 16, 1 << 22);
+SLAB_BENCHMARKS(SlabTraverse, Pages, "pages", 1 << 16, 1 << 22);
+SLAB_BENCHMARKS(SlabTraverse, TransparentHugePages, "thp", 1 << 16, 1 << 22);
+
+} // end anonymous namespace
@@ -0,0 +1,69 @@
+//===- llvm/benchmarks/Support/GlobalStateBench.cpp - Global state reads --===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Measures reads of the process-wide state passes consult on every call:
+// ManagedStatics and cl::opts, with and without an active option context.
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/Benchmark.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ManagedStatic.h"
+
+using namespace llvm;
+using namespace llvm::benchmark;
+
+static cl::opt<unsigned> BenchThreshold("benchmark-global-state-threshold",
+                                        cl::Hidden, cl::init(1));
+
+static ManagedStatic<unsigned> BenchStatic;
+
+namespace {
+
+void ManagedStaticRead(State &S) {
+  *BenchStatic = 1;
+  while (S.keepRunning()) {
+    unsigned Sum = 0;
+    for (int64_t I = 0; I != S.getArg(); ++I)
+      Sum += *BenchStatic;
+    doNotOptimize(Sum);
+  }
+  S.setItemsProcessed(S.getIterations() * S.getArg());
+}
+BENCHMARK_ARGS(ManagedStaticRead, 1024);
+
+void OptionRead(State &S) {
+  while (S.keepRunning()) {
+    unsigned Sum = 0;
+    for (int64_t I = 0; I != S.getArg(); ++I) {
+      Sum += BenchThreshold;
+      doNotOptimize(Sum);
+    }
+  }
+  S.setItemsProcessed(S.getIterations() * S.getArg());
+}
+BENCHMARK_ARGS(OptionRead, 1024);
+
+/// Read an option the active context overrides.
+void OptionReadInContext(State &S) {
+  cl::OptionContext Ctx;
+  Ctx.setOption("benchmark-global-state-threshold", "2");
+  cl::OptionContext::Scope Scope(Ctx);
+  while (S.keepRunning()) {
+    unsigned Sum = 0;
+    for (int64_t I = 0; I != S.getArg(); ++I) {
+      Sum += BenchThreshold;
+      doNotOptimize(Sum);
+    }
+  }
+  S.setItemsProcessed(S.getIterations() * S.getArg());
+}
+BENCHMARK_ARGS(OptionReadInContext, 1024);
+
+} // end anonymous namespace
@@ -0,0 +1,97 @@
+//===- llvm/benchmarks/Support/MemoryBufferBench.cpp - File reading -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Reads a memory-mapped file from start to end, as the bitcode reader does,
+// with and without access hints.  Each iteration first drops the file from
+// the page cache, so the file is read from disk.  Set TMPDIR to a directory
+// on the disk to measure; on a tmpfs the file cannot be dropped.
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/Benchmark.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <vector>
+#if defined(LLVM_ON_UNIX)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace llvm;
+using namespace llvm::benchmark;
+
+namespace {
+
+/// A temporary file of the size in MiB the benchmark was registered with.
+struct TempFile {
+  SmallString<128> Path;
+
+  explicit TempFile(unsigned MiB) {
+    int FD;
+    if (sys::fs::createTemporaryFile("MemoryBufferBench", "bin", FD, Path))
+      report_fatal_error("cannot create a temporary file");
+    raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    std::vector<char> Chunk(1 << 20);
+    for (unsigned I = 0; I != Chunk.size(); ++I)
+      Chunk[I] = char(I * 31);
+    for (unsigned I = 0; I != MiB; ++I)
+      OS.write(Chunk.data(), Chunk.size());
+  }
+  ~TempFile() { sys::fs::remove(Path); }
+
+  /// Drop the file from the page cache.
+  void evict() {
+#if defined(LLVM_ON_UNIX) && defined(POSIX_FADV_DONTNEED)
+    int FD = ::open(Path.c_str(), O_RDONLY);
+    if (FD == -1)
+      return;
+    ::posix_fadvise(FD, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(FD);
+#endif
+  }
+};
+
+enum Hint { NoHint, Sequential, Prefetch };
+
+template <Hint H> void coldRead(State &S) {
+  TempFile File(S.getArg());
+  while (S.keepRunning()) {
+    S.pauseTiming();
+    File.evict();
+    S.resumeTiming();
+
+    auto MB = MemoryBuffer::getFile(File.Path, -1, false);
+    if (!MB)
+      report_fatal_error("cannot map the temporary file");
+    if (H == Sequential)
+      (*MB)->adviseAccess(MemoryBuffer::Access_Sequential);
+    else if (H == Prefetch)
+      MemoryBuffer::prefetch((*MB)->getBuffer());
+
+    // Touch every cache line, as a parser would.
+    unsigned Sum = 0;
+    StringRef Data = (*MB)->getBuffer();
+    for (size_t I = 0, E = Data.size(); I < E; I += 64)
+      Sum += (unsigned char)Data[I];
+    doNotOptimize(Sum);
+  }
+  S.setItemsProcessed(S.getIterations() * S.getArg() * (1 << 20));
+}
+
+Registration ColdReadNoHint("MemoryBufferColdRead/none", coldRead<NoHint>,
+                            {64});
+Registration ColdReadSequential("MemoryBufferColdRead/sequential",
+                                coldRead<Sequential>, {64});
+Registration ColdReadPrefetch("MemoryBufferColdRead/prefetch",
+                              coldRead<Prefetch>, {64});
+
+} // end anonymous namespace
@@ -0,0 +1,143 @@
+//===- llvm/benchmarks/Support/RawOstreamBench.cpp - raw_ostream benches --===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// raw_ostream benchmarks on the output of the AsmPrinter and of textual IR:
+// short strings, decimal and hex numbers.
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/Benchmark.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+using namespace llvm::benchmark;
+
+namespace {
+
+void RawOstreamStrings(State &S) {
+  std::vector<std::string> Names = makeSymbolNames(S.getArg());
+  SmallString<4096> Buffer;
+  while (S.keepRunning()) {
+    Buffer.clear();
+    raw_svector_ostream OS(Buffer);
+    for (const std::string &N : Names)
+      OS << "\tcallq\t" << N << '\n';
+    doNotOptimize(Buffer.data());
+  }
+  S.setItemsProcessed(S.getIterations() * S.getArg());
+}
+BENCHMARK_ARGS(RawOstreamStrings, 1024);
+
+void RawOstreamDecimal(State &S) {
+  std::string Buffer;
+  while (S.keepRunning()) {
+    Buffer.clear();
+    raw_string_ostream OS(Buffer);
+    for (int64_t I = 0; I != S.getArg(); ++I)
+      OS << (I * 7919 - 4096) << ", ";
+    OS.flush();
+    doNotOptimize(Buffer.data());
+  }
+  S.setItemsProcessed(S.getIterations() * S.getArg());
+}
+BENCHMARK_ARGS(RawOstreamDecimal, 1024);
+
+void RawOstreamHex(State &S) {
+  std::string Buffer;
+  while (S.keepRunning()) {
+    Buffer.clear();
+    raw_string_ostream OS(Buffer);
+    for (int64_t I = 0; I != S.getArg(); ++I)
+      OS << format_hex(uint64_t(I) * 0x9E3779B97F4A7C15ULL, 18) << '\n';
+    OS.flush();
+    doNotOptimize(Buffer.data());
+  }
+  S.setItemsProcessed(S.getIterations() * S.getArg());
+}
+BENCHMARK_ARGS(RawOstreamHex, 1024);
+
+void RawOstreamFormat(State &S) {
+  const char *Label = "label";
+  std::string Buffer;
+  while (S.keepRunning()) {
+    Buffer.clear();
+    raw_string_ostream OS(Buffer);
+    for (int64_t I = 0; I != S.getArg(); ++I)
+      OS << format("%-8s %5d %08x\n", Label, int(I), unsigned(I * 31));
+    OS.flush();
+    doNotOptimize(Buffer.data());
+  }
+  S.setItemsProcessed(S.getIterations() * S.getArg());
+}
+BENCHMARK_ARGS(RawOstreamFormat, 1024);
+
+/// The output of RawOstreamFormat, without format().
+void RawOstreamFormatted(State &S) {
+  const char *Label = "label";
+  std::string Buffer;
+  while (S.keepRunning()) {
+    Buffer.clear();
+    raw_string_ostream OS(Buffer);
+    for (int64_t I = 0; I != S.getArg(); ++I)
+      OS << left_justify(Label, 8) << ' ' << format_decimal(I, 5) << ' '
+         << format_hex_no_prefix(unsigned(I * 31), 8) << '\n';
+    OS.flush();
+    doNotOptimize(Buffer.data());
+  }
+  S.setItemsProcessed(S.getIterations() * S.getArg());
+}
+BENCHMARK_ARGS(RawOstreamFormatted, 1024);
+
+void RawOstreamWriteHex(State &S) {
+  std::string Buffer;
+  while (S.keepRunning()) {
+    Buffer.clear();
+    raw_string_ostream OS(Buffer);
+    for (int64_t I = 0; I != S.getArg(); ++I)
+      OS.write_hex(uint64_t(I) * 0x9E3779B97F4A7C15ULL >> (I % 64)) << '\n';
+    OS.flush();
+    doNotOptimize(Buffer.data());
+  }
+  S.setItemsProcessed(S.getIterations() * S.getArg());
+}
+BENCHMARK_ARGS(RawOstreamWriteHex, 1024);
+
+/// Indented lines, as AsmWriter and the dumpers print them.
+void RawOstreamIndent(State &S) {
+  std::string Buffer;
+  while (S.keepRunning()) {
+    Buffer.clear();
+    raw_string_ostream OS(Buffer);
+    for (int64_t I = 0; I != S.getArg(); ++I)
+      OS.indent(2 + (I % 8) * 2) << "%" << I << '\n';
+    OS.flush();
+    doNotOptimize(Buffer.data());
+  }
+  S.setItemsProcessed(S.getIterations() * S.getArg());
+}
+BENCHMARK_ARGS(RawOstreamIndent, 1024);
+
+/// Section padding, as the object writers emit it.
+void RawOstreamZeros(State &S) {
+  std::string Buffer;
+  while (S.keepRunning()) {
+    Buffer.clear();
+    raw_string_ostream OS(Buffer);
+    for (int64_t I = 0; I != S.getArg(); ++I)
+      OS.write_zeros(I % 64) << 'x';
+    OS.flush();
+    doNotOptimize(Buffer.data());
+  }
+  S.setItemsProcessed(S.getIterations() * S.getArg());
+}
+BENCHMARK_ARGS(RawOstreamZeros, 1024);
+
+} // end anonymous namespace
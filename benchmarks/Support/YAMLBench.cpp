@@ -0,0 +1,111 @@
+//===- llvm/benchmarks/Support/YAMLBench.cpp - YAML I/O benchmarks --------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Measures the scanner and yaml::Input on documents shaped like the output of
+// obj2yaml: a long sequence of small mappings.
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/Benchmark.h"
+#include "llvm/Support/YAMLParser.h"
+#include "llvm/Support/YAMLTraits.h"
+
+using namespace llvm;
+using namespace llvm::benchmark;
+
+namespace {
+struct Symbol {
+  StringRef Name;
+  StringRef Section;
+  uint64_t Value;
+  uint64_t Size;
+  std::vector<uint64_t> Uses;
+};
+
+struct Object {
+  std::vector<Symbol> Symbols;
+};
+} // end anonymous namespace
+
+LLVM_YAML_IS_FLOW_SEQUENCE_VECTOR(uint64_t)
+LLVM_YAML_IS_SEQUENCE_VECTOR(Symbol)
+
+namespace llvm {
+namespace yaml {
+template <> struct MappingTraits<Symbol> {
+  static void mapping(IO &IO, Symbol &S) {
+    IO.mapRequired("Name", S.Name);
+    IO.mapRequired("Section", S.Section);
+    IO.mapRequired("Value", S.Value);
+    IO.mapOptional("Size", S.Size, uint64_t(0));
+    IO.mapOptional("Uses", S.Uses);
+  }
+};
+
+template <> struct MappingTraits<Object> {
+  static void mapping(IO &IO, Object &O) {
+    IO.mapRequired("Symbols", O.Symbols);
+  }
+};
+} // end namespace yaml
+} // end namespace llvm
+
+namespace {
+
+std::string makeDocument(unsigned N) {
+  static const char *const Sections[] = {".text", ".data", ".bss", ".rodata"};
+  std::vector<std::string> Names = makeSymbolNames(N);
+  Object O;
+  for (unsigned I = 0; I != N; ++I) {
+    Symbol S;
+    S.Name = Names[I];
+    S.Section = Sections[I % 4];
+    S.Value = uint64_t(I) * 48;
+    S.Size = I % 3 ? 48 : 0;
+    for (unsigned J = 0; J != I % 4; ++J)
+      S.Uses.push_back(I * 7 + J);
+    O.Symbols.push_back(S);
+  }
+  std::string Document;
+  raw_string_ostream OS(Document);
+  yaml::Output Out(OS);
+  Out << O;
+  return OS.str();
+}
+
+void YAMLScanTokens(State &S) {
+  std::string Document = makeDocument(S.getArg());
+  while (S.keepRunning()) {
+    bool Failed = yaml::scanTokens(Document);
+    doNotOptimize(Failed);
+  }
+  S.setItemsProcessed(S.getIterations() * Document.size());
+}
+BENCHMARK_ARGS(YAMLScanTokens, 65536);
+
+template <bool Streaming> void readObject(State &S) {
+  std::string Document = makeDocument(S.getArg());
+  while (S.keepRunning()) {
+    Object O;
+    yaml::Input In(Document);
+    In.setStreaming(Streaming);
+    In >> O;
+    if (In.error() || O.Symbols.size() != size_t(S.getArg()))
+      report_fatal_error("failed to read the benchmark document");
+    doNotOptimize(O);
+  }
+  S.setItemsProcessed(S.getIterations() * Document.size());
+}
+
+Registration YAMLInputTree("YAMLInput/tree", readObject<false>,
+                           {1024, 65536});
+Registration YAMLInputStreaming("YAMLInput/streaming", readObject<true>,
+                                {1024, 65536});
+
+} // end anonymous namespace
@@ -531,8 +531,10 @@ macro(add_llvm_library name)
   else()
     llvm_add_library(${name} ${ARGN})
   endif()
-  # The gtest libraries should not be installed or exported as a target
-  if ("${name}" STREQUAL gtest OR "${name}" STREQUAL gtest_main)
+  # The gtest and benchmark libraries should not be installed or exported as
+  # a target
+  if ("${name}" STREQUAL gtest OR "${name}" STREQUAL gtest_main OR
+      "${name}" STREQUAL benchmark OR "${name}" STREQUAL benchmark_main)
     set(_is_gtest TRUE)
   else()
     set(_is_gtest FALSE)
@@ -898,6 +900,35 @@ function(add_unittest test_suite test_name)
   endif ()
 endfunction()
 
+# Add a microbenchmark executable to the given suite, linked with the
+# framework in utils/benchmark. Run it with -benchmark-out=<file> to get the
+# results as JSON.
+function(add_benchmark benchmark_suite benchmark_name)
+  if( NOT LLVM_BUILD_BENCHMARKS )
+    set(EXCLUDE_FROM_ALL ON)
+  endif()
+
+  include_directories(${LLVM_MAIN_SRC_DIR}/utils/benchmark/include)
+  if (SUPPORTS_NO_VARIADIC_MACROS_FLAG)
+    list(APPEND LLVM_COMPILE_FLAGS "-Wno-variadic-macros")
+  endif ()
+
+  add_llvm_executable(${benchmark_name} IGNORE_EXTERNALIZE_DEBUGINFO ${ARGN})
+  set(outdir ${CMAKE_CURRENT_BINARY_DIR}/${CMAKE_CFG_INTDIR})
+  set_output_directory(${benchmark_name} BINARY_DIR ${outdir} LIBRARY_DIR ${outdir})
+  target_link_libraries(${benchmark_name}
+    benchmark
+    benchmark_main
+    LLVMSupport
+    )
+
+  add_dependencies(${benchmark_suite} ${benchmark_name})
+  get_target_property(benchmark_suite_folder ${benchmark_suite} FOLDER)
+  if (NOT ${benchmark_suite_folder} STREQUAL "NOTFOUND")
+    set_property(TARGET ${benchmark_name} PROPERTY FOLDER "${benchmark_suite_folder}")
+  endif ()
+endfunction()
+
 function(llvm_add_go_executable binary pkgpath)
   cmake_parse_arguments(ARG "ALL" "" "DEPENDS;GOFLAGS" ${ARGN})
 
@@ -40,7 +40,7 @@ typedef bool lto_bool_t;
  * @{
  */
 
-#define LTO_API_VERSION 17
+#define LTO_API_VERSION 18
 
 /**
  * \since prior to LTO_API_VERSION=3
@@ -548,6 +548,27 @@ extern void
 lto_codegen_set_should_embed_uselists(lto_code_gen_t cg,
                                       lto_bool_t ShouldEmbedUselists);
 
+/**
+ * Sets the directory of the on-disk object cache. When set, a code generator
+ * whose inputs, target and options match an earlier link returns the object
+ * generated by that link instead of optimizing and compiling the merged module
+ * again. The directory is created if it doesn't exist.
+ *
+ * \since LTO_API_VERSION=18
+ */
+extern void
+lto_codegen_set_cache_dir(lto_code_gen_t cg, const char *cache_dir);
+
+/**
+ * Sets the maximum size in bytes of the object cache. The least recently used
+ * objects are removed once it is exceeded. A size of 0, the default, means
+ * the cache is not limited.
+ *
+ * \since LTO_API_VERSION=18
+ */
+extern void
+lto_codegen_set_cache_max_size(lto_code_gen_t cg, unsigned long long max_size);
+
 #ifdef __cplusplus
 }
 #endif
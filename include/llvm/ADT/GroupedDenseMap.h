@@ -0,0 +1,593 @@
+//===- llvm/ADT/GroupedDenseMap.h - Group probed hash table -----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the GroupedDenseMap class, an open addressing hash table
+// with the interface of DenseMap.
+//
+//   DenseMap finds a key by comparing it with the key of each bucket along its
+// probe sequence, which touches a new cache line at almost every step once the
+// table is large. GroupedDenseMap instead keeps one control byte per bucket in
+// a separate array: the byte says whether the bucket is empty, deleted, or
+// full, in which case it holds 7 bits of the hash of the key. A lookup scans
+// the control bytes of 16 buckets at once, using SSE2 where available, and
+// only compares the keys whose 7 bits match, which is almost always at most
+// one.
+//
+//   The buckets hold key/value pairs, as in DenseMap, so that iterators can
+// give references to them. Unlike DenseMap, the keys don't need empty or
+// tombstone values: only KeyInfoT::getHashValue and KeyInfoT::isEqual are
+// used.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_ADT_GROUPEDDENSEMAP_H
+#define LLVM_ADT_GROUPEDDENSEMAP_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseMapInfo.h"
+#include "llvm/ADT/EpochTracker.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/MathExtras.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace llvm {
+
+namespace detail {
+/// Control byte values. Full buckets have a non-negative control byte, made of
+/// the low 7 bits of the hash of their key.
+enum : int8_t {
+  GroupedDenseMapEmpty = -128,
+  GroupedDenseMapDeleted = -2
+};
+
+/// The control bytes of GroupedDenseMapGroup::Width consecutive buckets.
+struct GroupedDenseMapGroup {
+  enum : unsigned { Width = 16 };
+
+#if defined(__SSE2__)
+  __m128i Ctrl;
+
+  explicit GroupedDenseMapGroup(const int8_t *Pos)
+      : Ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i *>(Pos))) {}
+
+  /// Return a mask of the buckets whose control byte is \p Byte.
+  unsigned match(int8_t Byte) const {
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(Byte), Ctrl));
+  }
+
+  /// Return a mask of the buckets that are empty or deleted.
+  unsigned matchNonFull() const {
+    return _mm_movemask_epi8(Ctrl);
+  }
+#else
+  const int8_t *Ctrl;
+
+  explicit GroupedDenseMapGroup(const int8_t *Pos) : Ctrl(Pos) {}
+
+  unsigned match(int8_t Byte) const {
+    unsigned Mask = 0;
+    for (unsigned I = 0; I != Width; ++I)
+      Mask |= unsigned(Ctrl[I] == Byte) << I;
+    return Mask;
+  }
+
+  unsigned matchNonFull() const {
+    unsigned Mask = 0;
+    for (unsigned I = 0; I != Width; ++I)
+      Mask |= unsigned(Ctrl[I] < 0) << I;
+    return Mask;
+  }
+#endif
+
+  unsigned matchEmpty() const { return match(GroupedDenseMapEmpty); }
+};
+} // end namespace detail
+
+template <typename KeyT, typename ValueT, typename KeyInfoT, bool IsConst>
+class GroupedDenseMapIterator;
+
+/// A hash map with the interface of DenseMap, probing the buckets by groups.
+/// Like DenseMap, it invalidates iterators and references on insertion.
+template <typename KeyT, typename ValueT,
+          typename KeyInfoT = DenseMapInfo<KeyT>>
+class GroupedDenseMap : public DebugEpochBase {
+  typedef detail::DenseMapPair<KeyT, ValueT> BucketT;
+  typedef detail::GroupedDenseMapGroup Group;
+  enum : unsigned { GroupWidth = Group::Width };
+
+public:
+  typedef unsigned size_type;
+  typedef KeyT key_type;
+  typedef ValueT mapped_type;
+  typedef BucketT value_type;
+
+  typedef GroupedDenseMapIterator<KeyT, ValueT, KeyInfoT, false> iterator;
+  typedef GroupedDenseMapIterator<KeyT, ValueT, KeyInfoT, true> const_iterator;
+
+private:
+  /// NumBuckets + GroupWidth control bytes. The last GroupWidth bytes copy the
+  /// first ones, so that a group can be loaded from any bucket.
+  int8_t *Ctrl = nullptr;
+  BucketT *Buckets = nullptr;
+  unsigned NumBuckets = 0;
+  unsigned NumEntries = 0;
+  /// The number of empty buckets that can still be filled before growing.
+  unsigned GrowthLeft = 0;
+
+public:
+  explicit GroupedDenseMap(unsigned NumInitEntries = 0) {
+    if (NumInitEntries)
+      init(getMinBucketsForEntries(NumInitEntries));
+  }
+
+  GroupedDenseMap(const GroupedDenseMap &Other) : DebugEpochBase() {
+    copyFrom(Other);
+  }
+
+  GroupedDenseMap(GroupedDenseMap &&Other) : DebugEpochBase() {
+    swap(Other);
+  }
+
+  template <typename InputIt>
+  GroupedDenseMap(const InputIt &I, const InputIt &E) {
+    insert(I, E);
+  }
+
+  ~GroupedDenseMap() {
+    destroyAll();
+    deallocate();
+  }
+
+  GroupedDenseMap &operator=(const GroupedDenseMap &Other) {
+    if (&Other != this) {
+      destroyAll();
+      deallocate();
+      copyFrom(Other);
+    }
+    return *this;
+  }
+
+  GroupedDenseMap &operator=(GroupedDenseMap &&Other) {
+    destroyAll();
+    deallocate();
+    Ctrl = nullptr;
+    Buckets = nullptr;
+    NumBuckets = NumEntries = GrowthLeft = 0;
+    swap(Other);
+    return *this;
+  }
+
+  void swap(GroupedDenseMap &RHS) {
+    incrementEpoch();
+    RHS.incrementEpoch();
+    std::swap(Ctrl, RHS.Ctrl);
+    std::swap(Buckets, RHS.Buckets);
+    std::swap(NumBuckets, RHS.NumBuckets);
+    std::swap(NumEntries, RHS.NumEntries);
+    std::swap(GrowthLeft, RHS.GrowthLeft);
+  }
+
+  inline iterator begin() {
+    return empty() ? end() : iterator(Buckets, Ctrl, Buckets + NumBuckets,
+                                      *this);
+  }
+  inline iterator end() {
+    return iterator(Buckets + NumBuckets, Ctrl + NumBuckets,
+                    Buckets + NumBuckets, *this, true);
+  }
+  inline const_iterator begin() const {
+    return empty() ? end() : const_iterator(Buckets, Ctrl,
+                                            Buckets + NumBuckets, *this);
+  }
+  inline const_iterator end() const {
+    return const_iterator(Buckets + NumBuckets, Ctrl + NumBuckets,
+                          Buckets + NumBuckets, *this, true);
+  }
+
+  bool LLVM_ATTRIBUTE_UNUSED_RESULT empty() const { return NumEntries == 0; }
+  unsigned size() const { return NumEntries; }
+
+  /// Grow the map so that it has at least Size buckets. Does not shrink.
+  void resize(size_type Size) {
+    incrementEpoch();
+    if (Size > NumBuckets)
+      rehash(std::max<unsigned>(GroupWidth, NextPowerOf2(Size - 1)));
+  }
+
+  void clear() {
+    incrementEpoch();
+    if (NumEntries == 0 && GrowthLeft == getMaxEntries(NumBuckets))
+      return;
+    destroyAll();
+    resetCtrl();
+  }
+
+  /// Return 1 if the specified key is in the map, 0 otherwise.
+  size_type count(const KeyT &Val) const {
+    return findBucket(Val) ? 1 : 0;
+  }
+
+  iterator find(const KeyT &Val) { return find_as(Val); }
+  const_iterator find(const KeyT &Val) const { return find_as(Val); }
+
+  /// Alternate version of find() which allows a different, and possibly less
+  /// expensive, key type, as for DenseMap.
+  template <class LookupKeyT> iterator find_as(const LookupKeyT &Val) {
+    if (const BucketT *B = findBucket(Val))
+      return makeIterator(B);
+    return end();
+  }
+  template <class LookupKeyT>
+  const_iterator find_as(const LookupKeyT &Val) const {
+    if (const BucketT *B = findBucket(Val))
+      return makeConstIterator(B);
+    return end();
+  }
+
+  /// Return the entry for the specified key, or a default constructed value
+  /// if no such entry exists.
+  ValueT lookup(const KeyT &Val) const {
+    if (const BucketT *B = findBucket(Val))
+      return B->getSecond();
+    return ValueT();
+  }
+
+  std::pair<iterator, bool> insert(const std::pair<KeyT, ValueT> &KV) {
+    return insertImpl(KV.first, KV.second);
+  }
+
+  std::pair<iterator, bool> insert(std::pair<KeyT, ValueT> &&KV) {
+    return insertImpl(std::move(KV.first), std::move(KV.second));
+  }
+
+  template <typename InputIt> void insert(InputIt I, InputIt E) {
+    for (; I != E; ++I)
+      insert(*I);
+  }
+
+  bool erase(const KeyT &Val) {
+    const BucketT *B = findBucket(Val);
+    if (!B)
+      return false;
+    eraseBucket(B - Buckets);
+    return true;
+  }
+  void erase(iterator I) { eraseBucket(&*I - Buckets); }
+
+  value_type &FindAndConstruct(const KeyT &Key) {
+    return *insertImpl(Key, ValueT()).first;
+  }
+  ValueT &operator[](const KeyT &Key) { return FindAndConstruct(Key).second; }
+
+  value_type &FindAndConstruct(KeyT &&Key) {
+    return *insertImpl(std::move(Key), ValueT()).first;
+  }
+  ValueT &operator[](KeyT &&Key) {
+    return FindAndConstruct(std::move(Key)).second;
+  }
+
+  /// Return true if the specified pointer points somewhere into the map's
+  /// array of buckets (i.e. either to a key or value in the map).
+  bool isPointerIntoBucketsArray(const void *Ptr) const {
+    return Ptr >= Buckets && Ptr < Buckets + NumBuckets;
+  }
+
+  /// Return an opaque pointer into the buckets array, to determine whether an
+  /// insertion caused the map to reallocate.
+  const void *getPointerIntoBucketsArray() const { return Buckets; }
+
+  /// Return the amount of memory allocated by the map.
+  size_t getMemorySize() const {
+    if (!NumBuckets)
+      return 0;
+    return NumBuckets * sizeof(BucketT) + NumBuckets + GroupWidth;
+  }
+
+private:
+  iterator makeIterator(const BucketT *B) {
+    return iterator(const_cast<BucketT *>(B), Ctrl + (B - Buckets),
+                    Buckets + NumBuckets, *this, true);
+  }
+  const_iterator makeConstIterator(const BucketT *B) const {
+    return const_iterator(B, Ctrl + (B - Buckets), Buckets + NumBuckets, *this,
+                          true);
+  }
+
+  /// The buckets can be filled up to 7/8 of their number.
+  static unsigned getMaxEntries(unsigned NumBuckets) {
+    return NumBuckets - NumBuckets / 8;
+  }
+
+  static unsigned getMinBucketsForEntries(unsigned NumEntries) {
+    return std::max<unsigned>(GroupWidth,
+                              NextPowerOf2(NumEntries * 8 / 7 + 1));
+  }
+
+  /// DenseMapInfo hashes are cheap and often weak, e.g. for pointers. Spread
+  /// their bits so that both the position and the control byte get enough
+  /// entropy.
+  static uint64_t mixHash(unsigned Hash) {
+    uint64_t H = uint64_t(Hash) * 0x9E3779B97F4A7C15ULL;
+    return H ^ (H >> 32);
+  }
+
+  static int8_t getH2(uint64_t Hash) { return int8_t(Hash & 0x7f); }
+  unsigned getH1(uint64_t Hash) const {
+    return unsigned(Hash >> 7) & (NumBuckets - 1);
+  }
+
+  void setCtrl(unsigned Idx, int8_t Byte) {
+    Ctrl[Idx] = Byte;
+    if (Idx < GroupWidth)
+      Ctrl[NumBuckets + Idx] = Byte;
+  }
+
+  void resetCtrl() {
+    std::memset(Ctrl, detail::GroupedDenseMapEmpty, NumBuckets + GroupWidth);
+    NumEntries = 0;
+    GrowthLeft = getMaxEntries(NumBuckets);
+  }
+
+  void init(unsigned InitBuckets) {
+    assert(isPowerOf2_32(InitBuckets) && InitBuckets >= GroupWidth &&
+           "Invalid number of buckets");
+    NumBuckets = InitBuckets;
+    Ctrl = static_cast<int8_t *>(operator new(NumBuckets + GroupWidth));
+    Buckets = static_cast<BucketT *>(operator new(sizeof(BucketT) * NumBuckets));
+    resetCtrl();
+  }
+
+  void deallocate() {
+    operator delete(Ctrl);
+    operator delete(Buckets);
+  }
+
+  void destroyAll() {
+    for (unsigned I = 0; I != NumBuckets; ++I)
+      if (Ctrl[I] >= 0) {
+        Buckets[I].getSecond().~ValueT();
+        Buckets[I].getFirst().~KeyT();
+      }
+  }
+
+  void copyFrom(const GroupedDenseMap &Other) {
+    Ctrl = nullptr;
+    Buckets = nullptr;
+    NumBuckets = NumEntries = GrowthLeft = 0;
+    if (!Other.NumBuckets)
+      return;
+    init(Other.NumBuckets);
+    std::memcpy(Ctrl, Other.Ctrl, NumBuckets + GroupWidth);
+    for (unsigned I = 0; I != NumBuckets; ++I)
+      if (Ctrl[I] >= 0) {
+        ::new (&Buckets[I].getFirst()) KeyT(Other.Buckets[I].getFirst());
+        ::new (&Buckets[I].getSecond()) ValueT(Other.Buckets[I].getSecond());
+      }
+    NumEntries = Other.NumEntries;
+    GrowthLeft = Other.GrowthLeft;
+  }
+
+  /// Return the bucket holding \p Val, or null.
+  template <typename LookupKeyT>
+  const BucketT *findBucket(const LookupKeyT &Val) const {
+    if (!NumBuckets)
+      return nullptr;
+    uint64_t Hash = mixHash(KeyInfoT::getHashValue(Val));
+    int8_t H2 = getH2(Hash);
+    unsigned Mask = NumBuckets - 1;
+    unsigned Pos = getH1(Hash);
+    // Triangular probing over groups visits every group of a power of 2 sized
+    // table.
+    for (unsigned Stride = GroupWidth;; Stride += GroupWidth) {
+      Group G(Ctrl + Pos);
+      for (unsigned Matches = G.match(H2); Matches; Matches &= Matches - 1) {
+        unsigned Idx = (Pos + countTrailingZeros(Matches)) & Mask;
+        if (LLVM_LIKELY(KeyInfoT::isEqual(Val, Buckets[Idx].getFirst())))
+          return Buckets + Idx;
+      }
+      if (LLVM_LIKELY(G.matchEmpty()))
+        return nullptr;
+      Pos = (Pos + Stride) & Mask;
+    }
+  }
+
+  /// Return the first empty or deleted bucket along the probe sequence of
+  /// \p Hash.
+  unsigned findFirstNonFull(uint64_t Hash) const {
+    unsigned Mask = NumBuckets - 1;
+    unsigned Pos = getH1(Hash);
+    for (unsigned Stride = GroupWidth;; Stride += GroupWidth) {
+      if (unsigned NonFull = Group(Ctrl + Pos).matchNonFull())
+        return (Pos + countTrailingZeros(NonFull)) & Mask;
+      Pos = (Pos + Stride) & Mask;
+    }
+  }
+
+  template <typename KeyArg, typename ValueArg>
+  std::pair<iterator, bool> insertImpl(KeyArg &&Key, ValueArg &&Value) {
+    if (const BucketT *B = findBucket(Key))
+      return std::make_pair(makeIterator(B), false);
+
+    incrementEpoch();
+    if (!NumBuckets)
+      init(GroupWidth);
+    uint64_t Hash = mixHash(KeyInfoT::getHashValue(Key));
+    unsigned Idx = findFirstNonFull(Hash);
+    if (Ctrl[Idx] == detail::GroupedDenseMapEmpty && GrowthLeft == 0) {
+      // Grow, unless most of the used buckets are deleted ones, in which case
+      // rehashing in place is enough.
+      rehash(NumEntries * 2 >= getMaxEntries(NumBuckets) ? NumBuckets * 2
+                                                          : NumBuckets);
+      Idx = findFirstNonFull(Hash);
+    }
+
+    if (Ctrl[Idx] == detail::GroupedDenseMapEmpty)
+      --GrowthLeft;
+    ++NumEntries;
+    setCtrl(Idx, getH2(Hash));
+    BucketT *B = Buckets + Idx;
+    ::new (&B->getFirst()) KeyT(std::forward<KeyArg>(Key));
+    ::new (&B->getSecond()) ValueT(std::forward<ValueArg>(Value));
+    return std::make_pair(makeIterator(B), true);
+  }
+
+  void eraseBucket(unsigned Idx) {
+    assert(Ctrl[Idx] >= 0 && "Erasing an empty bucket");
+    Buckets[Idx].getSecond().~ValueT();
+    Buckets[Idx].getFirst().~KeyT();
+    --NumEntries;
+    // The bucket can only go back to empty if no probe sequence went past it,
+    // which is the case if its group never filled up.
+    unsigned Mask = NumBuckets - 1;
+    unsigned Before = Group(Ctrl + ((Idx - GroupWidth) & Mask)).matchEmpty();
+    unsigned After = Group(Ctrl + Idx).matchEmpty();
+    if (After && Before &&
+        countTrailingZeros(After) + countLeadingZeros(Before << 16) <
+            GroupWidth) {
+      setCtrl(Idx, detail::GroupedDenseMapEmpty);
+      ++GrowthLeft;
+    } else {
+      setCtrl(Idx, detail::GroupedDenseMapDeleted);
+    }
+  }
+
+  /// Move the entries to \p NewNumBuckets new buckets, dropping the deleted
+  /// ones.
+  void rehash(unsigned NewNumBuckets) {
+    int8_t *OldCtrl = Ctrl;
+    BucketT *OldBuckets = Buckets;
+    unsigned OldNumBuckets = NumBuckets;
+    init(NewNumBuckets);
+
+    for (unsigned I = 0; I != OldNumBuckets; ++I) {
+      if (OldCtrl[I] < 0)
+        continue;
+      BucketT &Old = OldBuckets[I];
+      uint64_t Hash = mixHash(KeyInfoT::getHashValue(Old.getFirst()));
+      unsigned Idx = findFirstNonFull(Hash);
+      setCtrl(Idx, getH2(Hash));
+      ::new (&Buckets[Idx].getFirst()) KeyT(std::move(Old.getFirst()));
+      ::new (&Buckets[Idx].getSecond()) ValueT(std::move(Old.getSecond()));
+      Old.getSecond().~ValueT();
+      Old.getFirst().~KeyT();
+      ++NumEntries;
+      --GrowthLeft;
+    }
+
+    operator delete(OldCtrl);
+    operator delete(OldBuckets);
+  }
+};
+
+template <typename KeyT, typename ValueT, typename KeyInfoT, bool IsConst>
+class GroupedDenseMapIterator : DebugEpochBase::HandleBase {
+  typedef GroupedDenseMapIterator<KeyT, ValueT, KeyInfoT, true> ConstIterator;
+  friend class GroupedDenseMapIterator<KeyT, ValueT, KeyInfoT, true>;
+  friend class GroupedDenseMapIterator<KeyT, ValueT, KeyInfoT, false>;
+  typedef detail::DenseMapPair<KeyT, ValueT> Bucket;
+
+public:
+  typedef ptrdiff_t difference_type;
+  typedef typename std::conditional<IsConst, const Bucket, Bucket>::type
+  value_type;
+  typedef value_type *pointer;
+  typedef value_type &reference;
+  typedef std::forward_iterator_tag iterator_category;
+
+private:
+  pointer Ptr = nullptr, End = nullptr;
+  /// The control byte of Ptr.
+  const int8_t *Ctrl = nullptr;
+
+public:
+  GroupedDenseMapIterator() = default;
+
+  GroupedDenseMapIterator(pointer Pos, const int8_t *PosCtrl, pointer E,
+                          const DebugEpochBase &Epoch, bool NoAdvance = false)
+      : DebugEpochBase::HandleBase(&Epoch), Ptr(Pos), End(E), Ctrl(PosCtrl) {
+    assert(isHandleInSync() && "invalid construction!");
+    if (!NoAdvance)
+      AdvancePastEmptyBuckets();
+  }
+
+  // Converting ctor from non-const iterators to const iterators. SFINAE'd out
+  // for const iterator destinations so it doesn't end up as a user defined copy
+  // constructor.
+  template <bool IsConstSrc,
+            typename = typename std::enable_if<!IsConstSrc && IsConst>::type>
+  GroupedDenseMapIterator(
+      const GroupedDenseMapIterator<KeyT, ValueT, KeyInfoT, IsConstSrc> &I)
+      : DebugEpochBase::HandleBase(I), Ptr(I.Ptr), End(I.End), Ctrl(I.Ctrl) {}
+
+  reference operator*() const {
+    assert(isHandleInSync() && "invalid iterator access!");
+    return *Ptr;
+  }
+  pointer operator->() const {
+    assert(isHandleInSync() && "invalid iterator access!");
+    return Ptr;
+  }
+
+  bool operator==(const ConstIterator &RHS) const {
+    assert((!Ptr || isHandleInSync()) && "handle not in sync!");
+    assert((!RHS.Ptr || RHS.isHandleInSync()) && "handle not in sync!");
+    assert(getEpochAddress() == RHS.getEpochAddress() &&
+           "comparing incomparable iterators!");
+    return Ptr == RHS.Ptr;
+  }
+  bool operator!=(const ConstIterator &RHS) const {
+    assert((!Ptr || isHandleInSync()) && "handle not in sync!");
+    assert((!RHS.Ptr || RHS.isHandleInSync()) && "handle not in sync!");
+    assert(getEpochAddress() == RHS.getEpochAddress() &&
+           "comparing incomparable iterators!");
+    return Ptr != RHS.Ptr;
+  }
+
+  inline GroupedDenseMapIterator &operator++() { // Preincrement
+    assert(isHandleInSync() && "invalid iterator access!");
+    ++Ptr;
+    ++Ctrl;
+    AdvancePastEmptyBuckets();
+    return *this;
+  }
+  GroupedDenseMapIterator operator++(int) { // Postincrement
+    assert(isHandleInSync() && "invalid iterator access!");
+    GroupedDenseMapIterator tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+private:
+  void AdvancePastEmptyBuckets() {
+    while (Ptr != End && *Ctrl < 0) {
+      ++Ptr;
+      ++Ctrl;
+    }
+  }
+};
+
+template <typename KeyT, typename ValueT, typename KeyInfoT>
+static inline size_t
+capacity_in_bytes(const GroupedDenseMap<KeyT, ValueT, KeyInfoT> &X) {
+  return X.getMemorySize();
+}
+
+} // end namespace llvm
+
+#endif
@@ -21,14 +21,20 @@
 //
 // NOTE: Statistics *must* be declared as global variables.
 //
+// Statistics may be updated from several threads. A build service running
+// many compilations in one process can take a snapshot of the statistics of
+// each compilation with GetStatistics() or PrintStatisticsJSON(), and reset
+// them with ResetStatistics().
+//
 //===----------------------------------------------------------------------===//
 
 #ifndef LLVM_ADT_STATISTIC_H
 #define LLVM_ADT_STATISTIC_H
 
-#include "llvm/Support/Atomic.h"
-#include "llvm/Support/Valgrind.h"
+#include "llvm/Support/Compiler.h"
+#include <atomic>
 #include <memory>
+#include <vector>
 
 namespace llvm {
 class raw_ostream;
@@ -38,10 +44,10 @@ class Statistic {
 public:
   const char *Name;
   const char *Desc;
-  volatile llvm::sys::cas_flag Value;
-  bool Initialized;
+  std::atomic<unsigned> Value;
+  std::atomic<bool> Initialized;
 
-  llvm::sys::cas_flag getValue() const { return Value; }
+  unsigned getValue() const { return Value.load(std::memory_order_relaxed); }
   const char *getName() const { return Name; }
   const char *getDesc() const { return Desc; }
 
@@ -52,66 +58,66 @@ public:
   }
 
   // Allow use of this class as the value itself.
-  operator unsigned() const { return Value; }
+  operator unsigned() const { return getValue(); }
 
 #if !defined(NDEBUG) || defined(LLVM_ENABLE_STATS)
-   const Statistic &operator=(unsigned Val) {
-    Value = Val;
+  // The updates are relaxed atomic operations: statistics may be bumped from
+  // several threads, but their values are only read once the threads are
+  // done.
+  const Statistic &operator=(unsigned Val) {
+    Value.store(Val, std::memory_order_relaxed);
     return init();
   }
 
   const Statistic &operator++() {
-    // FIXME: This function and all those that follow carefully use an
-    // atomic operation to update the value safely in the presence of
-    // concurrent accesses, but not to read the return value, so the
-    // return value is not thread safe.
-    sys::AtomicIncrement(&Value);
+    Value.fetch_add(1, std::memory_order_relaxed);
     return init();
   }
 
   unsigned operator++(int) {
     init();
-    unsigned OldValue = Value;
-    sys::AtomicIncrement(&Value);
-    return OldValue;
+    return Value.fetch_add(1, std::memory_order_relaxed);
   }
 
   const Statistic &operator--() {
-    sys::AtomicDecrement(&Value);
+    Value.fetch_sub(1, std::memory_order_relaxed);
     return init();
   }
 
   unsigned operator--(int) {
     init();
-    unsigned OldValue = Value;
-    sys::AtomicDecrement(&Value);
-    return OldValue;
+    return Value.fetch_sub(1, std::memory_order_relaxed);
   }
 
   const Statistic &operator+=(const unsigned &V) {
     if (!V) return *this;
-    sys::AtomicAdd(&Value, V);
+    Value.fetch_add(V, std::memory_order_relaxed);
     return init();
   }
 
   const Statistic &operator-=(const unsigned &V) {
     if (!V) return *this;
-    sys::AtomicAdd(&Value, -V);
+    Value.fetch_sub(V, std::memory_order_relaxed);
     return init();
   }
 
   const Statistic &operator*=(const unsigned &V) {
-    sys::AtomicMul(&Value, V);
+    unsigned Old = Value.load(std::memory_order_relaxed);
+    while (!Value.compare_exchange_weak(Old, Old * V,
+                                        std::memory_order_relaxed))
+      ;
     return init();
   }
 
   const Statistic &operator/=(const unsigned &V) {
-    sys::AtomicDiv(&Value, V);
+    unsigned Old = Value.load(std::memory_order_relaxed);
+    while (!Value.compare_exchange_weak(Old, Old / V,
+                                        std::memory_order_relaxed))
+      ;
     return init();
   }
 
 #else  // Statistics are disabled in release builds.
-
   const Statistic &operator=(unsigned Val) {
     return *this;
   }
@@ -152,10 +158,9 @@ public:
 
 protected:
   Statistic &init() {
-    bool tmp = Initialized;
-    sys::MemoryFence();
-    if (!tmp) RegisterStatistic();
-    TsanHappensAfter(this);
+    // Only the first update of a statistic takes the registration lock.
+    if (LLVM_UNLIKELY(!Initialized.load(std::memory_order_acquire)))
+      RegisterStatistic();
     return *this;
   }
   void RegisterStatistic();
@@ -164,7 +169,7 @@ protected:
 // STATISTIC - A macro to make definition of statistics really simple.  This
 // automatically passes the DEBUG_TYPE of the file into the statistic.
 #define STATISTIC(VARNAME, DESC) \
-  static llvm::Statistic VARNAME = { DEBUG_TYPE, DESC, 0, 0 }
+  static llvm::Statistic VARNAME = { DEBUG_TYPE, DESC, {0}, {false} }
 
 /// \brief Enable the collection and printing of statistics.
 void EnableStatistics();
@@ -181,6 +186,30 @@ void PrintStatistics();
 /// \brief Print statistics to the given output stream.
 void PrintStatistics(raw_ostream &OS);
 
+/// \brief Print statistics in JSON format to the given output stream.
+///
+/// The output is an object whose "statistics" member lists each statistic
+/// with its DEBUG_TYPE, description and value, sorted as PrintStatistics sorts
+/// them. -stats-json makes the statistics printed at exit use this format.
+void PrintStatisticsJSON(raw_ostream &OS);
+
+/// \brief A statistic reported by GetStatistics: its DEBUG_TYPE, description
+/// and value.
+struct StatisticValue {
+  const char *Name;
+  const char *Desc;
+  unsigned Value;
+};
+
+/// \brief Return a snapshot of the statistics collected so far.
+std::vector<StatisticValue> GetStatistics();
+
+/// \brief Reset the statistics to zero and forget about them, so that the next
+/// compilation in the same process reports only its own statistics.
+///
+/// This must not run concurrently with updates of the statistics.
+void ResetStatistics();
+
 } // End llvm namespace
 
 #endif
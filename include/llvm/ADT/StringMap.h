@@ -74,11 +74,13 @@ protected:
   /// case, the FullHashValue field of the bucket will be set to the hash value
   /// of the string.
   unsigned LookupBucketFor(StringRef Key);
+  unsigned LookupBucketFor(StringRef Key, unsigned FullHashValue);
 
   /// FindKey - Look up the bucket that contains the specified key. If it exists
   /// in the map, return the bucket number of the key.  Otherwise return -1.
   /// This does not modify the map.
   int FindKey(StringRef Key) const;
+  int FindKey(StringRef Key, unsigned FullHashValue) const;
 
   /// RemoveKey - Remove the specified StringMapEntry from the table, but do not
   /// delete it.  This aborts if the value isn't in the table.
@@ -96,9 +98,22 @@ public:
     return (StringMapEntryBase*)-1;
   }
 
+  /// hash - Return the hash value of \p Key used by the map.  Clients that
+  /// look up the same string in several maps, or that keep it around, can
+  /// compute it once and pass it to the lookup methods that take a hash.
+  static unsigned hash(StringRef Key);
+
   unsigned getNumBuckets() const { return NumBuckets; }
   unsigned getNumItems() const { return NumItems; }
 
+  /// getMemorySize - Return the size of the bucket table in bytes.  This does
+  /// not include the entries, which come from the allocator of the map.
+  size_t getMemorySize() const {
+    return NumBuckets ? (NumBuckets + 1) * (sizeof(StringMapEntryBase *) +
+                                            sizeof(unsigned))
+                      : 0;
+  }
+
   bool empty() const { return NumItems == 0; }
   unsigned size() const { return NumItems; }
 
@@ -286,6 +301,20 @@ public:
     return const_iterator(TheTable+Bucket, true);
   }
 
+  /// find - Look up \p Key, whose hash value StringMapImpl::hash already
+  /// computed.
+  iterator find(StringRef Key, unsigned FullHashValue) {
+    int Bucket = FindKey(Key, FullHashValue);
+    if (Bucket == -1) return end();
+    return iterator(TheTable+Bucket, true);
+  }
+
+  const_iterator find(StringRef Key, unsigned FullHashValue) const {
+    int Bucket = FindKey(Key, FullHashValue);
+    if (Bucket == -1) return end();
+    return const_iterator(TheTable+Bucket, true);
+  }
+
   /// lookup - Return the entry for the specified key, or a default
   /// constructed value if no such entry exists.
   ValueTy lookup(StringRef Key) const {
@@ -328,7 +357,15 @@ public:
   /// if and only if the insertion takes place, and the iterator component of
   /// the pair points to the element with key equivalent to the key of the pair.
   std::pair<iterator, bool> insert(std::pair<StringRef, ValueTy> KV) {
-    unsigned BucketNo = LookupBucketFor(KV.first);
+    unsigned FullHashValue = hash(KV.first);
+    return insert(std::move(KV), FullHashValue);
+  }
+
+  /// insert - Like insert(KV), for a key whose hash value StringMapImpl::hash
+  /// already computed.
+  std::pair<iterator, bool> insert(std::pair<StringRef, ValueTy> KV,
+                                   unsigned FullHashValue) {
+    unsigned BucketNo = LookupBucketFor(KV.first, FullHashValue);
     StringMapEntryBase *&Bucket = TheTable[BucketNo];
     if (Bucket && Bucket != getTombstoneVal())
       return std::make_pair(iterator(TheTable + BucketNo, false),
@@ -26,6 +26,12 @@
 
 namespace llvm {
 
+/// \brief Mark the functions that a pass run over \p C may have changed.
+///
+/// The functions of the SCC are changed unless the pass preserved the function
+/// analysis manager proxy, in which case it marked them itself.
+void markChangedFunctions(LazyCallGraph::SCC &C, const PreservedAnalyses &PA);
+
 /// \brief The CGSCC pass manager.
 ///
 /// See the documentation for the PassManager template for details. It runs
@@ -228,6 +234,7 @@ public:
     PreservedAnalyses PA = PreservedAnalyses::all();
     for (LazyCallGraph::SCC &C : CG.postorder_sccs()) {
       PreservedAnalyses PassPA = Pass.run(C, &CGAM);
+      markChangedFunctions(C, PassPA);
 
       // We know that the CGSCC pass couldn't have invalidated any other
       // SCC's analyses (that's the contract of a CGSCC pass), so
@@ -448,6 +455,7 @@ public:
     PreservedAnalyses PA = PreservedAnalyses::all();
     for (LazyCallGraph::Node *N : C) {
       PreservedAnalyses PassPA = Pass.run(N->getFunction(), FAM);
+      markChangedFunctions(N->getFunction(), PassPA);
 
       // We know that the function pass couldn't have invalidated any other
       // function's analyses (that's the contract of a function pass), so
@@ -162,11 +162,14 @@ template <> struct isPodLike<BitCodeAbbrevOp> { static const bool value=true; };
 /// BitCodeAbbrev - This class represents an abbreviation record.  An
 /// abbreviation allows a complex record that has redundancy to be stored in a
 /// specialized format instead of the fully-general, fully-vbr, format.
-class BitCodeAbbrev : public RefCountedBase<BitCodeAbbrev> {
+///
+/// Abbreviations are shared between cursors, which may read the same stream
+/// on different threads.
+class BitCodeAbbrev : public ThreadSafeRefCountedBase<BitCodeAbbrev> {
   SmallVector<BitCodeAbbrevOp, 32> OperandList;
-  // Only RefCountedBase is allowed to delete.
+  // Only ThreadSafeRefCountedBase is allowed to delete.
   ~BitCodeAbbrev() = default;
-  friend class RefCountedBase<BitCodeAbbrev>;
+  friend class ThreadSafeRefCountedBase<BitCodeAbbrev>;
 
 public:
   unsigned getNumOperandInfos() const {
@@ -52,7 +52,11 @@ enum BlockIDs {
 
   OPERAND_BUNDLE_TAGS_BLOCK_ID,
 
-  METADATA_KIND_BLOCK_ID
+  METADATA_KIND_BLOCK_ID,
+
+  // Optional top-level block describing the symbols of the module, written
+  // between the identification and module blocks.
+  SYMTAB_BLOCK_ID
 };
 
 /// Identification block contains a string that describes the producer details,
@@ -188,6 +192,29 @@ enum { BITCODE_CURRENT_EPOCH = 0 };
     FS_CODE_COMBINED_ENTRY  = 2,  // FS_ENTRY: [modid, linkage, instcount]
   };
 
+  // The symbol table block. Names are offsets and sizes in the string table.
+  enum SymtabCodes {
+    SYMTAB_CODE_STRTAB = 1, // STRTAB: [blob]
+    SYMTAB_CODE_TRIPLE = 2, // TRIPLE: [offset, size]
+    SYMTAB_CODE_SYMBOL = 3, // SYMBOL: [offset, size, kind, flags, linkage,
+                            //          visibility, comdatoffset, comdatsize,
+                            //          commonsize, commonalign]
+  };
+
+  enum SymtabSymbolKind {
+    SYMTAB_KIND_FUNCTION = 0,
+    SYMTAB_KIND_VARIABLE = 1,
+    SYMTAB_KIND_ALIAS = 2
+  };
+
+  enum SymtabSymbolFlags {
+    SYMTAB_FLAG_UNDEFINED = 1 << 0,
+    SYMTAB_FLAG_CONSTANT = 1 << 1,
+    SYMTAB_FLAG_LLVM_SPECIFIC = 1 << 2, // llvm.* or in the llvm.metadata section
+    SYMTAB_FLAG_HAS_COMDAT = 1 << 3,
+    SYMTAB_FLAG_EXECUTABLE = 1 << 4 // Of function type, aliases included
+  };
+
   enum MetadataCodes {
     METADATA_STRING        = 1,   // MDSTRING:      [values]
     METADATA_VALUE         = 2,   // VALUE:         [type num, value num]
@@ -16,11 +16,13 @@
 
 #include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/FunctionInfo.h"
+#include "llvm/IR/GlobalValue.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace llvm {
   class BitstreamWriter;
@@ -94,6 +96,40 @@ namespace llvm {
       MemoryBufferRef Buffer, DiagnosticHandlerFunction DiagnosticHandler,
       StringRef FunctionName, std::unique_ptr<FunctionInfoIndex> Index);
 
+  /// A symbol of the symbol table optionally written along a module. The
+  /// strings point into the bitcode buffer.
+  struct BitcodeSymbol {
+    enum KindTy { Function, Variable, Alias };
+
+    /// The name of the symbol as seen by the linker, i.e. mangled.
+    StringRef Name;
+    /// The name of the comdat of the symbol, if HasComdat.
+    StringRef Comdat;
+    uint64_t CommonSize = 0;
+    unsigned CommonAlign = 0;
+    GlobalValue::LinkageTypes Linkage = GlobalValue::ExternalLinkage;
+    GlobalValue::VisibilityTypes Visibility = GlobalValue::DefaultVisibility;
+    KindTy Kind = Function;
+    bool IsUndefined = false;
+    bool IsConstant = false;
+    /// Whether the symbol is only meaningful to LLVM, such as llvm.used.
+    bool IsLLVMSpecific = false;
+    bool HasComdat = false;
+    /// Whether the symbol is code, i.e. a function or an alias to one.
+    bool IsExecutable = false;
+  };
+
+  struct BitcodeSymbolTable {
+    StringRef TargetTriple;
+    std::vector<BitcodeSymbol> Symbols;
+  };
+
+  /// Read the symbol table of the specified bitcode buffer, without reading
+  /// the module. The table points into \p Buffer, which must outlive it.
+  /// Returns null if the bitcode has no symbol table.
+  ErrorOr<std::unique_ptr<BitcodeSymbolTable>>
+  readBitcodeSymbolTable(MemoryBufferRef Buffer);
+
   /// \brief Write the specified module to the specified raw output stream.
   ///
   /// For streams where it matters, the given stream should be in "binary"
@@ -105,9 +141,15 @@ namespace llvm {
   ///
   /// If \c EmitFunctionSummary, emit the function summary index (currently
   /// for use in ThinLTO optimization).
+  ///
+  /// If \c EmitSymbolTable, emit a symbol table block that tools only
+  /// interested in the symbols of \c M can read without reading the module.
+  /// The block is omitted when \c M has module inline asm, whose symbols the
+  /// writer can't know.
   void WriteBitcodeToFile(const Module *M, raw_ostream &Out,
                           bool ShouldPreserveUseListOrder = false,
-                          bool EmitFunctionSummary = false);
+                          bool EmitFunctionSummary = false,
+                          bool EmitSymbolTable = false);
 
   /// Write the specified function summary index to the given raw output stream,
   /// where it will be written in a new bitcode block. This is used when
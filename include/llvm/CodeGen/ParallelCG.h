@@ -29,6 +29,10 @@ class raw_pwrite_stream;
 /// files if linked together are intended to be equivalent to the single output
 /// file that would have been code generated from M.
 ///
+/// The partitions are balanced by instruction count. Code for the last one is
+/// generated on the calling thread in the context of M, the other partitions
+/// are moved to separate contexts and compiled on their own threads.
+///
 /// \returns M if OSs.size() == 1, otherwise returns std::unique_ptr<Module>().
 std::unique_ptr<Module>
 splitCodeGen(std::unique_ptr<Module> M, ArrayRef<raw_pwrite_stream *> OSs,
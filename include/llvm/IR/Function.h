@@ -73,7 +73,9 @@ private:
   enum {
     /// Whether this function is materializable.
     IsMaterializableBit = 1 << 0,
-    HasMetadataHashEntryBit = 1 << 1
+    HasMetadataHashEntryBit = 1 << 1,
+    /// Whether the verifier accepted the body and it has not changed since.
+    IsVerifiedBit = 1 << 2
   };
   void setGlobalObjectBit(unsigned Mask, bool Value) {
     setGlobalObjectSubClassData((~Mask & getGlobalObjectSubClassData()) |
@@ -132,6 +134,20 @@ public:
   bool isMaterializable() const;
   void setIsMaterializable(bool V);
 
+  /// isVerified - Return true if the verifier accepted the body of this
+  /// function and nothing marked it changed since.  Incremental verification
+  /// (see verifyModule) skips such functions.
+  bool isVerified() const {
+    return getGlobalObjectSubClassData() & IsVerifiedBit;
+  }
+  void setIsVerified(bool V) { setGlobalObjectBit(IsVerifiedBit, V); }
+
+  /// markChanged - Record that the body of this function may have changed
+  /// since it was last verified.  The pass managers call this for the
+  /// functions a pass reports changing; code that edits IR outside of a pass
+  /// and relies on incremental verification must call it too.
+  void markChanged() { setIsVerified(false); }
+
   /// getIntrinsicID - This method returns the ID number of the specified
   /// function, or Intrinsic::not_intrinsic if the function is not an
   /// intrinsic, or if the pointer is null.  This value is always defined to be
@@ -20,6 +20,7 @@
 #include "llvm/ADT/StringMap.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Mutex.h"
 #include "llvm/Support/raw_ostream.h"
 
 namespace llvm {
@@ -158,17 +159,52 @@ typedef FunctionInfoMapTy::iterator funcinfo_iterator;
 /// makes a copy of and owns inserted strings.
 typedef StringMap<uint64_t> ModulePathStringTableTy;
 
+/// Interface for reading the function infos of a lazily loaded
+/// FunctionInfoIndex on demand, e.g. from a memory-mapped combined index.
+class FunctionInfoSource {
+public:
+  virtual ~FunctionInfoSource();
+
+  /// Return the number of functions with function infos.
+  virtual unsigned getNumFunctions() const = 0;
+
+  /// Read the function infos recorded for \p FuncName into \p List, with
+  /// module paths owned by the index. Returns false if there are none.
+  virtual bool readFunctionInfoList(StringRef FuncName,
+                                    FunctionInfoList &List) = 0;
+
+  /// Add to \p Map the function info lists of the functions it doesn't
+  /// contain yet.
+  virtual void readAllFunctionInfoLists(FunctionInfoMapTy &Map) = 0;
+};
+
 /// Class to hold module path string table and function map,
 /// and encapsulate methods for operating on them.
+///
+/// A lazily loaded index only holds the function infos that have been looked
+/// up so far. findFunctionInfoList reads the others under a lock, into a map
+/// sized for all the functions of the source, so it may be called from several
+/// threads at once and the iterators it returns stay valid. The non-const
+/// methods must not run concurrently with any other.
 class FunctionInfoIndex {
 private:
   /// Map from function name to list of function information instances
   /// for functions of that name (may be duplicates in the COMDAT case, e.g.).
-  FunctionInfoMapTy FunctionMap;
+  /// The function infos of a lazily loaded index are added by const lookups.
+  mutable FunctionInfoMapTy FunctionMap;
 
   /// Holds strings for combined index, mapping to the corresponding module ID.
   ModulePathStringTableTy ModulePathStringTable;
 
+  /// Reads the function infos not in FunctionMap yet, if the index is lazily
+  /// loaded.
+  std::unique_ptr<FunctionInfoSource> Source;
+
+  /// Guards FunctionMap during the lookups of a lazily loaded index.
+  mutable sys::Mutex SourceLock;
+
+  const_funcinfo_iterator materializeFunctionInfoList(StringRef FuncName) const;
+
 public:
   FunctionInfoIndex() = default;
 
@@ -184,12 +220,16 @@ public:
 
   /// Get the list of function info objects for a given function.
   const FunctionInfoList &getFunctionInfoList(StringRef FuncName) {
+    if (Source)
+      findFunctionInfoList(FuncName);
     return FunctionMap[FuncName];
   }
 
   /// Get the list of function info objects for a given function.
   const const_funcinfo_iterator findFunctionInfoList(StringRef FuncName) const {
-    return FunctionMap.find(FuncName);
+    if (!Source)
+      return FunctionMap.find(FuncName);
+    return materializeFunctionInfoList(FuncName);
   }
 
   /// Add a function info for a function of the given name.
@@ -209,6 +249,15 @@ public:
     return ModulePathStringTable.lookup(ModPath);
   }
 
+  /// Read the function infos of a lazily loaded index on demand from
+  /// \p Source. The module paths must be added to the index beforehand, and
+  /// no function info.
+  void setSource(std::unique_ptr<FunctionInfoSource> Source);
+
+  /// Read all the function infos of a lazily loaded index, which is needed
+  /// before iterating over its functions.
+  void materializeAll();
+
   /// Add the given per-module index into this function index/summary,
   /// assigning it the given module ID. Each module merged in should have
   /// a unique ID, necessary for consistent renaming of promoted
@@ -35,14 +35,42 @@ class DebugLoc;
 /// This is an important class for using LLVM in a threaded context.  It
 /// (opaquely) owns and manages the core "global" data of LLVM's core
 /// infrastructure, including the type and constant uniquing tables.
-/// LLVMContext itself provides no locking guarantees, so you should be careful
-/// to have one context per thread.
+/// By default LLVMContext provides no locking guarantees, so you should be
+/// careful to have one context per thread. A context created with
+/// ConcurrentUniquing allows several threads to create constants, types and
+/// metadata at the same time, but not to modify IR that shares values with
+/// other threads; see UniquingMode.
 class LLVMContext {
 public:
+  /// Selects whether the uniquing tables of a context may be accessed from
+  /// several threads at once.
+  enum UniquingMode {
+    /// The uniquing tables are accessed without any synchronization.
+    SingleThreadedUniquing,
+    /// The constant, type, metadata and attribute uniquing tables are guarded
+    /// by locks, so that the corresponding get() methods may be called
+    /// concurrently.
+    ///
+    /// Use-lists, value handles, names and other per-value state remain
+    /// unsynchronized. Creating or deleting an instruction adds or removes a
+    /// use of each of its operands, and global values and constants are
+    /// operands shared by all the functions of a module. This mode therefore
+    /// does not make it safe to run passes or code generation on several
+    /// functions of one module at once. It is meant for threads that only
+    /// read shared IR, like the verifier, or that build IR no other thread
+    /// can reach.
+    ConcurrentUniquing
+  };
+
   LLVMContextImpl *const pImpl;
   LLVMContext();
+  explicit LLVMContext(UniquingMode Mode);
   ~LLVMContext();
 
+  /// Return true if the uniquing tables of this context may be accessed from
+  /// several threads at once.
+  bool hasConcurrentUniquing() const;
+
   // Pinned metadata names, which always have the same value.  This is a
   // compile-time performance optimization, not a correctness optimization.
   enum {
@@ -98,6 +98,7 @@ namespace llvm {
   class StringRef;
   class Value;
   class Timer;
+  class TraceEventRecorder;
   class PMDataManager;
 
 // enums for debugging strings
@@ -503,6 +504,10 @@ public:
 };
 
 Timer *getPassTimer(Pass *);
+
+/// Return the recorder of the pass execution trace, if any. Shared with the
+/// new pass manager, see llvm/IR/PassManager.h.
+TraceEventRecorder *getPassTraceRecorder();
 }
 
 #endif
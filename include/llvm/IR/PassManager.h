@@ -46,6 +46,7 @@
 #include "llvm/IR/PassManagerInternal.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/TraceEvents.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/type_traits.h"
 #include <list>
@@ -166,6 +167,28 @@ private:
 // Forward declare the analysis manager template.
 template <typename IRUnitT> class AnalysisManager;
 
+/// \brief Return the recorder of the pass execution trace requested with
+/// -pass-trace-file, or null if no trace is being recorded.
+///
+/// Both the legacy and the new pass managers record their pass runs in it,
+/// and the trace is written when llvm_shutdown() is called.
+TraceEventRecorder *getPassTraceRecorder();
+
+/// \brief Mark the functions that a pass run over \p F may have changed, given
+/// the analyses \p PA it preserved, so that the incremental verifier checks
+/// them again (see Function::markChanged).
+///
+/// A function is changed unless the pass preserved all analyses.
+void markChangedFunctions(Function &F, const PreservedAnalyses &PA);
+
+/// \brief Mark the functions that a pass run over \p M may have changed.
+///
+/// Module passes which handle function analyses incrementally, such as the
+/// adaptors running function passes, preserve the function analysis manager
+/// proxy and mark the functions they change themselves. Every function is
+/// changed after the other module passes that do not preserve all analyses.
+void markChangedFunctions(Module &M, const PreservedAnalyses &PA);
+
 /// \brief Manages a sequence of passes over units of IR.
 ///
 /// A pass manager contains a sequence of passes to run over units of IR. It is
@@ -206,7 +229,14 @@ public:
         dbgs() << "Running pass: " << Passes[Idx]->name() << " on "
                << IR.getName() << "\n";
 
-      PreservedAnalyses PassPA = Passes[Idx]->run(IR, AM);
+      PreservedAnalyses PassPA;
+      {
+        TraceRegion PassTrace(getPassTraceRecorder(), Passes[Idx]->name(),
+                              "pass", IR.getName());
+        PassPA = Passes[Idx]->run(IR, AM);
+      }
+
+      markChangedFunctions(IR, PassPA);
 
       // If we have an active analysis manager at this level we want to ensure
       // we update it as each pass runs and potentially invalidates analyses.
@@ -795,6 +825,7 @@ public:
         continue;
 
       PreservedAnalyses PassPA = Pass.run(F, FAM);
+      markChangedFunctions(F, PassPA);
 
       // We know that the function pass couldn't have invalidated any other
       // function's analyses (that's the contract of a function pass), so
@@ -46,7 +46,19 @@ bool verifyFunction(const Function &F, raw_ostream *OS = nullptr);
 /// If there are no errors, the function returns false. If an error is found,
 /// a message describing the error is written to OS (if non-null) and true is
 /// returned.
-bool verifyModule(const Module &M, raw_ostream *OS = nullptr);
+///
+/// If \p OnlyChanged is true, the functions that the verifier accepted before
+/// and that were not marked changed since (see Function::markChanged) are not
+/// checked again, except as needed to check the llvm.localrecover calls of
+/// the functions that are.  The module-level checks always run.
+///
+/// With -verify-threads=N, the functions and the subprograms of the debug
+/// info are checked on N threads; the diagnostics are the same as when
+/// checking them serially.  The checks create constants, so the LLVMContext
+/// of \p M is switched to concurrent uniquing for the duration of the call:
+/// no other thread may use that context while verifyModule runs.
+bool verifyModule(const Module &M, raw_ostream *OS = nullptr,
+                  bool OnlyChanged = false);
 
 /// \brief Create a verifier pass.
 ///
@@ -57,7 +69,8 @@ bool verifyModule(const Module &M, raw_ostream *OS = nullptr);
 /// passing \c false to \p FatalErrors.
 ///
 /// Note that this creates a pass suitable for the legacy pass manager. It has
-/// nothing to do with \c VerifierPass.
+/// nothing to do with \c VerifierPass.  It checks functions one at a time, as
+/// the pass manager hands them out, so -verify-threads does not apply to it.
 FunctionPass *createVerifierPass(bool FatalErrors = true);
 
 class VerifierPass {
@@ -105,6 +105,21 @@ struct LTOCodeGenerator {
 
   void addMustPreserveSymbol(StringRef Sym) { MustPreserveSymbols[Sym] = 1; }
 
+  /// Set the directory of the on-disk object cache.
+  ///
+  /// When set, the object generated for the merged module is stored in this
+  /// directory, keyed on a hash of the merged module, the target and the
+  /// optimization options. A later link with the same inputs and options
+  /// reuses it instead of optimizing and compiling the merged module again.
+  /// The cache is only used when the output is not split for parallel code
+  /// generation.
+  void setCacheDir(StringRef Dir) { CacheDir = Dir; }
+
+  /// Set the maximum size in bytes of the object cache. The least recently
+  /// used objects are removed once a new object makes it grow larger. The
+  /// default of 0 means the size is not limited.
+  void setCacheMaxSize(uint64_t Size) { CacheMaxSize = Size; }
+
   /// Pass options to the driver and optimization passes.
   ///
   /// These options are not necessarily for debugging purpose (the function
@@ -146,6 +161,10 @@ struct LTOCodeGenerator {
                                         bool DisableVectorization);
 
   /// Optimizes the merged module.  Returns true on success.
+  ///
+  /// If the object cache already has an object for the merged module,
+  /// optimization is skipped and the next compileOptimized() call returns the
+  /// cached object.
   bool optimize(bool DisableVerify, bool DisableInline, bool DisableGVNLoadPRE,
                 bool DisableVectorization);
 
@@ -171,6 +190,10 @@ private:
   void initializeLTOPasses();
 
   bool compileOptimizedToFile(const char **Name);
+  void runOptimizationPasses();
+  std::string computeCacheKey();
+  void lookupCachedObject();
+  void storeCachedObject(StringRef Object);
   void restoreLinkageForExternals();
   void applyScopeRestrictions();
   void applyRestriction(GlobalValue &GV, ArrayRef<StringRef> Libcalls,
@@ -211,6 +234,23 @@ private:
   bool ShouldEmbedUselists = false;
   bool ShouldRestoreGlobalsLinkage = false;
   TargetMachine::CodeGenFileType FileType = TargetMachine::CGFT_ObjectFile;
+
+  /// Flags of the last optimize() call, which are kept until optimization
+  /// actually runs.
+  bool DisableVerify = false;
+  bool DisableInline = false;
+  bool DisableGVNLoadPRE = false;
+  bool DisableVectorization = false;
+
+  std::string CacheDir;
+  uint64_t CacheMaxSize = 0;
+  /// Key of the merged module in the object cache, set by optimize() while the
+  /// cache is enabled.
+  std::string CacheKey;
+  /// Object found in the cache by optimize(), if any.
+  std::unique_ptr<MemoryBuffer> CachedObject;
+  /// False if optimize() skipped optimization because of a cache hit.
+  bool OptimizationDone = true;
 };
 }
 #endif
@@ -0,0 +1,126 @@
+//===-ThinLTOCodeGenerator.h - LLVM ThinLTO backend driver -----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the ThinLTOCodeGenerator class, which runs the ThinLTO
+// backends of a link in process.
+//
+//   In ThinLTO, every module of the link is optimized and compiled on its own,
+// after importing the functions of other modules it may benefit from. The
+// functions to import are chosen using the combined function index, built
+// from the function summaries of all the modules. Each of these per-module
+// backends is independent from the others, so they are run in parallel, each
+// one in its own LLVMContext.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LTO_THINLTOCODEGENERATOR_H
+#define LLVM_LTO_THINLTOCODEGENERATOR_H
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/CodeGen.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Target/TargetOptions.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace llvm {
+class FunctionInfoIndex;
+class LLVMContext;
+class Module;
+
+/// Driver running the ThinLTO backend, i.e. function importing, optimization
+/// and code generation, for each module of a link, on a thread pool.
+class ThinLTOCodeGenerator {
+public:
+  /// Receives the object generated for the module added at position
+  /// \p ModuleIndex. It is called on the thread that generated the object, but
+  /// never concurrently, and the object is freed when it returns.
+  typedef std::function<void(unsigned ModuleIndex, StringRef Object)>
+      ObjectHandlerTy;
+
+  /// Add the module with the given bitcode to the link. \p Identifier must be
+  /// the identifier the module has in the function summaries, i.e. the
+  /// identifier of the buffer it is read from. \p Data must stay alive until
+  /// run() returns.
+  void addModule(StringRef Identifier, StringRef Data);
+
+  /// How the linker resolved a symbol defined by one of the modules.
+  enum SymbolResolution {
+    /// The definition is the one the link uses. It is emitted even if its
+    /// module doesn't use it, e.g. a linkonce definition is made weak.
+    PrevailingDef,
+    /// Another definition is used. This one is dropped, and its module
+    /// refers to the prevailing one, which it may import but doesn't emit.
+    PreemptedDef
+  };
+
+  /// Set how the linker resolved the symbol \p Name, defined by the module
+  /// added at position \p ModuleIndex. \p Name is the name of the symbol in
+  /// the object file. Definitions without a resolution are left as they are.
+  void setSymbolResolution(unsigned ModuleIndex, StringRef Name,
+                           SymbolResolution Resolution);
+
+  void setTargetOptions(TargetOptions Options) { this->Options = Options; }
+  void setCodePICModel(Reloc::Model Model) { RelocModel = Model; }
+  void setCpu(StringRef MCpu) { this->MCpu = MCpu; }
+  void setAttr(StringRef MAttr) { this->MAttr = MAttr; }
+  void setOptLevel(unsigned OptLevel);
+  void setFileType(TargetMachine::CodeGenFileType FT) { FileType = FT; }
+
+  /// Set the number of backends running at the same time. Defaults to the
+  /// number of hardware threads.
+  void setThreadCount(unsigned Count) { ThreadCount = Count; }
+
+  /// Bound the memory used by the backends running at the same time. The
+  /// memory of a backend is estimated from the size of its module's bitcode,
+  /// and a backend only starts when the estimates of the running ones and its
+  /// own fit in \p Size bytes, or when no other backend is running. 0, the
+  /// default, means no bound besides the thread count.
+  void setMaxInFlightSize(uint64_t Size) { MaxInFlightSize = Size; }
+
+  /// Build the combined function index of the modules and run their backends,
+  /// passing the generated objects to \p HandleObject. Modules without
+  /// function summary are still optimized and compiled, without importing.
+  ///
+  /// \returns false and sets \p ErrMsg if any backend failed.
+  bool run(const ObjectHandlerTy &HandleObject, std::string &ErrMsg);
+
+private:
+  struct ModuleBuffer {
+    StringRef Identifier;
+    StringRef Data;
+    StringMap<SymbolResolution> Resolutions;
+  };
+
+  std::unique_ptr<Module> loadModule(const ModuleBuffer &Buffer,
+                                     LLVMContext &Context, bool Lazy,
+                                     std::string &ErrMsg);
+  std::unique_ptr<TargetMachine> createTargetMachine(Module &M,
+                                                     std::string &ErrMsg);
+  void optimize(Module &M, TargetMachine &TM);
+  bool runBackend(unsigned ModuleIndex, const FunctionInfoIndex &Index,
+                  SmallVectorImpl<char> &Object, std::string &ErrMsg);
+
+  std::vector<ModuleBuffer> Modules;
+  StringMap<unsigned> ModuleMap;
+  TargetOptions Options;
+  Reloc::Model RelocModel = Reloc::Default;
+  std::string MCpu;
+  std::string MAttr;
+  unsigned OptLevel = 2;
+  CodeGenOpt::Level CGOptLevel = CodeGenOpt::Default;
+  TargetMachine::CodeGenFileType FileType = TargetMachine::CGFT_ObjectFile;
+  unsigned ThreadCount = 0;
+  uint64_t MaxInFlightSize = 0;
+};
+}
+#endif
@@ -171,14 +171,7 @@ public:
       writeBE64(Value);
   }
 
-  void WriteZeros(unsigned N) {
-    const char Zeros[16] = {0};
-
-    for (unsigned i = 0, e = N / 16; i != e; ++i)
-      *OS << StringRef(Zeros, 16);
-
-    *OS << StringRef(Zeros, N % 16);
-  }
+  void WriteZeros(unsigned N) { OS->write_zeros(N); }
 
   void writeBytes(const SmallVectorImpl<char> &ByteVec,
                   unsigned ZeroFillSize = 0) {
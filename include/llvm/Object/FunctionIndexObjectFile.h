@@ -101,7 +101,8 @@ public:
 }
 
 /// Parse the function index out of an IR file and return the function
-/// index object if found, or nullptr if not.
+/// index object if found, or nullptr if not. A function index table is not
+/// parsed, but loaded lazily.
 ErrorOr<std::unique_ptr<FunctionInfoIndex>>
 getFunctionIndexForFile(StringRef Path,
                         DiagnosticHandlerFunction DiagnosticHandler);
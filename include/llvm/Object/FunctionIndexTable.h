@@ -0,0 +1,49 @@
+//===- FunctionIndexTable.h - Memory-mappable function index ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the reader and writer of function index tables, an
+// on-disk format for the combined function index of ThinLTO.
+//
+//   Unlike the bitcode combined index, a function index table doesn't need to
+// be parsed as a whole: it is an on-disk hash table keyed by function name,
+// which can be memory mapped and looked up in place. A FunctionInfoIndex read
+// from a table only materializes the summaries of the functions looked up,
+// which is what the importing of a single backend needs.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_OBJECT_FUNCTIONINDEXTABLE_H
+#define LLVM_OBJECT_FUNCTIONINDEXTABLE_H
+
+#include "llvm/Support/ErrorOr.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <memory>
+
+namespace llvm {
+class FunctionInfoIndex;
+class raw_ostream;
+
+namespace object {
+
+/// Write the given combined index as a function index table. All the
+/// functions of \p Index must have a summary.
+void writeFunctionIndexTable(const FunctionInfoIndex &Index, raw_ostream &OS);
+
+/// Return true if the given buffer holds a function index table.
+bool isFunctionIndexTable(MemoryBufferRef Buffer);
+
+/// Create a lazily loaded FunctionInfoIndex from the function index table in
+/// \p Buffer, which it takes ownership of. Only the module paths are read up
+/// front.
+ErrorOr<std::unique_ptr<FunctionInfoIndex>>
+createFunctionIndexFromTable(std::unique_ptr<MemoryBuffer> Buffer);
+}
+}
+
+#endif
@@ -20,6 +20,8 @@ namespace llvm {
 class Mangler;
 class Module;
 class GlobalValue;
+struct BitcodeSymbol;
+struct BitcodeSymbolTable;
 
 namespace object {
 class ObjectFile;
@@ -28,9 +30,14 @@ class IRObjectFile : public SymbolicFile {
   std::unique_ptr<Module> M;
   std::unique_ptr<Mangler> Mang;
   std::vector<std::pair<std::string, uint32_t>> AsmSymbols;
+  /// The symbols, when read from the symbol table of the bitcode instead of
+  /// the module.
+  std::unique_ptr<BitcodeSymbolTable> Symtab;
 
 public:
   IRObjectFile(MemoryBufferRef Object, std::unique_ptr<Module> M);
+  IRObjectFile(MemoryBufferRef Object,
+               std::unique_ptr<BitcodeSymbolTable> Symtab);
   ~IRObjectFile() override;
   void moveSymbolNext(DataRefImpl &Symb) const override;
   std::error_code printSymbolName(raw_ostream &OS,
@@ -43,10 +50,21 @@ public:
   basic_symbol_iterator symbol_begin_impl() const override;
   basic_symbol_iterator symbol_end_impl() const override;
 
+  /// Return the entry of the symbol in the bitcode symbol table, or null if
+  /// the symbols come from the module.
+  const BitcodeSymbol *getSymbolTableEntry(DataRefImpl Symb) const;
+
+  StringRef getTargetTriple() const;
+
+  /// Return true if the symbols are read from the module, false if they are
+  /// read from the bitcode symbol table, in which case there is no module.
+  bool hasModule() const { return !Symtab; }
+
   const Module &getModule() const {
     return const_cast<IRObjectFile*>(this)->getModule();
   }
   Module &getModule() {
+    assert(hasModule() && "Symbols read from the bitcode symbol table");
     return *M;
   }
   std::unique_ptr<Module> takeModule();
@@ -67,6 +85,12 @@ public:
 
   static ErrorOr<std::unique_ptr<IRObjectFile>> create(MemoryBufferRef Object,
                                                        LLVMContext &Context);
+
+  /// \brief Create an IRObjectFile from the symbol table of the bitcode,
+  /// without reading the module. Returns null if the bitcode has no symbol
+  /// table.
+  static ErrorOr<std::unique_ptr<IRObjectFile>>
+  createFromSymbolTable(MemoryBufferRef Object);
 };
 }
 }
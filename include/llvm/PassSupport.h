@@ -27,31 +27,28 @@
 #include "llvm/PassRegistry.h"
 #include "llvm/Support/Atomic.h"
 #include "llvm/Support/Compiler.h"
+#include <atomic>
 #include <vector>
 
 namespace llvm {
 
 class TargetMachine;
 
+// Once the initialization is done, calling it again is a single acquire load,
+// so that the pass constructors of concurrent compilations do not contend on
+// the flag.
 #define CALL_ONCE_INITIALIZATION(function) \
-  static volatile sys::cas_flag initialized = 0; \
-  sys::cas_flag old_val = sys::CompareAndSwap(&initialized, 1, 0); \
-  if (old_val == 0) { \
-    function(Registry); \
-    sys::MemoryFence(); \
-    TsanIgnoreWritesBegin(); \
-    TsanHappensBefore(&initialized); \
-    initialized = 2; \
-    TsanIgnoreWritesEnd(); \
-  } else { \
-    sys::cas_flag tmp = initialized; \
-    sys::MemoryFence(); \
-    while (tmp != 2) { \
-      tmp = initialized; \
-      sys::MemoryFence(); \
+  static std::atomic<sys::cas_flag> initialized; \
+  if (initialized.load(std::memory_order_acquire) != 2) { \
+    sys::cas_flag old_val = 0; \
+    if (initialized.compare_exchange_strong(old_val, 1)) { \
+      function(Registry); \
+      initialized.store(2, std::memory_order_release); \
+    } else { \
+      while (initialized.load(std::memory_order_acquire) != 2) \
+        ; \
     } \
-  } \
-  TsanHappensAfter(&initialized);
+  }
 
 #define INITIALIZE_PASS(passName, arg, name, cfg, analysis) \
   static void* initialize##passName##PassOnce(PassRegistry &Registry) { \
@@ -108,6 +108,77 @@ public:
   void PrintStats() const {}
 };
 
+/// \brief The allocator BumpPtrAllocatorImpl gets its slabs from by default.
+///
+/// By default, slabs come from malloc.  Large compilations, which traverse
+/// gigabytes of IR and MachineInstrs, can select with -slab-backing another
+/// backing at runtime: slabs are then carved out of 2MB chunks of mapped
+/// memory, which can be backed by transparent or explicit huge pages to save
+/// TLB misses.  With -slab-numa-local, each NUMA node gets its own chunks, and
+/// the pages of a chunk are placed on the node of the thread that uses it.
+///
+/// Chunks are never returned to the system.  Instead, slabs released by a
+/// BumpPtrAllocator, e.g. when a MachineFunction is destroyed, are kept and
+/// handed out again to the next allocators asking for slabs of their size.
+///
+/// Each SlabAllocator remembers whether it handed out mapped slabs, so that
+/// allocators which only ever used malloc free their slabs without looking
+/// them up in the shared pool.
+class SlabAllocator : public AllocatorBase<SlabAllocator> {
+  /// Whether some of the slabs allocated so far are mapped memory.
+  bool HasMappedSlabs = false;
+
+public:
+  enum BackingKind {
+    Malloc,                ///< malloc and free.
+    Pages,                 ///< Chunks of mapped memory with normal pages.
+    TransparentHugePages,  ///< Chunks backed by transparent huge pages.
+    ExplicitHugePages      ///< Chunks backed by reserved huge pages, or by
+                           ///< transparent huge pages if none is left.
+  };
+
+  /// \brief Select the memory backing the slabs allocated from now on.
+  ///
+  /// This is not synchronized with concurrent allocations, so it should be
+  /// called before the compilation starts threads.
+  static void setBacking(BackingKind Kind);
+  static BackingKind getBacking();
+
+  /// \brief Give each NUMA node its own chunks when mapping memory.
+  static void setNUMALocal(bool Enable);
+
+  /// \brief Return the number of bytes mapped for slabs so far.
+  static size_t getMappedMemory();
+
+  void Reset() {}
+
+  LLVM_ATTRIBUTE_RETURNS_NONNULL void *Allocate(size_t Size,
+                                                size_t Alignment) {
+    if (LLVM_LIKELY(getBacking() == Malloc))
+      return malloc(Size);
+    HasMappedSlabs = true;
+    return allocateMapped(Size);
+  }
+
+  // Pull in base class overloads.
+  using AllocatorBase<SlabAllocator>::Allocate;
+
+  void Deallocate(const void *Ptr, size_t Size) {
+    if (LLVM_LIKELY(!HasMappedSlabs))
+      return free(const_cast<void *>(Ptr));
+    deallocateMapped(Ptr, Size);
+  }
+
+  // Pull in base class overloads.
+  using AllocatorBase<SlabAllocator>::Deallocate;
+
+  void PrintStats() const {}
+
+private:
+  static void *allocateMapped(size_t Size);
+  static void deallocateMapped(const void *Ptr, size_t Size);
+};
+
 namespace detail {
 
 // We call out to an external function to actually print the message as the
@@ -127,10 +198,10 @@ void printBumpPtrAllocatorStats(unsigned NumSlabs, size_t BytesAllocated,
 /// Note that this also has a threshold for forcing allocations above a certain
 /// size into their own slab.
 ///
-/// The BumpPtrAllocatorImpl template defaults to using a MallocAllocator
-/// object, which wraps malloc, to allocate memory, but it can be changed to
-/// use a custom allocator.
-template <typename AllocatorT = MallocAllocator, size_t SlabSize = 4096,
+/// The BumpPtrAllocatorImpl template defaults to using a SlabAllocator
+/// object, which wraps malloc unless told otherwise, to allocate memory, but it
+/// can be changed to use a custom allocator.
+template <typename AllocatorT = SlabAllocator, size_t SlabSize = 4096,
           size_t SizeThreshold = SlabSize>
 class BumpPtrAllocatorImpl
     : public AllocatorBase<
@@ -174,6 +174,7 @@ extern OptionCategory GeneralCategory;
 // Option Base class
 //
 class alias;
+class OptionContext;
 class Option {
   friend class alias;
 
@@ -282,6 +283,12 @@ public:
   virtual bool addOccurrence(unsigned pos, StringRef ArgName, StringRef Value,
                              bool MultiArg = false);
 
+  // setContextValue - Parse Value as the value of this option in Ctx.  Only
+  // options that hold a scalar value support this.  Returns true on error.
+  //
+  virtual bool setContextValue(OptionContext &Ctx, StringRef ArgName,
+                               StringRef Value);
+
   // Prints option name followed by message.  Always returns true.
   bool error(const Twine &Message, StringRef ArgName = StringRef());
 
@@ -1081,6 +1088,77 @@ template <class Opt, class Mod> void apply(Opt *O, const Mod &M) {
   applicator<Mod>::opt(M, *O);
 }
 
+//===----------------------------------------------------------------------===//
+// OptionContext class
+//
+
+/// OptionContext - A set of option values which, on the threads the context
+/// is active on, override the values parsed from the command line.  This lets
+/// one process run concurrent compilations with different flags:
+///
+///   cl::OptionContext Ctx;
+///   Ctx.setOption("inline-threshold", "500");
+///   ...
+///   cl::OptionContext::Scope S(Ctx); // On the thread of the compilation.
+///
+/// Only options which hold a scalar in the option itself, such as
+/// cl::opt<bool>, cl::opt<unsigned> or cl::opt<SomeEnum>, can be set in a
+/// context.  A context must not be changed while it is active; options are
+/// then read without locks, and cost one thread-local load more than a plain
+/// global when no context is active.  getNumOccurrences() only reports the
+/// command line.
+class OptionContext {
+public:
+  OptionContext();
+  ~OptionContext();
+
+  /// setOption - Set the option named ArgName to Value in this context, as
+  /// -ArgName=Value would on the command line.  Returns true and prints an
+  /// error if there is no such option, it cannot be set in a context, or
+  /// Value is invalid.
+  bool setOption(StringRef ArgName, StringRef Value);
+
+  /// getCurrent - Return the context active on this thread, if any.
+  static OptionContext *getCurrent() { return Current; }
+
+  /// lookup - Return the value of the option storing its value at Storage in
+  /// this context, or null if the context does not set it.
+  void *lookup(const void *Storage) const;
+
+  /// setValue - Set the value of the option storing its value at Storage.
+  /// The context takes ownership of Value and destroys it with Deleter.
+  void setValue(const void *Storage, void *Value, void (*Deleter)(void *));
+
+  /// Scope - Makes a context active on the current thread for its lifetime.
+  class Scope {
+    OptionContext *Saved;
+
+  public:
+    explicit Scope(OptionContext &Ctx) : Saved(Current) { Current = &Ctx; }
+    /// A null context makes the command-line values visible in the scope.
+    explicit Scope(OptionContext *Ctx) : Saved(Current) { Current = Ctx; }
+    ~Scope() { Current = Saved; }
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+  };
+
+private:
+  OptionContext(const OptionContext &) = delete;
+  OptionContext &operator=(const OptionContext &) = delete;
+
+  struct Entry {
+    const void *Storage;
+    void *Value;
+    void (*Deleter)(void *);
+  };
+  // Sorted by Storage.  Contexts set few options, and lookups only happen
+  // while a context is active.
+  std::vector<Entry> Entries;
+
+  static LLVM_THREAD_LOCAL OptionContext *Current;
+};
+
 //===----------------------------------------------------------------------===//
 // opt_storage class
 
@@ -1129,6 +1207,12 @@ public:
   operator DataType() const { return this->getValue(); }
 
   const OptionValue<DataType> &getDefault() const { return Default; }
+
+  template <class T>
+  bool setContextValue(Option &O, OptionContext &, const T &) {
+    return O.error("cannot be set in an option context, it uses external "
+                   "storage");
+  }
 };
 
 // Define how to hold a class type object, such as a string.  Since we can
@@ -1150,6 +1234,11 @@ public:
   const DataType &getValue() const { return *this; }
 
   const OptionValue<DataType> &getDefault() const { return Default; }
+
+  template <class T>
+  bool setContextValue(Option &O, OptionContext &, const T &) {
+    return O.error("cannot be set in an option context");
+  }
 };
 
 // Define a partial specialization to handle things we cannot inherit from.  In
@@ -1170,15 +1259,31 @@ public:
     if (initial)
       Default = V;
   }
-  DataType &getValue() { return Value; }
-  DataType getValue() const { return Value; }
+  // The value in the option context active on this thread, if it sets one,
+  // and the command line value otherwise.
+  DataType &getValue() {
+    if (LLVM_UNLIKELY(OptionContext::getCurrent()))
+      if (void *V = OptionContext::getCurrent()->lookup(&Value))
+        return *static_cast<DataType *>(V);
+    return Value;
+  }
+  DataType getValue() const {
+    return const_cast<opt_storage *>(this)->getValue();
+  }
 
   const OptionValue<DataType> &getDefault() const { return Default; }
 
   operator DataType() const { return getValue(); }
 
   // If the datatype is a pointer, support -> on it.
-  DataType operator->() const { return Value; }
+  DataType operator->() const { return getValue(); }
+
+  template <class T>
+  bool setContextValue(Option &, OptionContext &Ctx, const T &V) {
+    Ctx.setValue(&Value, new DataType(V),
+                 [](void *P) { delete static_cast<DataType *>(P); });
+    return false;
+  }
 };
 
 //===----------------------------------------------------------------------===//
@@ -1202,6 +1307,17 @@ class opt : public Option,
     return false;
   }
 
+  bool setContextValue(OptionContext &Ctx, StringRef ArgName,
+                       StringRef Arg) override {
+    typename ParserClass::parser_data_type Val =
+        typename ParserClass::parser_data_type();
+    if (Parser.parse(*this, ArgName, Arg, Val))
+      return true; // Parse error!
+    return opt_storage<DataType, ExternalStorage,
+                       std::is_class<DataType>::value>::
+        setContextValue(*this, Ctx, Val);
+  }
+
   enum ValueExpected getValueExpectedFlagDefault() const override {
     return Parser.getValueExpectedFlagDefault();
   }
@@ -1572,6 +1688,10 @@ class alias : public Option {
                      bool MultiArg = false) override {
     return AliasFor->addOccurrence(pos, AliasFor->ArgStr, Value, MultiArg);
   }
+  bool setContextValue(OptionContext &Ctx, StringRef /*ArgName*/,
+                       StringRef Value) override {
+    return AliasFor->setContextValue(Ctx, AliasFor->ArgStr, Value);
+  }
   // Handle printing stuff...
   size_t getOptionWidth() const override;
   void printOptionInfo(size_t GlobalWidth) const override;
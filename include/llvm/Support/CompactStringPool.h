@@ -0,0 +1,134 @@
+//===-- CompactStringPool.h - Arena-backed interned strings -----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares CompactStringPool, which stores each distinct string once
+// in a slab arena together with its hash value, and InternedString, a
+// pointer-sized handle to such a string.
+//
+// Unlike StringPool, strings are not reference-counted: they live as long as
+// the pool.  In exchange, an interned string costs its characters plus eight
+// bytes, and the pool can be shared by the many tables that name the same
+// symbols:
+//
+//   CompactStringPool Names;
+//   DenseMap<InternedString, Function *> Functions;
+//   InternedString Name = Names.intern("_ZN4llvm5Value4dumpEv");
+//   Functions[Name] = F;
+//
+// Maps keyed by InternedString compare keys by address and use the hash value
+// computed at interning time.  The hash value is the one StringMap uses, so an
+// InternedString can also look up a StringMap without hashing the string
+// again:
+//
+//   Map.find(Name.str(), Name.hash());
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_COMPACTSTRINGPOOL_H
+#define LLVM_SUPPORT_COMPACTSTRINGPOOL_H
+
+#include "llvm/ADT/DenseMapInfo.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Allocator.h"
+
+namespace llvm {
+
+/// InternedString - A string interned in a CompactStringPool, or null.
+class InternedString {
+  typedef StringMapEntry<unsigned> EntryTy;
+  friend class CompactStringPool;
+  friend struct DenseMapInfo<InternedString>;
+
+  const EntryTy *Entry;
+
+  explicit InternedString(const EntryTy *Entry) : Entry(Entry) {}
+
+public:
+  InternedString() : Entry(nullptr) {}
+
+  explicit operator bool() const { return Entry != nullptr; }
+
+  StringRef str() const { return Entry->getKey(); }
+  /// data - Return the characters of the string, which are null-terminated.
+  const char *data() const { return Entry->getKeyData(); }
+  size_t size() const { return Entry->getKeyLength(); }
+
+  /// hash - Return the hash value of the string, as StringMapImpl::hash
+  /// computes it.
+  unsigned hash() const { return Entry->getValue(); }
+
+  bool operator==(const InternedString &RHS) const {
+    return Entry == RHS.Entry;
+  }
+  bool operator!=(const InternedString &RHS) const {
+    return Entry != RHS.Entry;
+  }
+};
+
+/// CompactStringPool - An interned string pool whose strings live in a
+/// BumpPtrAllocator until the pool is destroyed.
+class CompactStringPool {
+  // Maps each string to its hash value.  The entries hold the characters, so
+  // they are the storage of the interned strings.
+  StringMap<unsigned, BumpPtrAllocator> Map;
+
+public:
+  /// intern - Return the interned copy of \p Str, creating it if needed.
+  InternedString intern(StringRef Str) {
+    unsigned FullHashValue = StringMapImpl::hash(Str);
+    return intern(Str, FullHashValue);
+  }
+
+  /// intern - Like intern(Str), for a string whose hash value
+  /// StringMapImpl::hash already computed.
+  InternedString intern(StringRef Str, unsigned FullHashValue) {
+    return InternedString(
+        &*Map.insert(std::make_pair(Str, FullHashValue), FullHashValue).first);
+  }
+
+  /// lookup - Return the interned copy of \p Str, or null if \p Str was never
+  /// interned.
+  InternedString lookup(StringRef Str) const {
+    auto I = Map.find(Str);
+    return I == Map.end() ? InternedString() : InternedString(&*I);
+  }
+
+  /// size - Return the number of distinct strings in the pool.
+  unsigned size() const { return Map.size(); }
+  bool empty() const { return Map.empty(); }
+
+  /// getMemorySize - Return the number of bytes the pool uses, including the
+  /// unused tail of its last slab.
+  size_t getMemorySize() const {
+    return Map.getMemorySize() + Map.getAllocator().getTotalMemory();
+  }
+};
+
+// InternedStrings hash to the hash value of their string, so that maps keyed
+// by them never read the characters.  The null InternedString hashes to 0.
+template <> struct DenseMapInfo<InternedString> {
+  typedef DenseMapInfo<const InternedString::EntryTy *> EntryInfo;
+
+  static inline InternedString getEmptyKey() {
+    return InternedString(EntryInfo::getEmptyKey());
+  }
+  static inline InternedString getTombstoneKey() {
+    return InternedString(EntryInfo::getTombstoneKey());
+  }
+  static unsigned getHashValue(const InternedString &Val) {
+    return Val ? Val.hash() : 0;
+  }
+  static bool isEqual(const InternedString &LHS, const InternedString &RHS) {
+    return LHS == RHS;
+  }
+};
+
+} // end namespace llvm
+
+#endif
@@ -651,6 +651,13 @@ public:
     priv ///< May modify via data, but changes are lost on destruction.
   };
 
+  enum advice {
+    normal,     ///< No particular access pattern.
+    sequential, ///< Read from start to end, so read ahead aggressively.
+    random,     ///< Read in no particular order, so do not read ahead.
+    willneed    ///< Read soon, so start reading it in now.
+  };
+
 private:
   /// Platform-specific mapping state.
   uint64_t Size;
@@ -676,6 +683,19 @@ public:
 
   /// \returns The minimum alignment offset must be.
   static int alignment();
+
+  /// Tell the OS how the mapping will be accessed, so that it can schedule
+  /// reading the file in.  This is only a hint: it does not change the
+  /// contents of the mapping, and does nothing on hosts without madvise.
+  std::error_code advise(advice Advice) const {
+    return advise(Mapping, Size, Advice);
+  }
+
+  /// Like advise(Advice), for the pages of [Addr, Addr + Size), which may be
+  /// any part of a mapping.  Memory that does not map a file is not read in,
+  /// but should only be given willneed advice, which leaves its pages as they
+  /// are.
+  static std::error_code advise(const void *Addr, size_t Size, advice Advice);
 };
 
 /// Return the path to the main executable, given the value of argv[0] from
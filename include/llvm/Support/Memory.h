@@ -48,7 +48,18 @@ namespace sys {
     enum ProtectionFlags {
       MF_READ  = 0x1000000,
       MF_WRITE = 0x2000000,
-      MF_EXEC  = 0x4000000
+      MF_EXEC  = 0x4000000,
+      MF_RWE_MASK = 0x7000000,
+
+      /// Hints for allocateMappedMemory, ignored where they are not supported.
+      /// MF_HUGE_HINT asks for transparent huge pages, MF_HUGE_EXPLICIT for
+      /// pages from the pool of reserved huge pages (the allocation fails if
+      /// the pool is empty), and MF_NUMA_LOCAL places each page on the NUMA
+      /// node of the thread that first touches it, whatever the memory policy
+      /// of the process.
+      MF_HUGE_HINT = 0x0000001,
+      MF_HUGE_EXPLICIT = 0x0000002,
+      MF_NUMA_LOCAL = 0x0000004
     };
 
     /// This method allocates a block of memory that is suitable for loading
@@ -59,7 +70,9 @@ namespace sys {
     /// The actual allocated address is not guaranteed to be near the requested
     /// address.
     /// \p Flags is used to set the initial protection flags for the block
-    /// of the memory.
+    /// of the memory, and may also contain the MF_HUGE_* and MF_NUMA_LOCAL
+    /// hints.  With MF_HUGE_HINT or MF_HUGE_EXPLICIT, the block is aligned and
+    /// rounded up to the huge page size.
     /// \p EC [out] returns an object describing any error that occurs.
     ///
     /// This method may allocate more than the number of bytes requested.  The
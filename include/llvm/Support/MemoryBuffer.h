@@ -128,6 +128,28 @@ public:
   static ErrorOr<std::unique_ptr<MemoryBuffer>>
   getFileSlice(const Twine &Filename, uint64_t MapSize, uint64_t Offset);
 
+  //===--------------------------------------------------------------------===//
+  // Access hints.
+  //===--------------------------------------------------------------------===//
+
+  /// How a client is going to read a buffer.
+  enum AccessPattern {
+    Access_Normal,     ///< No particular order.
+    Access_Sequential, ///< From start to end, e.g. a full bitcode parse.
+    Access_Random,     ///< Jumping around, e.g. lazy materialization.
+    Access_WillNeed    ///< All of it, soon.
+  };
+
+  /// Tell the OS how the buffer is going to be read, so that it can read a
+  /// memory-mapped file ahead of the reader, or avoid reading parts it will
+  /// skip.  Buffers that do not map a file ignore this.
+  virtual void adviseAccess(AccessPattern Pattern) const {}
+
+  /// Start reading in the pages of \p Data in the background, if it is part
+  /// of a memory-mapped file.  \p Data may point into any memory, so this
+  /// can be used through a MemoryBufferRef.
+  static void prefetch(StringRef Data);
+
   //===--------------------------------------------------------------------===//
   // Provided for performance analysis.
   //===--------------------------------------------------------------------===//
@@ -7,13 +7,14 @@
 //
 //===----------------------------------------------------------------------===//
 //
-// This file defines a crude C++11 based thread pool.
+// This file defines a C++11 based work-stealing thread pool.
 //
 //===----------------------------------------------------------------------===//
 
 #ifndef LLVM_SUPPORT_THREAD_POOL_H
 #define LLVM_SUPPORT_THREAD_POOL_H
 
+#include "llvm/Support/ThreadLocal.h"
 #include "llvm/Support/thread.h"
 
 #ifdef _MSC_VER
@@ -33,7 +34,9 @@
 #pragma warning(pop)
 #endif
 
+#include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -42,11 +45,26 @@
 
 namespace llvm {
 
+namespace cl {
+class OptionContext;
+}
+class ThreadPoolTaskGroup;
+
 /// A ThreadPool for asynchronous parallel execution on a defined number of
 /// threads.
 ///
-/// The pool keeps a vector of threads alive, waiting on a condition variable
-/// for some work to become available.
+/// Every thread in the pool owns a double-ended queue of tasks. Tasks
+/// submitted from inside a pool thread are pushed onto that thread's own
+/// queue and popped in LIFO order, which keeps recursively spawned work hot
+/// in the cache. Tasks submitted from outside the pool are distributed
+/// round-robin across the queues. A thread that runs out of local work steals
+/// the oldest task from another thread's queue, and only sleeps on a
+/// condition variable once every queue is empty.
+///
+/// Tasks running in the pool may spawn subtasks through a ThreadPoolTaskGroup
+/// and wait on them: a pool thread blocked in ThreadPoolTaskGroup::wait()
+/// keeps executing queued tasks instead of idling, so nested parallelism
+/// cannot deadlock the pool.
 class ThreadPool {
 public:
 #ifndef _MSC_VER
@@ -100,37 +118,160 @@ public:
 #endif
   }
 
-  /// Blocking wait for all the threads to complete and the queue to be empty.
-  /// It is an error to try to add new tasks while blocking on this call.
+  /// Blocking wait for all the threads to complete and the queues to be
+  /// empty. It is an error to try to add new tasks while blocking on this
+  /// call, and to call it from a task running in the pool; use a
+  /// ThreadPoolTaskGroup to wait on nested tasks.
   void wait();
 
+  /// Returns the number of threads executing tasks in this pool.
+  unsigned getThreadCount() const { return ThreadCount; }
+
 private:
+  friend class ThreadPoolTaskGroup;
+
+  /// A task waiting for execution, with the group it was submitted to, if any,
+  /// and the option context active on the thread that submitted it.
+  struct QueuedTask {
+    PackagedTaskTy Task;
+    ThreadPoolTaskGroup *Group;
+    cl::OptionContext *Options;
+  };
+
+  /// Wrap \p F in a callable that is valid for the pool's task signature.
+  template <typename Function> static TaskTy makeTask(Function &&F) {
+#ifndef _MSC_VER
+    return TaskTy(std::forward<Function>(F));
+#else
+    return [F](VoidTy) mutable -> VoidTy {
+      F();
+      return VoidTy();
+    };
+#endif
+  }
+
   /// Asynchronous submission of a task to the pool. The returned future can be
   /// used to wait for the task to finish and is *non-blocking* on destruction.
-  std::shared_future<VoidTy> asyncImpl(TaskTy F);
+  std::shared_future<VoidTy> asyncImpl(TaskTy F,
+                                       ThreadPoolTaskGroup *Group = nullptr);
 
-  /// Threads in flight
-  std::vector<llvm::thread> Threads;
+  /// Run a dequeued task and update the completion counters of the pool and of
+  /// the task's group.
+  void runTask(QueuedTask &Task);
 
-  /// Tasks waiting for execution in the pool.
-  std::queue<PackagedTaskTy> Tasks;
+  /// Blocking wait until every task of \p Group completed. When called from a
+  /// pool thread, queued tasks are executed while waiting.
+  void waitForGroup(ThreadPoolTaskGroup &Group);
+
+  /// Number of threads requested for this pool.
+  unsigned ThreadCount;
 
-  /// Locking and signaling for accessing the Tasks queue.
-  std::mutex QueueLock;
-  std::condition_variable QueueCondition;
+  /// Number of submitted tasks that have not finished executing yet.
+  std::atomic<unsigned> OutstandingTasks;
 
   /// Locking and signaling for job completion
   std::mutex CompletionLock;
   std::condition_variable CompletionCondition;
 
-  /// Keep track of the number of thread actually busy
-  std::atomic<unsigned> ActiveThreads;
+#if LLVM_ENABLE_THREADS
+  /// Per-thread task queue. The owner pushes and pops at the back, thieves
+  /// take from the front.
+  struct WorkerQueue {
+    std::mutex Lock;
+    std::deque<QueuedTask> Tasks;
+    unsigned Index;
+  };
+
+  /// Main loop of the pool thread owning queue \p Index.
+  void workerLoop(unsigned Index);
+
+  /// Try to grab a task, first from the back of the queue \p Index and then
+  /// from the front of the other queues. Returns false if every queue is
+  /// empty.
+  bool popTask(unsigned Index, QueuedTask &Task);
+
+  /// Threads in flight
+  std::vector<llvm::thread> Threads;
+
+  /// One task queue per thread.
+  std::vector<std::unique_ptr<WorkerQueue>> Queues;
+
+  /// Queue owned by the calling thread, or null outside of this pool.
+  sys::ThreadLocal<WorkerQueue> CurrentQueue;
+
+  /// Round-robin cursor used to distribute tasks submitted from outside of the
+  /// pool.
+  std::atomic<unsigned> NextQueue;
+
+  /// Number of tasks sitting in one of the queues.
+  std::atomic<unsigned> QueuedTasks;
+
+  /// Number of threads sleeping on WorkCondition.
+  std::atomic<unsigned> IdleThreads;
+
+  /// Locking and signaling for threads waiting for work to become available.
+  std::mutex SleepLock;
+  std::condition_variable WorkCondition;
 
-#if LLVM_ENABLE_THREADS // avoids warning for unused variable
   /// Signal for the destruction of the pool, asking thread to exit.
   bool EnableFlag;
+#else
+  /// Tasks waiting for execution in the pool.
+  std::queue<QueuedTask> Tasks;
 #endif
 };
+
+/// A set of tasks submitted to a ThreadPool that can be waited on
+/// independently of the other tasks in the pool.
+///
+/// Unlike ThreadPool::wait(), ThreadPoolTaskGroup::wait() may be called from a
+/// task running in the pool, which makes it the building block for nested
+/// (fork/join) parallelism. The destructor waits for the pending tasks of the
+/// group.
+class ThreadPoolTaskGroup {
+public:
+  explicit ThreadPoolTaskGroup(ThreadPool &Pool)
+      : Pool(Pool), PendingTasks(0) {}
+
+  /// Blocking destructor: waits for every task of the group to complete.
+  ~ThreadPoolTaskGroup() { wait(); }
+
+  /// Asynchronous submission of a task belonging to this group.
+  template <typename Function, typename... Args>
+  inline std::shared_future<ThreadPool::VoidTy> async(Function &&F,
+                                                      Args &&... ArgList) {
+    return Pool.asyncImpl(
+        ThreadPool::makeTask(std::bind(std::forward<Function>(F),
+                                       std::forward<Args>(ArgList)...)),
+        this);
+  }
+
+  /// Asynchronous submission of a task belonging to this group.
+  template <typename Function>
+  inline std::shared_future<ThreadPool::VoidTy> async(Function &&F) {
+    return Pool.asyncImpl(ThreadPool::makeTask(std::forward<Function>(F)),
+                          this);
+  }
+
+  /// Blocking wait for every task of the group to complete. Tasks of the group
+  /// may keep adding tasks to it while this is waiting.
+  void wait() { Pool.waitForGroup(*this); }
+
+  /// Returns the pool tasks of this group are submitted to.
+  ThreadPool &getPool() const { return Pool; }
+
+private:
+  friend class ThreadPool;
+
+  ThreadPool &Pool;
+
+  /// Number of tasks of this group that have not finished executing yet.
+  std::atomic<unsigned> PendingTasks;
+
+  /// Locking and signaling for threads outside the pool waiting on the group.
+  std::mutex CompletionLock;
+  std::condition_variable CompletionCondition;
+};
 }
 
 #endif // LLVM_SUPPORT_THREAD_POOL_H
@@ -0,0 +1,95 @@
+//===- llvm/Support/TraceEvents.h - Trace event recording -------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the TraceEventRecorder class, which records timed events
+// and writes them in the Chrome trace event format, and the TraceRegion class,
+// which records the execution of a scope as an event.
+//
+//   Unlike a TimerGroup, which aggregates the time of each timer, a recorder
+// keeps every event with the thread it ran on, so that a trace viewer can
+// show when things ran and how they overlapped.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_TRACEEVENTS_H
+#define LLVM_SUPPORT_TRACEEVENTS_H
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/DataTypes.h"
+#include "llvm/Support/Mutex.h"
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace llvm {
+class raw_ostream;
+
+/// Thread-safe recorder of complete trace events.
+class TraceEventRecorder {
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  TraceEventRecorder();
+
+  /// Record an event named \p Name, of the given category, which ran from
+  /// \p Begin to \p End on the calling thread. \p Detail, typically the name
+  /// of the IR unit the event worked on, and \p MemDelta, the change in heap
+  /// usage of the process during the event, are passed as arguments of the
+  /// event.
+  void addEvent(StringRef Name, StringRef Category, StringRef Detail,
+                Clock::time_point Begin, Clock::time_point End,
+                int64_t MemDelta);
+
+  /// Write the events recorded so far as a JSON trace.
+  void write(raw_ostream &OS) const;
+
+private:
+  struct Event {
+    std::string Name;
+    std::string Category;
+    std::string Detail;
+    Clock::time_point Begin;
+    Clock::time_point End;
+    int64_t MemDelta;
+    unsigned ThreadIndex;
+  };
+
+  mutable sys::SmartMutex<true> Lock;
+  Clock::time_point Start;
+  std::vector<Event> Events;
+  /// The threads that recorded events, the position of a thread being its
+  /// identifier in the trace.
+  std::vector<std::thread::id> Threads;
+};
+
+/// Records the execution of the enclosing scope in a TraceEventRecorder, if
+/// any.
+class TraceRegion {
+  TraceEventRecorder *Recorder;
+  StringRef Name;
+  StringRef Category;
+  std::string Detail;
+  TraceEventRecorder::Clock::time_point Begin;
+  size_t MemBegin = 0;
+
+  TraceRegion(const TraceRegion &) = delete;
+  void operator=(const TraceRegion &) = delete;
+
+public:
+  /// Start recording an event. \p Name and \p Category must outlive the
+  /// region. Nothing is recorded if \p Recorder is null.
+  TraceRegion(TraceEventRecorder *Recorder, StringRef Name,
+              StringRef Category, StringRef Detail);
+  ~TraceRegion();
+};
+
+} // end namespace llvm
+
+#endif
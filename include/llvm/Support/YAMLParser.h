@@ -44,6 +44,7 @@
 #include <limits>
 #include <map>
 #include <utility>
+#include <vector>
 
 namespace llvm {
 class MemoryBufferRef;
@@ -243,7 +244,8 @@ public:
     SourceRange = SMRange(Start, End);
   }
 
-  /// \brief Gets the value of this node as a StringRef.
+  /// \brief Gets the value of this node as a null-terminated StringRef. The
+  ///        value remains valid for the lifetime of the Stream.
   StringRef getValue() const { return Value; }
 
   static inline bool classof(const Node *N) {
@@ -523,6 +525,18 @@ public:
 
   const std::map<StringRef, StringRef> &getTagMap() const { return TagMap; }
 
+  /// \brief Allocate the nodes parsed from now on in a new region, which is
+  ///        released by the matching popNodeRegion.
+  ///
+  /// A region has two halves. advanceNodeRegion switches to the other half and
+  /// releases the nodes allocated in it. A reader going through the entries
+  /// of a long collection one at a time calls it before moving to the next
+  /// entry, so only the nodes of the current and the previous entries are
+  /// kept.
+  void pushNodeRegion();
+  void advanceNodeRegion();
+  void popNodeRegion();
+
 private:
   friend class Node;
   friend class document_iterator;
@@ -534,6 +548,17 @@ private:
   ///        destructor when the document is destroyed.
   BumpPtrAllocator NodeAllocator;
 
+  /// \brief The node regions opened with pushNodeRegion, innermost last.
+  struct NodeRegion {
+    BumpPtrAllocator Halves[2];
+    unsigned Current = 0;
+  };
+  std::vector<NodeRegion> NodeRegions;
+
+  /// \brief Return the allocator of the innermost node region, or the
+  ///        document's allocator if no region is open.
+  BumpPtrAllocator &getNodeAllocator();
+
   /// \brief The root node. Used to support skipping a partially parsed
   ///        document.
   Node *Root;
@@ -461,6 +461,10 @@ public:
 
   virtual bool outputting() = 0;
 
+  /// Returns the number of elements of the sequence. An input which only
+  /// knows it once it read them all (see Input::setStreaming) returns
+  /// UINT_MAX, and preflightElement returns false past the last element.
+  /// The same goes for beginFlowSequence and preflightFlowElement.
   virtual unsigned beginSequence() = 0;
   virtual bool preflightElement(unsigned, void *&) = 0;
   virtual void postflightElement(void*) = 0;
@@ -742,26 +746,30 @@ template<typename T>
 typename std::enable_if<has_SequenceTraits<T>::value,void>::type
 yamlize(IO &io, T &Seq, bool) {
   if ( has_FlowTraits< SequenceTraits<T> >::value ) {
+    // When reading, incnt may be UINT_MAX if the length isn't known yet; the
+    // loop then ends when preflightFlowElement runs out of elements.
     unsigned incnt = io.beginFlowSequence();
     unsigned count = io.outputting() ? SequenceTraits<T>::size(io, Seq) : incnt;
     for(unsigned i=0; i < count; ++i) {
       void *SaveInfo;
-      if ( io.preflightFlowElement(i, SaveInfo) ) {
-        yamlize(io, SequenceTraits<T>::element(io, Seq, i), true);
-        io.postflightFlowElement(SaveInfo);
-      }
+      if ( !io.preflightFlowElement(i, SaveInfo) )
+        break;
+      yamlize(io, SequenceTraits<T>::element(io, Seq, i), true);
+      io.postflightFlowElement(SaveInfo);
     }
     io.endFlowSequence();
   }
   else {
+    // When reading, incnt may be UINT_MAX if the length isn't known yet; the
+    // loop then ends when preflightElement runs out of elements.
     unsigned incnt = io.beginSequence();
     unsigned count = io.outputting() ? SequenceTraits<T>::size(io, Seq) : incnt;
     for(unsigned i=0; i < count; ++i) {
       void *SaveInfo;
-      if ( io.preflightElement(i, SaveInfo) ) {
-        yamlize(io, SequenceTraits<T>::element(io, Seq, i), true);
-        io.postflightElement(SaveInfo);
-      }
+      if ( !io.preflightElement(i, SaveInfo) )
+        break;
+      yamlize(io, SequenceTraits<T>::element(io, Seq, i), true);
+      io.postflightElement(SaveInfo);
     }
     io.endSequence();
   }
@@ -950,6 +958,17 @@ public:
   // Check if there was an syntax or semantic error during parsing.
   std::error_code error();
 
+  // Read each document as it is mapped instead of building its whole tree
+  // first, so that long sequences are read one element at a time. Only the
+  // element being mapped, and the parser nodes of the one before, are kept
+  // in memory; scalars which had to be unescaped are still copied into
+  // storage that lives as long as the Input. The keys of a mapping are read
+  // in the order they are mapped; a key which is read past to find another
+  // one is kept until the end of the mapping. A key appearing twice in a
+  // mapping is an error, while reading the whole tree keeps its last value.
+  // Must be set before the first document is read.
+  void setStreaming(bool Enable) { Streaming = Enable; }
+
 private:
   bool outputting() override;
   bool mapTag(StringRef, bool) override;
@@ -1019,7 +1038,7 @@ private:
     void anchor() override;
 
   public:
-    MapHNode(Node *n) : HNode(n) { }
+    MapHNode(Node *n) : HNode(n), ActiveValue(nullptr), IsStreaming(false) { }
 
     static inline bool classof(const HNode *n) {
       return MappingNode::classof(n->_node);
@@ -1032,13 +1051,19 @@ private:
 
     NameToNode                        Mapping;
     llvm::SmallVector<const char*, 6> ValidKeys;
+    // In streaming mode, the first entry of the mapping which is not in
+    // Mapping, and the value of the last key read, if it belongs to that entry.
+    MappingNode::iterator             NextEntry;
+    HNode                            *ActiveValue;
+    bool                              IsStreaming;
   };
 
   class SequenceHNode : public HNode {
     void anchor() override;
 
   public:
-    SequenceHNode(Node *n) : HNode(n) { }
+    SequenceHNode(Node *n)
+        : HNode(n), IsStreaming(false), HasNodeRegion(false) { }
 
     static inline bool classof(const HNode *n) {
       return SequenceNode::classof(n->_node);
@@ -1046,9 +1071,22 @@ private:
     static inline bool classof(const SequenceHNode *) { return true; }
 
     std::vector<std::unique_ptr<HNode>> Entries;
+    // In streaming mode, Entries only holds the element being read, if any,
+    // and NextEntry points to its node. The nodes of the elements are
+    // allocated in a node region of the document until the sequence is
+    // finished.
+    SequenceNode::iterator              NextEntry;
+    bool                                IsStreaming;
+    bool                                HasNodeRegion;
   };
 
   std::unique_ptr<Input::HNode> createHNodes(Node *node);
+  std::unique_ptr<Input::HNode> createStreamingHNode(Node *node);
+  HNode *readStreamingKey(MapHNode *MN, StringRef Key);
+  HNode *readStreamingElement(SequenceHNode *SQ);
+  void readAllStreamingElements(SequenceHNode *SQ);
+  void finishStreamingNode(HNode *hnode);
+  StringRef getKeyString(KeyValueNode &KVN, SmallVectorImpl<char> &Storage);
   void setError(HNode *hnode, const Twine &message);
   void setError(Node *node, const Twine &message);
 
@@ -1071,6 +1109,7 @@ private:
   std::vector<bool>                   BitValuesUsed;
   HNode                              *CurrentNode;
   bool                                ScalarMatchFound;
+  bool                                Streaming;
 };
 
 ///
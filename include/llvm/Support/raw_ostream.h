@@ -210,6 +210,10 @@ public:
   /// satisfy std::isprint into an escape sequence.
   raw_ostream &write_escaped(StringRef Str, bool UseHexEscapes = false);
 
+  /// Output \p Str as a quoted JSON string, escaping '"', '\\' and the
+  /// control characters.
+  raw_ostream &write_json_string(StringRef Str);
+
   raw_ostream &write(unsigned char C);
   raw_ostream &write(const char *Ptr, size_t Size);
 
@@ -225,6 +229,9 @@ public:
   /// indent - Insert 'NumSpaces' spaces.
   raw_ostream &indent(unsigned NumSpaces);
 
+  /// write_zeros - Insert 'NumZeros' nulls.
+  raw_ostream &write_zeros(unsigned NumZeros);
+
   /// Changes the foreground color of text that will be output from this point
   /// forward.
   /// @param Color ANSI color to use, the special SAVEDCOLOR can be used to
@@ -312,6 +319,12 @@ private:
   /// Copy data into the buffer. Size must not be greater than the number of
   /// unused bytes in the buffer.
   void copy_to_buffer(const char *Ptr, size_t Size);
+
+  /// Write \p Count copies of \p C.
+  raw_ostream &write_fill(char C, unsigned Count);
+
+  /// Write the \p NumDigits decimal digits of \p N.
+  raw_ostream &write_digits(uint64_t N, unsigned NumDigits);
 };
 
 /// An abstract base class for streams implementations that also support a
@@ -0,0 +1,61 @@
+//===- llvm/Transforms/IPO/ParallelFunctionPasses.h -------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This header declares a driver running a function pass pipeline concurrently
+// over the functions of a module.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TRANSFORMS_IPO_PARALLELFUNCTIONPASSES_H
+#define LLVM_TRANSFORMS_IPO_PARALLELFUNCTIONPASSES_H
+
+#include <functional>
+
+namespace llvm {
+
+class Module;
+
+namespace legacy {
+class FunctionPassManager;
+}
+
+/// Callback populating a function pass manager for module \p M. It is called
+/// once per partition, on the thread optimizing that partition, and must add
+/// the same pipeline every time.
+typedef std::function<void(legacy::FunctionPassManager &FPM, Module &M)>
+    FunctionPassSetupFn;
+
+/// Run the function pass pipeline built by \p AddPasses over every function
+/// definition of \p M, using up to \p ThreadCount threads.
+///
+/// The function definitions are split into contiguous partitions of similar
+/// instruction count. Each partition is optimized on its own thread, in a
+/// private LLVMContext holding a copy of the module in which only the bodies
+/// of the partition are read, and the optimized bodies are then moved back
+/// into \p M in partition order.
+///
+/// The resulting module can differ from the one obtained by running the
+/// pipeline sequentially:
+/// - The use-list order of globals and constants may differ.
+/// - A sequential run optimizes a function knowing the attributes that passes
+///   inferred for declarations (e.g. of library functions) while optimizing
+///   the functions before it. A partition only sees the attributes inferred
+///   in that partition. The attributes of the last partition that changed
+///   them are kept.
+///
+/// Modules for which this can't be guaranteed, i.e. modules with blockaddress
+/// constants, are optimized sequentially on the calling thread.
+///
+/// \returns true if the pipeline modified the module.
+bool runFunctionPassesInParallel(Module &M, unsigned ThreadCount,
+                                 const FunctionPassSetupFn &AddPasses);
+
+} // namespace llvm
+
+#endif
@@ -61,6 +61,17 @@ std::unique_ptr<Module>
 CloneModule(const Module *M, ValueToValueMapTy &VMap,
             std::function<bool(const GlobalValue *)> ShouldCloneDefinition);
 
+/// Return a copy of the specified module whose function bodies are only
+/// cloned when they are materialized, e.g. by GlobalValue::materialize or
+/// Module::materializeAll, like those of a lazily loaded bitcode module.
+/// Cloning a module to work on a few of its functions then costs little more
+/// than copying its globals.  \p M must not be changed or destroyed until the
+/// copy is fully materialized or destroyed.
+std::unique_ptr<Module> CloneModuleLazily(const Module *M);
+std::unique_ptr<Module> CloneModuleLazily(
+    const Module *M,
+    std::function<bool(const GlobalValue *)> ShouldCloneDefinition);
+
 /// ClonedCodeInfo - This struct can be used to capture information about code
 /// being cloned, while it is being cloned.
 struct ClonedCodeInfo {
@@ -27,6 +27,10 @@ class StringRef;
 /// Splits the module M into N linkable partitions. The function ModuleCallback
 /// is called N times passing each individual partition as the MPart argument.
 ///
+/// Definitions are assigned to partitions by a hash of their name, unless
+/// BalanceBySize is set, in which case the partitions are balanced by the
+/// estimated size (the instruction count) of the definitions they contain.
+///
 /// FIXME: This function does not deal with the somewhat subtle symbol
 /// visibility issues around module splitting, including (but not limited to):
 ///
@@ -37,7 +41,7 @@ class StringRef;
 void SplitModule(
     std::unique_ptr<Module> M, unsigned N,
     std::function<void(std::unique_ptr<Module> MPart)> ModuleCallback,
-    bool PreserveLocals = false);
+    bool PreserveLocals = false, bool BalanceBySize = false);
 
 } // End llvm namespace
 
@@ -13,6 +13,14 @@
 
 using namespace llvm;
 
+void llvm::markChangedFunctions(LazyCallGraph::SCC &C,
+                                const PreservedAnalyses &PA) {
+  if (PA.preserved<FunctionAnalysisManagerCGSCCProxy>())
+    return;
+  for (LazyCallGraph::Node *N : C)
+    N->getFunction().markChanged();
+}
+
 char CGSCCAnalysisManagerModuleProxy::PassID;
 
 CGSCCAnalysisManagerModuleProxy::Result
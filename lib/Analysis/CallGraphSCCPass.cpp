@@ -26,6 +26,7 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/Timer.h"
+#include "llvm/Support/TraceEvents.h"
 #include "llvm/Support/raw_ostream.h"
 using namespace llvm;
 
@@ -107,6 +108,19 @@ private:
 
 char CGPassManager::ID = 0;
 
+/// Mark the functions of \p SCC and the functions that call them as changed,
+/// for incremental verification.
+static void markSCCChanged(CallGraphSCC &SCC) {
+  for (CallGraphNode *CGN : SCC) {
+    Function *F = CGN->getFunction();
+    if (!F)
+      continue;
+    F->markChanged();
+    for (User *U : F->users())
+      if (auto *I = dyn_cast<Instruction>(U))
+        I->getParent()->getParent()->markChanged();
+  }
+}
 
 bool CGPassManager::RunPassOnSCC(Pass *P, CallGraphSCC &CurSCC,
                                  CallGraph &CG, bool &CallGraphUpToDate,
@@ -123,8 +137,16 @@ bool CGPassManager::RunPassOnSCC(Pass *P, CallGraphSCC &CurSCC,
 
     {
       TimeRegion PassTimer(getPassTimer(CGSP));
+      Function *F = (*CurSCC.begin())->getFunction();
+      TraceRegion PassTrace(getPassTraceRecorder(), CGSP->getPassName(),
+                            "pass", F ? F->getName() : "<external node>");
       Changed = CGSP->runOnSCC(CurSCC);
     }
+
+    // An SCC pass may change any function of the SCC, and the call sites in
+    // their callers, e.g. when it rewrites the signature of a function.
+    if (Changed)
+      markSCCChanged(CurSCC);
     
     // After the CGSCCPass is done, when assertions are enabled, use
     // RefreshCallGraph to verify that the callgraph was correctly updated.
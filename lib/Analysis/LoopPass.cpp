@@ -194,6 +194,8 @@ bool LPPassManager::runOnFunction(Function &F) {
       {
         PassManagerPrettyStackEntry X(P, *CurrentLoop->getHeader());
         TimeRegion PassTimer(getPassTimer(P));
+        TraceRegion PassTrace(getPassTraceRecorder(), P->getPassName(), "pass",
+                              CurrentLoop->getHeader()->getName());
 
         Changed |= P->runOnLoop(CurrentLoop, *this);
       }
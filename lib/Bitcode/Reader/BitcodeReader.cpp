@@ -29,15 +29,22 @@
 #include "llvm/IR/Operator.h"
 #include "llvm/IR/FunctionInfo.h"
 #include "llvm/IR/ValueHandle.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/DataStream.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include <deque>
 
 using namespace llvm;
 
+static cl::opt<unsigned> BitcodeDecodeThreads(
+    "bitcode-decode-threads", cl::init(1),
+    cl::desc("Number of threads decoding the function bodies of a module "
+             "that is read entirely (1 = decode on the reading thread)"));
+
 namespace {
 enum {
   SWITCH_INST_MAGIC = 0x4B5 // May 2012 => 1205 => Hex
@@ -131,12 +138,77 @@ public:
   void tryToResolveCycles();
 };
 
+/// A function block decoded ahead of time, from its own cursor: the entries
+/// BitstreamCursor::advance returns for it and its sub-blocks, with the
+/// contents of the records. Decoding doesn't touch the module, so blocks can
+/// be decoded on other threads while the reader builds the IR.
+struct DecodedFunctionBlock {
+  struct Entry {
+    /// The BitstreamEntry kind.
+    unsigned Kind;
+    /// The ID of a sub-block, or the code of a record.
+    unsigned ID;
+    /// The operands of a record in Ops.
+    size_t OpsBegin;
+    unsigned NumOps;
+  };
+  std::vector<Entry> Entries;
+  std::vector<uint64_t> Ops;
+
+  /// Decode the function block whose body starts at \p Bit, i.e. right after
+  /// its block ID.
+  void decode(BitstreamReader &Reader, uint64_t Bit);
+};
+
+/// A function block being decoded on another thread, see
+/// BitcodeReader::materializeFunctionBodies.
+struct PendingFunctionBlock {
+  DecodedFunctionBlock Block;
+  std::shared_future<ThreadPool::VoidTy> Decoded;
+};
+
+/// Reads the blocks nested in a function block, either from the bitstream or,
+/// when the function block was decoded ahead of time, from its decoded
+/// entries. It has the interface of BitstreamCursor used by the parsers of
+/// these blocks.
+class FunctionBlockCursor {
+  BitstreamCursor &Stream;
+  const DecodedFunctionBlock *Replay = nullptr;
+  size_t Pos = 0;
+
+  bool atError() const {
+    return Pos == Replay->Entries.size() ||
+           Replay->Entries[Pos].Kind == BitstreamEntry::Error;
+  }
+
+public:
+  explicit FunctionBlockCursor(BitstreamCursor &Stream) : Stream(Stream) {}
+
+  /// Read the entries of \p Block until stopReplay().
+  void startReplay(const DecodedFunctionBlock &Block) {
+    Replay = &Block;
+    Pos = 0;
+  }
+  void stopReplay() { Replay = nullptr; }
+
+  BitstreamEntry advance();
+  BitstreamEntry advanceSkippingSubblocks();
+  bool EnterSubBlock(unsigned BlockID);
+  bool SkipBlock();
+  unsigned ReadCode();
+  unsigned readRecord(unsigned AbbrevID, SmallVectorImpl<uint64_t> &Vals);
+};
+
 class BitcodeReader : public GVMaterializer {
   LLVMContext &Context;
   Module *TheModule = nullptr;
   std::unique_ptr<MemoryBuffer> Buffer;
   std::unique_ptr<BitstreamReader> StreamFile;
   BitstreamCursor Stream;
+  // Reads the blocks that can be nested in function blocks.
+  FunctionBlockCursor Blocks;
+  // Whether the bitcode is streamed, rather than entirely in memory.
+  bool IsStreamed = false;
   // Next offset to start scanning for lazy parsing of function bodies.
   uint64_t NextUnreadBit = 0;
   // Last function offset found in the VST.
@@ -197,6 +269,11 @@ class BitcodeReader : public GVMaterializer {
   /// where to find deferred function body in the stream.
   DenseMap<Function*, uint64_t> DeferredFunctionInfo;
 
+  /// The function blocks being decoded ahead of time while materializing the
+  /// whole module.
+  DenseMap<Function *, std::unique_ptr<PendingFunctionBlock>>
+      PendingFunctionBlocks;
+
   /// When Metadata block is initially scanned when parsing the module, we may
   /// choose to defer parsing of the metadata. This vector contains info about
   /// which Metadata blocks are deferred.
@@ -395,6 +472,7 @@ private:
   /// Save the positions of the Metadata blocks and skip parsing the blocks.
   std::error_code rememberAndSkipMetadata();
   std::error_code parseFunctionBody(Function *F);
+  std::error_code materializeFunctionBodies();
   std::error_code globalCleanup();
   std::error_code resolveGlobalAndAliasInits();
   std::error_code parseMetadata(bool ModuleLevel = false);
@@ -557,12 +635,125 @@ std::error_code BitcodeReader::error(BitcodeError E) {
   return ::error(Context, make_error_code(E));
 }
 
+void DecodedFunctionBlock::decode(BitstreamReader &Reader, uint64_t Bit) {
+  BitstreamCursor Cursor(Reader);
+  Cursor.JumpToBit(Bit);
+  if (Cursor.EnterSubBlock(bitc::FUNCTION_BLOCK_ID)) {
+    Entries.push_back({BitstreamEntry::Error, 0, 0, 0});
+    return;
+  }
+
+  SmallVector<uint64_t, 64> Record;
+  for (unsigned Depth = 1; Depth;) {
+    BitstreamEntry Entry = Cursor.advance();
+    switch (Entry.Kind) {
+    case BitstreamEntry::Error:
+      Entries.push_back({BitstreamEntry::Error, 0, 0, 0});
+      return;
+    case BitstreamEntry::EndBlock:
+      Entries.push_back({BitstreamEntry::EndBlock, 0, 0, 0});
+      --Depth;
+      break;
+    case BitstreamEntry::SubBlock:
+      // Sub-blocks are decoded whatever their kind, the parsers skip the
+      // unknown ones when replaying.
+      Entries.push_back({BitstreamEntry::SubBlock, Entry.ID, 0, 0});
+      if (Cursor.EnterSubBlock(Entry.ID)) {
+        Entries.push_back({BitstreamEntry::Error, 0, 0, 0});
+        return;
+      }
+      ++Depth;
+      break;
+    case BitstreamEntry::Record: {
+      Record.clear();
+      unsigned Code = Cursor.readRecord(Entry.ID, Record);
+      Entries.push_back({BitstreamEntry::Record, Code, Ops.size(),
+                         static_cast<unsigned>(Record.size())});
+      Ops.insert(Ops.end(), Record.begin(), Record.end());
+      break;
+    }
+    }
+  }
+}
+
+BitstreamEntry FunctionBlockCursor::advance() {
+  if (!Replay)
+    return Stream.advance();
+  if (atError())
+    return BitstreamEntry::getError();
+  const DecodedFunctionBlock::Entry &E = Replay->Entries[Pos];
+  switch (E.Kind) {
+  case BitstreamEntry::Record:
+    // The record is consumed by readRecord.
+    return BitstreamEntry::getRecord(bitc::UNABBREV_RECORD);
+  case BitstreamEntry::SubBlock:
+    ++Pos;
+    return BitstreamEntry::getSubBlock(E.ID);
+  default:
+    ++Pos;
+    return BitstreamEntry::getEndBlock();
+  }
+}
+
+BitstreamEntry FunctionBlockCursor::advanceSkippingSubblocks() {
+  if (!Replay)
+    return Stream.advanceSkippingSubblocks();
+  while (1) {
+    BitstreamEntry Entry = advance();
+    if (Entry.Kind != BitstreamEntry::SubBlock)
+      return Entry;
+    if (SkipBlock())
+      return BitstreamEntry::getError();
+  }
+}
+
+bool FunctionBlockCursor::EnterSubBlock(unsigned BlockID) {
+  if (!Replay)
+    return Stream.EnterSubBlock(BlockID);
+  // The decoder records an error right after the blocks it couldn't enter.
+  return Pos < Replay->Entries.size() &&
+         Replay->Entries[Pos].Kind == BitstreamEntry::Error;
+}
+
+bool FunctionBlockCursor::SkipBlock() {
+  if (!Replay)
+    return Stream.SkipBlock();
+  for (unsigned Depth = 1; !atError(); ++Pos) {
+    unsigned Kind = Replay->Entries[Pos].Kind;
+    if (Kind == BitstreamEntry::SubBlock)
+      ++Depth;
+    else if (Kind == BitstreamEntry::EndBlock && !--Depth) {
+      ++Pos;
+      return false;
+    }
+  }
+  return true;
+}
+
+unsigned FunctionBlockCursor::ReadCode() {
+  if (!Replay)
+    return Stream.ReadCode();
+  return bitc::UNABBREV_RECORD;
+}
+
+unsigned FunctionBlockCursor::readRecord(unsigned AbbrevID,
+                                         SmallVectorImpl<uint64_t> &Vals) {
+  if (!Replay)
+    return Stream.readRecord(AbbrevID, Vals);
+  if (atError() || Replay->Entries[Pos].Kind != BitstreamEntry::Record)
+    return ~0U;
+  const DecodedFunctionBlock::Entry &E = Replay->Entries[Pos++];
+  Vals.append(Replay->Ops.begin() + E.OpsBegin,
+              Replay->Ops.begin() + E.OpsBegin + E.NumOps);
+  return E.ID;
+}
+
 BitcodeReader::BitcodeReader(MemoryBuffer *Buffer, LLVMContext &Context)
-    : Context(Context), Buffer(Buffer), ValueList(Context),
+    : Context(Context), Buffer(Buffer), Blocks(Stream), ValueList(Context),
       MetadataList(Context) {}
 
 BitcodeReader::BitcodeReader(LLVMContext &Context)
-    : Context(Context), Buffer(nullptr), ValueList(Context),
+    : Context(Context), Buffer(nullptr), Blocks(Stream), ValueList(Context),
       MetadataList(Context) {}
 
 std::error_code BitcodeReader::materializeForwardReferencedFunctions() {
@@ -1762,7 +1953,7 @@ std::error_code BitcodeReader::parseValueSymbolTable(uint64_t Offset) {
   unsigned FuncBitcodeOffsetDelta =
       Stream.getAbbrevIDWidth() + bitc::BlockIDWidth;
 
-  if (Stream.EnterSubBlock(bitc::VALUE_SYMTAB_BLOCK_ID))
+  if (Blocks.EnterSubBlock(bitc::VALUE_SYMTAB_BLOCK_ID))
     return error("Invalid record");
 
   SmallVector<uint64_t, 64> Record;
@@ -1772,7 +1963,7 @@ std::error_code BitcodeReader::parseValueSymbolTable(uint64_t Offset) {
   // Read all the records for this value table.
   SmallString<128> ValueName;
   while (1) {
-    BitstreamEntry Entry = Stream.advanceSkippingSubblocks();
+    BitstreamEntry Entry = Blocks.advanceSkippingSubblocks();
 
     switch (Entry.Kind) {
     case BitstreamEntry::SubBlock: // Handled for us already.
@@ -1789,7 +1980,7 @@ std::error_code BitcodeReader::parseValueSymbolTable(uint64_t Offset) {
 
     // Read a record.
     Record.clear();
-    switch (Stream.readRecord(Entry.ID, Record)) {
+    switch (Blocks.readRecord(Entry.ID, Record)) {
     default:  // Default behavior: unknown type.
       break;
     case bitc::VST_CODE_ENTRY: {  // VST_ENTRY: [valueid, namechar x N]
@@ -1880,7 +2071,7 @@ std::error_code BitcodeReader::parseMetadata(bool ModuleLevel) {
     NextMetadataNo = 0;
   }
 
-  if (Stream.EnterSubBlock(bitc::METADATA_BLOCK_ID))
+  if (Blocks.EnterSubBlock(bitc::METADATA_BLOCK_ID))
     return error("Invalid record");
 
   SmallVector<uint64_t, 64> Record;
@@ -1904,7 +2095,7 @@ std::error_code BitcodeReader::parseMetadata(bool ModuleLevel) {
 
   // Read all the records.
   while (1) {
-    BitstreamEntry Entry = Stream.advanceSkippingSubblocks();
+    BitstreamEntry Entry = Blocks.advanceSkippingSubblocks();
 
     switch (Entry.Kind) {
     case BitstreamEntry::SubBlock: // Handled for us already.
@@ -1923,7 +2114,7 @@ std::error_code BitcodeReader::parseMetadata(bool ModuleLevel) {
 
     // Read a record.
     Record.clear();
-    unsigned Code = Stream.readRecord(Entry.ID, Record);
+    unsigned Code = Blocks.readRecord(Entry.ID, Record);
     bool IsDistinct = false;
     switch (Code) {
     default:  // Default behavior: ignore.
@@ -1932,9 +2123,9 @@ std::error_code BitcodeReader::parseMetadata(bool ModuleLevel) {
       // Read name of the named metadata.
       SmallString<8> Name(Record.begin(), Record.end());
       Record.clear();
-      Code = Stream.ReadCode();
+      Code = Blocks.ReadCode();
 
-      unsigned NextBitCode = Stream.readRecord(Code, Record);
+      unsigned NextBitCode = Blocks.readRecord(Code, Record);
       if (NextBitCode != bitc::METADATA_NAMED_NODE)
         return error("METADATA_NAME not followed by METADATA_NAMED_NODE");
 
@@ -2517,7 +2708,7 @@ static APInt readWideAPInt(ArrayRef<uint64_t> Vals, unsigned TypeBits) {
 }
 
 std::error_code BitcodeReader::parseConstants() {
-  if (Stream.EnterSubBlock(bitc::CONSTANTS_BLOCK_ID))
+  if (Blocks.EnterSubBlock(bitc::CONSTANTS_BLOCK_ID))
     return error("Invalid record");
 
   SmallVector<uint64_t, 64> Record;
@@ -2526,7 +2717,7 @@ std::error_code BitcodeReader::parseConstants() {
   Type *CurTy = Type::getInt32Ty(Context);
   unsigned NextCstNo = ValueList.size();
   while (1) {
-    BitstreamEntry Entry = Stream.advanceSkippingSubblocks();
+    BitstreamEntry Entry = Blocks.advanceSkippingSubblocks();
 
     switch (Entry.Kind) {
     case BitstreamEntry::SubBlock: // Handled for us already.
@@ -2548,7 +2739,7 @@ std::error_code BitcodeReader::parseConstants() {
     // Read a record.
     Record.clear();
     Value *V = nullptr;
-    unsigned BitCode = Stream.readRecord(Entry.ID, Record);
+    unsigned BitCode = Blocks.readRecord(Entry.ID, Record);
     switch (BitCode) {
     default:  // Default behavior: unknown constant
     case bitc::CST_CODE_UNDEF:     // UNDEF
@@ -2974,13 +3165,13 @@ std::error_code BitcodeReader::parseConstants() {
 }
 
 std::error_code BitcodeReader::parseUseLists() {
-  if (Stream.EnterSubBlock(bitc::USELIST_BLOCK_ID))
+  if (Blocks.EnterSubBlock(bitc::USELIST_BLOCK_ID))
     return error("Invalid record");
 
   // Read all the records.
   SmallVector<uint64_t, 64> Record;
   while (1) {
-    BitstreamEntry Entry = Stream.advanceSkippingSubblocks();
+    BitstreamEntry Entry = Blocks.advanceSkippingSubblocks();
 
     switch (Entry.Kind) {
     case BitstreamEntry::SubBlock: // Handled for us already.
@@ -2996,7 +3187,7 @@ std::error_code BitcodeReader::parseUseLists() {
     // Read a use list record.
     Record.clear();
     bool IsBB = false;
-    switch (Stream.readRecord(Entry.ID, Record)) {
+    switch (Blocks.readRecord(Entry.ID, Record)) {
     default:  // Default behavior: unknown type.
       break;
     case bitc::USELIST_CODE_BB:
@@ -3864,12 +4055,12 @@ ErrorOr<std::string> BitcodeReader::parseIdentificationBlock() {
 
 /// Parse metadata attachments.
 std::error_code BitcodeReader::parseMetadataAttachment(Function &F) {
-  if (Stream.EnterSubBlock(bitc::METADATA_ATTACHMENT_ID))
+  if (Blocks.EnterSubBlock(bitc::METADATA_ATTACHMENT_ID))
     return error("Invalid record");
 
   SmallVector<uint64_t, 64> Record;
   while (1) {
-    BitstreamEntry Entry = Stream.advanceSkippingSubblocks();
+    BitstreamEntry Entry = Blocks.advanceSkippingSubblocks();
 
     switch (Entry.Kind) {
     case BitstreamEntry::SubBlock: // Handled for us already.
@@ -3884,7 +4075,7 @@ std::error_code BitcodeReader::parseMetadataAttachment(Function &F) {
 
     // Read a metadata attachment record.
     Record.clear();
-    switch (Stream.readRecord(Entry.ID, Record)) {
+    switch (Blocks.readRecord(Entry.ID, Record)) {
     default:  // Default behavior: ignore.
       break;
     case bitc::METADATA_ATTACHMENT: {
@@ -3942,7 +4133,7 @@ static std::error_code typeCheckLoadStoreInst(Type *ValType, Type *PtrType) {
 
 /// Lazily parse the specified function body block.
 std::error_code BitcodeReader::parseFunctionBody(Function *F) {
-  if (Stream.EnterSubBlock(bitc::FUNCTION_BLOCK_ID))
+  if (Blocks.EnterSubBlock(bitc::FUNCTION_BLOCK_ID))
     return error("Invalid record");
 
   InstructionList.clear();
@@ -3972,7 +4163,7 @@ std::error_code BitcodeReader::parseFunctionBody(Function *F) {
   // Read all the records.
   SmallVector<uint64_t, 64> Record;
   while (1) {
-    BitstreamEntry Entry = Stream.advance();
+    BitstreamEntry Entry = Blocks.advance();
 
     switch (Entry.Kind) {
     case BitstreamEntry::Error:
@@ -3983,7 +4174,7 @@ std::error_code BitcodeReader::parseFunctionBody(Function *F) {
     case BitstreamEntry::SubBlock:
       switch (Entry.ID) {
       default:  // Skip unknown content.
-        if (Stream.SkipBlock())
+        if (Blocks.SkipBlock())
           return error("Invalid record");
         break;
       case bitc::CONSTANTS_BLOCK_ID:
@@ -4018,7 +4209,7 @@ std::error_code BitcodeReader::parseFunctionBody(Function *F) {
     // Read a record.
     Record.clear();
     Instruction *I = nullptr;
-    unsigned BitCode = Stream.readRecord(Entry.ID, Record);
+    unsigned BitCode = Blocks.readRecord(Entry.ID, Record);
     switch (BitCode) {
     default: // Default behavior: reject
       return error("Invalid value");
@@ -5251,10 +5442,21 @@ std::error_code BitcodeReader::materialize(GlobalValue *GV) {
     if (std::error_code EC = findFunctionInStream(F, DFII))
       return EC;
 
-  // Move the bit stream to the saved position of the deferred function body.
-  Stream.JumpToBit(DFII->second);
-
-  if (std::error_code EC = parseFunctionBody(F))
+  // Replay the function body if it was decoded ahead of time, otherwise move
+  // the bit stream to its saved position.
+  auto PFBI = PendingFunctionBlocks.find(F);
+  if (PFBI != PendingFunctionBlocks.end()) {
+    PFBI->second->Decoded.wait();
+    Blocks.startReplay(PFBI->second->Block);
+  } else
+    Stream.JumpToBit(DFII->second);
+
+  std::error_code EC = parseFunctionBody(F);
+  if (PFBI != PendingFunctionBlocks.end()) {
+    Blocks.stopReplay();
+    PendingFunctionBlocks.erase(PFBI);
+  }
+  if (EC)
     return EC;
   F->setIsMaterializable(false);
 
@@ -5290,10 +5492,8 @@ std::error_code BitcodeReader::materializeModule() {
 
   // Iterate over the module, deserializing any functions that are still on
   // disk.
-  for (Function &F : *TheModule) {
-    if (std::error_code EC = materialize(&F))
-      return EC;
-  }
+  if (std::error_code EC = materializeFunctionBodies())
+    return EC;
   // At this point, if there are any function bodies, parse the rest of
   // the bits in the module past the last function block we have recorded
   // through either lazy scanning or the VST.
@@ -5328,6 +5528,61 @@ std::error_code BitcodeReader::materializeModule() {
   return std::error_code();
 }
 
+/// Materialize the functions of the module in order. With
+/// -bitcode-decode-threads, the function blocks whose position is known are
+/// decoded ahead of time on a thread pool, and only replayed here to build
+/// the IR, which can't be built concurrently. Decoding is kept a bounded
+/// number of functions ahead, as the decoded records take much more memory
+/// than their bitcode.
+std::error_code BitcodeReader::materializeFunctionBodies() {
+  std::vector<Function *> Functions;
+  if (BitcodeDecodeThreads > 1 && !IsStreamed)
+    for (Function &F : *TheModule)
+      if (F.isMaterializable() && DeferredFunctionInfo.lookup(&F))
+        Functions.push_back(&F);
+
+  if (Functions.size() < 2) {
+    for (Function &F : *TheModule)
+      if (std::error_code EC = materialize(&F))
+        return EC;
+    return std::error_code();
+  }
+
+  ThreadPool Pool(BitcodeDecodeThreads);
+  const size_t MaxDecodedAhead = 4 * BitcodeDecodeThreads;
+  size_t NextToDecode = 0, NextToMaterialize = 0;
+  std::error_code EC;
+  for (Function &F : *TheModule) {
+    if (NextToMaterialize < Functions.size() &&
+        Functions[NextToMaterialize] == &F) {
+      ++NextToMaterialize;
+      for (; NextToDecode < Functions.size() &&
+             NextToDecode < NextToMaterialize + MaxDecodedAhead;
+           ++NextToDecode) {
+        Function *ToDecode = Functions[NextToDecode];
+        // The function may have been materialized already, through a
+        // blockaddress.
+        if (!ToDecode->isMaterializable())
+          continue;
+        auto &Pending = PendingFunctionBlocks[ToDecode];
+        Pending.reset(new PendingFunctionBlock);
+        DecodedFunctionBlock *Block = &Pending->Block;
+        BitstreamReader *Reader = StreamFile.get();
+        uint64_t Bit = DeferredFunctionInfo[ToDecode];
+        Pending->Decoded =
+            Pool.async([Block, Reader, Bit] { Block->decode(*Reader, Bit); });
+      }
+    }
+    if ((EC = materialize(&F)))
+      break;
+  }
+
+  // Blocks left after an error may still be being decoded.
+  Pool.wait();
+  PendingFunctionBlocks.clear();
+  return EC;
+}
+
 std::vector<StructType *> BitcodeReader::getIdentifiedStructTypes() const {
   return IdentifiedStructTypes;
 }
@@ -5367,6 +5622,7 @@ BitcodeReader::initLazyStream(std::unique_ptr<DataStreamer> Streamer) {
   StreamingMemoryObject &Bytes = *OwnedBytes;
   StreamFile = llvm::make_unique<BitstreamReader>(std::move(OwnedBytes));
   Stream.init(&*StreamFile);
+  IsStreamed = true;
 
   unsigned char buf[16];
   if (Bytes.readBytes(buf, 16, 0) != 16)
@@ -5924,6 +6180,130 @@ std::string llvm::getBitcodeProducerString(MemoryBufferRef Buffer,
   return ProducerString.get();
 }
 
+static std::error_code parseSymbolTableBlock(BitstreamCursor &Stream,
+                                             BitcodeSymbolTable &Table) {
+  std::error_code Corrupted = make_error_code(BitcodeError::CorruptedBitcode);
+  if (Stream.EnterSubBlock(bitc::SYMTAB_BLOCK_ID))
+    return Corrupted;
+
+  // The names are resolved once the string table, which comes last, is read.
+  SmallVector<uint64_t, 10> Record;
+  SmallVector<std::pair<uint64_t, uint64_t>, 64> Names;
+  SmallVector<std::pair<uint64_t, uint64_t>, 64> Comdats;
+  std::pair<uint64_t, uint64_t> Triple;
+  StringRef StrTab;
+  while (1) {
+    BitstreamEntry Entry = Stream.advanceSkippingSubblocks();
+    if (Entry.Kind == BitstreamEntry::EndBlock)
+      break;
+    if (Entry.Kind != BitstreamEntry::Record)
+      return Corrupted;
+
+    Record.clear();
+    StringRef Blob;
+    switch (Stream.readRecord(Entry.ID, Record, &Blob)) {
+    default: // Default behavior: ignore.
+      break;
+    case bitc::SYMTAB_CODE_STRTAB: // STRTAB: [blob]
+      StrTab = Blob;
+      break;
+    case bitc::SYMTAB_CODE_TRIPLE: // TRIPLE: [offset, size]
+      if (Record.size() < 2)
+        return Corrupted;
+      Triple = std::make_pair(Record[0], Record[1]);
+      break;
+    case bitc::SYMTAB_CODE_SYMBOL: { // SYMBOL: [offset, size, kind, flags,
+                                     //          linkage, visibility, ...]
+      if (Record.size() < 10)
+        return Corrupted;
+      BitcodeSymbol Sym;
+      switch (Record[2]) {
+      case bitc::SYMTAB_KIND_FUNCTION:
+        Sym.Kind = BitcodeSymbol::Function;
+        break;
+      case bitc::SYMTAB_KIND_VARIABLE:
+        Sym.Kind = BitcodeSymbol::Variable;
+        break;
+      case bitc::SYMTAB_KIND_ALIAS:
+        Sym.Kind = BitcodeSymbol::Alias;
+        break;
+      default:
+        return Corrupted;
+      }
+      uint64_t Flags = Record[3];
+      Sym.IsUndefined = Flags & bitc::SYMTAB_FLAG_UNDEFINED;
+      Sym.IsConstant = Flags & bitc::SYMTAB_FLAG_CONSTANT;
+      Sym.IsLLVMSpecific = Flags & bitc::SYMTAB_FLAG_LLVM_SPECIFIC;
+      Sym.HasComdat = Flags & bitc::SYMTAB_FLAG_HAS_COMDAT;
+      Sym.IsExecutable = Flags & bitc::SYMTAB_FLAG_EXECUTABLE;
+      Sym.Linkage = getDecodedLinkage(Record[4]);
+      Sym.Visibility = getDecodedVisibility(Record[5]);
+      Sym.CommonSize = Record[8];
+      Sym.CommonAlign = Record[9];
+      Table.Symbols.push_back(Sym);
+      Names.push_back(std::make_pair(Record[0], Record[1]));
+      Comdats.push_back(std::make_pair(Record[6], Record[7]));
+      break;
+    }
+    }
+  }
+
+  auto GetString = [&](std::pair<uint64_t, uint64_t> Ref, StringRef &Str) {
+    if (Ref.first > StrTab.size() || Ref.second > StrTab.size() - Ref.first)
+      return false;
+    Str = StrTab.substr(Ref.first, Ref.second);
+    return true;
+  };
+  if (!GetString(Triple, Table.TargetTriple))
+    return Corrupted;
+  for (unsigned I = 0, E = Table.Symbols.size(); I != E; ++I) {
+    BitcodeSymbol &Sym = Table.Symbols[I];
+    if (!GetString(Names[I], Sym.Name) ||
+        (Sym.HasComdat && !GetString(Comdats[I], Sym.Comdat)))
+      return Corrupted;
+  }
+  return std::error_code();
+}
+
+ErrorOr<std::unique_ptr<BitcodeSymbolTable>>
+llvm::readBitcodeSymbolTable(MemoryBufferRef Buffer) {
+  const unsigned char *BufPtr =
+      reinterpret_cast<const unsigned char *>(Buffer.getBufferStart());
+  const unsigned char *BufEnd = BufPtr + Buffer.getBufferSize();
+  if (Buffer.getBufferSize() & 3)
+    return make_error_code(BitcodeError::InvalidBitcodeSignature);
+  if (isBitcodeWrapper(BufPtr, BufEnd))
+    if (SkipBitcodeWrapperHeader(BufPtr, BufEnd, true))
+      return make_error_code(BitcodeError::InvalidBitcodeSignature);
+
+  BitstreamReader StreamFile(BufPtr, BufEnd);
+  BitstreamCursor Stream(StreamFile);
+  if (!hasValidBitcodeHeader(Stream))
+    return make_error_code(BitcodeError::InvalidBitcodeSignature);
+
+  // The symbol table is written before the module block, which is never
+  // entered.
+  while (!Stream.AtEndOfStream()) {
+    BitstreamEntry Entry = Stream.advance();
+    if (Entry.Kind != BitstreamEntry::SubBlock)
+      break;
+
+    if (Entry.ID == bitc::MODULE_BLOCK_ID)
+      break;
+
+    if (Entry.ID == bitc::SYMTAB_BLOCK_ID) {
+      auto Table = llvm::make_unique<BitcodeSymbolTable>();
+      if (std::error_code EC = parseSymbolTableBlock(Stream, *Table))
+        return EC;
+      return std::move(Table);
+    }
+
+    if (Stream.SkipBlock())
+      return make_error_code(BitcodeError::CorruptedBitcode);
+  }
+  return std::unique_ptr<BitcodeSymbolTable>();
+}
+
 // Parse the specified bitcode buffer, returning the function info index.
 // If IsLazy is false, parse the entire function summary into
 // the index. Otherwise skip the function summary section, and only create
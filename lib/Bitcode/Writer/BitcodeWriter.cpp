@@ -14,6 +14,8 @@
 #include "llvm/Bitcode/ReaderWriter.h"
 #include "ValueEnumerator.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Bitcode/BitstreamWriter.h"
 #include "llvm/Bitcode/LLVMBitCodes.h"
@@ -25,6 +27,7 @@
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/Mangler.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Operator.h"
 #include "llvm/IR/UseListOrder.h"
@@ -2901,6 +2904,125 @@ static void WriteIdentificationBlock(const Module *M, BitstreamWriter &Stream) {
   Stream.ExitBlock();
 }
 
+namespace {
+/// Builds the string table of the symbol table block, sharing the strings
+/// added more than once.
+class SymtabStringTable {
+  SmallString<256> Data;
+  StringMap<uint64_t> Offsets;
+
+public:
+  /// Add \p Str to the table and push its offset and size to \p Vals.
+  void add(StringRef Str, SmallVectorImpl<uint64_t> &Vals) {
+    auto P = Offsets.insert(std::make_pair(Str, Data.size()));
+    if (P.second)
+      Data += Str;
+    Vals.push_back(P.first->second);
+    Vals.push_back(Str.size());
+  }
+
+  StringRef str() const { return Data; }
+};
+} // end anonymous namespace
+
+/// Emit the symbol table block of the module, which describes its symbols the
+/// way IRObjectFile does, so that they can be read without the module.
+static void WriteSymbolTable(const Module *M, BitstreamWriter &Stream) {
+  Stream.EnterSubblock(bitc::SYMTAB_BLOCK_ID, 3);
+
+  BitCodeAbbrev *Abbv = new BitCodeAbbrev();
+  Abbv->Add(BitCodeAbbrevOp(bitc::SYMTAB_CODE_SYMBOL));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8)); // offset
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6)); // size
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 2)); // kind
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6)); // flags
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 5)); // linkage
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 2)); // visibility
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8)); // comdatoffset
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6)); // comdatsize
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8)); // commonsize
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 6)); // commonalign
+  unsigned SymbolAbbrev = Stream.EmitAbbrev(Abbv);
+
+  Abbv = new BitCodeAbbrev();
+  Abbv->Add(BitCodeAbbrevOp(bitc::SYMTAB_CODE_STRTAB));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob));
+  unsigned StrtabAbbrev = Stream.EmitAbbrev(Abbv);
+
+  SymtabStringTable StrTab;
+  SmallVector<uint64_t, 10> Vals;
+  StrTab.add(M->getTargetTriple(), Vals);
+  Stream.EmitRecord(bitc::SYMTAB_CODE_TRIPLE, Vals);
+  Vals.clear();
+
+  Mangler Mang;
+  SmallString<64> Name;
+  auto WriteSymbol = [&](const GlobalValue &GV) {
+    Name.clear();
+    raw_svector_ostream OS(Name);
+    if (GV.hasDLLImportStorageClass())
+      OS << "__imp_";
+    Mang.getNameWithPrefix(OS, &GV, false);
+    StrTab.add(Name, Vals);
+
+    unsigned Kind = bitc::SYMTAB_KIND_FUNCTION;
+    if (isa<GlobalVariable>(GV))
+      Kind = bitc::SYMTAB_KIND_VARIABLE;
+    else if (isa<GlobalAlias>(GV))
+      Kind = bitc::SYMTAB_KIND_ALIAS;
+    Vals.push_back(Kind);
+
+    unsigned Flags = 0;
+    if (GV.isDeclarationForLinker())
+      Flags |= bitc::SYMTAB_FLAG_UNDEFINED;
+    const auto *GVar = dyn_cast<GlobalVariable>(&GV);
+    if (GVar && GVar->isConstant())
+      Flags |= bitc::SYMTAB_FLAG_CONSTANT;
+    if (GV.getName().startswith("llvm.") ||
+        (GVar && GVar->getSection() == StringRef("llvm.metadata")))
+      Flags |= bitc::SYMTAB_FLAG_LLVM_SPECIFIC;
+    const Comdat *C = GV.getComdat();
+    if (C)
+      Flags |= bitc::SYMTAB_FLAG_HAS_COMDAT;
+    if (GV.getValueType()->isFunctionTy())
+      Flags |= bitc::SYMTAB_FLAG_EXECUTABLE;
+    Vals.push_back(Flags);
+
+    Vals.push_back(getEncodedLinkage(GV));
+    Vals.push_back(getEncodedVisibility(GV));
+    if (C) {
+      StrTab.add(C->getName(), Vals);
+    } else {
+      Vals.push_back(0);
+      Vals.push_back(0);
+    }
+    if (GV.hasCommonLinkage()) {
+      Vals.push_back(
+          M->getDataLayout().getTypeAllocSize(GV.getValueType()));
+      Vals.push_back(GVar->getAlignment());
+    } else {
+      Vals.push_back(0);
+      Vals.push_back(0);
+    }
+
+    Stream.EmitRecord(bitc::SYMTAB_CODE_SYMBOL, Vals, SymbolAbbrev);
+    Vals.clear();
+  };
+
+  // Same order as the symbols of IRObjectFile.
+  for (const Function &F : *M)
+    WriteSymbol(F);
+  for (const GlobalVariable &GV : M->globals())
+    WriteSymbol(GV);
+  for (const GlobalAlias &A : M->aliases())
+    WriteSymbol(A);
+
+  // The string table comes last, once complete.
+  Vals.push_back(bitc::SYMTAB_CODE_STRTAB);
+  Stream.EmitRecordWithBlob(StrtabAbbrev, Vals, StrTab.str());
+  Stream.ExitBlock();
+}
+
 /// WriteModule - Emit the specified module to the bitstream.
 static void WriteModule(const Module *M, BitstreamWriter &Stream,
                         bool ShouldPreserveUseListOrder,
@@ -3046,7 +3168,7 @@ static void WriteBitcodeHeader(BitstreamWriter &Stream) {
 /// stream.
 void llvm::WriteBitcodeToFile(const Module *M, raw_ostream &Out,
                               bool ShouldPreserveUseListOrder,
-                              bool EmitFunctionSummary) {
+                              bool EmitFunctionSummary, bool EmitSymbolTable) {
   SmallVector<char, 0> Buffer;
   Buffer.reserve(256*1024);
 
@@ -3070,6 +3192,11 @@ void llvm::WriteBitcodeToFile(const Module *M, raw_ostream &Out,
 
     WriteIdentificationBlock(M, Stream);
 
+    // The symbol table precedes the module so that it can be found without
+    // skipping over it.
+    if (EmitSymbolTable && M->getModuleInlineAsm().empty())
+      WriteSymbolTable(M, Stream);
+
     // Emit the module.
     WriteModule(M, Stream, ShouldPreserveUseListOrder, BitcodeStartBit,
                 EmitFunctionSummary);
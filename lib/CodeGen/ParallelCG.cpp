@@ -12,19 +12,69 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/CodeGen/ParallelCG.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ErrorOr.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/thread.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Transforms/Utils/SplitModule.h"
+#include <future>
 
 using namespace llvm;
 
+static cl::opt<bool> TimeCodeGenPartitions(
+    "time-codegen-partitions", cl::Hidden,
+    cl::desc("Report the wall time spent generating code for each partition "
+             "of a split module"));
+
+namespace {
+/// Size and code generation time of a partition.
+struct PartitionInfo {
+  unsigned NumInstructions = 0;
+  double WallTime = 0;
+};
+}
+
+static unsigned countInstructions(const Module &M) {
+  unsigned Count = 0;
+  for (const Function &F : M)
+    for (const BasicBlock &BB : F)
+      Count += BB.size();
+  return Count;
+}
+
+static void printPartitionTimes(ArrayRef<PartitionInfo> Partitions) {
+  double Total = 0, Max = 0;
+  for (const PartitionInfo &P : Partitions) {
+    Total += P.WallTime;
+    Max = std::max(Max, P.WallTime);
+  }
+
+  std::unique_ptr<raw_ostream> OS = CreateInfoOutputFile();
+  *OS << "===" << std::string(73, '-') << "===\n"
+      << "                      Split module code generation report\n"
+      << "===" << std::string(73, '-') << "===\n"
+      << "  Partition  Instructions   ---Wall Time---\n";
+  for (unsigned I = 0, E = Partitions.size(); I != E; ++I)
+    *OS << format("  %9u  %12u   %7.4fs (%5.1f%%)\n", I,
+                  Partitions[I].NumInstructions, Partitions[I].WallTime,
+                  Total ? Partitions[I].WallTime * 100 / Total : 0.0);
+  // The imbalance is the ratio between the slowest partition and the average
+  // one: 1.0 means all threads were busy until the end.
+  *OS << format("  Imbalance (slowest / average): %.2f\n\n",
+                Total ? Max * Partitions.size() / Total : 1.0);
+  OS->flush();
+}
+
 static void codegen(Module *M, llvm::raw_pwrite_stream &OS,
                     const Target *TheTarget, StringRef CPU, StringRef Features,
                     const TargetOptions &Options, Reloc::Model RM,
@@ -58,40 +108,73 @@ llvm::splitCodeGen(std::unique_ptr<Module> M,
     return M;
   }
 
-  std::vector<thread> Threads;
+  // Split the module into partitions of similar instruction counts. All of
+  // them are created up front, so that the original context isn't modified
+  // anymore while the partitions are handed off to the threads.
+  std::vector<std::unique_ptr<Module>> Parts;
   SplitModule(std::move(M), OSs.size(), [&](std::unique_ptr<Module> MPart) {
-    // We want to clone the module in a new context to multi-thread the codegen.
-    // We do it by serializing partition modules to bitcode (while still on the
-    // main thread, in order to avoid data races) and spinning up new threads
-    // which deserialize the partitions into separate contexts.
-    // FIXME: Provide a more direct way to do this in LLVM.
-    SmallVector<char, 0> BC;
-    raw_svector_ostream BCOS(BC);
-    WriteBitcodeToFile(MPart.get(), BCOS);
-
-    llvm::raw_pwrite_stream *ThreadOS = OSs[Threads.size()];
-    Threads.emplace_back(
-        [TheTarget, CPU, Features, Options, RM, CM, OL, FileType,
-         ThreadOS](const SmallVector<char, 0> &BC) {
-          LLVMContext Ctx;
-          ErrorOr<std::unique_ptr<Module>> MOrErr =
-              parseBitcodeFile(MemoryBufferRef(StringRef(BC.data(), BC.size()),
-                                               "<split-module>"),
-                               Ctx);
-          if (!MOrErr)
-            report_fatal_error("Failed to read bitcode");
-          std::unique_ptr<Module> MPartInCtx = std::move(MOrErr.get());
-
-          codegen(MPartInCtx.get(), *ThreadOS, TheTarget, CPU, Features,
-                  Options, RM, CM, OL, FileType);
-        },
-        // Pass BC using std::move to ensure that it get moved rather than
-        // copied into the thread's context.
-        std::move(BC));
-  }, PreserveLocals);
+    Parts.push_back(std::move(MPart));
+  }, PreserveLocals, /*BalanceBySize=*/true);
+
+  std::vector<PartitionInfo> Infos(Parts.size());
+  for (unsigned I = 0, E = Parts.size(); I != E; ++I)
+    Infos[I].NumInstructions = countInstructions(*Parts[I]);
+
+  // The last partition is compiled on this thread, in the original context.
+  // Every other partition is moved to a context of its own by the thread
+  // compiling it: the thread serializes it to an in-memory bitcode buffer,
+  // which only reads the original context and can therefore be done by all
+  // the threads at once, and parses the buffer back in its own context.
+  unsigned LastPart = Parts.size() - 1;
+  std::vector<std::promise<void>> Serialized(LastPart);
+  std::vector<std::future<void>> SerializedFutures;
+  for (std::promise<void> &P : Serialized)
+    SerializedFutures.push_back(P.get_future());
+
+  std::vector<thread> Threads;
+  for (unsigned I = 0; I != LastPart; ++I) {
+    Threads.emplace_back([&, I] {
+      TimeRecord Start = TimeRecord::getCurrentTime();
+      SmallVector<char, 0> BC;
+      {
+        raw_svector_ostream BCOS(BC);
+        WriteBitcodeToFile(Parts[I].get(), BCOS);
+      }
+      Serialized[I].set_value();
+
+      LLVMContext Ctx;
+      ErrorOr<std::unique_ptr<Module>> MOrErr = parseBitcodeFile(
+          MemoryBufferRef(StringRef(BC.data(), BC.size()), "<split-module>"),
+          Ctx);
+      if (!MOrErr)
+        report_fatal_error("Failed to read bitcode");
+      std::unique_ptr<Module> MPartInCtx = std::move(MOrErr.get());
+
+      codegen(MPartInCtx.get(), *OSs[I], TheTarget, CPU, Features, Options, RM,
+              CM, OL, FileType);
+      Infos[I].WallTime =
+          TimeRecord::getCurrentTime(false).getWallTime() - Start.getWallTime();
+    });
+  }
+
+  // Once all the partitions are serialized, the original context is only used
+  // by this thread.
+  for (std::future<void> &F : SerializedFutures)
+    F.wait();
+  for (unsigned I = 0; I != LastPart; ++I)
+    Parts[I].reset();
+
+  TimeRecord Start = TimeRecord::getCurrentTime();
+  codegen(Parts[LastPart].get(), *OSs[LastPart], TheTarget, CPU, Features,
+          Options, RM, CM, OL, FileType);
+  Infos[LastPart].WallTime =
+      TimeRecord::getCurrentTime(false).getWallTime() - Start.getWallTime();
 
   for (thread &T : Threads)
     T.join();
 
+  if (TimeCodeGenPartitions)
+    printPartitionTimes(Infos);
+
   return {};
 }
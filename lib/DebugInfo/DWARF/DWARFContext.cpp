@@ -16,6 +16,7 @@
 #include "llvm/Support/Compression.h"
 #include "llvm/Support/Dwarf.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
@@ -682,6 +683,13 @@ DWARFContextInMemory::DWARFContextInMemory(const object::ObjectFile &Obj,
             .Default(nullptr);
     if (SectionData) {
       *SectionData = data;
+      // Every lookup starts from the abbreviations, the address ranges and
+      // the unit indexes, so start paging them in.  The other sections are
+      // often only partly read, e.g. by the symbolizer.
+      if (SectionData == &AbbrevSection || SectionData == &ARangeSection ||
+          SectionData == &AbbrevDWOSection || SectionData == &CUIndexSection ||
+          SectionData == &TUIndexSection)
+        MemoryBuffer::prefetch(data);
       if (name == "debug_ranges") {
         // FIXME: Use the other dwo range section when we emit it.
         RangeDWOSection = data;
@@ -297,6 +297,8 @@ Constant *Constant::getAggregateElement(Constant *Elt) const {
 }
 
 void Constant::destroyConstant() {
+  UniquingLock Guard(getContext().pImpl->ConstantsLock);
+
   /// First call destroyConstantImpl on the subclass.  This gives the subclass
   /// a chance to remove the constant from any maps/pools it's contained in.
   switch (getValueID()) {
@@ -567,8 +569,10 @@ Constant *ConstantInt::getFalse(Type *Ty) {
 // Get a ConstantInt from an APInt.
 ConstantInt *ConstantInt::get(LLVMContext &Context, const APInt &V) {
   // get an existing value or the insertion position
-  LLVMContextImpl *pImpl = Context.pImpl;
-  ConstantInt *&Slot = pImpl->IntConstants[V];
+  LLVMContextImpl::IntConstantShard &Shard =
+      Context.pImpl->getIntConstantShard(V);
+  UniquingLock Guard(Shard.Lock);
+  ConstantInt *&Slot = Shard.Constants[V];
   if (!Slot) {
     // Get the corresponding integer type for the bit width of the value.
     IntegerType *ITy = IntegerType::get(Context, V.getBitWidth());
@@ -713,6 +717,7 @@ Constant *ConstantFP::getZeroValueForNegation(Type *Ty) {
 ConstantFP* ConstantFP::get(LLVMContext &Context, const APFloat& V) {
   LLVMContextImpl* pImpl = Context.pImpl;
 
+  UniquingLock Guard(pImpl->FPConstantsLock);
   ConstantFP *&Slot = pImpl->FPConstants[V];
 
   if (!Slot) {
@@ -925,7 +930,9 @@ ConstantArray::ConstantArray(ArrayType *T, ArrayRef<Constant *> V)
 Constant *ConstantArray::get(ArrayType *Ty, ArrayRef<Constant*> V) {
   if (Constant *C = getImpl(Ty, V))
     return C;
-  return Ty->getContext().pImpl->ArrayConstants.getOrCreate(Ty, V);
+  LLVMContextImpl *pImpl = Ty->getContext().pImpl;
+  UniquingLock Guard(pImpl->ConstantsLock);
+  return pImpl->ArrayConstants.getOrCreate(Ty, V);
 }
 
 Constant *ConstantArray::getImpl(ArrayType *Ty, ArrayRef<Constant*> V) {
@@ -1017,7 +1024,9 @@ Constant *ConstantStruct::get(StructType *ST, ArrayRef<Constant*> V) {
   if (isUndef)
     return UndefValue::get(ST);
 
-  return ST->getContext().pImpl->StructConstants.getOrCreate(ST, V);
+  LLVMContextImpl *pImpl = ST->getContext().pImpl;
+  UniquingLock Guard(pImpl->ConstantsLock);
+  return pImpl->StructConstants.getOrCreate(ST, V);
 }
 
 Constant *ConstantStruct::get(StructType *T, ...) {
@@ -1045,7 +1054,9 @@ Constant *ConstantVector::get(ArrayRef<Constant*> V) {
   if (Constant *C = getImpl(V))
     return C;
   VectorType *Ty = VectorType::get(V.front()->getType(), V.size());
-  return Ty->getContext().pImpl->VectorConstants.getOrCreate(Ty, V);
+  LLVMContextImpl *pImpl = Ty->getContext().pImpl;
+  UniquingLock Guard(pImpl->ConstantsLock);
+  return pImpl->VectorConstants.getOrCreate(Ty, V);
 }
 
 Constant *ConstantVector::getImpl(ArrayRef<Constant*> V) {
@@ -1094,6 +1105,7 @@ Constant *ConstantVector::getSplat(unsigned NumElts, Constant *V) {
 
 ConstantTokenNone *ConstantTokenNone::get(LLVMContext &Context) {
   LLVMContextImpl *pImpl = Context.pImpl;
+  UniquingLock Guard(pImpl->ConstantsLock);
   if (!pImpl->TheNoneToken)
     pImpl->TheNoneToken.reset(new ConstantTokenNone(Context));
   return pImpl->TheNoneToken.get();
@@ -1313,7 +1325,9 @@ ConstantAggregateZero *ConstantAggregateZero::get(Type *Ty) {
   assert((Ty->isStructTy() || Ty->isArrayTy() || Ty->isVectorTy()) &&
          "Cannot create an aggregate zero of non-aggregate type!");
   
-  ConstantAggregateZero *&Entry = Ty->getContext().pImpl->CAZConstants[Ty];
+  LLVMContextImpl *pImpl = Ty->getContext().pImpl;
+  UniquingLock Guard(pImpl->ConstantsLock);
+  ConstantAggregateZero *&Entry = pImpl->CAZConstants[Ty];
   if (!Entry)
     Entry = new ConstantAggregateZero(Ty);
 
@@ -1388,7 +1402,9 @@ const APInt &Constant::getUniqueInteger() const {
 //
 
 ConstantPointerNull *ConstantPointerNull::get(PointerType *Ty) {
-  ConstantPointerNull *&Entry = Ty->getContext().pImpl->CPNConstants[Ty];
+  LLVMContextImpl *pImpl = Ty->getContext().pImpl;
+  UniquingLock Guard(pImpl->ConstantsLock);
+  ConstantPointerNull *&Entry = pImpl->CPNConstants[Ty];
   if (!Entry)
     Entry = new ConstantPointerNull(Ty);
 
@@ -1406,7 +1422,9 @@ void ConstantPointerNull::destroyConstantImpl() {
 //
 
 UndefValue *UndefValue::get(Type *Ty) {
-  UndefValue *&Entry = Ty->getContext().pImpl->UVConstants[Ty];
+  LLVMContextImpl *pImpl = Ty->getContext().pImpl;
+  UniquingLock Guard(pImpl->ConstantsLock);
+  UndefValue *&Entry = pImpl->UVConstants[Ty];
   if (!Entry)
     Entry = new UndefValue(Ty);
 
@@ -1429,8 +1447,9 @@ BlockAddress *BlockAddress::get(BasicBlock *BB) {
 }
 
 BlockAddress *BlockAddress::get(Function *F, BasicBlock *BB) {
-  BlockAddress *&BA =
-    F->getContext().pImpl->BlockAddresses[std::make_pair(F, BB)];
+  LLVMContextImpl *pImpl = F->getContext().pImpl;
+  UniquingLock Guard(pImpl->ConstantsLock);
+  BlockAddress *&BA = pImpl->BlockAddresses[std::make_pair(F, BB)];
   if (!BA)
     BA = new BlockAddress(F, BB);
 
@@ -1452,8 +1471,9 @@ BlockAddress *BlockAddress::lookup(const BasicBlock *BB) {
 
   const Function *F = BB->getParent();
   assert(F && "Block must have a parent");
-  BlockAddress *BA =
-      F->getContext().pImpl->BlockAddresses.lookup(std::make_pair(F, BB));
+  LLVMContextImpl *pImpl = F->getContext().pImpl;
+  UniquingLock Guard(pImpl->ConstantsLock);
+  BlockAddress *BA = pImpl->BlockAddresses.lookup(std::make_pair(F, BB));
   assert(BA && "Refcount and block address map disagree!");
   return BA;
 }
@@ -1520,6 +1540,7 @@ static Constant *getFoldedCast(Instruction::CastOps opc, Constant *C, Type *Ty,
   // Look up the constant in the table first to ensure uniqueness.
   ConstantExprKeyType Key(opc, C);
 
+  UniquingLock Guard(pImpl->ConstantsLock);
   return pImpl->ExprConstants.getOrCreate(Ty, Key);
 }
 
@@ -1877,6 +1898,7 @@ Constant *ConstantExpr::get(unsigned Opcode, Constant *C1, Constant *C2,
   ConstantExprKeyType Key(Opcode, ArgVec, 0, Flags);
 
   LLVMContextImpl *pImpl = C1->getContext().pImpl;
+  UniquingLock Guard(pImpl->ConstantsLock);
   return pImpl->ExprConstants.getOrCreate(C1->getType(), Key);
 }
 
@@ -1958,6 +1980,7 @@ Constant *ConstantExpr::getSelect(Constant *C, Constant *V1, Constant *V2,
   ConstantExprKeyType Key(Instruction::Select, ArgVec);
 
   LLVMContextImpl *pImpl = C->getContext().pImpl;
+  UniquingLock Guard(pImpl->ConstantsLock);
   return pImpl->ExprConstants.getOrCreate(V1->getType(), Key);
 }
 
@@ -2003,6 +2026,7 @@ Constant *ConstantExpr::getGetElementPtr(Type *Ty, Constant *C,
                                 Ty);
 
   LLVMContextImpl *pImpl = C->getContext().pImpl;
+  UniquingLock Guard(pImpl->ConstantsLock);
   return pImpl->ExprConstants.getOrCreate(ReqTy, Key);
 }
 
@@ -2028,6 +2052,7 @@ Constant *ConstantExpr::getICmp(unsigned short pred, Constant *LHS,
     ResultTy = VectorType::get(ResultTy, VT->getNumElements());
 
   LLVMContextImpl *pImpl = LHS->getType()->getContext().pImpl;
+  UniquingLock Guard(pImpl->ConstantsLock);
   return pImpl->ExprConstants.getOrCreate(ResultTy, Key);
 }
 
@@ -2052,6 +2077,7 @@ Constant *ConstantExpr::getFCmp(unsigned short pred, Constant *LHS,
     ResultTy = VectorType::get(ResultTy, VT->getNumElements());
 
   LLVMContextImpl *pImpl = LHS->getType()->getContext().pImpl;
+  UniquingLock Guard(pImpl->ConstantsLock);
   return pImpl->ExprConstants.getOrCreate(ResultTy, Key);
 }
 
@@ -2074,6 +2100,7 @@ Constant *ConstantExpr::getExtractElement(Constant *Val, Constant *Idx,
   const ConstantExprKeyType Key(Instruction::ExtractElement, ArgVec);
 
   LLVMContextImpl *pImpl = Val->getContext().pImpl;
+  UniquingLock Guard(pImpl->ConstantsLock);
   return pImpl->ExprConstants.getOrCreate(ReqTy, Key);
 }
 
@@ -2097,6 +2124,7 @@ Constant *ConstantExpr::getInsertElement(Constant *Val, Constant *Elt,
   const ConstantExprKeyType Key(Instruction::InsertElement, ArgVec);
 
   LLVMContextImpl *pImpl = Val->getContext().pImpl;
+  UniquingLock Guard(pImpl->ConstantsLock);
   return pImpl->ExprConstants.getOrCreate(Val->getType(), Key);
 }
 
@@ -2120,6 +2148,7 @@ Constant *ConstantExpr::getShuffleVector(Constant *V1, Constant *V2,
   const ConstantExprKeyType Key(Instruction::ShuffleVector, ArgVec);
 
   LLVMContextImpl *pImpl = ShufTy->getContext().pImpl;
+  UniquingLock Guard(pImpl->ConstantsLock);
   return pImpl->ExprConstants.getOrCreate(ShufTy, Key);
 }
 
@@ -2144,6 +2173,7 @@ Constant *ConstantExpr::getInsertValue(Constant *Agg, Constant *Val,
   const ConstantExprKeyType Key(Instruction::InsertValue, ArgVec, 0, 0, Idxs);
 
   LLVMContextImpl *pImpl = Agg->getContext().pImpl;
+  UniquingLock Guard(pImpl->ConstantsLock);
   return pImpl->ExprConstants.getOrCreate(ReqTy, Key);
 }
 
@@ -2168,6 +2198,7 @@ Constant *ConstantExpr::getExtractValue(Constant *Agg, ArrayRef<unsigned> Idxs,
   const ConstantExprKeyType Key(Instruction::ExtractValue, ArgVec, 0, 0, Idxs);
 
   LLVMContextImpl *pImpl = Agg->getContext().pImpl;
+  UniquingLock Guard(pImpl->ConstantsLock);
   return pImpl->ExprConstants.getOrCreate(ReqTy, Key);
 }
 
@@ -2425,10 +2456,10 @@ Constant *ConstantDataSequential::getImpl(StringRef Elements, Type *Ty) {
     return ConstantAggregateZero::get(Ty);
 
   // Do a lookup to see if we have already formed one of these.
+  LLVMContextImpl *pImpl = Ty->getContext().pImpl;
+  UniquingLock Guard(pImpl->ConstantsLock);
   auto &Slot =
-      *Ty->getContext()
-           .pImpl->CDSConstants.insert(std::make_pair(Elements, nullptr))
-           .first;
+      *pImpl->CDSConstants.insert(std::make_pair(Elements, nullptr)).first;
 
   // The bucket can point to a linked list of different CDS's that have the same
   // body but different types.  For example, 0,0,0,1 could be a 4 element array
@@ -2788,6 +2819,7 @@ Constant *ConstantDataVector::getSplatValue() const {
 /// array instance.
 ///
 void Constant::handleOperandChange(Value *From, Value *To, Use *U) {
+  UniquingLock Guard(getContext().pImpl->ConstantsLock);
   Value *Replacement = nullptr;
   switch (getValueID()) {
   default:
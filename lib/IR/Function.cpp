@@ -317,6 +317,7 @@ void Function::setParent(Module *parent) {
 //
 void Function::dropAllReferences() {
   setIsMaterializable(false);
+  markChanged();
 
   for (iterator I = begin(), E = end(); I != E; ++I)
     I->dropAllReferences();
@@ -14,12 +14,42 @@
 
 #include "llvm/IR/FunctionInfo.h"
 #include "llvm/ADT/StringMap.h"
+#include "llvm/Support/MathExtras.h"
 using namespace llvm;
 
+FunctionInfoSource::~FunctionInfoSource() {}
+
+void FunctionInfoIndex::setSource(std::unique_ptr<FunctionInfoSource> Source) {
+  assert(FunctionMap.empty() && "Index already has function infos");
+  // Size the map so that it never grows, which would invalidate the iterators
+  // returned to other threads: the StringMap grows past 3/4 full.
+  if (unsigned NumFunctions = Source->getNumFunctions())
+    FunctionMap = FunctionInfoMapTy(NextPowerOf2(NumFunctions * 4ULL / 3));
+  this->Source = std::move(Source);
+}
+
+const_funcinfo_iterator
+FunctionInfoIndex::materializeFunctionInfoList(StringRef FuncName) const {
+  sys::ScopedLock Guard(SourceLock);
+  auto I = FunctionMap.find(FuncName);
+  if (I != FunctionMap.end())
+    return I;
+  FunctionInfoList List;
+  if (!Source->readFunctionInfoList(FuncName, List))
+    return FunctionMap.end();
+  return FunctionMap.insert(std::make_pair(FuncName, std::move(List))).first;
+}
+
+void FunctionInfoIndex::materializeAll() {
+  if (Source)
+    Source->readAllFunctionInfoLists(FunctionMap);
+}
+
 // Create the combined function index/summary from multiple
 // per-module instances.
 void FunctionInfoIndex::mergeFrom(std::unique_ptr<FunctionInfoIndex> Other,
                                   uint64_t NextModuleId) {
+  Other->materializeAll();
 
   StringRef ModPath;
   for (auto &OtherFuncInfoLists : *Other) {
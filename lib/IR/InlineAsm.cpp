@@ -29,8 +29,10 @@ InlineAsm *InlineAsm::get(FunctionType *FTy, StringRef AsmString,
                           bool isAlignStack, AsmDialect asmDialect) {
   InlineAsmKeyType Key(AsmString, Constraints, FTy, hasSideEffects,
                        isAlignStack, asmDialect);
+  PointerType *Ty = PointerType::getUnqual(FTy);
   LLVMContextImpl *pImpl = FTy->getContext().pImpl;
-  return pImpl->InlineAsms.getOrCreate(PointerType::getUnqual(FTy), Key);
+  UniquingLock Guard(pImpl->ConstantsLock);
+  return pImpl->InlineAsms.getOrCreate(Ty, Key);
 }
 
 InlineAsm::InlineAsm(FunctionType *FTy, const std::string &asmString,
@@ -47,7 +49,9 @@ InlineAsm::InlineAsm(FunctionType *FTy, const std::string &asmString,
 }
 
 void InlineAsm::destroyConstant() {
-  getType()->getContext().pImpl->InlineAsms.remove(this);
+  LLVMContextImpl *pImpl = getType()->getContext().pImpl;
+  UniquingLock Guard(pImpl->ConstantsLock);
+  pImpl->InlineAsms.remove(this);
   delete this;
 }
 
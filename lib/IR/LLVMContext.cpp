@@ -31,7 +31,18 @@ LLVMContext& llvm::getGlobalContext() {
   return *GlobalContext;
 }
 
-LLVMContext::LLVMContext() : pImpl(new LLVMContextImpl(*this)) {
+LLVMContext::LLVMContext() : LLVMContext(SingleThreadedUniquing) {}
+
+LLVMContext::LLVMContext(UniquingMode Mode)
+    : pImpl(new LLVMContextImpl(*this)) {
+  if (Mode == ConcurrentUniquing) {
+    pImpl->enableConcurrentUniquing();
+    // Create the cached i1 constants up front, so that ConstantInt::getTrue()
+    // and getFalse() only ever read them.
+    ConstantInt::getTrue(*this);
+    ConstantInt::getFalse(*this);
+  }
+
   // Create the fixed metadata kinds. This is done in the same order as the
   // MD_* enum values so that they correspond.
 
@@ -145,6 +156,10 @@ LLVMContext::LLVMContext() : pImpl(new LLVMContextImpl(*this)) {
 }
 LLVMContext::~LLVMContext() { delete pImpl; }
 
+bool LLVMContext::hasConcurrentUniquing() const {
+  return pImpl->hasConcurrentUniquing();
+}
+
 void LLVMContext::addModule(Module *M) {
   pImpl->OwnedModules.insert(M);
 }
@@ -286,6 +301,7 @@ void LLVMContext::emitError(unsigned LocCookie, const Twine &ErrorStr) {
 
 /// Return a unique non-zero ID for the specified metadata kind.
 unsigned LLVMContext::getMDKindID(StringRef Name) const {
+  UniquingLock Guard(pImpl->MetadataLock);
   // If this is new, assign it its ID.
   return pImpl->CustomMDKindNames.insert(
                                      std::make_pair(
@@ -296,6 +312,7 @@ unsigned LLVMContext::getMDKindID(StringRef Name) const {
 /// getHandlerNames - Populate client-supplied smallvector using custom
 /// metadata name and ID.
 void LLVMContext::getMDKindNames(SmallVectorImpl<StringRef> &Names) const {
+  UniquingLock Guard(pImpl->MetadataLock);
   Names.resize(pImpl->CustomMDKindNames.size());
   for (StringMap<unsigned>::const_iterator I = pImpl->CustomMDKindNames.begin(),
        E = pImpl->CustomMDKindNames.end(); I != E; ++I)
@@ -46,6 +46,7 @@ LLVMContextImpl::LLVMContextImpl(LLVMContext &C)
   YieldCallback = nullptr;
   YieldOpaqueHandle = nullptr;
   NamedStructTypesUniqueID = 0;
+  ConcurrentUniquing = false;
 }
 
 namespace {
@@ -115,7 +116,8 @@ LLVMContextImpl::~LLVMContextImpl() {
   DeleteContainerSeconds(CPNConstants);
   DeleteContainerSeconds(UVConstants);
   InlineAsms.freeConstants();
-  DeleteContainerSeconds(IntConstants);
+  for (IntConstantShard &Shard : IntConstants)
+    DeleteContainerSeconds(Shard.Constants);
   DeleteContainerSeconds(FPConstants);
   
   for (StringMap<ConstantDataSequential*>::iterator I = CDSConstants.begin(),
@@ -163,7 +165,30 @@ LLVMContextImpl::~LLVMContextImpl() {
   MDStringCache.clear();
 }
 
+void LLVMContextImpl::enableConcurrentUniquing() {
+  ConcurrentUniquing = true;
+  TypesLock.enable();
+  ConstantsLock.enable();
+  FPConstantsLock.enable();
+  MetadataLock.enable();
+  AttributesLock.enable();
+  for (IntConstantShard &Shard : IntConstants)
+    Shard.Lock.enable();
+}
+
+void LLVMContextImpl::disableConcurrentUniquing() {
+  ConcurrentUniquing = false;
+  TypesLock.disable();
+  ConstantsLock.disable();
+  FPConstantsLock.disable();
+  MetadataLock.disable();
+  AttributesLock.disable();
+  for (IntConstantShard &Shard : IntConstants)
+    Shard.Lock.disable();
+}
+
 void LLVMContextImpl::dropTriviallyDeadConstantArrays() {
+  UniquingLock Guard(ConstantsLock);
   bool Changed;
   do {
     Changed = false;
@@ -32,6 +32,8 @@
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Metadata.h"
 #include "llvm/IR/ValueHandle.h"
+#include "llvm/Support/Mutex.h"
+#include <mutex>
 #include <vector>
 
 namespace llvm {
@@ -899,6 +901,30 @@ public:
   }
 };
 
+/// A recursive lock guarding a group of uniquing tables. Locking and unlocking
+/// are no-ops unless the owning context was created with concurrent uniquing.
+class UniquingMutex {
+  sys::MutexImpl Mutex;
+  bool Enabled;
+
+public:
+  UniquingMutex() : Mutex(/*recursive=*/true), Enabled(false) {}
+
+  void enable() { Enabled = true; }
+  void disable() { Enabled = false; }
+
+  void lock() {
+    if (Enabled)
+      Mutex.acquire();
+  }
+  void unlock() {
+    if (Enabled)
+      Mutex.release();
+  }
+};
+
+typedef std::lock_guard<UniquingMutex> UniquingLock;
+
 class LLVMContextImpl {
 public:
   /// OwnedModules - The set of modules instantiated in this context, and which
@@ -915,8 +941,51 @@ public:
   LLVMContext::YieldCallbackTy YieldCallback;
   void *YieldOpaqueHandle;
 
+  /// Locks guarding the uniquing tables when concurrent uniquing is enabled.
+  /// TypesLock guards the type tables and TypeAllocator, ConstantsLock the
+  /// constant and inline asm tables, FPConstantsLock the floating point
+  /// constants, MetadataLock the metadata tables and AttributesLock the
+  /// attribute sets. Integer constants are sharded, each shard having its own
+  /// lock. ConstantsLock also serializes the use-list updates made when
+  /// constant expressions are created, replaced or destroyed. It does not
+  /// serialize them with instructions that use the same operands.
+  ///
+  /// A thread holding some of these locks may only acquire locks that come
+  /// later in this order, or a lock it already holds:
+  ///
+  ///   1. ConstantsLock. Held while constant expressions are folded or
+  ///      replaced, which creates integer and floating point constants and
+  ///      updates the metadata referring to the replaced constants.
+  ///   2. FPConstantsLock, or the lock of one integer constant shard, never
+  ///      two shards at once.
+  ///   3. MetadataLock.
+  ///   4. TypesLock. Integer constants get their type while the shard is
+  ///      locked.
+  ///
+  /// AttributesLock is never held together with any of the other locks.
+  UniquingMutex TypesLock;
+  UniquingMutex ConstantsLock;
+  UniquingMutex FPConstantsLock;
+  UniquingMutex MetadataLock;
+  UniquingMutex AttributesLock;
+
   typedef DenseMap<APInt, ConstantInt *, DenseMapAPIntKeyInfo> IntMapTy;
-  IntMapTy IntConstants;
+  struct IntConstantShard {
+    UniquingMutex Lock;
+    IntMapTy Constants;
+  };
+  enum { NumIntConstantShards = 16 };
+  IntConstantShard IntConstants[NumIntConstantShards];
+
+  /// Return the shard holding the integer constant \p V. The shard only
+  /// depends on the value, as concurrent uniquing may be enabled and disabled
+  /// again on a context that already holds constants.
+  IntConstantShard &getIntConstantShard(const APInt &V) {
+    // DenseMap picks buckets from the low bits of the hash, so use the high
+    // ones to pick the shard.
+    unsigned Hash = DenseMapAPIntKeyInfo::getHashValue(V);
+    return IntConstants[(Hash >> 24) % NumIntConstantShards];
+  }
 
   typedef DenseMap<APFloat, ConstantFP *, DenseMapAPFloatKeyInfo> FPMapTy;
   FPMapTy FPConstants;
@@ -1034,9 +1103,20 @@ public:
   /// clients which do use GC.
   DenseMap<const Function*, std::string> GCNames;
 
+  /// True if the uniquing tables are guarded by their locks.
+  bool ConcurrentUniquing;
+
   LLVMContextImpl(LLVMContext &C);
   ~LLVMContextImpl();
 
+  /// Start guarding the uniquing tables by their locks. This must be called
+  /// before the context is shared between threads.
+  void enableConcurrentUniquing();
+  /// Stop guarding the uniquing tables. This must only be called while no
+  /// other thread uses the context.
+  void disableConcurrentUniquing();
+  bool hasConcurrentUniquing() const { return ConcurrentUniquing; }
+
   /// Destroy the ConstantArrays if they are not used.
   void dropTriviallyDeadConstantArrays();
 };
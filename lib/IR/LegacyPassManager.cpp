@@ -25,6 +25,7 @@
 #include "llvm/Support/Mutex.h"
 #include "llvm/Support/TimeValue.h"
 #include "llvm/Support/Timer.h"
+#include "llvm/Support/TraceEvents.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <map>
@@ -1330,6 +1331,8 @@ bool BBPassManager::runOnFunction(Function &F) {
         // If the pass crashes, remember this.
         PassManagerPrettyStackEntry X(BP, *I);
         TimeRegion PassTimer(getPassTimer(BP));
+        TraceRegion PassTrace(getPassTraceRecorder(), BP->getPassName(),
+                              "pass", I->getName());
 
         LocalChanged |= BP->runOnBasicBlock(*I);
       }
@@ -1546,13 +1549,17 @@ bool FPPassManager::runOnFunction(Function &F) {
     {
       PassManagerPrettyStackEntry X(FP, F);
       TimeRegion PassTimer(getPassTimer(FP));
+      TraceRegion PassTrace(getPassTraceRecorder(), FP->getPassName(), "pass",
+                            F.getName());
 
       LocalChanged |= FP->runOnFunction(F);
     }
 
     Changed |= LocalChanged;
-    if (LocalChanged)
+    if (LocalChanged) {
+      F.markChanged();
       dumpPassInfo(FP, MODIFICATION_MSG, ON_FUNCTION_MSG, F.getName());
+    }
     dumpPreservedSet(FP);
     dumpUsedSet(FP);
 
@@ -1623,14 +1630,20 @@ MPPassManager::runOnModule(Module &M) {
     {
       PassManagerPrettyStackEntry X(MP, M);
       TimeRegion PassTimer(getPassTimer(MP));
+      TraceRegion PassTrace(getPassTraceRecorder(), MP->getPassName(), "pass",
+                            M.getModuleIdentifier());
 
       LocalChanged |= MP->runOnModule(M);
     }
 
     Changed |= LocalChanged;
-    if (LocalChanged)
+    if (LocalChanged) {
+      // A module pass does not say which functions it changed.
+      for (Function &F : M)
+        F.markChanged();
       dumpPassInfo(MP, MODIFICATION_MSG, ON_MODULE_MSG,
                    M.getModuleIdentifier());
+    }
     dumpPreservedSet(MP);
     dumpUsedSet(MP);
 
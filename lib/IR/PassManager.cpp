@@ -10,9 +10,54 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/PassManager.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/ManagedStatic.h"
 
 using namespace llvm;
 
+static cl::opt<std::string> PassTraceFile(
+    "pass-trace-file", cl::value_desc("filename"),
+    cl::desc("Record the execution of each pass and write it to the given "
+             "file as a Chrome trace"));
+
+namespace {
+/// The pass trace, written when destroyed.
+struct PassTrace {
+  TraceEventRecorder Recorder;
+
+  ~PassTrace() {
+    std::error_code EC;
+    raw_fd_ostream OS(PassTraceFile, EC, sys::fs::F_Text);
+    if (EC) {
+      errs() << "Error opening pass trace file '" << PassTraceFile
+             << "': " << EC.message() << '\n';
+      return;
+    }
+    Recorder.write(OS);
+  }
+};
+} // end anonymous namespace
+
+static ManagedStatic<PassTrace> ThePassTrace;
+
+TraceEventRecorder *llvm::getPassTraceRecorder() {
+  if (PassTraceFile.empty())
+    return nullptr;
+  return &ThePassTrace->Recorder;
+}
+
+void llvm::markChangedFunctions(Function &F, const PreservedAnalyses &PA) {
+  if (!PA.areAllPreserved())
+    F.markChanged();
+}
+
+void llvm::markChangedFunctions(Module &M, const PreservedAnalyses &PA) {
+  if (PA.preserved<FunctionAnalysisManagerModuleProxy>())
+    return;
+  for (Function &F : M)
+    F.markChanged();
+}
+
 char FunctionAnalysisManagerModuleProxy::PassID;
 
 FunctionAnalysisManagerModuleProxy::Result
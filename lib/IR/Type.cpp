@@ -262,6 +262,7 @@ IntegerType *IntegerType::get(LLVMContext &C, unsigned NumBits) {
     break;
   }
   
+  UniquingLock Guard(C.pImpl->TypesLock);
   IntegerType *&Entry = C.pImpl->IntegerTypes[NumBits];
 
   if (!Entry)
@@ -307,6 +308,7 @@ FunctionType *FunctionType::get(Type *ReturnType,
                                 ArrayRef<Type*> Params, bool isVarArg) {
   LLVMContextImpl *pImpl = ReturnType->getContext().pImpl;
   FunctionTypeKeyInfo::KeyTy Key(ReturnType, Params, isVarArg);
+  UniquingLock Guard(pImpl->TypesLock);
   auto I = pImpl->FunctionTypes.find_as(Key);
   FunctionType *FT;
 
@@ -350,6 +352,7 @@ StructType *StructType::get(LLVMContext &Context, ArrayRef<Type*> ETypes,
                             bool isPacked) {
   LLVMContextImpl *pImpl = Context.pImpl;
   AnonStructTypeKeyInfo::KeyTy Key(ETypes, isPacked);
+  UniquingLock Guard(pImpl->TypesLock);
   auto I = pImpl->AnonStructTypes.find_as(Key);
   StructType *ST;
 
@@ -380,13 +383,17 @@ void StructType::setBody(ArrayRef<Type*> Elements, bool isPacked) {
     return;
   }
 
-  ContainedTys = Elements.copy(getContext().pImpl->TypeAllocator).data();
+  LLVMContextImpl *pImpl = getContext().pImpl;
+  UniquingLock Guard(pImpl->TypesLock);
+  ContainedTys = Elements.copy(pImpl->TypeAllocator).data();
 }
 
 void StructType::setName(StringRef Name) {
+  LLVMContextImpl *pImpl = getContext().pImpl;
+  UniquingLock Guard(pImpl->TypesLock);
   if (Name == getName()) return;
 
-  StringMap<StructType *> &SymbolTable = getContext().pImpl->NamedStructTypes;
+  StringMap<StructType *> &SymbolTable = pImpl->NamedStructTypes;
   typedef StringMap<StructType *>::MapEntryTy EntryTy;
 
   // If this struct already had a name, remove its symbol table entry. Don't
@@ -405,8 +412,7 @@ void StructType::setName(StringRef Name) {
   }
   
   // Look up the entry for the name.
-  auto IterBool =
-      getContext().pImpl->NamedStructTypes.insert(std::make_pair(Name, this));
+  auto IterBool = SymbolTable.insert(std::make_pair(Name, this));
 
   // While we have a name collision, try a random rename.
   if (!IterBool.second) {
@@ -417,10 +423,9 @@ void StructType::setName(StringRef Name) {
    
     do {
       TempStr.resize(NameSize + 1);
-      TmpStream << getContext().pImpl->NamedStructTypesUniqueID++;
+      TmpStream << pImpl->NamedStructTypesUniqueID++;
 
-      IterBool = getContext().pImpl->NamedStructTypes.insert(
-          std::make_pair(TmpStream.str(), this));
+      IterBool = SymbolTable.insert(std::make_pair(TmpStream.str(), this));
     } while (!IterBool.second);
   }
 
@@ -434,7 +439,11 @@ void StructType::setName(StringRef Name) {
 // StructType Helper functions.
 
 StructType *StructType::create(LLVMContext &Context, StringRef Name) {
-  StructType *ST = new (Context.pImpl->TypeAllocator) StructType(Context);
+  StructType *ST;
+  {
+    UniquingLock Guard(Context.pImpl->TypesLock);
+    ST = new (Context.pImpl->TypeAllocator) StructType(Context);
+  }
   if (!Name.empty())
     ST->setName(Name);
   return ST;
@@ -566,7 +575,9 @@ bool StructType::isLayoutIdentical(StructType *Other) const {
 /// getTypeByName - Return the type with the specified name, or null if there
 /// is none by that name.
 StructType *Module::getTypeByName(StringRef Name) const {
-  return getContext().pImpl->NamedStructTypes.lookup(Name);
+  LLVMContextImpl *pImpl = getContext().pImpl;
+  UniquingLock Guard(pImpl->TypesLock);
+  return pImpl->NamedStructTypes.lookup(Name);
 }
 
 
@@ -632,6 +643,7 @@ ArrayType *ArrayType::get(Type *ElementType, uint64_t NumElements) {
   assert(isValidElementType(ElementType) && "Invalid type for array element!");
 
   LLVMContextImpl *pImpl = ElementType->getContext().pImpl;
+  UniquingLock Guard(pImpl->TypesLock);
   ArrayType *&Entry = 
     pImpl->ArrayTypes[std::make_pair(ElementType, NumElements)];
 
@@ -662,8 +674,9 @@ VectorType *VectorType::get(Type *ElementType, unsigned NumElements) {
                                             "pointer type.");
 
   LLVMContextImpl *pImpl = ElementType->getContext().pImpl;
-  VectorType *&Entry = ElementType->getContext().pImpl
-    ->VectorTypes[std::make_pair(ElementType, NumElements)];
+  UniquingLock Guard(pImpl->TypesLock);
+  VectorType *&Entry =
+      pImpl->VectorTypes[std::make_pair(ElementType, NumElements)];
 
   if (!Entry)
     Entry = new (pImpl->TypeAllocator) VectorType(ElementType, NumElements);
@@ -684,7 +697,8 @@ PointerType *PointerType::get(Type *EltTy, unsigned AddressSpace) {
   assert(isValidElementType(EltTy) && "Invalid type for pointer element!");
   
   LLVMContextImpl *CImpl = EltTy->getContext().pImpl;
-  
+  UniquingLock Guard(CImpl->TypesLock);
+
   // Since AddressSpace #0 is the common case, we special case it.
   PointerType *&Entry = AddressSpace == 0 ? CImpl->PointerTypes[EltTy]
      : CImpl->ASPointerTypes[std::make_pair(EltTy, AddressSpace)];
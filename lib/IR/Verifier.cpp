@@ -45,11 +45,13 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/IR/Verifier.h"
+#include "LLVMContextImpl.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/IR/CFG.h"
 #include "llvm/IR/CallSite.h"
@@ -73,13 +75,30 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cstdarg>
 using namespace llvm;
 
+#define DEBUG_TYPE "verify"
+
+STATISTIC(NumFunctionsVerified, "Number of function bodies verified");
+
 static cl::opt<bool> VerifyDebugInfo("verify-debug-info", cl::init(true));
 
+static cl::opt<bool> VerifyIncremental(
+    "verify-incremental",
+    cl::desc("Only verify the functions that changed since the verifier last "
+             "accepted them"),
+    cl::init(false));
+
+static cl::opt<unsigned> VerifierThreads(
+    "verify-threads", cl::init(1),
+    cl::desc("Number of threads verifyModule checks the functions and the "
+             "debug info of a module on (1 = check them on the calling "
+             "thread)"));
+
 namespace {
 struct VerifierSupport {
   raw_ostream &OS;
@@ -88,8 +107,13 @@ struct VerifierSupport {
   /// \brief Track the brokenness of the module while recursively visiting.
   bool Broken;
 
+  /// \brief Whether to print the values a failed check is about. Printing a
+  /// value can build state in the module, e.g. the arguments of a function,
+  /// so verifiers that run on several threads at once don't.
+  bool PrintValues;
+
   explicit VerifierSupport(raw_ostream &OS)
-      : OS(OS), M(nullptr), Broken(false) {}
+      : OS(OS), M(nullptr), Broken(false), PrintValues(true) {}
 
 private:
   template <class NodeTy> void Write(const ilist_iterator<NodeTy> &I) {
@@ -176,7 +200,8 @@ public:
   template <typename T1, typename... Ts>
   void CheckFailed(const Twine &Message, const T1 &V1, const Ts &... Vs) {
     CheckFailed(Message);
-    WriteTs(V1, Vs...);
+    if (PrintValues)
+      WriteTs(V1, Vs...);
   }
 };
 
@@ -210,6 +235,15 @@ class Verifier : public InstVisitor<Verifier>, VerifierSupport {
   /// given function and the largest index passed to llvm.localrecover.
   DenseMap<Function *, std::pair<unsigned, unsigned>> FrameEscapeInfo;
 
+  /// The functions verified since this verifier was created.
+  SmallPtrSet<const Function *, 32> VerifiedFunctions;
+
+  /// Whether to set the verified bit of the functions that pass.
+  bool MarkVerified;
+
+  /// The number of threads verifyFunctions and verify(Module) may use.
+  unsigned Threads;
+
   // Maps catchswitches and cleanuppads that unwind to siblings to the
   // terminators that indicate the unwind, used to detect cycles therein.
   MapVector<Instruction *, TerminatorInst *> SiblingFuncletInfo;
@@ -226,13 +260,14 @@ class Verifier : public InstVisitor<Verifier>, VerifierSupport {
   void checkAtomicMemAccessSize(const Module *M, Type *Ty,
                                 const Instruction *I);
 public:
-  explicit Verifier(raw_ostream &OS)
+  explicit Verifier(raw_ostream &OS, unsigned Threads = 1)
       : VerifierSupport(OS), Context(nullptr), LandingPadResultTy(nullptr),
-        SawFrameEscape(false) {}
+        SawFrameEscape(false), MarkVerified(true), Threads(Threads) {}
 
   bool verify(const Function &F) {
     M = F.getParent();
     Context = &M->getContext();
+    ++NumFunctionsVerified;
 
     // First ensure the function is well-enough formed to compute dominance
     // information.
@@ -267,9 +302,73 @@ public:
     SawFrameEscape = false;
     SiblingFuncletInfo.clear();
 
+    VerifiedFunctions.insert(&F);
+    if (!Broken && MarkVerified)
+      const_cast<Function &>(F).setIsVerified(true);
     return !Broken;
   }
 
+  /// Verify \p Functions of one module, spread over several threads if this
+  /// verifier may use several. Either way the diagnostics are printed in the
+  /// order of \p Functions.
+  bool verifyFunctions(ArrayRef<const Function *> Functions) {
+    bool Valid = true;
+    if (Threads < 2 || Functions.size() < 2) {
+      for (const Function *F : Functions)
+        Valid &= verify(*F);
+      return Valid;
+    }
+
+    M = Functions.front()->getParent();
+    Context = &M->getContext();
+    auto Failed = checkInParallel(
+        Functions, [](Verifier &V, const Function *F) { return V.verify(*F); });
+    for (const auto &Range : Failed)
+      for (const Function *F :
+           Functions.slice(Range.first, Range.second - Range.first))
+        Valid &= verify(*F);
+    return Valid;
+  }
+
+  /// Verify the functions that the llvm.localescape and llvm.localrecover
+  /// calls seen so far refer to, and that were not verified yet.  The indices
+  /// passed to llvm.localrecover can only be checked once both the parent
+  /// function and all of its children were visited, so incremental
+  /// verification must visit them too.
+  bool verifyFrameEscapeDependencies() {
+    bool Valid = true;
+    SmallPtrSet<const Function *, 8> Visited;
+    SmallVector<const Function *, 8> Worklist;
+    for (;;) {
+      for (auto &Counts : FrameEscapeInfo)
+        if (Visited.insert(Counts.first).second)
+          Worklist.push_back(Counts.first);
+      if (Worklist.empty())
+        return Valid;
+
+      while (!Worklist.empty()) {
+        const Function *Parent = Worklist.pop_back_val();
+        SmallVector<const Function *, 4> Related;
+        Related.push_back(Parent);
+        // The children name their parent in their llvm.localrecover calls,
+        // usually through a bitcast.
+        SmallVector<const User *, 8> Users(Parent->user_begin(),
+                                           Parent->user_end());
+        while (!Users.empty()) {
+          const User *U = Users.pop_back_val();
+          if (auto *I = dyn_cast<Instruction>(U))
+            Related.push_back(I->getParent()->getParent());
+          else if (isa<ConstantExpr>(U))
+            Users.append(U->user_begin(), U->user_end());
+        }
+        for (const Function *F : Related)
+          if (!F->isDeclaration() && !F->isMaterializable() &&
+              !VerifiedFunctions.count(F))
+            Valid &= verify(*F);
+      }
+    }
+  }
+
   bool verify(const Module &M) {
     this->M = &M;
     Context = &M.getContext();
@@ -292,6 +391,9 @@ public:
          I != E; ++I)
       visitGlobalVariable(*I);
 
+    if (Threads > 1)
+      verifySubprogramsInParallel();
+
     for (Module::const_alias_iterator I = M.alias_begin(), E = M.alias_end();
          I != E; ++I)
       visitGlobalAlias(*I);
@@ -314,6 +416,12 @@ public:
   }
 
 private:
+  template <typename T, typename CheckFn>
+  SmallVector<std::pair<size_t, size_t>, 4>
+  checkInParallel(ArrayRef<T> Items, CheckFn Check);
+  void merge(const Verifier &Other);
+  void verifySubprogramsInParallel();
+
   // Verification methods...
   void visitGlobalValue(const GlobalValue &GV);
   void visitGlobalVariable(const GlobalVariable &GV);
@@ -452,6 +560,8 @@ private:
   // Module-level debug info verification...
   void verifyTypeRefs();
   template <class MapTy>
+  void verifyBitPieceExpressions(const Function &F, const MapTy &TypeRefs);
+  template <class MapTy>
   void verifyBitPieceExpression(const DbgInfoIntrinsic &I,
                                 const MapTy &TypeRefs);
   void visitUnresolvedTypeRef(const MDString *S, const MDNode *N);
@@ -4208,11 +4318,22 @@ void Verifier::verifyTypeRefs() {
   // pass through the intructions, since we haven't built TypeRefs yet when
   // verifying functions, and simply queuing the DbgInfoIntrinsics to evaluate
   // later/now would queue up some that could be later deleted.
-  for (const Function &F : *M)
-    for (const BasicBlock &BB : F)
-      for (const Instruction &I : BB)
-        if (auto *DII = dyn_cast<DbgInfoIntrinsic>(&I))
-          verifyBitPieceExpression(*DII, TypeRefs);
+  if (Threads > 1 && M->size() > 1) {
+    std::vector<const Function *> Functions;
+    for (const Function &F : *M)
+      Functions.push_back(&F);
+    auto Failed = checkInParallel(
+        makeArrayRef(Functions), [&TypeRefs](Verifier &V, const Function *F) {
+          V.verifyBitPieceExpressions(*F, TypeRefs);
+          return !V.Broken;
+        });
+    for (const auto &Range : Failed)
+      for (size_t I = Range.first; I != Range.second; ++I)
+        verifyBitPieceExpressions(*Functions[I], TypeRefs);
+  } else {
+    for (const Function &F : *M)
+      verifyBitPieceExpressions(F, TypeRefs);
+  }
 
   // Return early if all typerefs were resolved.
   if (UnresolvedTypeRefs.empty())
@@ -4232,6 +4353,138 @@ void Verifier::verifyTypeRefs() {
     visitUnresolvedTypeRef(TR.first, TR.second);
 }
 
+template <class MapTy>
+void Verifier::verifyBitPieceExpressions(const Function &F,
+                                         const MapTy &TypeRefs) {
+  for (const BasicBlock &BB : F)
+    for (const Instruction &I : BB)
+      if (auto *DII = dyn_cast<DbgInfoIntrinsic>(&I))
+        verifyBitPieceExpression(*DII, TypeRefs);
+}
+
+namespace {
+/// Guards the uniquing tables of a context by their locks while it exists,
+/// unless the context already does. The verifier uniques attribute sets and
+/// types while it checks functions.
+class ConcurrentUniquingScope {
+  LLVMContext &Context;
+  bool WasConcurrent;
+
+public:
+  explicit ConcurrentUniquingScope(LLVMContext &Context)
+      : Context(Context),
+        WasConcurrent(Context.pImpl->hasConcurrentUniquing()) {
+    if (WasConcurrent)
+      return;
+    // As in a concurrent context, create the cached i1 constants up front.
+    ConstantInt::getTrue(Context);
+    ConstantInt::getFalse(Context);
+    Context.pImpl->enableConcurrentUniquing();
+  }
+  ~ConcurrentUniquingScope() {
+    if (!WasConcurrent)
+      Context.pImpl->disableConcurrentUniquing();
+  }
+};
+} // end anonymous namespace
+
+/// Run \p Check on \p Items with verifiers of their own, which print nothing,
+/// on a pool of Threads threads. The items are split in consecutive chunks, a
+/// few per thread. The chunks where every check passed are merged into this
+/// verifier; the [Begin, End) ranges of the others are returned in order, for
+/// the caller to check them again here and print deterministic diagnostics.
+template <typename T, typename CheckFn>
+SmallVector<std::pair<size_t, size_t>, 4>
+Verifier::checkInParallel(ArrayRef<T> Items, CheckFn Check) {
+  struct Chunk {
+    raw_null_ostream NullStr;
+    Verifier V;
+    size_t Begin, End;
+    bool Valid;
+
+    Chunk() : V(NullStr), Begin(0), End(0), Valid(true) {}
+  };
+
+  size_t NumChunks = std::min<size_t>(Items.size(), 4 * Threads);
+  std::vector<std::unique_ptr<Chunk>> Chunks;
+  {
+    ConcurrentUniquingScope Uniquing(*Context);
+    ThreadPool Pool(std::min<size_t>(Threads, NumChunks));
+    for (size_t I = 0; I != NumChunks; ++I) {
+      Chunks.emplace_back(new Chunk);
+      Chunk &C = *Chunks.back();
+      C.Begin = Items.size() * I / NumChunks;
+      C.End = Items.size() * (I + 1) / NumChunks;
+      C.V.M = M;
+      C.V.Context = Context;
+      C.V.PrintValues = false;
+      C.V.MarkVerified = false;
+      Pool.async([&C, Items, &Check] {
+        for (size_t J = C.Begin; J != C.End; ++J)
+          if (!Check(C.V, Items[J])) {
+            C.Valid = false;
+            return;
+          }
+      });
+    }
+    Pool.wait();
+  }
+
+  SmallVector<std::pair<size_t, size_t>, 4> Failed;
+  for (const auto &C : Chunks) {
+    if (C->Valid)
+      merge(C->V);
+    else
+      Failed.push_back(std::make_pair(C->Begin, C->End));
+  }
+  return Failed;
+}
+
+/// Take over the state that \p Other, which checked another part of the
+/// module without failures, collected for the module-level checks.
+void Verifier::merge(const Verifier &Other) {
+  MDNodes.insert(Other.MDNodes.begin(), Other.MDNodes.end());
+  UnresolvedTypeRefs.insert(Other.UnresolvedTypeRefs.begin(),
+                            Other.UnresolvedTypeRefs.end());
+  for (const auto &Counts : Other.FrameEscapeInfo) {
+    auto &Entry = FrameEscapeInfo[Counts.first];
+    Entry.first = std::max(Entry.first, Counts.second.first);
+    Entry.second = std::max(Entry.second, Counts.second.second);
+  }
+  for (const Function *F : Other.VerifiedFunctions) {
+    VerifiedFunctions.insert(F);
+    if (MarkVerified)
+      const_cast<Function *>(F)->setIsVerified(true);
+  }
+}
+
+/// Check the subprograms listed by the compile units of the module on several
+/// threads, ahead of the walk of the named metadata, which then skips them.
+/// The subprograms of failing chunks are left to that walk, which reports
+/// their errors.
+void Verifier::verifySubprogramsInParallel() {
+  auto *CUs = M->getNamedMetadata("llvm.dbg.cu");
+  if (!CUs)
+    return;
+
+  std::vector<const MDNode *> Subprograms;
+  for (const MDNode *CU : CUs->operands())
+    if (auto *N = dyn_cast_or_null<DICompileUnit>(CU))
+      if (auto *SPs = dyn_cast_or_null<MDTuple>(N->getRawSubprograms()))
+        for (const MDOperand &Op : SPs->operands())
+          if (auto *SP = dyn_cast_or_null<DISubprogram>(Op))
+            if (!MDNodes.count(SP))
+              Subprograms.push_back(SP);
+  if (Subprograms.size() < 2)
+    return;
+
+  checkInParallel(makeArrayRef(Subprograms),
+                  [](Verifier &V, const MDNode *SP) {
+                    V.visitMDNode(*SP);
+                    return !V.Broken;
+                  });
+}
+
 //===----------------------------------------------------------------------===//
 //  Implement the public interfaces to this file...
 //===----------------------------------------------------------------------===//
@@ -4248,14 +4501,18 @@ bool llvm::verifyFunction(const Function &f, raw_ostream *OS) {
   return !V.verify(F);
 }
 
-bool llvm::verifyModule(const Module &M, raw_ostream *OS) {
+bool llvm::verifyModule(const Module &M, raw_ostream *OS, bool OnlyChanged) {
   raw_null_ostream NullStr;
-  Verifier V(OS ? *OS : NullStr);
+  Verifier V(OS ? *OS : NullStr, VerifierThreads);
 
-  bool Broken = false;
+  std::vector<const Function *> Functions;
   for (Module::const_iterator I = M.begin(), E = M.end(); I != E; ++I)
-    if (!I->isDeclaration() && !I->isMaterializable())
-      Broken |= !V.verify(*I);
+    if (!I->isDeclaration() && !I->isMaterializable() &&
+        !(OnlyChanged && I->isVerified()))
+      Functions.push_back(&*I);
+  bool Broken = !V.verifyFunctions(Functions);
+  if (OnlyChanged)
+    Broken |= !V.verifyFrameEscapeDependencies();
 
   // Note that this function's return value is inverted from what you would
   // expect of a function called "verify".
@@ -4278,6 +4535,8 @@ struct VerifierLegacyPass : public FunctionPass {
   }
 
   bool runOnFunction(Function &F) override {
+    if (VerifyIncremental && F.isVerified())
+      return false;
     if (!V.verify(F) && FatalErrors)
       report_fatal_error("Broken function found, compilation aborted!");
 
@@ -4285,6 +4544,8 @@ struct VerifierLegacyPass : public FunctionPass {
   }
 
   bool doFinalization(Module &M) override {
+    if (VerifyIncremental && !V.verifyFrameEscapeDependencies() && FatalErrors)
+      report_fatal_error("Broken function found, compilation aborted!");
     if (!V.verify(M) && FatalErrors)
       report_fatal_error("Broken module found, compilation aborted!");
 
@@ -4305,13 +4566,15 @@ FunctionPass *llvm::createVerifierPass(bool FatalErrors) {
 }
 
 PreservedAnalyses VerifierPass::run(Module &M) {
-  if (verifyModule(M, &dbgs()) && FatalErrors)
+  if (verifyModule(M, &dbgs(), VerifyIncremental) && FatalErrors)
     report_fatal_error("Broken module found, compilation aborted!");
 
   return PreservedAnalyses::all();
 }
 
 PreservedAnalyses VerifierPass::run(Function &F) {
+  if (VerifyIncremental && F.isVerified())
+    return PreservedAnalyses::all();
   if (verifyFunction(F, &dbgs()) && FatalErrors)
     report_fatal_error("Broken function found, compilation aborted!");
 
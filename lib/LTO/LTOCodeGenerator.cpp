@@ -38,12 +38,17 @@
 #include "llvm/MC/MCContext.h"
 #include "llvm/MC/SubtargetFeature.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/TimeValue.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetLowering.h"
@@ -169,6 +174,11 @@ bool LTOCodeGenerator::writeMergedModules(const char *Path) {
   if (!determineTarget())
     return false;
 
+  // The merged module is expected to be optimized after optimize(), even if
+  // the object came from the cache.
+  if (CachedObject && !OptimizationDone)
+    runOptimizationPasses();
+
   // mark which symbols can not be internalized
   applyScopeRestrictions();
 
@@ -237,6 +247,11 @@ bool LTOCodeGenerator::compileOptimizedToFile(const char **Name) {
 
 std::unique_ptr<MemoryBuffer>
 LTOCodeGenerator::compileOptimized() {
+  if (CachedObject) {
+    CacheKey.clear();
+    return std::move(CachedObject);
+  }
+
   const char *name;
   if (!compileOptimizedToFile(&name))
     return nullptr;
@@ -407,9 +422,7 @@ void LTOCodeGenerator::applyScopeRestrictions() {
   if (ScopeRestrictionsDone || !ShouldInternalize)
     return;
 
-  // Start off with a verification pass.
   legacy::PassManager passes;
-  passes.add(createVerifierPass());
 
   // mark which symbols can not be internalized
   Mangler Mangler;
@@ -452,6 +465,11 @@ void LTOCodeGenerator::applyScopeRestrictions() {
     LLVMCompilerUsed->setSection("llvm.metadata");
   }
 
+  // Verify the module before internalizing.  Unlike the legacy verifier
+  // pass, verifyModule checks the functions on -verify-threads threads.
+  if (verifyModule(*MergedModule, &errs()))
+    report_fatal_error("Broken module found, compilation aborted!");
+
   passes.add(createInternalizePass(MustPreserveList));
 
   // apply scope restrictions
@@ -496,6 +514,28 @@ bool LTOCodeGenerator::optimize(bool DisableVerify, bool DisableInline,
   if (!this->determineTarget())
     return false;
 
+  this->DisableVerify = DisableVerify;
+  this->DisableInline = DisableInline;
+  this->DisableGVNLoadPRE = DisableGVNLoadPRE;
+  this->DisableVectorization = DisableVectorization;
+
+  // Optimization is only needed if the object isn't in the cache. It is run
+  // later if the merged module turns out to be needed anyway.
+  if (!CacheDir.empty()) {
+    lookupCachedObject();
+    if (CachedObject) {
+      OptimizationDone = false;
+      return true;
+    }
+  }
+
+  runOptimizationPasses();
+  return true;
+}
+
+void LTOCodeGenerator::runOptimizationPasses() {
+  OptimizationDone = true;
+
   // Mark which symbols can not be internalized
   this->applyScopeRestrictions();
 
@@ -524,14 +564,225 @@ bool LTOCodeGenerator::optimize(bool DisableVerify, bool DisableInline,
 
   // Run our queue of passes all at once now, efficiently.
   passes.run(*MergedModule);
+}
 
-  return true;
+/// Compute the key of the object generated for the merged module in the
+/// object cache, from everything the object depends on.
+std::string LTOCodeGenerator::computeCacheKey() {
+  MD5 Hasher;
+  auto AddString = [&](StringRef Str) {
+    Hasher.update(Str);
+    const uint8_t Terminator = 0;
+    Hasher.update(Terminator);
+  };
+  auto AddInt = [&](uint64_t Value) {
+    uint8_t Bytes[8];
+    for (unsigned I = 0; I != 8; ++I)
+      Bytes[I] = Value >> (8 * I);
+    Hasher.update(Bytes);
+  };
+  auto AddSortedKeys = [&](const StringSet &Set) {
+    std::vector<StringRef> Keys;
+    for (auto &Entry : Set)
+      Keys.push_back(Entry.first());
+    std::sort(Keys.begin(), Keys.end());
+    AddInt(Keys.size());
+    for (StringRef Key : Keys)
+      AddString(Key);
+  };
+
+  AddString(getVersionString());
+
+  // The merged module, which only depends on the inputs and their link order.
+  // It is hashed here rather than when the inputs are read, so that links
+  // without a cache don't pay for it.
+  SmallVector<char, 0> Bitcode;
+  raw_svector_ostream BitcodeOS(Bitcode);
+  WriteBitcodeToFile(MergedModule.get(), BitcodeOS);
+  AddInt(Bitcode.size());
+  Hasher.update(ArrayRef<uint8_t>((const uint8_t *)Bitcode.data(),
+                                  Bitcode.size()));
+  AddSortedKeys(MustPreserveSymbols);
+  AddSortedKeys(AsmUndefinedRefs);
+
+  // The target.
+  AddString(TargetMach->getTargetTriple().str());
+  AddString(MCpu);
+  AddString(FeatureStr);
+  AddInt(RelocModel);
+  AddInt(FileType);
+
+  // The target options. TargetOptions::Reciprocals can't be enumerated, it is
+  // left out.
+  AddInt(Options.UnsafeFPMath);
+  AddInt(Options.NoInfsFPMath);
+  AddInt(Options.NoNaNsFPMath);
+  AddInt(Options.HonorSignDependentRoundingFPMathOption);
+  AddInt(Options.NoZerosInBSS);
+  AddInt(Options.GuaranteedTailCallOpt);
+  AddInt(Options.StackAlignmentOverride);
+  AddInt(Options.EnableFastISel);
+  AddInt(Options.PositionIndependentExecutable);
+  AddInt(Options.UseInitArray);
+  AddInt(Options.DisableIntegratedAS);
+  AddInt(Options.CompressDebugSections);
+  AddInt(Options.FunctionSections);
+  AddInt(Options.DataSections);
+  AddInt(Options.UniqueSectionNames);
+  AddInt(Options.TrapUnreachable);
+  AddInt(Options.EmulatedTLS);
+  AddInt(Options.FloatABIType);
+  AddInt(Options.AllowFPOpFusion);
+  AddInt(Options.JTType);
+  AddInt(Options.ThreadModel);
+  AddInt(static_cast<uint64_t>(Options.EABIVersion));
+  AddInt(static_cast<uint64_t>(Options.DebuggerTuning));
+  const MCTargetOptions &MCOptions = Options.MCOptions;
+  AddInt(MCOptions.SanitizeAddress);
+  AddInt(MCOptions.MCRelaxAll);
+  AddInt(MCOptions.MCNoExecStack);
+  AddInt(MCOptions.MCFatalWarnings);
+  AddInt(MCOptions.MCNoWarn);
+  AddInt(MCOptions.MCSaveTempLabels);
+  AddInt(MCOptions.MCUseDwarfDirectory);
+  AddInt(MCOptions.MCIncrementalLinkerCompatible);
+  AddInt(MCOptions.ShowMCEncoding);
+  AddInt(MCOptions.ShowMCInst);
+  AddInt(MCOptions.AsmVerbose);
+  AddInt(MCOptions.DwarfVersion);
+  AddString(MCOptions.ABIName);
+
+  // The optimization options.
+  AddInt(OptLevel);
+  AddInt(CGOptLevel);
+  AddInt(ShouldInternalize);
+  AddInt(ShouldRestoreGlobalsLinkage);
+  AddInt(DisableVerify);
+  AddInt(DisableInline);
+  AddInt(DisableGVNLoadPRE);
+  AddInt(DisableVectorization);
+  AddInt(CodegenOptions.size());
+  for (const std::string &Option : CodegenOptions)
+    AddString(Option);
+
+  MD5::MD5Result Result;
+  Hasher.final(Result);
+  SmallString<32> Key;
+  MD5::stringifyResult(Result, Key);
+  return Key.str();
+}
+
+static std::string getCacheEntryPath(StringRef CacheDir, StringRef Key) {
+  SmallString<128> Path(CacheDir);
+  sys::path::append(Path, "llvmcache-" + Key);
+  return Path.str();
+}
+
+void LTOCodeGenerator::lookupCachedObject() {
+  CacheKey = computeCacheKey();
+  std::string EntryPath = getCacheEntryPath(CacheDir, CacheKey);
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr =
+      MemoryBuffer::getFile(EntryPath, -1, false);
+  if (!BufferOrErr)
+    return;
+  CachedObject = std::move(*BufferOrErr);
+
+  // The modification time of the entries tracks their last use, for pruning.
+  int FD;
+  if (!sys::fs::openFileForWrite(EntryPath, FD, sys::fs::F_Append)) {
+    sys::fs::setLastModificationAndAccessTime(FD, sys::TimeValue::now());
+    sys::Process::SafelyCloseFileDescriptor(FD);
+  }
+}
+
+/// Remove the least recently used entries of the object cache in \p CacheDir
+/// until it is no larger than \p MaxSize bytes. The entry at \p KeepPath, which
+/// was just added, is never removed.
+static void pruneCache(StringRef CacheDir, uint64_t MaxSize,
+                       StringRef KeepPath) {
+  struct Entry {
+    std::string Path;
+    sys::TimeValue LastUse;
+    uint64_t Size;
+  };
+  std::vector<Entry> Entries;
+  uint64_t TotalSize = 0;
+  std::error_code EC;
+  for (sys::fs::directory_iterator I(CacheDir, EC), E; I != E && !EC;
+       I.increment(EC)) {
+    StringRef Name = sys::path::filename(I->path());
+    if (!Name.startswith("llvmcache-") || Name.endswith(".tmp"))
+      continue;
+    sys::fs::file_status Status;
+    if (I->status(Status))
+      continue;
+    TotalSize += Status.getSize();
+    if (I->path() != KeepPath)
+      Entries.push_back(
+          {I->path(), Status.getLastModificationTime(), Status.getSize()});
+  }
+
+  std::sort(Entries.begin(), Entries.end(),
+            [](const Entry &LHS, const Entry &RHS) {
+              return LHS.LastUse < RHS.LastUse;
+            });
+  for (const Entry &E : Entries) {
+    if (TotalSize <= MaxSize)
+      break;
+    if (!sys::fs::remove(E.Path))
+      TotalSize -= E.Size;
+  }
+}
+
+void LTOCodeGenerator::storeCachedObject(StringRef Object) {
+  // The cache is only an optimization, failing to update it isn't an error.
+  if (sys::fs::create_directories(CacheDir))
+    return;
+
+  // Write to a temporary file renamed into place, so that concurrent links
+  // never see a partial entry.
+  std::string EntryPath = getCacheEntryPath(CacheDir, CacheKey);
+  SmallString<128> TempPath;
+  int FD;
+  if (sys::fs::createUniqueFile(EntryPath + "-%%%%%%.tmp", FD, TempPath))
+    return;
+  {
+    raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << Object;
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      sys::fs::remove(TempPath);
+      return;
+    }
+  }
+  if (sys::fs::rename(TempPath, EntryPath)) {
+    sys::fs::remove(TempPath);
+    return;
+  }
+
+  if (CacheMaxSize)
+    pruneCache(CacheDir, CacheMaxSize, EntryPath);
 }
 
 bool LTOCodeGenerator::compileOptimized(ArrayRef<raw_pwrite_stream *> Out) {
   if (!this->determineTarget())
     return false;
 
+  if (CachedObject) {
+    if (Out.size() == 1) {
+      *Out[0] << CachedObject->getBuffer();
+      CachedObject.reset();
+      CacheKey.clear();
+      return true;
+    }
+
+    // The cached object can't be split into partitions, generate them.
+    CachedObject.reset();
+    if (!OptimizationDone)
+      runOptimizationPasses();
+  }
+
   legacy::PassManager preCodeGenPasses;
 
   // If the bitcode files contain ARC code and were compiled with optimization,
@@ -548,10 +799,25 @@ bool LTOCodeGenerator::compileOptimized(ArrayRef<raw_pwrite_stream *> Out) {
   // parallelism level 1. This is achieved by having splitCodeGen return the
   // original module at parallelism level 1 which we then assign back to
   // MergedModule.
-  MergedModule =
-      splitCodeGen(std::move(MergedModule), Out, MCpu, FeatureStr, Options,
-                   RelocModel, CodeModel::Default, CGOptLevel, FileType,
-                   ShouldRestoreGlobalsLinkage);
+  //
+  // The object is generated in memory when it's going to be stored in the
+  // cache.
+  bool StoreInCache = !CacheKey.empty() && Out.size() == 1;
+  SmallVector<char, 0> Object;
+  raw_svector_ostream ObjectOS(Object);
+  raw_pwrite_stream *ObjectOut[] = {&ObjectOS};
+  MergedModule = splitCodeGen(std::move(MergedModule),
+                              StoreInCache ? makeArrayRef(ObjectOut) : Out,
+                              MCpu, FeatureStr, Options, RelocModel,
+                              CodeModel::Default, CGOptLevel, FileType,
+                              ShouldRestoreGlobalsLinkage);
+
+  if (StoreInCache) {
+    StringRef ObjectRef(Object.data(), Object.size());
+    *Out[0] << ObjectRef;
+    storeCachedObject(ObjectRef);
+  }
+  CacheKey.clear();
 
   return true;
 }
@@ -0,0 +1,379 @@
+//===-ThinLTOCodeGenerator.cpp - LLVM ThinLTO backend driver --------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the ThinLTOCodeGenerator class, which runs the ThinLTO
+// backends of a link in parallel.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/LTO/ThinLTOCodeGenerator.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/DiagnosticPrinter.h"
+#include "llvm/IR/FunctionInfo.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Mangler.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Linker/Linker.h"
+#include "llvm/MC/SubtargetFeature.h"
+#include "llvm/Object/FunctionIndexObjectFile.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/IPO.h"
+#include "llvm/Transforms/IPO/FunctionImport.h"
+#include "llvm/Transforms/IPO/PassManagerBuilder.h"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+
+using namespace llvm;
+
+#define DEBUG_TYPE "thinlto"
+
+void ThinLTOCodeGenerator::addModule(StringRef Identifier, StringRef Data) {
+  ModuleMap[Identifier] = Modules.size();
+  Modules.push_back({Identifier, Data});
+}
+
+void ThinLTOCodeGenerator::setSymbolResolution(unsigned ModuleIndex,
+                                               StringRef Name,
+                                               SymbolResolution Resolution) {
+  Modules[ModuleIndex].Resolutions[Name] = Resolution;
+}
+
+void ThinLTOCodeGenerator::setOptLevel(unsigned Level) {
+  OptLevel = Level;
+  switch (OptLevel) {
+  case 0:
+    CGOptLevel = CodeGenOpt::None;
+    break;
+  case 1:
+    CGOptLevel = CodeGenOpt::Less;
+    break;
+  case 2:
+    CGOptLevel = CodeGenOpt::Default;
+    break;
+  case 3:
+    CGOptLevel = CodeGenOpt::Aggressive;
+    break;
+  }
+}
+
+std::unique_ptr<Module>
+ThinLTOCodeGenerator::loadModule(const ModuleBuffer &Buffer,
+                                 LLVMContext &Context, bool Lazy,
+                                 std::string &ErrMsg) {
+  MemoryBufferRef Ref(Buffer.Data, Buffer.Identifier);
+  ErrorOr<std::unique_ptr<Module>> MOrErr =
+      Lazy ? getLazyBitcodeModule(MemoryBuffer::getMemBuffer(Ref, false),
+                                  Context,
+                                  /* ShouldLazyLoadMetadata */ true)
+           : parseBitcodeFile(Ref, Context);
+  if (std::error_code EC = MOrErr.getError()) {
+    ErrMsg = "could not read '" + Buffer.Identifier.str() +
+             "': " + EC.message();
+    return nullptr;
+  }
+  return std::move(*MOrErr);
+}
+
+std::unique_ptr<TargetMachine>
+ThinLTOCodeGenerator::createTargetMachine(Module &M, std::string &ErrMsg) {
+  std::string TripleStr = M.getTargetTriple();
+  if (TripleStr.empty()) {
+    TripleStr = sys::getDefaultTargetTriple();
+    M.setTargetTriple(TripleStr);
+  }
+  Triple TheTriple(TripleStr);
+
+  const Target *TheTarget = TargetRegistry::lookupTarget(TripleStr, ErrMsg);
+  if (!TheTarget)
+    return nullptr;
+
+  SubtargetFeatures Features(MAttr);
+  Features.getDefaultSubtargetFeatures(TheTriple);
+  return std::unique_ptr<TargetMachine>(TheTarget->createTargetMachine(
+      TripleStr, MCpu, Features.getString(), Options, RelocModel,
+      CodeModel::Default, CGOptLevel));
+}
+
+/// Turn the definition of \p GV into a declaration, so that its module refers
+/// to the prevailing definition of another module.
+static void dropDefinition(GlobalValue &GV) {
+  if (auto *F = dyn_cast<Function>(&GV)) {
+    F->deleteBody();
+    F->setComdat(nullptr);
+  } else if (auto *Var = dyn_cast<GlobalVariable>(&GV)) {
+    Var->setInitializer(nullptr);
+    Var->setLinkage(GlobalValue::ExternalLinkage);
+    Var->setComdat(nullptr);
+  } else {
+    // An alias can't be a declaration, replace it with a declaration of its
+    // value type.
+    auto &GA = cast<GlobalAlias>(GV);
+    Module &M = *GA.getParent();
+    GlobalValue *Decl;
+    if (auto *FTy = dyn_cast<FunctionType>(GA.getValueType()))
+      Decl = Function::Create(FTy, GlobalValue::ExternalLinkage, "", &M);
+    else
+      Decl = new GlobalVariable(M, GA.getValueType(), /* isConstant */ false,
+                                GlobalValue::ExternalLinkage, nullptr, "",
+                                nullptr, GA.getThreadLocalMode(),
+                                GA.getType()->getAddressSpace());
+    Decl->takeName(&GA);
+    Decl->setVisibility(GA.getVisibility());
+    GA.replaceAllUsesWith(ConstantExpr::getBitCast(Decl, GA.getType()));
+    GA.eraseFromParent();
+  }
+}
+
+/// Returns the linker's resolution of \p GV, or null if it has none.
+static const ThinLTOCodeGenerator::SymbolResolution *
+findResolution(Mangler &Mang, const GlobalValue &GV,
+               const StringMap<ThinLTOCodeGenerator::SymbolResolution> &Res) {
+  if (GV.hasLocalLinkage() || GV.isDeclarationForLinker())
+    return nullptr;
+  SmallString<64> Name;
+  Mang.getNameWithPrefix(Name, &GV, /* CannotUsePrivateLabel */ false);
+  auto I = Res.find(Name);
+  return I == Res.end() ? nullptr : &I->second;
+}
+
+/// Apply the linker's resolution of the symbols defined by \p M.
+static void
+applyResolutions(Module &M,
+                 const StringMap<ThinLTOCodeGenerator::SymbolResolution> &Res) {
+  if (Res.empty())
+    return;
+
+  Mangler Mang;
+  std::vector<GlobalValue *> Preempted;
+  auto Apply = [&](GlobalValue &GV) {
+    const ThinLTOCodeGenerator::SymbolResolution *R =
+        findResolution(Mang, GV, Res);
+    if (!R)
+      return;
+
+    if (*R == ThinLTOCodeGenerator::PreemptedDef) {
+      Preempted.push_back(&GV);
+      return;
+    }
+    // The linker won't see the definitions of the other modules, so this one
+    // has to be emitted even if nothing in the module uses it.
+    if (GV.hasLinkOnceODRLinkage())
+      GV.setLinkage(GlobalValue::WeakODRLinkage);
+    else if (GV.hasLinkOnceLinkage())
+      GV.setLinkage(GlobalValue::WeakAnyLinkage);
+  };
+  for (Function &F : M)
+    Apply(F);
+  for (GlobalVariable &Var : M.globals())
+    Apply(Var);
+  for (GlobalAlias &GA : M.aliases())
+    Apply(GA);
+
+  for (GlobalValue *GV : Preempted)
+    dropDefinition(*GV);
+}
+
+/// The importer may bring back the prevailing definition of a function whose
+/// own definition was dropped by applyResolutions. Keep it for inlining, but
+/// don't emit it again.
+static void hidePreemptedImports(
+    Module &M, const StringMap<ThinLTOCodeGenerator::SymbolResolution> &Res) {
+  if (Res.empty())
+    return;
+
+  Mangler Mang;
+  for (Function &F : M) {
+    const ThinLTOCodeGenerator::SymbolResolution *R =
+        findResolution(Mang, F, Res);
+    if (R && *R == ThinLTOCodeGenerator::PreemptedDef) {
+      F.setLinkage(GlobalValue::AvailableExternallyLinkage);
+      F.setComdat(nullptr);
+    }
+  }
+}
+
+/// Run the per-module optimization pipeline, which in ThinLTO comes after
+/// importing.
+void ThinLTOCodeGenerator::optimize(Module &M, TargetMachine &TM) {
+  M.setDataLayout(TM.createDataLayout());
+
+  legacy::PassManager PM;
+  PM.add(createTargetTransformInfoWrapperPass(TM.getTargetIRAnalysis()));
+
+  PassManagerBuilder PMB;
+  PMB.LibraryInfo = new TargetLibraryInfoImpl(TM.getTargetTriple());
+  PMB.Inliner = createFunctionInliningPass();
+  PMB.OptLevel = OptLevel;
+  PMB.LoopVectorize = true;
+  PMB.SLPVectorize = true;
+  PMB.VerifyInput = true;
+  PMB.VerifyOutput = true;
+  PMB.populateModulePassManager(PM);
+  PM.run(M);
+}
+
+bool ThinLTOCodeGenerator::runBackend(unsigned ModuleIndex,
+                                      const FunctionInfoIndex &Index,
+                                      SmallVectorImpl<char> &Object,
+                                      std::string &ErrMsg) {
+  LLVMContext Context;
+  std::unique_ptr<Module> M =
+      loadModule(Modules[ModuleIndex], Context, /* Lazy */ false, ErrMsg);
+  if (!M)
+    return false;
+  applyResolutions(*M, Modules[ModuleIndex].Resolutions);
+
+  // Locals that may be referenced by the functions imported by other modules
+  // are promoted the same way by every backend.
+  if (renameModuleForThinLTO(*M, &Index)) {
+    ErrMsg = "could not promote the locals of '" +
+             Modules[ModuleIndex].Identifier.str() + "'";
+    return false;
+  }
+
+  // The modules to import from are read lazily in the backend's context. The
+  // importer skips a module that fails to load, and the first such error
+  // fails the backend once importing is done.
+  std::string LoadErrMsg;
+  auto ModuleLoader = [&](StringRef Identifier) -> std::unique_ptr<Module> {
+    auto I = ModuleMap.find(Identifier);
+    if (I == ModuleMap.end()) {
+      if (LoadErrMsg.empty())
+        LoadErrMsg = "unknown module '" + Identifier.str() + "' in the index";
+      return nullptr;
+    }
+    std::string SrcErrMsg;
+    std::unique_ptr<Module> Src =
+        loadModule(Modules[I->second], Context, /* Lazy */ true, SrcErrMsg);
+    if (!Src && LoadErrMsg.empty())
+      LoadErrMsg = std::move(SrcErrMsg);
+    return Src;
+  };
+  FunctionImporter Importer(Index, ModuleLoader);
+  Importer.importFunctions(*M);
+  if (!LoadErrMsg.empty()) {
+    ErrMsg = std::move(LoadErrMsg);
+    return false;
+  }
+  hidePreemptedImports(*M, Modules[ModuleIndex].Resolutions);
+
+  std::unique_ptr<TargetMachine> TM = createTargetMachine(*M, ErrMsg);
+  if (!TM)
+    return false;
+  optimize(*M, *TM);
+
+  raw_svector_ostream OS(Object);
+  legacy::PassManager CodeGenPasses;
+  if (TM->addPassesToEmitFile(CodeGenPasses, OS, FileType)) {
+    ErrMsg = "target does not support generation of this file type";
+    return false;
+  }
+  CodeGenPasses.run(*M);
+  return true;
+}
+
+static void diagnosticHandler(const DiagnosticInfo &DI) {
+  raw_ostream &OS = errs();
+  DiagnosticPrinterRawOStream DP(OS);
+  DI.print(DP);
+  OS << '\n';
+}
+
+bool ThinLTOCodeGenerator::run(const ObjectHandlerTy &HandleObject,
+                               std::string &ErrMsg) {
+  // Build the combined index from the summaries of the modules.
+  FunctionInfoIndex CombinedIndex;
+  uint64_t NextModuleId = 0;
+  for (const ModuleBuffer &Buffer : Modules) {
+    MemoryBufferRef Ref(Buffer.Data, Buffer.Identifier);
+    if (!object::FunctionIndexObjectFile::hasFunctionSummaryInMemBuffer(
+            Ref, diagnosticHandler))
+      continue;
+    ErrorOr<std::unique_ptr<object::FunctionIndexObjectFile>> ObjOrErr =
+        object::FunctionIndexObjectFile::create(Ref, diagnosticHandler);
+    if (std::error_code EC = ObjOrErr.getError()) {
+      ErrMsg = "could not read the function summary of '" +
+               Buffer.Identifier.str() + "': " + EC.message();
+      return false;
+    }
+    CombinedIndex.mergeFrom((*ObjOrErr)->takeIndex(), ++NextModuleId);
+  }
+
+  std::mutex Mutex;
+  std::condition_variable InFlightReleased;
+  uint64_t InFlightSize = 0;
+  unsigned NumInFlight = 0;
+
+  auto RunBackend = [&](unsigned I) {
+    DEBUG(dbgs() << "Running ThinLTO backend for '" << Modules[I].Identifier
+                 << "'\n");
+    SmallVector<char, 0> Object;
+    std::string BackendErrMsg;
+    bool Success = runBackend(I, CombinedIndex, Object, BackendErrMsg);
+
+    std::lock_guard<std::mutex> Lock(Mutex);
+    if (Success)
+      HandleObject(I, StringRef(Object.data(), Object.size()));
+    else if (ErrMsg.empty())
+      ErrMsg = BackendErrMsg;
+    InFlightSize -= Modules[I].Data.size();
+    --NumInFlight;
+    InFlightReleased.notify_all();
+  };
+
+  {
+    std::unique_ptr<ThreadPool> Pool(ThreadCount ? new ThreadPool(ThreadCount)
+                                                 : new ThreadPool());
+    // Backends are submitted in module order, and no more are in flight than
+    // the pool has threads. A backend waits in the pool's queue at most until
+    // the thread of one that finished returns to the pool, so they start in
+    // module order or close to it. A backend is held back until the bitcode
+    // sizes of the running backends and its own fit in the bound, unless
+    // nothing else is running. The first error stops the backends that
+    // haven't been submitted yet.
+    unsigned MaxInFlight = std::max(1u, Pool->getThreadCount());
+    for (unsigned I = 0, E = Modules.size(); I != E; ++I) {
+      uint64_t Size = Modules[I].Data.size();
+      auto CanSubmit = [&] {
+        return NumInFlight == 0 ||
+               (NumInFlight < MaxInFlight &&
+                (!MaxInFlightSize || InFlightSize + Size <= MaxInFlightSize));
+      };
+      std::unique_lock<std::mutex> Lock(Mutex);
+      // Without threads, the backends only run when the pool is waited on.
+      if (!Pool->getThreadCount() && !CanSubmit()) {
+        Lock.unlock();
+        Pool->wait();
+        Lock.lock();
+      }
+      InFlightReleased.wait(Lock,
+                            [&] { return !ErrMsg.empty() || CanSubmit(); });
+      if (!ErrMsg.empty())
+        break;
+      InFlightSize += Size;
+      ++NumInFlight;
+      Lock.unlock();
+      Pool->async(RunBackend, I);
+    }
+    Pool->wait();
+  }
+  return ErrMsg.empty();
+}
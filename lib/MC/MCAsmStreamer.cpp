@@ -1130,8 +1130,8 @@ static void PrintCFIEscape(llvm::formatted_raw_ostream &OS, StringRef Values) {
   if (!Values.empty()) {
     size_t e = Values.size() - 1;
     for (size_t i = 0; i < e; ++i)
-      OS << format("0x%02x", uint8_t(Values[i])) << ", ";
-    OS << format("0x%02x", uint8_t(Values[e]));
+      OS << format_hex(uint8_t(Values[i]), 4) << ", ";
+    OS << format_hex(uint8_t(Values[e]), 4);
   }
 }
 
@@ -1392,11 +1392,11 @@ void MCAsmStreamer::AddEncodingComment(const MCInst &Inst,
 
     if (MapEntry != uint8_t(~0U)) {
       if (MapEntry == 0) {
-        OS << format("0x%02x", uint8_t(Code[i]));
+        OS << format_hex(uint8_t(Code[i]), 4);
       } else {
         if (Code[i]) {
           // FIXME: Some of the 8 bits require fix up.
-          OS << format("0x%02x", uint8_t(Code[i])) << '\''
+          OS << format_hex(uint8_t(Code[i]), 4) << '\''
              << char('A' + MapEntry - 1) << '\'';
         } else
           OS << char('A' + MapEntry - 1);
@@ -249,6 +249,10 @@ ErrorOr<std::unique_ptr<Archive>> Archive::create(MemoryBufferRef Source) {
   std::unique_ptr<Archive> Ret(new Archive(Source, EC));
   if (EC)
     return EC;
+  // Symbol lookups and member names read these tables before any member, so
+  // page them in while the client walks the member headers.
+  MemoryBuffer::prefetch(Ret->SymbolTable);
+  MemoryBuffer::prefetch(Ret->StringTable);
   return std::move(Ret);
 }
 
@@ -16,6 +16,7 @@
 #include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/IR/FunctionInfo.h"
 #include "llvm/MC/MCStreamer.h"
+#include "llvm/Object/FunctionIndexTable.h"
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
@@ -121,8 +122,8 @@ std::error_code FunctionIndexObjectFile::findFunctionSummaryInMemBuffer(
   }
 }
 
-// Parse the function index out of an IR file and return the function
-// index object if found, or nullptr if not.
+// Parse the function index out of an IR file or a function index table and
+// return the function index object if found, or nullptr if not.
 ErrorOr<std::unique_ptr<FunctionInfoIndex>>
 llvm::getFunctionIndexForFile(StringRef Path,
                               DiagnosticHandlerFunction DiagnosticHandler) {
@@ -131,6 +132,9 @@ llvm::getFunctionIndexForFile(StringRef Path,
   std::error_code EC = FileOrErr.getError();
   if (EC)
     return EC;
+  // Function index tables are read lazily, from the buffer itself.
+  if (object::isFunctionIndexTable((*FileOrErr)->getMemBufferRef()))
+    return object::createFunctionIndexFromTable(std::move(*FileOrErr));
   MemoryBufferRef BufferRef = (FileOrErr.get())->getMemBufferRef();
   ErrorOr<std::unique_ptr<object::FunctionIndexObjectFile>> ObjOrErr =
       object::FunctionIndexObjectFile::create(BufferRef, DiagnosticHandler);
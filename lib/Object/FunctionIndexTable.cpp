@@ -0,0 +1,301 @@
+//===- FunctionIndexTable.cpp - Memory-mappable function index ------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the reader and writer of function index tables.
+//
+// A table is laid out as follows, all integers being little endian:
+//
+//   Header:        char Magic[8], uint32 Version, uint32 NumModules,
+//                  uint64 PayloadOffset, uint64 BucketOffset
+//   Module table:  NumModules times { uint64 ModuleId, uint32 PathLength,
+//                  char Path[PathLength] }
+//   Payload:       the items of an OnDiskChainedHashTable keyed by function
+//                  name and hashed with the low 64 bits of its MD5. The data
+//                  of an item is a list of { uint32 ModuleIndex, uint8 Linkage,
+//                  uint32 InstCount } entries, ModuleIndex being the position
+//                  of the module in the module table. No bitcode offset is
+//                  stored, as the entries are the whole summaries.
+//   Buckets:       the buckets of the hash table, at BucketOffset.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Object/FunctionIndexTable.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/IR/FunctionInfo.h"
+#include "llvm/Object/Error.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/OnDiskHashTable.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+using namespace llvm::object;
+using namespace llvm::support;
+
+namespace {
+
+const char Magic[8] = {'\xff', 'L', 'L', 'V', 'M', 'F', 'I', 'T'};
+const uint32_t Version = 1;
+const size_t HeaderSize = 32;
+const size_t EntrySize = 9;
+
+uint64_t hashFunctionName(StringRef Name) {
+  MD5 Hash;
+  Hash.update(Name);
+  MD5::MD5Result Result;
+  Hash.final(Result);
+  return endian::read64le(Result);
+}
+
+class FunctionIndexTableWriterTrait {
+public:
+  typedef StringRef key_type;
+  typedef StringRef key_type_ref;
+
+  typedef const FunctionInfoList *data_type;
+  typedef const FunctionInfoList *data_type_ref;
+
+  typedef uint64_t hash_value_type;
+  typedef uint64_t offset_type;
+
+  /// Position of each module path in the module table.
+  StringMap<uint32_t> ModuleIndices;
+
+  static hash_value_type ComputeHash(key_type_ref Key) {
+    return hashFunctionName(Key);
+  }
+
+  static std::pair<offset_type, offset_type>
+  EmitKeyDataLength(raw_ostream &Out, key_type_ref Key, data_type_ref Data) {
+    endian::Writer<little> LE(Out);
+    offset_type KeyLen = Key.size();
+    offset_type DataLen = Data->size() * EntrySize;
+    LE.write<uint32_t>(KeyLen);
+    LE.write<uint32_t>(DataLen);
+    return std::make_pair(KeyLen, DataLen);
+  }
+
+  static void EmitKey(raw_ostream &Out, key_type_ref Key, offset_type) {
+    Out << Key;
+  }
+
+  void EmitData(raw_ostream &Out, key_type_ref, data_type_ref Data,
+                offset_type) {
+    endian::Writer<little> LE(Out);
+    for (const auto &Info : *Data) {
+      const FunctionSummary *Summary = Info->functionSummary();
+      assert(Summary && "Writing a function without summary");
+      LE.write<uint32_t>(ModuleIndices.lookup(Summary->modulePath()));
+      LE.write<uint8_t>(Summary->getFunctionLinkage());
+      LE.write<uint32_t>(Summary->instCount());
+    }
+  }
+};
+
+class FunctionIndexTableLookupTrait {
+public:
+  typedef StringRef internal_key_type;
+  typedef StringRef external_key_type;
+  /// The raw entries of the function.
+  typedef StringRef data_type;
+
+  typedef uint64_t hash_value_type;
+  typedef uint64_t offset_type;
+
+  static bool EqualKey(StringRef A, StringRef B) { return A == B; }
+  static StringRef GetInternalKey(StringRef Key) { return Key; }
+  static StringRef GetExternalKey(StringRef Key) { return Key; }
+  static hash_value_type ComputeHash(StringRef Key) {
+    return hashFunctionName(Key);
+  }
+
+  static std::pair<offset_type, offset_type>
+  ReadKeyDataLength(const unsigned char *&D) {
+    offset_type KeyLen = endian::readNext<uint32_t, little, unaligned>(D);
+    offset_type DataLen = endian::readNext<uint32_t, little, unaligned>(D);
+    return std::make_pair(KeyLen, DataLen);
+  }
+
+  static StringRef ReadKey(const unsigned char *D, offset_type KeyLen) {
+    return StringRef(reinterpret_cast<const char *>(D), KeyLen);
+  }
+
+  static StringRef ReadData(StringRef, const unsigned char *D,
+                            offset_type DataLen) {
+    return StringRef(reinterpret_cast<const char *>(D), DataLen);
+  }
+};
+
+typedef OnDiskIterableChainedHashTable<FunctionIndexTableLookupTrait>
+    FunctionIndexHashTable;
+
+/// Reads the function infos of a lazily loaded index from its table.
+class FunctionIndexTableSource : public FunctionInfoSource {
+  std::unique_ptr<MemoryBuffer> Buffer;
+  std::unique_ptr<FunctionIndexHashTable> Table;
+  /// The module paths owned by the index, by position in the module table.
+  std::vector<StringRef> ModulePaths;
+
+public:
+  FunctionIndexTableSource(std::unique_ptr<MemoryBuffer> Buffer,
+                           std::unique_ptr<FunctionIndexHashTable> Table,
+                           std::vector<StringRef> ModulePaths)
+      : Buffer(std::move(Buffer)), Table(std::move(Table)),
+        ModulePaths(std::move(ModulePaths)) {}
+
+  unsigned getNumFunctions() const override { return Table->getNumEntries(); }
+  bool readFunctionInfoList(StringRef FuncName,
+                            FunctionInfoList &List) override;
+  void readAllFunctionInfoLists(FunctionInfoMapTy &Map) override;
+};
+
+} // end anonymous namespace
+
+bool FunctionIndexTableSource::readFunctionInfoList(StringRef FuncName,
+                                                    FunctionInfoList &List) {
+  auto I = Table->find(FuncName);
+  if (I == Table->end())
+    return false;
+
+  StringRef Entries = *I;
+  if (Entries.empty() || Entries.size() % EntrySize)
+    report_fatal_error("Malformed function index table entry for '" +
+                       FuncName + "'");
+  const unsigned char *D = Entries.bytes_begin();
+  while (D != Entries.bytes_end()) {
+    uint32_t ModuleIndex = endian::readNext<uint32_t, little, unaligned>(D);
+    uint8_t Linkage = endian::readNext<uint8_t, little, unaligned>(D);
+    uint32_t InstCount = endian::readNext<uint32_t, little, unaligned>(D);
+    if (ModuleIndex >= ModulePaths.size() ||
+        Linkage > GlobalValue::CommonLinkage)
+      report_fatal_error("Malformed function index table entry for '" +
+                         FuncName + "'");
+
+    auto Summary = llvm::make_unique<FunctionSummary>(InstCount);
+    Summary->setModulePath(ModulePaths[ModuleIndex]);
+    Summary->setFunctionLinkage(
+        static_cast<GlobalValue::LinkageTypes>(Linkage));
+    // The table holds the whole summary, so unlike a combined index read from
+    // bitcode, there is no summary record left to parse later, and the bitcode
+    // offset is left to 0.
+    List.push_back(llvm::make_unique<FunctionInfo>(0, std::move(Summary)));
+  }
+  return true;
+}
+
+void FunctionIndexTableSource::readAllFunctionInfoLists(
+    FunctionInfoMapTy &Map) {
+  for (StringRef FuncName : Table->keys()) {
+    if (Map.count(FuncName))
+      continue;
+    FunctionInfoList List;
+    readFunctionInfoList(FuncName, List);
+    Map[FuncName] = std::move(List);
+  }
+}
+
+void object::writeFunctionIndexTable(const FunctionInfoIndex &Index,
+                                     raw_ostream &OS) {
+  // The hash table needs to know where it is written, so the table is built
+  // in memory and the header patched afterwards.
+  SmallString<0> Data;
+  raw_svector_ostream Out(Data);
+  endian::Writer<little> LE(Out);
+  Out.write(Magic, sizeof(Magic));
+  LE.write<uint32_t>(Version);
+  LE.write<uint32_t>(0); // NumModules
+  LE.write<uint64_t>(0); // PayloadOffset
+  LE.write<uint64_t>(0); // BucketOffset
+
+  FunctionIndexTableWriterTrait Trait;
+  for (const auto &ModPath : Index.modPathStringEntries()) {
+    uint32_t ModuleIndex = Trait.ModuleIndices.size();
+    Trait.ModuleIndices[ModPath.getKey()] = ModuleIndex;
+    LE.write<uint64_t>(ModPath.getValue());
+    LE.write<uint32_t>(ModPath.getKey().size());
+    Out << ModPath.getKey();
+  }
+
+  OnDiskChainedHashTableGenerator<FunctionIndexTableWriterTrait> Generator;
+  for (const auto &FuncInfoList : Index)
+    Generator.insert(FuncInfoList.getKey(), &FuncInfoList.second, Trait);
+  uint64_t PayloadOffset = Out.tell();
+  uint64_t BucketOffset = Generator.Emit(Out, Trait);
+
+  char *Header = &Data[sizeof(Magic) + sizeof(uint32_t)];
+  endian::write32le(Header, Trait.ModuleIndices.size());
+  endian::write64le(Header + 4, PayloadOffset);
+  endian::write64le(Header + 12, BucketOffset);
+  OS << Data;
+}
+
+bool object::isFunctionIndexTable(MemoryBufferRef Buffer) {
+  return Buffer.getBuffer().startswith(StringRef(Magic, sizeof(Magic)));
+}
+
+ErrorOr<std::unique_ptr<FunctionInfoIndex>>
+object::createFunctionIndexFromTable(std::unique_ptr<MemoryBuffer> Buffer) {
+  if (!isFunctionIndexTable(Buffer->getMemBufferRef()))
+    return object_error::invalid_file_type;
+  if (Buffer->getBufferSize() < HeaderSize)
+    return object_error::parse_failed;
+
+  const unsigned char *Base = Buffer->getBuffer().bytes_begin();
+  const unsigned char *End = Buffer->getBuffer().bytes_end();
+  const unsigned char *D = Base + sizeof(Magic);
+  uint32_t FileVersion = endian::readNext<uint32_t, little, unaligned>(D);
+  uint32_t NumModules = endian::readNext<uint32_t, little, unaligned>(D);
+  uint64_t PayloadOffset = endian::readNext<uint64_t, little, unaligned>(D);
+  uint64_t BucketOffset = endian::readNext<uint64_t, little, unaligned>(D);
+  if (FileVersion != Version)
+    return object_error::parse_failed;
+  // The buckets are read in place, and must be aligned.
+  uint64_t Size = End - Base;
+  if (PayloadOffset > BucketOffset || BucketOffset + 16 > Size ||
+      (reinterpret_cast<uintptr_t>(Base + BucketOffset) & 0x7))
+    return object_error::parse_failed;
+
+  // Only the module table is read up front, as the index owns the paths.
+  auto Index = llvm::make_unique<FunctionInfoIndex>();
+  std::vector<StringRef> ModulePaths;
+  ModulePaths.reserve(NumModules);
+  for (uint32_t I = 0; I != NumModules; ++I) {
+    if (uint64_t(End - D) < 12)
+      return object_error::parse_failed;
+    uint64_t ModuleId = endian::readNext<uint64_t, little, unaligned>(D);
+    uint32_t PathLen = endian::readNext<uint32_t, little, unaligned>(D);
+    if (uint64_t(End - D) < PathLen)
+      return object_error::parse_failed;
+    StringRef Path(reinterpret_cast<const char *>(D), PathLen);
+    ModulePaths.push_back(Index->addModulePath(Path, ModuleId));
+    D += PathLen;
+  }
+  if (uint64_t(D - Base) != PayloadOffset)
+    return object_error::parse_failed;
+
+  const unsigned char *Buckets = Base + BucketOffset;
+  uint64_t NumBuckets = endian::read64le(Buckets);
+  uint64_t NumEntries = endian::read64le(Buckets + 8);
+  if (!NumBuckets || (NumBuckets & (NumBuckets - 1)) ||
+      NumBuckets > (Size - BucketOffset - 16) / sizeof(uint64_t))
+    return object_error::parse_failed;
+  // The index is sized for all the entries, each of which starts with the
+  // lengths of its key and data.
+  if (NumEntries > (BucketOffset - PayloadOffset) / (2 * sizeof(uint32_t)))
+    return object_error::parse_failed;
+
+  std::unique_ptr<FunctionIndexHashTable> Table(
+      FunctionIndexHashTable::Create(Buckets, Base + PayloadOffset, Base));
+  Index->setSource(llvm::make_unique<FunctionIndexTableSource>(
+      std::move(Buffer), std::move(Table), std::move(ModulePaths)));
+  return std::move(Index);
+}
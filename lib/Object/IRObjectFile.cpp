@@ -111,6 +111,10 @@ IRObjectFile::IRObjectFile(MemoryBufferRef Object, std::unique_ptr<Module> Mod)
   }
 }
 
+IRObjectFile::IRObjectFile(MemoryBufferRef Object,
+                           std::unique_ptr<BitcodeSymbolTable> Symtab)
+    : SymbolicFile(Binary::ID_IR, Object), Symtab(std::move(Symtab)) {}
+
 IRObjectFile::~IRObjectFile() {
  }
 
@@ -150,6 +154,12 @@ static unsigned getAsmSymIndex(DataRefImpl Symb) {
 }
 
 void IRObjectFile::moveSymbolNext(DataRefImpl &Symb) const {
+  // Symbols of the symbol table are referenced by index.
+  if (Symtab) {
+    ++Symb.p;
+    return;
+  }
+
   const GlobalValue *GV = getGV(Symb);
   uintptr_t Res;
 
@@ -188,6 +198,11 @@ void IRObjectFile::moveSymbolNext(DataRefImpl &Symb) const {
 
 std::error_code IRObjectFile::printSymbolName(raw_ostream &OS,
                                               DataRefImpl Symb) const {
+  if (const BitcodeSymbol *Sym = getSymbolTableEntry(Symb)) {
+    OS << Sym->Name;
+    return std::error_code();
+  }
+
   const GlobalValue *GV = getGV(Symb);
   if (!GV) {
     unsigned Index = getAsmSymIndex(Symb);
@@ -207,7 +222,34 @@ std::error_code IRObjectFile::printSymbolName(raw_ostream &OS,
   return std::error_code();
 }
 
+static uint32_t getSymbolTableEntryFlags(const BitcodeSymbol &Sym) {
+  // Keep in sync with the flags computed from the module below.
+  uint32_t Res = BasicSymbolRef::SF_None;
+  if (Sym.IsUndefined)
+    Res |= BasicSymbolRef::SF_Undefined;
+  else if (Sym.Visibility == GlobalValue::HiddenVisibility &&
+           !GlobalValue::isLocalLinkage(Sym.Linkage))
+    Res |= BasicSymbolRef::SF_Hidden;
+  if (Sym.IsConstant)
+    Res |= BasicSymbolRef::SF_Const;
+  if (GlobalValue::isPrivateLinkage(Sym.Linkage))
+    Res |= BasicSymbolRef::SF_FormatSpecific;
+  if (!GlobalValue::isLocalLinkage(Sym.Linkage))
+    Res |= BasicSymbolRef::SF_Global;
+  if (GlobalValue::isCommonLinkage(Sym.Linkage))
+    Res |= BasicSymbolRef::SF_Common;
+  if (GlobalValue::isLinkOnceLinkage(Sym.Linkage) ||
+      GlobalValue::isWeakLinkage(Sym.Linkage))
+    Res |= BasicSymbolRef::SF_Weak;
+  if (Sym.IsLLVMSpecific)
+    Res |= BasicSymbolRef::SF_FormatSpecific;
+  return Res;
+}
+
 uint32_t IRObjectFile::getSymbolFlags(DataRefImpl Symb) const {
+  if (const BitcodeSymbol *Sym = getSymbolTableEntry(Symb))
+    return getSymbolTableEntryFlags(*Sym);
+
   const GlobalValue *GV = getGV(Symb);
 
   if (!GV) {
@@ -244,19 +286,45 @@ uint32_t IRObjectFile::getSymbolFlags(DataRefImpl Symb) const {
   return Res;
 }
 
-GlobalValue *IRObjectFile::getSymbolGV(DataRefImpl Symb) { return getGV(Symb); }
+GlobalValue *IRObjectFile::getSymbolGV(DataRefImpl Symb) {
+  if (Symtab)
+    return nullptr;
+  return getGV(Symb);
+}
+
+const BitcodeSymbol *
+IRObjectFile::getSymbolTableEntry(DataRefImpl Symb) const {
+  if (!Symtab)
+    return nullptr;
+  assert(Symb.p < Symtab->Symbols.size());
+  return &Symtab->Symbols[Symb.p];
+}
+
+StringRef IRObjectFile::getTargetTriple() const {
+  if (Symtab)
+    return Symtab->TargetTriple;
+  return M->getTargetTriple();
+}
 
 std::unique_ptr<Module> IRObjectFile::takeModule() { return std::move(M); }
 
 basic_symbol_iterator IRObjectFile::symbol_begin_impl() const {
-  Module::const_iterator I = M->begin();
   DataRefImpl Ret;
+  if (Symtab) {
+    Ret.p = 0;
+    return basic_symbol_iterator(BasicSymbolRef(Ret, this));
+  }
+  Module::const_iterator I = M->begin();
   Ret.p = skipEmpty(I, *M);
   return basic_symbol_iterator(BasicSymbolRef(Ret, this));
 }
 
 basic_symbol_iterator IRObjectFile::symbol_end_impl() const {
   DataRefImpl Ret;
+  if (Symtab) {
+    Ret.p = Symtab->Symbols.size();
+    return basic_symbol_iterator(BasicSymbolRef(Ret, this));
+  }
   uint64_t NumAsm = AsmSymbols.size();
   NumAsm <<= 2;
   Ret.p = 3 | NumAsm;
@@ -317,3 +385,18 @@ llvm::object::IRObjectFile::create(MemoryBufferRef Object,
   std::unique_ptr<Module> &M = MOrErr.get();
   return llvm::make_unique<IRObjectFile>(Object, std::move(M));
 }
+
+ErrorOr<std::unique_ptr<IRObjectFile>>
+llvm::object::IRObjectFile::createFromSymbolTable(MemoryBufferRef Object) {
+  ErrorOr<MemoryBufferRef> BCOrErr = findBitcodeInMemBuffer(Object);
+  if (!BCOrErr)
+    return BCOrErr.getError();
+
+  ErrorOr<std::unique_ptr<BitcodeSymbolTable>> SymtabOrErr =
+      readBitcodeSymbolTable(BCOrErr.get());
+  if (std::error_code EC = SymtabOrErr.getError())
+    return EC;
+  if (!*SymtabOrErr)
+    return std::unique_ptr<IRObjectFile>();
+  return llvm::make_unique<IRObjectFile>(Object, std::move(*SymtabOrErr));
+}
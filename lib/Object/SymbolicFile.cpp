@@ -33,9 +33,18 @@ ErrorOr<std::unique_ptr<SymbolicFile>> SymbolicFile::createSymbolicFile(
     Type = sys::fs::identify_magic(Data);
 
   switch (Type) {
-  case sys::fs::file_magic::bitcode:
+  case sys::fs::file_magic::bitcode: {
+    // The symbol table of the bitcode, if any, spares reading the module.
+    // Errors are left for the module reader to report when there is one.
+    ErrorOr<std::unique_ptr<IRObjectFile>> ObjOrErr =
+        IRObjectFile::createFromSymbolTable(Object);
+    if (ObjOrErr && *ObjOrErr)
+      return std::unique_ptr<SymbolicFile>(std::move(*ObjOrErr));
     if (Context)
       return IRObjectFile::create(Object, *Context);
+    if (!ObjOrErr)
+      return ObjOrErr.getError();
+  }
   // Fallthrough
   case sys::fs::file_magic::unknown:
   case sys::fs::file_magic::archive:
@@ -38,6 +38,28 @@ inline static uint64_t* getClearedMemory(unsigned numWords) {
   return result;
 }
 
+#if defined(__SIZEOF_INT128__)
+// Values of 65 to 128 bits, such as i128 constants, fit in the 128-bit integer
+// type of the compiler, whose multiplication, division and shifts are much
+// faster than the generic multiword algorithms below.
+#define APINT_HAS_DOUBLE_WORD 1
+typedef unsigned __int128 DoubleWord;
+
+static inline DoubleWord getDoubleWord(const uint64_t *Words) {
+  return DoubleWord(Words[1]) << 64 | Words[0];
+}
+
+static inline void setDoubleWord(uint64_t *Words, DoubleWord Val) {
+  Words[0] = uint64_t(Val);
+  Words[1] = uint64_t(Val >> 64);
+}
+
+/// Return true if an APInt of the given width is stored in two words.
+static inline bool isDoubleWord(unsigned BitWidth) {
+  return BitWidth > 64 && BitWidth <= 128;
+}
+#endif
+
 /// A utility function for allocating memory and checking for allocation
 /// failure.  The content is not zeroed.
 inline static uint64_t* getMemory(unsigned numWords) {
@@ -237,11 +259,14 @@ APInt& APInt::operator--() {
 /// @brief General addition of 64-bit integer arrays
 static bool add(uint64_t *dest, const uint64_t *x, const uint64_t *y,
                 unsigned len) {
-  bool carry = false;
-  for (unsigned i = 0; i< len; ++i) {
-    uint64_t limit = std::min(x[i],y[i]); // must come first in case dest == x
-    dest[i] = x[i] + y[i] + carry;
-    carry = dest[i] < limit || (carry && dest[i] == limit);
+  // Compute the carry without branches, so that the compiler can keep it in
+  // the carry flag.
+  uint64_t carry = 0;
+  for (unsigned i = 0; i < len; ++i) {
+    uint64_t sum = x[i] + y[i];
+    uint64_t carry1 = sum < x[i];
+    dest[i] = sum + carry;
+    carry = carry1 | (dest[i] < sum);
   }
   return carry;
 }
@@ -253,6 +278,10 @@ APInt& APInt::operator+=(const APInt& RHS) {
   assert(BitWidth == RHS.BitWidth && "Bit widths must be the same");
   if (isSingleWord())
     VAL += RHS.VAL;
+#ifdef APINT_HAS_DOUBLE_WORD
+  else if (isDoubleWord(BitWidth))
+    setDoubleWord(pVal, getDoubleWord(pVal) + getDoubleWord(RHS.pVal));
+#endif
   else {
     add(pVal, pVal, RHS.pVal, getNumWords());
   }
@@ -264,11 +293,12 @@ APInt& APInt::operator+=(const APInt& RHS) {
 /// @brief Generalized subtraction of 64-bit integer arrays.
 static bool sub(uint64_t *dest, const uint64_t *x, const uint64_t *y,
                 unsigned len) {
-  bool borrow = false;
+  uint64_t borrow = 0;
   for (unsigned i = 0; i < len; ++i) {
-    uint64_t x_tmp = borrow ? x[i] - 1 : x[i];
-    borrow = y[i] > x_tmp || (borrow && x[i] == 0);
-    dest[i] = x_tmp - y[i];
+    uint64_t diff = x[i] - y[i];
+    uint64_t borrow1 = x[i] < y[i];
+    dest[i] = diff - borrow;
+    borrow = borrow1 | (diff < borrow);
   }
   return borrow;
 }
@@ -280,6 +310,10 @@ APInt& APInt::operator-=(const APInt& RHS) {
   assert(BitWidth == RHS.BitWidth && "Bit widths must be the same");
   if (isSingleWord())
     VAL -= RHS.VAL;
+#ifdef APINT_HAS_DOUBLE_WORD
+  else if (isDoubleWord(BitWidth))
+    setDoubleWord(pVal, getDoubleWord(pVal) - getDoubleWord(RHS.pVal));
+#endif
   else
     sub(pVal, pVal, RHS.pVal, getNumWords());
   return clearUnusedBits();
@@ -360,6 +394,12 @@ APInt& APInt::operator*=(const APInt& RHS) {
     clearUnusedBits();
     return *this;
   }
+#ifdef APINT_HAS_DOUBLE_WORD
+  if (isDoubleWord(BitWidth)) {
+    setDoubleWord(pVal, getDoubleWord(pVal) * getDoubleWord(RHS.pVal));
+    return clearUnusedBits();
+  }
+#endif
 
   // Get some bit facts about LHS and check for zero
   unsigned lhsBits = getActiveBits();
@@ -474,6 +514,13 @@ APInt APInt::operator+(const APInt& RHS) const {
   if (isSingleWord())
     return APInt(BitWidth, VAL + RHS.VAL);
   APInt Result(BitWidth, 0);
+#ifdef APINT_HAS_DOUBLE_WORD
+  if (isDoubleWord(BitWidth)) {
+    setDoubleWord(Result.pVal, getDoubleWord(pVal) + getDoubleWord(RHS.pVal));
+    Result.clearUnusedBits();
+    return Result;
+  }
+#endif
   add(Result.pVal, this->pVal, RHS.pVal, getNumWords());
   Result.clearUnusedBits();
   return Result;
@@ -484,6 +531,13 @@ APInt APInt::operator-(const APInt& RHS) const {
   if (isSingleWord())
     return APInt(BitWidth, VAL - RHS.VAL);
   APInt Result(BitWidth, 0);
+#ifdef APINT_HAS_DOUBLE_WORD
+  if (isDoubleWord(BitWidth)) {
+    setDoubleWord(Result.pVal, getDoubleWord(pVal) - getDoubleWord(RHS.pVal));
+    Result.clearUnusedBits();
+    return Result;
+  }
+#endif
   sub(Result.pVal, this->pVal, RHS.pVal, getNumWords());
   Result.clearUnusedBits();
   return Result;
@@ -1075,6 +1129,19 @@ APInt APInt::ashr(unsigned shiftAmt) const {
       return APInt(BitWidth, 0);
   }
 
+#ifdef APINT_HAS_DOUBLE_WORD
+  if (isDoubleWord(BitWidth)) {
+    // Sign extend to 128 bits, then shift.
+    unsigned SignBit = 128 - BitWidth;
+    APInt Result(BitWidth, 0);
+    setDoubleWord(Result.pVal,
+                  DoubleWord((__int128(getDoubleWord(pVal) << SignBit) >>
+                              SignBit) >> shiftAmt));
+    Result.clearUnusedBits();
+    return Result;
+  }
+#endif
+
   // Create some space for the result.
   uint64_t * val = new uint64_t[getNumWords()];
 
@@ -1159,6 +1226,14 @@ APInt APInt::lshr(unsigned shiftAmt) const {
   if (shiftAmt == 0)
     return *this;
 
+#ifdef APINT_HAS_DOUBLE_WORD
+  if (isDoubleWord(BitWidth)) {
+    APInt Result(BitWidth, 0);
+    setDoubleWord(Result.pVal, getDoubleWord(pVal) >> shiftAmt);
+    return Result;
+  }
+#endif
+
   // Create some space for the result.
   uint64_t * val = new uint64_t[getNumWords()];
 
@@ -1221,6 +1296,15 @@ APInt APInt::shlSlowCase(unsigned shiftAmt) const {
   if (shiftAmt == 0)
     return *this;
 
+#ifdef APINT_HAS_DOUBLE_WORD
+  if (isDoubleWord(BitWidth)) {
+    APInt Result(BitWidth, 0);
+    setDoubleWord(Result.pVal, getDoubleWord(pVal) << shiftAmt);
+    Result.clearUnusedBits();
+    return Result;
+  }
+#endif
+
   // Create some space for the result.
   uint64_t * val = new uint64_t[getNumWords()];
 
@@ -1844,6 +1928,15 @@ APInt APInt::udiv(const APInt& RHS) const {
     assert(RHS.VAL != 0 && "Divide by zero?");
     return APInt(BitWidth, VAL / RHS.VAL);
   }
+#ifdef APINT_HAS_DOUBLE_WORD
+  if (isDoubleWord(BitWidth)) {
+    DoubleWord Divisor = getDoubleWord(RHS.pVal);
+    assert(Divisor != 0 && "Divide by zero?");
+    APInt Quotient(BitWidth, 0);
+    setDoubleWord(Quotient.pVal, getDoubleWord(pVal) / Divisor);
+    return Quotient;
+  }
+#endif
 
   // Get some facts about the LHS and RHS number of bits and words
   unsigned rhsBits = RHS.getActiveBits();
@@ -1890,6 +1983,15 @@ APInt APInt::urem(const APInt& RHS) const {
     assert(RHS.VAL != 0 && "Remainder by zero?");
     return APInt(BitWidth, VAL % RHS.VAL);
   }
+#ifdef APINT_HAS_DOUBLE_WORD
+  if (isDoubleWord(BitWidth)) {
+    DoubleWord Divisor = getDoubleWord(RHS.pVal);
+    assert(Divisor != 0 && "Remainder by zero?");
+    APInt Remainder(BitWidth, 0);
+    setDoubleWord(Remainder.pVal, getDoubleWord(pVal) % Divisor);
+    return Remainder;
+  }
+#endif
 
   // Get some facts about the LHS
   unsigned lhsBits = getActiveBits();
@@ -1945,6 +2047,19 @@ void APInt::udivrem(const APInt &LHS, const APInt &RHS,
     Remainder = APInt(LHS.BitWidth, RemVal);
     return;
   }
+#ifdef APINT_HAS_DOUBLE_WORD
+  if (isDoubleWord(LHS.BitWidth)) {
+    // Read the operands first, as they may be the results.
+    DoubleWord Dividend = getDoubleWord(LHS.pVal);
+    DoubleWord Divisor = getDoubleWord(RHS.pVal);
+    assert(Divisor != 0 && "Divide by zero?");
+    Quotient = APInt(LHS.BitWidth, 0);
+    Remainder = APInt(LHS.BitWidth, 0);
+    setDoubleWord(Quotient.pVal, Dividend / Divisor);
+    setDoubleWord(Remainder.pVal, Dividend % Divisor);
+    return;
+  }
+#endif
 
   // Get some size facts about the dividend and divisor
   unsigned lhsBits  = LHS.getActiveBits();
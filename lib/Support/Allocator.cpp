@@ -12,10 +12,220 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/Allocator.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/raw_ostream.h"
+#include <map>
+#include <mutex>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 namespace llvm {
 
+// The options write their values directly to these variables, which are
+// zero-initialized: allocators constructed before the options are get slabs
+// from malloc.
+static SlabAllocator::BackingKind Backing;
+static bool NUMALocal;
+
+static cl::opt<SlabAllocator::BackingKind, true> SlabBacking(
+    "slab-backing", cl::desc("Memory backing the slabs of BumpPtrAllocators"),
+    cl::location(Backing), cl::Hidden,
+    cl::values(clEnumValN(SlabAllocator::Malloc, "malloc", "malloc (default)"),
+               clEnumValN(SlabAllocator::Pages, "pages",
+                          "Mapped memory, with slab reuse"),
+               clEnumValN(SlabAllocator::TransparentHugePages, "thp",
+                          "Transparent huge pages, with slab reuse"),
+               clEnumValN(SlabAllocator::ExplicitHugePages, "huge",
+                          "Reserved huge pages, with slab reuse"),
+               clEnumValEnd));
+
+static cl::opt<bool, true> SlabNUMALocal(
+    "slab-numa-local",
+    cl::desc("Map separate slab memory for each NUMA node (with "
+             "-slab-backing other than malloc)"),
+    cl::location(NUMALocal), cl::Hidden);
+
+namespace {
+
+/// The chunks of mapped memory that slabs are carved out of, and the slabs
+/// released so far.
+class SlabPool {
+public:
+  /// The size of the chunks: one huge page on common targets.
+  static const size_t ChunkSize = 2 * 1024 * 1024;
+  /// Slabs larger than this get their own mapping, which is released with
+  /// them.
+  static const size_t MaxPooledSlabSize = ChunkSize / 4;
+
+  void *allocate(size_t Size);
+  void deallocate(const void *Ptr, size_t Size);
+
+  size_t getMappedMemory() const { return MappedMemory; }
+
+private:
+  /// The chunk that new slabs are carved out of, and the released slabs, for
+  /// one NUMA node.
+  struct Node {
+    char *CurPtr = nullptr;
+    char *End = nullptr;
+    DenseMap<size_t, std::vector<void *>> FreeSlabs;
+  };
+
+  sys::MemoryBlock map(size_t Size);
+  unsigned getCurrentNode() const;
+
+  /// A chunk, or the mapping of a large slab.
+  struct Mapping {
+    sys::MemoryBlock Block;
+    /// The node owning the chunk, or -1 for a large slab.
+    int NodeIdx;
+  };
+
+  std::mutex Lock;
+  std::vector<Node> Nodes;
+  /// The mappings, by start address.
+  std::map<uintptr_t, Mapping> Mappings;
+  size_t MappedMemory = 0;
+};
+
+} // end anonymous namespace
+
+static SlabPool &getSlabPool() {
+  // The pool is never destroyed: BumpPtrAllocators with static storage may
+  // release their slabs after llvm_shutdown.
+  static SlabPool *Pool = new SlabPool();
+  return *Pool;
+}
+
+static size_t getPageSize() {
+  static const size_t PageSize = sys::Process::getPageSize();
+  return PageSize;
+}
+
+sys::MemoryBlock SlabPool::map(size_t Size) {
+  unsigned Flags = sys::Memory::MF_READ | sys::Memory::MF_WRITE;
+  if (NUMALocal)
+    Flags |= sys::Memory::MF_NUMA_LOCAL;
+
+  std::error_code EC;
+  sys::MemoryBlock Block;
+  if (Backing == SlabAllocator::ExplicitHugePages)
+    Block = sys::Memory::allocateMappedMemory(
+        Size, nullptr, Flags | sys::Memory::MF_HUGE_EXPLICIT, EC);
+  if (!Block.base() && Backing != SlabAllocator::Pages)
+    Block = sys::Memory::allocateMappedMemory(
+        Size, nullptr, Flags | sys::Memory::MF_HUGE_HINT, EC);
+  if (!Block.base())
+    Block = sys::Memory::allocateMappedMemory(Size, nullptr, Flags, EC);
+  if (!Block.base())
+    report_fatal_error("Unable to map memory for slabs: " + EC.message());
+
+  MappedMemory += Block.size();
+  return Block;
+}
+
+unsigned SlabPool::getCurrentNode() const {
+#if defined(__linux__) && defined(SYS_getcpu)
+  if (NUMALocal) {
+    unsigned CPU, Node;
+    if (::syscall(SYS_getcpu, &CPU, &Node, nullptr) == 0)
+      return Node;
+  }
+#endif
+  return 0;
+}
+
+void *SlabPool::allocate(size_t Size) {
+  // Slabs are a whole number of pages, so that the pages of a slab are
+  // only touched by the thread using it.
+  Size = alignTo(Size, getPageSize());
+  unsigned NodeIdx = getCurrentNode();
+
+  std::lock_guard<std::mutex> Guard(Lock);
+  if (Size > MaxPooledSlabSize) {
+    sys::MemoryBlock Block = map(Size);
+    Mappings[uintptr_t(Block.base())] = {Block, -1};
+    return Block.base();
+  }
+
+  if (NodeIdx >= Nodes.size())
+    Nodes.resize(NodeIdx + 1);
+  Node &N = Nodes[NodeIdx];
+  auto I = N.FreeSlabs.find(Size);
+  if (I != N.FreeSlabs.end() && !I->second.empty()) {
+    void *Slab = I->second.back();
+    I->second.pop_back();
+    return Slab;
+  }
+
+  // Carve the slab out of the current chunk, leaving the rest of the chunk
+  // unused if the slab doesn't fit.
+  if (size_t(N.End - N.CurPtr) < Size) {
+    sys::MemoryBlock Block = map(ChunkSize);
+    Mappings[uintptr_t(Block.base())] = {Block, int(NodeIdx)};
+    N.CurPtr = static_cast<char *>(Block.base());
+    N.End = N.CurPtr + Block.size();
+  }
+  void *Slab = N.CurPtr;
+  N.CurPtr += Size;
+  return Slab;
+}
+
+void SlabPool::deallocate(const void *Ptr, size_t Size) {
+  uintptr_t Addr = reinterpret_cast<uintptr_t>(Ptr);
+  Size = alignTo(Size, getPageSize());
+
+  std::lock_guard<std::mutex> Guard(Lock);
+  auto I = Mappings.upper_bound(Addr);
+  if (I == Mappings.begin()) {
+    free(const_cast<void *>(Ptr));
+    return;
+  }
+  --I;
+  Mapping &M = I->second;
+  if (Addr >= I->first + M.Block.size()) {
+    // The allocator got the slab from malloc before mapped memory was
+    // selected.
+    free(const_cast<void *>(Ptr));
+    return;
+  }
+
+  if (M.NodeIdx < 0) {
+    MappedMemory -= M.Block.size();
+    sys::Memory::releaseMappedMemory(M.Block);
+    Mappings.erase(I);
+    return;
+  }
+
+  // Keep the slab for the next allocator on the node owning the chunk.
+  Nodes[M.NodeIdx].FreeSlabs[Size].push_back(const_cast<void *>(Ptr));
+}
+
+void SlabAllocator::setBacking(BackingKind Kind) { Backing = Kind; }
+
+SlabAllocator::BackingKind SlabAllocator::getBacking() { return Backing; }
+
+void SlabAllocator::setNUMALocal(bool Enable) { NUMALocal = Enable; }
+
+size_t SlabAllocator::getMappedMemory() {
+  return getSlabPool().getMappedMemory();
+}
+
+void *SlabAllocator::allocateMapped(size_t Size) {
+  return getSlabPool().allocate(Size);
+}
+
+void SlabAllocator::deallocateMapped(const void *Ptr, size_t Size) {
+  getSlabPool().deallocate(Ptr, Size);
+}
+
 namespace detail {
 
 void printBumpPtrAllocatorStats(unsigned NumSlabs, size_t BytesAllocated,
@@ -34,7 +34,9 @@
 #include "llvm/Support/Path.h"
 #include "llvm/Support/StringSaver.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <cstdlib>
+#include <functional>
 #include <map>
 using namespace llvm;
 using namespace cl;
@@ -1137,6 +1139,62 @@ bool Option::addOccurrence(unsigned pos, StringRef ArgName, StringRef Value,
   return handleOccurrence(pos, ArgName, Value);
 }
 
+bool Option::setContextValue(OptionContext &, StringRef ArgName, StringRef) {
+  return error("cannot be set in an option context", ArgName);
+}
+
+//===----------------------------------------------------------------------===//
+// OptionContext implementation
+//
+
+LLVM_THREAD_LOCAL OptionContext *OptionContext::Current = nullptr;
+
+OptionContext::OptionContext() {}
+
+OptionContext::~OptionContext() {
+  assert(Current != this && "Destroying an active option context!");
+  for (Entry &E : Entries)
+    E.Deleter(E.Value);
+}
+
+bool OptionContext::setOption(StringRef ArgName, StringRef Value) {
+  StringMap<Option *>::const_iterator I =
+      GlobalParser->OptionsMap.find(ArgName);
+  if (I == GlobalParser->OptionsMap.end()) {
+    errs() << GlobalParser->ProgramName << ": Unknown command line argument '-"
+           << ArgName << "'\n";
+    return true;
+  }
+  return I->second->setContextValue(*this, ArgName, Value);
+}
+
+void *OptionContext::lookup(const void *Storage) const {
+  auto I = std::lower_bound(Entries.begin(), Entries.end(), Storage,
+                            [](const Entry &E, const void *Storage) {
+                              return std::less<const void *>()(E.Storage,
+                                                               Storage);
+                            });
+  if (I == Entries.end() || I->Storage != Storage)
+    return nullptr;
+  return I->Value;
+}
+
+void OptionContext::setValue(const void *Storage, void *Value,
+                             void (*Deleter)(void *)) {
+  auto I = std::lower_bound(Entries.begin(), Entries.end(), Storage,
+                            [](const Entry &E, const void *Storage) {
+                              return std::less<const void *>()(E.Storage,
+                                                               Storage);
+                            });
+  if (I != Entries.end() && I->Storage == Storage) {
+    I->Deleter(I->Value);
+    I->Value = Value;
+    I->Deleter = Deleter;
+    return;
+  }
+  Entries.insert(I, Entry{Storage, Value, Deleter});
+}
+
 // getValueStr - Get the value description string, using "DefaultMsg" if nothing
 // has been specified yet.
 //
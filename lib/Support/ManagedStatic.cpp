@@ -13,10 +13,9 @@
 
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Config/config.h"
-#include "llvm/Support/Atomic.h"
-#include "llvm/Support/Compiler.h"
 #include "llvm/Support/Mutex.h"
 #include "llvm/Support/MutexGuard.h"
+#include "llvm/Support/Threading.h"
 #include <cassert>
 using namespace llvm;
 
@@ -36,18 +35,12 @@ void ManagedStaticBase::RegisterManagedStatic(void *(*Creator)(),
   if (llvm_is_multithreaded()) {
     MutexGuard Lock(getManagedStaticMutex());
 
-    if (!Ptr) {
-      void* tmp = Creator();
+    if (!Ptr.load(std::memory_order_relaxed)) {
+      void *Tmp = Creator();
 
-      TsanHappensBefore(this);
-      sys::MemoryFence();
-
-      // This write is racy against the first read in the ManagedStatic
-      // accessors. The race is benign because it does a second read after a
-      // memory fence, at which point it isn't possible to get a partial value.
-      TsanIgnoreWritesBegin();
-      Ptr = tmp;
-      TsanIgnoreWritesEnd();
+      // Publish the object: the accessors read Ptr with an acquire load and
+      // only take the mutex while it is null.
+      Ptr.store(Tmp, std::memory_order_release);
       DeleterFn = Deleter;
       
       // Add to list of managed statics.
@@ -57,7 +50,7 @@ void ManagedStaticBase::RegisterManagedStatic(void *(*Creator)(),
   } else {
     assert(!Ptr && !DeleterFn && !Next &&
            "Partially initialized ManagedStatic!?");
-    Ptr = Creator();
+    Ptr.store(Creator(), std::memory_order_relaxed);
     DeleterFn = Deleter;
   
     // Add to list of managed statics.
@@ -78,7 +71,7 @@ void ManagedStaticBase::destroy() const {
   DeleterFn(Ptr);
   
   // Cleanup.
-  Ptr = nullptr;
+  Ptr.store(nullptr, std::memory_order_relaxed);
   DeleterFn = nullptr;
 }
 
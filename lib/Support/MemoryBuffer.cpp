@@ -229,6 +229,26 @@ public:
   BufferKind getBufferKind() const override {
     return MemoryBuffer_MMap;
   }
+
+  void adviseAccess(AccessPattern Pattern) const override {
+    sys::fs::mapped_file_region::advice Advice;
+    switch (Pattern) {
+    case Access_Normal:
+      Advice = sys::fs::mapped_file_region::normal;
+      break;
+    case Access_Sequential:
+      Advice = sys::fs::mapped_file_region::sequential;
+      break;
+    case Access_Random:
+      Advice = sys::fs::mapped_file_region::random;
+      break;
+    case Access_WillNeed:
+      Advice = sys::fs::mapped_file_region::willneed;
+      break;
+    }
+    // Hints are best effort.
+    MFR.advise(Advice);
+  }
 };
 }
 
@@ -438,6 +458,13 @@ ErrorOr<std::unique_ptr<MemoryBuffer>> MemoryBuffer::getSTDIN() {
   return getMemoryBufferForStream(0, "<stdin>");
 }
 
+void MemoryBuffer::prefetch(StringRef Data) {
+  // willneed does not change the pages of memory that is not a file mapping,
+  // so Data need not be.  Hints are best effort.
+  sys::fs::mapped_file_region::advise(Data.data(), Data.size(),
+                                      sys::fs::mapped_file_region::willneed);
+}
+
 MemoryBufferRef MemoryBuffer::getMemBufferRef() const {
   StringRef Data = getBuffer();
   StringRef Identifier = getBufferIdentifier();
@@ -7,102 +7,212 @@
 //
 //===----------------------------------------------------------------------===//
 //
-// This file implements a crude C++11 based thread pool.
+// This file implements a C++11 based work-stealing thread pool.
 //
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/ThreadPool.h"
 
 #include "llvm/Config/llvm-config.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace llvm;
 
+void ThreadPool::runTask(QueuedTask &Task) {
+  {
+    // Options read by the task see the values of its submitter, even when a
+    // thread waiting on a group runs tasks submitted from another context.
+    cl::OptionContext::Scope Options(Task.Options);
+#ifndef _MSC_VER
+    Task.Task();
+#else
+    Task.Task(/* unused */ false);
+#endif
+  }
+
+  if (ThreadPoolTaskGroup *Group = Task.Group) {
+    // The group may be destroyed as soon as its last task is accounted for,
+    // so only touch it while holding its lock; waiters synchronize on it
+    // before returning.
+    bool GroupDone;
+    {
+      std::unique_lock<std::mutex> LockGuard(Group->CompletionLock);
+      GroupDone = --Group->PendingTasks == 0;
+      if (GroupDone)
+        Group->CompletionCondition.notify_all();
+    }
+#if LLVM_ENABLE_THREADS
+    // Pool threads waiting on the group sleep on WorkCondition.
+    if (GroupDone) {
+      {
+        std::unique_lock<std::mutex> LockGuard(SleepLock);
+      }
+      WorkCondition.notify_all();
+    }
+#endif
+  }
+
+  if (--OutstandingTasks == 0) {
+    // Notify completion, in case someone waits on ThreadPool::wait()
+    {
+      std::unique_lock<std::mutex> LockGuard(CompletionLock);
+    }
+    CompletionCondition.notify_all();
+  }
+}
+
 #if LLVM_ENABLE_THREADS
 
 // Default to std::thread::hardware_concurrency
 ThreadPool::ThreadPool() : ThreadPool(std::thread::hardware_concurrency()) {}
 
 ThreadPool::ThreadPool(unsigned ThreadCount)
-    : ActiveThreads(0), EnableFlag(true) {
-  // Create ThreadCount threads that will loop forever, wait on QueueCondition
+    : ThreadCount(ThreadCount), OutstandingTasks(0), NextQueue(0),
+      QueuedTasks(0), IdleThreads(0), EnableFlag(true) {
+  // Always keep at least one queue around so that tasks have somewhere to go.
+  unsigned QueueCount = std::max(ThreadCount, 1u);
+  Queues.reserve(QueueCount);
+  for (unsigned Index = 0; Index < QueueCount; ++Index) {
+    Queues.emplace_back(new WorkerQueue());
+    Queues.back()->Index = Index;
+  }
+
+  // Create ThreadCount threads that will loop forever, running tasks from
+  // their own queue, stealing from the others, or waiting on WorkCondition
   // for tasks to be queued or the Pool to be destroyed.
   Threads.reserve(ThreadCount);
-  for (unsigned ThreadID = 0; ThreadID < ThreadCount; ++ThreadID) {
-    Threads.emplace_back([&] {
-      while (true) {
-        PackagedTaskTy Task;
-        {
-          std::unique_lock<std::mutex> LockGuard(QueueLock);
-          // Wait for tasks to be pushed in the queue
-          QueueCondition.wait(LockGuard,
-                              [&] { return !EnableFlag || !Tasks.empty(); });
-          // Exit condition
-          if (!EnableFlag && Tasks.empty())
-            return;
-          // Yeah, we have a task, grab it and release the lock on the queue
-
-          // We first need to signal that we are active before popping the queue
-          // in order for wait() to properly detect that even if the queue is
-          // empty, there is still a task in flight.
-          {
-            ++ActiveThreads;
-            std::unique_lock<std::mutex> LockGuard(CompletionLock);
-          }
-          Task = std::move(Tasks.front());
-          Tasks.pop();
-        }
-        // Run the task we just grabbed
-#ifndef _MSC_VER
-        Task();
-#else
-        Task(/* unused */ false);
-#endif
+  for (unsigned ThreadID = 0; ThreadID < ThreadCount; ++ThreadID)
+    Threads.emplace_back([this, ThreadID] { workerLoop(ThreadID); });
+}
 
-        {
-          // Adjust `ActiveThreads`, in case someone waits on ThreadPool::wait()
-          std::unique_lock<std::mutex> LockGuard(CompletionLock);
-          --ActiveThreads;
-        }
+void ThreadPool::workerLoop(unsigned Index) {
+  CurrentQueue.set(Queues[Index].get());
+  while (true) {
+    QueuedTask Task;
+    if (popTask(Index, Task)) {
+      runTask(Task);
+      continue;
+    }
 
-        // Notify task completion, in case someone waits on ThreadPool::wait()
-        CompletionCondition.notify_all();
-      }
-    });
+    // Every queue looked empty, go to sleep until a task is pushed. Bumping
+    // IdleThreads before checking QueuedTasks pairs with the increment of
+    // QueuedTasks in asyncImpl() so that a wakeup can't be missed.
+    std::unique_lock<std::mutex> LockGuard(SleepLock);
+    ++IdleThreads;
+    WorkCondition.wait(LockGuard, [&] { return !EnableFlag || QueuedTasks; });
+    --IdleThreads;
+    // Exit condition
+    if (!EnableFlag && !QueuedTasks)
+      return;
   }
 }
 
+bool ThreadPool::popTask(unsigned Index, QueuedTask &Task) {
+  unsigned QueueCount = Queues.size();
+  for (unsigned I = 0; I < QueueCount; ++I) {
+    WorkerQueue &Queue = *Queues[(Index + I) % QueueCount];
+    std::unique_lock<std::mutex> LockGuard(Queue.Lock);
+    if (Queue.Tasks.empty())
+      continue;
+    if (I == 0) {
+      // Our own queue: newest task first.
+      Task = std::move(Queue.Tasks.back());
+      Queue.Tasks.pop_back();
+    } else {
+      // Stealing: oldest task first, it is likely to carry the most work.
+      Task = std::move(Queue.Tasks.front());
+      Queue.Tasks.pop_front();
+    }
+    --QueuedTasks;
+    return true;
+  }
+  return false;
+}
+
 void ThreadPool::wait() {
-  // Wait for all threads to complete and the queue to be empty
+  assert(!CurrentQueue.get() &&
+         "ThreadPool::wait() called from a pool thread, use a task group");
+  // Wait for all tasks to complete
   std::unique_lock<std::mutex> LockGuard(CompletionLock);
-  CompletionCondition.wait(LockGuard,
-                           [&] { return Tasks.empty() && !ActiveThreads; });
+  CompletionCondition.wait(LockGuard, [&] { return !OutstandingTasks; });
 }
 
-std::shared_future<ThreadPool::VoidTy> ThreadPool::asyncImpl(TaskTy Task) {
+void ThreadPool::waitForGroup(ThreadPoolTaskGroup &Group) {
+  WorkerQueue *Queue = CurrentQueue.get();
+  if (!Queue) {
+    // Outside of the pool, just block until the group is done.
+    std::unique_lock<std::mutex> LockGuard(Group.CompletionLock);
+    Group.CompletionCondition.wait(LockGuard,
+                                   [&] { return !Group.PendingTasks; });
+    return;
+  }
+
+  // Inside the pool, blocking this thread could starve the tasks we are
+  // waiting on: keep running queued tasks until the group completes.
+  while (Group.PendingTasks) {
+    QueuedTask Task;
+    if (popTask(Queue->Index, Task)) {
+      runTask(Task);
+      continue;
+    }
+
+    // The remaining tasks of the group are running on other threads, sleep
+    // until either they complete or new work shows up.
+    std::unique_lock<std::mutex> LockGuard(SleepLock);
+    ++IdleThreads;
+    WorkCondition.wait(LockGuard,
+                       [&] { return !Group.PendingTasks || QueuedTasks; });
+    --IdleThreads;
+  }
+
+  // Make sure the thread that completed the group is done with it.
+  std::unique_lock<std::mutex> LockGuard(Group.CompletionLock);
+}
+
+std::shared_future<ThreadPool::VoidTy>
+ThreadPool::asyncImpl(TaskTy Task, ThreadPoolTaskGroup *Group) {
   /// Wrap the Task in a packaged_task to return a future object.
   PackagedTaskTy PackagedTask(std::move(Task));
   auto Future = PackagedTask.get_future();
-  {
-    // Lock the queue and push the new task
-    std::unique_lock<std::mutex> LockGuard(QueueLock);
 
-    // Don't allow enqueueing after disabling the pool
-    assert(EnableFlag && "Queuing a thread during ThreadPool destruction");
+  // Don't allow enqueueing after disabling the pool
+  assert(EnableFlag && "Queuing a thread during ThreadPool destruction");
+
+  ++OutstandingTasks;
+  if (Group)
+    ++Group->PendingTasks;
+  ++QueuedTasks;
+
+  // Tasks spawned by a pool thread stay local to that thread, others are
+  // spread over all the queues.
+  WorkerQueue *Queue = CurrentQueue.get();
+  if (!Queue)
+    Queue = Queues[NextQueue++ % Queues.size()].get();
+  {
+    std::unique_lock<std::mutex> LockGuard(Queue->Lock);
+    Queue->Tasks.push_back(
+        {std::move(PackagedTask), Group, cl::OptionContext::getCurrent()});
+  }
 
-    Tasks.push(std::move(PackagedTask));
+  // Only pay for the lock when somebody may be sleeping.
+  if (IdleThreads) {
+    {
+      std::unique_lock<std::mutex> LockGuard(SleepLock);
+    }
+    WorkCondition.notify_one();
   }
-  QueueCondition.notify_one();
   return Future.share();
 }
 
 // The destructor joins all threads, waiting for completion.
 ThreadPool::~ThreadPool() {
+  wait();
   {
-    std::unique_lock<std::mutex> LockGuard(QueueLock);
+    std::unique_lock<std::mutex> LockGuard(SleepLock);
     EnableFlag = false;
   }
-  QueueCondition.notify_all();
+  WorkCondition.notify_all();
   for (auto &Worker : Threads)
     Worker.join();
 }
@@ -113,7 +223,7 @@ ThreadPool::ThreadPool() : ThreadPool(0) {}
 
 // No threads are launched, issue a warning if ThreadCount is not 0
 ThreadPool::ThreadPool(unsigned ThreadCount)
-    : ActiveThreads(0) {
+    : ThreadCount(0), OutstandingTasks(0) {
   if (ThreadCount) {
     errs() << "Warning: request a ThreadPool with " << ThreadCount
            << " threads, but LLVM_ENABLE_THREADS has been turned off\n";
@@ -125,15 +235,22 @@ void ThreadPool::wait() {
   while (!Tasks.empty()) {
     auto Task = std::move(Tasks.front());
     Tasks.pop();
-#ifndef _MSC_VER
-        Task();
-#else
-        Task(/* unused */ false);
-#endif
+    runTask(Task);
+  }
+}
+
+void ThreadPool::waitForGroup(ThreadPoolTaskGroup &Group) {
+  // Run tasks in submission order until the group is done; tasks of other
+  // groups queued in between are executed as well.
+  while (Group.PendingTasks && !Tasks.empty()) {
+    auto Task = std::move(Tasks.front());
+    Tasks.pop();
+    runTask(Task);
   }
 }
 
-std::shared_future<ThreadPool::VoidTy> ThreadPool::asyncImpl(TaskTy Task) {
+std::shared_future<ThreadPool::VoidTy>
+ThreadPool::asyncImpl(TaskTy Task, ThreadPoolTaskGroup *Group) {
 #ifndef _MSC_VER
   // Get a Future with launch::deferred execution using std::async
   auto Future = std::async(std::launch::deferred, std::move(Task)).share();
@@ -144,7 +261,11 @@ std::shared_future<ThreadPool::VoidTy> ThreadPool::asyncImpl(TaskTy Task) {
   auto Future = std::async(std::launch::deferred, std::move(Task), false).share();
   PackagedTaskTy PackagedTask([Future](bool) -> bool { Future.get(); return false; });
 #endif
-  Tasks.push(std::move(PackagedTask));
+  ++OutstandingTasks;
+  if (Group)
+    ++Group->PendingTasks;
+  Tasks.push(
+      {std::move(PackagedTask), Group, cl::OptionContext::getCurrent()});
   return Future;
 }
 
@@ -0,0 +1,76 @@
+//===-- TraceEvents.cpp - Trace event recording ---------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Trace events are written as complete ("X") events of the Chrome trace event
+// format, which chrome://tracing and other trace viewers can display.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/TraceEvents.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+
+using namespace llvm;
+
+TraceEventRecorder::TraceEventRecorder() : Start(Clock::now()) {}
+
+void TraceEventRecorder::addEvent(StringRef Name, StringRef Category,
+                                  StringRef Detail, Clock::time_point Begin,
+                                  Clock::time_point End, int64_t MemDelta) {
+  std::thread::id Thread = std::this_thread::get_id();
+  sys::SmartScopedLock<true> L(Lock);
+  auto I = std::find(Threads.begin(), Threads.end(), Thread);
+  unsigned ThreadIndex = I - Threads.begin();
+  if (I == Threads.end())
+    Threads.push_back(Thread);
+  Events.push_back({Name, Category, Detail, Begin, End, MemDelta, ThreadIndex});
+}
+
+void TraceEventRecorder::write(raw_ostream &OS) const {
+  typedef std::chrono::microseconds Micros;
+  sys::SmartScopedLock<true> L(Lock);
+  OS << "{\"traceEvents\":[";
+  for (unsigned I = 0, E = Events.size(); I != E; ++I) {
+    const Event &Ev = Events[I];
+    OS << (I ? ",\n" : "\n") << "{\"name\":";
+    OS.write_json_string(Ev.Name);
+    OS << ",\"cat\":";
+    OS.write_json_string(Ev.Category);
+    OS << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << Ev.ThreadIndex
+       << ",\"ts\":"
+       << std::chrono::duration_cast<Micros>(Ev.Begin - Start).count()
+       << ",\"dur\":"
+       << std::chrono::duration_cast<Micros>(Ev.End - Ev.Begin).count()
+       << ",\"args\":{\"detail\":";
+    OS.write_json_string(Ev.Detail);
+    OS << ",\"mem_delta\":" << Ev.MemDelta << "}}";
+  }
+  OS << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+TraceRegion::TraceRegion(TraceEventRecorder *Recorder, StringRef Name,
+                         StringRef Category, StringRef Detail)
+    : Recorder(Recorder), Name(Name), Category(Category) {
+  if (!Recorder)
+    return;
+  this->Detail = Detail;
+  // The memory is measured first, so that it isn't counted in the duration.
+  MemBegin = sys::Process::GetMallocUsage();
+  Begin = TraceEventRecorder::Clock::now();
+}
+
+TraceRegion::~TraceRegion() {
+  if (!Recorder)
+    return;
+  TraceEventRecorder::Clock::time_point End = TraceEventRecorder::Clock::now();
+  int64_t MemDelta =
+      int64_t(sys::Process::GetMallocUsage()) - int64_t(MemBegin);
+  Recorder->addEvent(Name, Category, Detail, Begin, End, MemDelta);
+}
@@ -139,8 +139,9 @@ struct Token : ilist_node<Token> {
   /// of the token in the input.
   StringRef Range;
 
-  /// The value of a block scalar node.
-  std::string Value;
+  /// The value of a block scalar node. It points into the scanner's allocator,
+  /// so that tokens are cheap to copy.
+  StringRef Value;
 
   Token() : Kind(TK_Error) {}
 };
@@ -564,6 +565,10 @@ private:
 
   /// @brief Potential simple keys.
   SmallVector<SimpleKey, 4> SimpleKeys;
+
+  /// @brief Storage for the values of block scalars, which are the only
+  ///        values that are not a range of the input.
+  BumpPtrAllocator ValueAllocator;
 };
 
 } // end namespace yaml
@@ -1641,7 +1646,12 @@ bool Scanner::scanBlockScalar(bool IsLiteral) {
   Token T;
   T.Kind = Token::TK_BlockScalar;
   T.Range = StringRef(Start, Current - Start);
-  T.Value = Str.str().str();
+  // Copy the value once, null-terminated, for the lifetime of the scanner.
+  // The nodes and the users of the stream refer to this copy.
+  char *Value = ValueAllocator.Allocate<char>(Str.size() + 1);
+  memcpy(Value, Str.data(), Str.size());
+  Value[Str.size()] = '\0';
+  T.Value = StringRef(Value, Str.size());
   TokenQueue.push_back(T);
   return true;
 }
@@ -1868,7 +1878,7 @@ Node *Node::parseBlockNode() {
 }
 
 BumpPtrAllocator &Node::getAllocator() {
-  return Doc->NodeAllocator;
+  return Doc->getNodeAllocator();
 }
 
 void Node::setError(const Twine &Msg, Token &Tok) const {
@@ -2301,6 +2311,29 @@ bool Document::failed() const {
   return stream.scanner->failed();
 }
 
+void Document::pushNodeRegion() {
+  NodeRegions.emplace_back();
+}
+
+void Document::advanceNodeRegion() {
+  assert(!NodeRegions.empty() && "No node region to advance!");
+  NodeRegion &R = NodeRegions.back();
+  R.Current ^= 1;
+  R.Halves[R.Current].Reset();
+}
+
+void Document::popNodeRegion() {
+  assert(!NodeRegions.empty() && "No node region to pop!");
+  NodeRegions.pop_back();
+}
+
+BumpPtrAllocator &Document::getNodeAllocator() {
+  if (NodeRegions.empty())
+    return NodeAllocator;
+  NodeRegion &R = NodeRegions.back();
+  return R.Halves[R.Current];
+}
+
 Node *Document::parseBlockNode() {
   Token T = peekNext();
   // Handle properties.
@@ -2310,7 +2343,8 @@ parse_property:
   switch (T.Kind) {
   case Token::TK_Alias:
     getNext();
-    return new (NodeAllocator) AliasNode(stream.CurrentDoc, T.Range.substr(1));
+    return new (getNodeAllocator())
+        AliasNode(stream.CurrentDoc, T.Range.substr(1));
   case Token::TK_Anchor:
     if (AnchorInfo.Kind == Token::TK_Anchor) {
       setError("Already encountered an anchor for this node!", T);
@@ -2336,56 +2370,54 @@ parse_property:
     // We got an unindented BlockEntry sequence. This is not terminated with
     // a BlockEnd.
     // Don't eat the TK_BlockEntry, SequenceNode needs it.
-    return new (NodeAllocator) SequenceNode( stream.CurrentDoc
+    return new (getNodeAllocator()) SequenceNode( stream.CurrentDoc
                                            , AnchorInfo.Range.substr(1)
                                            , TagInfo.Range
                                            , SequenceNode::ST_Indentless);
   case Token::TK_BlockSequenceStart:
     getNext();
-    return new (NodeAllocator)
+    return new (getNodeAllocator())
       SequenceNode( stream.CurrentDoc
                   , AnchorInfo.Range.substr(1)
                   , TagInfo.Range
                   , SequenceNode::ST_Block);
   case Token::TK_BlockMappingStart:
     getNext();
-    return new (NodeAllocator)
+    return new (getNodeAllocator())
       MappingNode( stream.CurrentDoc
                  , AnchorInfo.Range.substr(1)
                  , TagInfo.Range
                  , MappingNode::MT_Block);
   case Token::TK_FlowSequenceStart:
     getNext();
-    return new (NodeAllocator)
+    return new (getNodeAllocator())
       SequenceNode( stream.CurrentDoc
                   , AnchorInfo.Range.substr(1)
                   , TagInfo.Range
                   , SequenceNode::ST_Flow);
   case Token::TK_FlowMappingStart:
     getNext();
-    return new (NodeAllocator)
+    return new (getNodeAllocator())
       MappingNode( stream.CurrentDoc
                  , AnchorInfo.Range.substr(1)
                  , TagInfo.Range
                  , MappingNode::MT_Flow);
   case Token::TK_Scalar:
     getNext();
-    return new (NodeAllocator)
+    return new (getNodeAllocator())
       ScalarNode( stream.CurrentDoc
                 , AnchorInfo.Range.substr(1)
                 , TagInfo.Range
                 , T.Range);
   case Token::TK_BlockScalar: {
     getNext();
-    StringRef NullTerminatedStr(T.Value.c_str(), T.Value.length() + 1);
-    StringRef StrCopy = NullTerminatedStr.copy(NodeAllocator).drop_back();
-    return new (NodeAllocator)
+    return new (getNodeAllocator())
         BlockScalarNode(stream.CurrentDoc, AnchorInfo.Range.substr(1),
-                        TagInfo.Range, StrCopy, T.Range);
+                        TagInfo.Range, T.Value, T.Range);
   }
   case Token::TK_Key:
     // Don't eat the TK_Key, KeyValueNode expects it.
-    return new (NodeAllocator)
+    return new (getNodeAllocator())
       MappingNode( stream.CurrentDoc
                  , AnchorInfo.Range.substr(1)
                  , TagInfo.Range
@@ -2396,7 +2428,7 @@ parse_property:
   default:
     // TODO: Properly handle tags. "[!!str ]" should resolve to !!str "", not
     //       !!null null.
-    return new (NodeAllocator) NullNode(stream.CurrentDoc);
+    return new (getNodeAllocator()) NullNode(stream.CurrentDoc);
   case Token::TK_Error:
     return nullptr;
   }
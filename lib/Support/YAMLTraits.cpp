@@ -18,6 +18,7 @@
 #include "llvm/Support/YAMLParser.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cctype>
+#include <climits>
 #include <cstring>
 using namespace llvm;
 using namespace yaml;
@@ -50,7 +51,8 @@ Input::Input(StringRef InputContent,
              void *DiagHandlerCtxt)
   : IO(Ctxt),
     Strm(new Stream(InputContent, SrcMgr)),
-    CurrentNode(nullptr) {
+    CurrentNode(nullptr),
+    Streaming(false) {
   if (DiagHandler)
     SrcMgr.setDiagHandler(DiagHandler, DiagHandlerCtxt);
   DocIterator = Strm->begin();
@@ -86,7 +88,7 @@ bool Input::setCurrentDocument() {
       ++DocIterator;
       return setCurrentDocument();
     }
-    TopNode = this->createHNodes(N);
+    TopNode = Streaming ? createStreamingHNode(N) : createHNodes(N);
     CurrentNode = TopNode.get();
     return true;
   }
@@ -94,6 +96,8 @@ bool Input::setCurrentDocument() {
 }
 
 bool Input::nextDocument() {
+  if (TopNode)
+    finishStreamingNode(TopNode.get());
   return ++DocIterator != Strm->end();
 }
 
@@ -141,8 +145,11 @@ bool Input::preflightKey(const char *Key, bool Required, bool, bool &UseDefault,
     return false;
   }
   MN->ValidKeys.push_back(Key);
-  HNode *Value = MN->Mapping[Key].get();
+  HNode *Value =
+      MN->IsStreaming ? readStreamingKey(MN, Key) : MN->Mapping[Key].get();
   if (!Value) {
+    if (EC)
+      return false;
     if (Required)
       setError(CurrentNode, Twine("missing required key '") + Key + "'");
     else
@@ -168,9 +175,32 @@ void Input::endMapping() {
   for (const auto &NN : MN->Mapping) {
     if (!MN->isValidKey(NN.first())) {
       setError(NN.second.get(), Twine("unknown key '") + NN.first() + "'");
-      break;
+      return;
     }
   }
+  if (!MN->IsStreaming)
+    return;
+
+  // Check the keys which were not read, skipping their values.
+  if (MN->ActiveValue) {
+    finishStreamingNode(MN->ActiveValue);
+    MN->ActiveValue = nullptr;
+    ++MN->NextEntry;
+  }
+  SmallString<128> StringStorage;
+  for (; !EC && MN->NextEntry != MappingNode::iterator(); ++MN->NextEntry) {
+    StringRef KeyStr = getKeyString(*MN->NextEntry, StringStorage);
+    if (EC)
+      break;
+    // The keys mapped were all read, so a valid key is a duplicate.
+    if (MN->Mapping.count(KeyStr))
+      setError(MN->NextEntry->getKey(),
+               Twine("duplicated mapping key '") + KeyStr + "'");
+    else if (!MN->isValidKey(KeyStr))
+      setError(MN->NextEntry->getKey(),
+               Twine("unknown key '") + KeyStr + "'");
+  }
+  MN->IsStreaming = false;
 }
 
 void Input::beginFlowMapping() { beginMapping(); }
@@ -178,8 +208,14 @@ void Input::beginFlowMapping() { beginMapping(); }
 void Input::endFlowMapping() { endMapping(); }
 
 unsigned Input::beginSequence() {
-  if (SequenceHNode *SQ = dyn_cast<SequenceHNode>(CurrentNode))
+  if (SequenceHNode *SQ = dyn_cast<SequenceHNode>(CurrentNode)) {
+    // The length of a streamed sequence is only known at its end. Return the
+    // UINT_MAX sentinel (see IO::beginSequence) and let yamlize read elements
+    // until preflightElement runs out of them.
+    if (SQ->IsStreaming)
+      return UINT_MAX;
     return SQ->Entries.size();
+  }
   if (isa<EmptyHNode>(CurrentNode))
     return 0;
   // Treat case where there's a scalar "null" value as an empty sequence.
@@ -193,14 +229,20 @@ unsigned Input::beginSequence() {
 }
 
 void Input::endSequence() {
+  if (SequenceHNode *SQ = dyn_cast_or_null<SequenceHNode>(CurrentNode))
+    finishStreamingNode(SQ);
 }
 
 bool Input::preflightElement(unsigned Index, void *&SaveInfo) {
   if (EC)
     return false;
   if (SequenceHNode *SQ = dyn_cast<SequenceHNode>(CurrentNode)) {
+    HNode *Entry =
+        SQ->IsStreaming ? readStreamingElement(SQ) : SQ->Entries[Index].get();
+    if (!Entry)
+      return false;
     SaveInfo = CurrentNode;
-    CurrentNode = SQ->Entries[Index].get();
+    CurrentNode = Entry;
     return true;
   }
   return false;
@@ -213,22 +255,14 @@ void Input::postflightElement(void *SaveInfo) {
 unsigned Input::beginFlowSequence() { return beginSequence(); }
 
 bool Input::preflightFlowElement(unsigned index, void *&SaveInfo) {
-  if (EC)
-    return false;
-  if (SequenceHNode *SQ = dyn_cast<SequenceHNode>(CurrentNode)) {
-    SaveInfo = CurrentNode;
-    CurrentNode = SQ->Entries[index].get();
-    return true;
-  }
-  return false;
+  return preflightElement(index, SaveInfo);
 }
 
 void Input::postflightFlowElement(void *SaveInfo) {
   CurrentNode = reinterpret_cast<HNode *>(SaveInfo);
 }
 
-void Input::endFlowSequence() {
-}
+void Input::endFlowSequence() { endSequence(); }
 
 void Input::beginEnumScalar() {
   ScalarMatchFound = false;
@@ -262,6 +296,8 @@ void Input::endEnumScalar() {
 bool Input::beginBitSetScalar(bool &DoClear) {
   BitValuesUsed.clear();
   if (SequenceHNode *SQ = dyn_cast<SequenceHNode>(CurrentNode)) {
+    if (SQ->IsStreaming)
+      readAllStreamingElements(SQ);
     BitValuesUsed.insert(BitValuesUsed.begin(), SQ->Entries.size(), false);
   } else {
     setError(CurrentNode, "expected sequence of bit values");
@@ -336,8 +372,8 @@ std::unique_ptr<Input::HNode> Input::createHNodes(Node *N) {
     }
     return llvm::make_unique<ScalarHNode>(N, KeyStr);
   } else if (BlockScalarNode *BSN = dyn_cast<BlockScalarNode>(N)) {
-    StringRef ValueCopy = BSN->getValue().copy(StringAllocator);
-    return llvm::make_unique<ScalarHNode>(N, ValueCopy);
+    // The value of a block scalar lives as long as the stream.
+    return llvm::make_unique<ScalarHNode>(N, BSN->getValue());
   } else if (SequenceNode *SQ = dyn_cast<SequenceNode>(N)) {
     auto SQHNode = llvm::make_unique<SequenceHNode>(N);
     for (Node &SN : *SQ) {
@@ -350,17 +386,17 @@ std::unique_ptr<Input::HNode> Input::createHNodes(Node *N) {
   } else if (MappingNode *Map = dyn_cast<MappingNode>(N)) {
     auto mapHNode = llvm::make_unique<MapHNode>(N);
     for (KeyValueNode &KVN : *Map) {
-      Node *KeyNode = KVN.getKey();
-      ScalarNode *KeyScalar = dyn_cast<ScalarNode>(KeyNode);
-      if (!KeyScalar) {
-        setError(KeyNode, "Map key must be a scalar");
+      StringRef KeyStr = getKeyString(KVN, StringStorage);
+      if (EC)
+        break;
+      // From YAML spec: "The content of a mapping node is an unordered set
+      // of key/value node pairs, with the restriction that each of the keys
+      // is unique." When reading the whole tree the last value is kept, but a
+      // streamed mapping may already have mapped the first one.
+      if (Streaming && mapHNode->Mapping.count(KeyStr)) {
+        setError(KVN.getKey(),
+                 Twine("duplicated mapping key '") + KeyStr + "'");
         break;
-      }
-      StringStorage.clear();
-      StringRef KeyStr = KeyScalar->getValue(StringStorage);
-      if (!StringStorage.empty()) {
-        // Copy string to permanent storage
-        KeyStr = StringStorage.str().copy(StringAllocator);
       }
       auto ValueHNode = this->createHNodes(KVN.getValue());
       if (EC)
@@ -376,6 +412,146 @@ std::unique_ptr<Input::HNode> Input::createHNodes(Node *N) {
   }
 }
 
+std::unique_ptr<Input::HNode> Input::createStreamingHNode(Node *N) {
+  if (SequenceNode *SQ = dyn_cast<SequenceNode>(N)) {
+    auto SQHNode = llvm::make_unique<SequenceHNode>(N);
+    // The nodes of the elements are released as the elements are read.
+    (*DocIterator).pushNodeRegion();
+    SQHNode->HasNodeRegion = true;
+    SQHNode->NextEntry = SQ->begin();
+    SQHNode->IsStreaming = true;
+    return std::move(SQHNode);
+  } else if (MappingNode *Map = dyn_cast<MappingNode>(N)) {
+    auto mapHNode = llvm::make_unique<MapHNode>(N);
+    mapHNode->NextEntry = Map->begin();
+    mapHNode->IsStreaming = true;
+    return std::move(mapHNode);
+  }
+  return createHNodes(N);
+}
+
+Input::HNode *Input::readStreamingKey(MapHNode *MN, StringRef Key) {
+  auto I = MN->Mapping.find(Key);
+  if (I != MN->Mapping.end())
+    return I->second.get();
+
+  if (MN->ActiveValue) {
+    finishStreamingNode(MN->ActiveValue);
+    MN->ActiveValue = nullptr;
+    ++MN->NextEntry;
+  }
+  // Read up to the key, keeping the entries before it for later lookups.
+  SmallString<128> StringStorage;
+  for (; !EC && MN->NextEntry != MappingNode::iterator(); ++MN->NextEntry) {
+    KeyValueNode &KVN = *MN->NextEntry;
+    StringRef KeyStr = getKeyString(KVN, StringStorage);
+    if (EC)
+      break;
+    if (KeyStr == Key) {
+      auto ValueHNode = createStreamingHNode(KVN.getValue());
+      if (EC)
+        break;
+      MN->ActiveValue = ValueHNode.get();
+      MN->Mapping[KeyStr] = std::move(ValueHNode);
+      return MN->ActiveValue;
+    }
+    if (MN->Mapping.count(KeyStr)) {
+      setError(KVN.getKey(), Twine("duplicated mapping key '") + KeyStr + "'");
+      break;
+    }
+    auto ValueHNode = createHNodes(KVN.getValue());
+    if (EC)
+      break;
+    MN->Mapping[KeyStr] = std::move(ValueHNode);
+  }
+  return nullptr;
+}
+
+Input::HNode *Input::readStreamingElement(SequenceHNode *SQ) {
+  // Release the previous element before reading the next one. Moving to the
+  // next element still reads the nodes of the previous one, so they are only
+  // released with the element after.
+  if (!SQ->Entries.empty()) {
+    finishStreamingNode(SQ->Entries.back().get());
+    SQ->Entries.clear();
+    if (EC)
+      return nullptr;
+    (*DocIterator).advanceNodeRegion();
+    ++SQ->NextEntry;
+  }
+  if (EC || SQ->NextEntry == SequenceNode::iterator())
+    return nullptr;
+  auto Entry = createStreamingHNode(&*SQ->NextEntry);
+  if (EC)
+    return nullptr;
+  SQ->Entries.push_back(std::move(Entry));
+  return SQ->Entries.back().get();
+}
+
+void Input::readAllStreamingElements(SequenceHNode *SQ) {
+  assert(SQ->Entries.empty() && "Sequence already partially read");
+  // All the elements are kept, and their nodes with them, until the sequence
+  // is finished.
+  for (; !EC && SQ->NextEntry != SequenceNode::iterator(); ++SQ->NextEntry) {
+    auto Entry = createHNodes(&*SQ->NextEntry);
+    if (EC)
+      break;
+    SQ->Entries.push_back(std::move(Entry));
+  }
+  SQ->IsStreaming = false;
+}
+
+void Input::finishStreamingNode(HNode *N) {
+  // After an error, the parser is left where the error occurred.
+  if (EC)
+    return;
+  if (MapHNode *MN = dyn_cast<MapHNode>(N)) {
+    if (!MN->IsStreaming)
+      return;
+    if (MN->ActiveValue) {
+      finishStreamingNode(MN->ActiveValue);
+      MN->ActiveValue = nullptr;
+      ++MN->NextEntry;
+    }
+    while (MN->NextEntry != MappingNode::iterator())
+      ++MN->NextEntry;
+    MN->IsStreaming = false;
+  } else if (SequenceHNode *SQ = dyn_cast<SequenceHNode>(N)) {
+    if (SQ->IsStreaming) {
+      if (!SQ->Entries.empty()) {
+        finishStreamingNode(SQ->Entries.back().get());
+        SQ->Entries.clear();
+        if (EC)
+          return;
+        (*DocIterator).advanceNodeRegion();
+        ++SQ->NextEntry;
+      }
+      while (SQ->NextEntry != SequenceNode::iterator()) {
+        (*DocIterator).advanceNodeRegion();
+        ++SQ->NextEntry;
+      }
+      SQ->IsStreaming = false;
+    }
+    if (SQ->HasNodeRegion) {
+      SQ->Entries.clear();
+      (*DocIterator).popNodeRegion();
+      SQ->HasNodeRegion = false;
+    }
+  }
+}
+
+StringRef Input::getKeyString(KeyValueNode &KVN,
+                              SmallVectorImpl<char> &Storage) {
+  Node *KeyNode = KVN.getKey();
+  ScalarNode *KeyScalar = dyn_cast<ScalarNode>(KeyNode);
+  if (!KeyScalar) {
+    setError(KeyNode, "Map key must be a scalar");
+    return StringRef();
+  }
+  Storage.clear();
+  return KeyScalar->getValue(Storage);
+}
+
 bool Input::MapHNode::isValidKey(StringRef Key) {
   for (const char *K : ValidKeys) {
     if (Key.equals(K))
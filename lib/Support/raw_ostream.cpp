@@ -109,20 +109,97 @@ void raw_ostream::SetBufferAndMode(char *BufferStart, size_t Size,
   assert(OutBufStart <= OutBufEnd && "Invalid size!");
 }
 
-raw_ostream &raw_ostream::operator<<(unsigned long N) {
-  // Zero is a special case.
-  if (N == 0)
-    return *this << '0';
+// The decimal representations of 0 to 99, to convert numbers two digits at a
+// time.
+static const char DigitPairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static const char HexDigitsLower[] = "0123456789abcdef";
+static const char HexDigitsUpper[] = "0123456789ABCDEF";
+
+/// Return the number of decimal digits of \p N, one for zero.
+static unsigned getNumDecimalDigits(uint64_t N) {
+  static const uint64_t PowersOf10[] = {
+      0,
+      10ULL,
+      100ULL,
+      1000ULL,
+      10000ULL,
+      100000ULL,
+      1000000ULL,
+      10000000ULL,
+      100000000ULL,
+      1000000000ULL,
+      10000000000ULL,
+      100000000000ULL,
+      1000000000000ULL,
+      10000000000000ULL,
+      100000000000000ULL,
+      1000000000000000ULL,
+      10000000000000000ULL,
+      100000000000000000ULL,
+      1000000000000000000ULL,
+      10000000000000000000ULL};
+  // Estimate the number of digits from the number of bits (1233 / 4096 is
+  // close to log10(2)) and correct the estimate, which may be one too low.
+  unsigned Log10 = unsigned((64 - countLeadingZeros(N | 1)) * 1233) >> 12;
+  return Log10 + 1 - (N < PowersOf10[Log10]);
+}
+
+/// Write the decimal digits of \p N backwards from \p End.
+template <typename T> static void formatDecimal(char *End, T N) {
+  while (N >= 100) {
+    unsigned Pair = unsigned(N % 100) * 2;
+    N /= 100;
+    *--End = DigitPairs[Pair + 1];
+    *--End = DigitPairs[Pair];
+  }
+  if (N >= 10) {
+    *--End = DigitPairs[N * 2 + 1];
+    *--End = DigitPairs[N * 2];
+  } else {
+    *--End = char('0' + N);
+  }
+}
 
-  char NumberBuffer[20];
-  char *EndPtr = NumberBuffer+sizeof(NumberBuffer);
-  char *CurPtr = EndPtr;
+/// Write the last \p NumDigits hexadecimal digits of \p N backwards from
+/// \p End.
+static void formatHex(char *End, uint64_t N, unsigned NumDigits,
+                      const char *Digits) {
+  for (unsigned I = 0; I != NumDigits; ++I) {
+    *--End = Digits[N & 15];
+    N >>= 4;
+  }
+}
 
-  while (N) {
-    *--CurPtr = '0' + char(N % 10);
-    N /= 10;
+raw_ostream &raw_ostream::write_digits(uint64_t N, unsigned NumDigits) {
+  // Format directly into the buffer when it has room, using 32-bit divisions
+  // when possible.
+  char NumberBuffer[20];
+  bool Direct = size_t(OutBufEnd - OutBufCur) >= NumDigits;
+  char *End = (Direct ? OutBufCur : NumberBuffer) + NumDigits;
+  if (N == uint32_t(N))
+    formatDecimal(End, uint32_t(N));
+  else
+    formatDecimal(End, N);
+  if (LLVM_LIKELY(Direct)) {
+    OutBufCur = End;
+    return *this;
   }
-  return write(CurPtr, EndPtr-CurPtr);
+  return write(NumberBuffer, NumDigits);
+}
+
+raw_ostream &raw_ostream::operator<<(unsigned long N) {
+  return write_digits(N, getNumDecimalDigits(N));
 }
 
 raw_ostream &raw_ostream::operator<<(long N) {
@@ -136,19 +213,7 @@ raw_ostream &raw_ostream::operator<<(long N) {
 }
 
 raw_ostream &raw_ostream::operator<<(unsigned long long N) {
-  // Output using 32-bit div/mod when possible.
-  if (N == static_cast<unsigned long>(N))
-    return this->operator<<(static_cast<unsigned long>(N));
-
-  char NumberBuffer[20];
-  char *EndPtr = std::end(NumberBuffer);
-  char *CurPtr = EndPtr;
-
-  while (N) {
-    *--CurPtr = '0' + char(N % 10);
-    N /= 10;
-  }
-  return write(CurPtr, EndPtr-CurPtr);
+  return write_digits(N, getNumDecimalDigits(N));
 }
 
 raw_ostream &raw_ostream::operator<<(long long N) {
@@ -162,21 +227,17 @@ raw_ostream &raw_ostream::operator<<(long long N) {
 }
 
 raw_ostream &raw_ostream::write_hex(unsigned long long N) {
-  // Zero is a special case.
-  if (N == 0)
-    return *this << '0';
-
-  char NumberBuffer[16];
-  char *EndPtr = std::end(NumberBuffer);
-  char *CurPtr = EndPtr;
-
-  while (N) {
-    unsigned char x = static_cast<unsigned char>(N) % 16;
-    *--CurPtr = hexdigit(x, /*LowerCase*/true);
-    N /= 16;
+  // Zero is written as a single digit.
+  unsigned NumDigits = N ? (64 - countLeadingZeros(N) + 3) / 4 : 1;
+  if (LLVM_LIKELY(size_t(OutBufEnd - OutBufCur) >= NumDigits)) {
+    OutBufCur += NumDigits;
+    formatHex(OutBufCur, N, NumDigits, HexDigitsLower);
+    return *this;
   }
 
-  return write(CurPtr, EndPtr-CurPtr);
+  char NumberBuffer[16];
+  formatHex(NumberBuffer + NumDigits, N, NumDigits, HexDigitsLower);
+  return write(NumberBuffer, NumDigits);
 }
 
 raw_ostream &raw_ostream::write_escaped(StringRef Str,
@@ -219,6 +280,19 @@ raw_ostream &raw_ostream::write_escaped(StringRef Str,
   return *this;
 }
 
+raw_ostream &raw_ostream::write_json_string(StringRef Str) {
+  *this << '"';
+  for (unsigned char c : Str) {
+    if (c == '"' || c == '\\')
+      *this << '\\' << c;
+    else if (c < 0x20)
+      *this << "\\u00" << hexdigit(c >> 4, true) << hexdigit(c & 0xF, true);
+    else
+      *this << c;
+  }
+  return *this << '"';
+}
+
 raw_ostream &raw_ostream::operator<<(const void *P) {
   *this << '0' << 'x';
 
@@ -415,67 +489,62 @@ raw_ostream &raw_ostream::operator<<(const FormattedNumber &FN) {
     unsigned PrefixChars = FN.HexPrefix ? 2 : 0;
     unsigned Width = std::max(FN.Width, Nibbles + PrefixChars);
 
-    char NumberBuffer[20] = "0x0000000000000000";
-    if (!FN.HexPrefix)
-      NumberBuffer[1] = '0';
-    char *EndPtr = NumberBuffer+Width;
-    char *CurPtr = EndPtr;
-    const char A = FN.Upper ? 'A' : 'a';
-    unsigned long long N = FN.HexValue;
-    while (N) {
-      uintptr_t x = N % 16;
-      *--CurPtr = (x < 10 ? '0' + x : A + x - 10);
-      N /= 16;
+    if (FN.HexPrefix)
+      *this << '0' << 'x';
+    // Pad with zeros past the 16 digits of the value.
+    unsigned NumDigits = Width - PrefixChars;
+    if (NumDigits > 16) {
+      write_fill('0', NumDigits - 16);
+      NumDigits = 16;
     }
 
-    return write(NumberBuffer, Width);
+    char NumberBuffer[16];
+    formatHex(NumberBuffer + NumDigits, FN.HexValue, NumDigits,
+              FN.Upper ? HexDigitsUpper : HexDigitsLower);
+    return write(NumberBuffer, NumDigits);
   } else {
-    // Zero is a special case.
-    if (FN.DecValue == 0) {
-      this->indent(FN.Width-1);
-      return *this << '0';
-    }
-    char NumberBuffer[32];
-    char *EndPtr = NumberBuffer+sizeof(NumberBuffer);
-    char *CurPtr = EndPtr;
     bool Neg = (FN.DecValue < 0);
     uint64_t N = Neg ? -static_cast<uint64_t>(FN.DecValue) : FN.DecValue;
-    while (N) {
-      *--CurPtr = '0' + char(N % 10);
-      N /= 10;
-    }
-    int Len = EndPtr - CurPtr;
+    unsigned Len = getNumDecimalDigits(N);
     int Pad = FN.Width - Len;
     if (Neg) 
       --Pad;
     if (Pad > 0)
-      this->indent(Pad);
+      write_fill(' ', Pad);
     if (Neg)
       *this << '-';
-    return write(CurPtr, Len);
+    return write_digits(N, Len);
   }
 }
 
+raw_ostream &raw_ostream::write_fill(char C, unsigned Count) {
+  // Usually the padding fits in the buffer: fill it in place.
+  if (LLVM_LIKELY(size_t(OutBufEnd - OutBufCur) >= Count)) {
+    memset(OutBufCur, C, Count);
+    OutBufCur += Count;
+    return *this;
+  }
 
-/// indent - Insert 'NumSpaces' spaces.
-raw_ostream &raw_ostream::indent(unsigned NumSpaces) {
-  static const char Spaces[] = "                                "
-                               "                                "
-                               "                ";
-
-  // Usually the indentation is small, handle it with a fastpath.
-  if (NumSpaces < array_lengthof(Spaces))
-    return write(Spaces, NumSpaces);
-
-  while (NumSpaces) {
-    unsigned NumToWrite = std::min(NumSpaces,
-                                   (unsigned)array_lengthof(Spaces)-1);
-    write(Spaces, NumToWrite);
-    NumSpaces -= NumToWrite;
+  char Chunk[80];
+  memset(Chunk, C, std::min<unsigned>(Count, sizeof(Chunk)));
+  while (Count) {
+    unsigned NumToWrite = std::min<unsigned>(Count, sizeof(Chunk));
+    write(Chunk, NumToWrite);
+    Count -= NumToWrite;
   }
   return *this;
 }
 
+/// indent - Insert 'NumSpaces' spaces.
+raw_ostream &raw_ostream::indent(unsigned NumSpaces) {
+  return write_fill(' ', NumSpaces);
+}
+
+/// write_zeros - Insert 'NumZeros' nulls.
+raw_ostream &raw_ostream::write_zeros(unsigned NumZeros) {
+  return write_fill(0, NumZeros);
+}
+
 
 //===----------------------------------------------------------------------===//
 //  Formatted Output
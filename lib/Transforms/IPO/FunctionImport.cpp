@@ -70,8 +70,9 @@ public:
       std::unique_ptr<Module>(StringRef FileName)> createLazyModule)
       : createLazyModule(createLazyModule) {}
 
-  /// Retrieve a Module from the cache or lazily load it on demand.
-  Module &operator()(StringRef FileName);
+  /// Retrieve a Module from the cache or lazily load it on demand. Return
+  /// null if the module can't be loaded.
+  Module *operator()(StringRef FileName);
 
   std::unique_ptr<Module> takeModule(StringRef FileName) {
     auto I = ModuleMap.find(FileName);
@@ -82,12 +83,14 @@ public:
   }
 };
 
-// Get a Module for \p FileName from the cache, or load it lazily.
-Module &ModuleLazyLoaderCache::operator()(StringRef Identifier) {
-  auto &Module = ModuleMap[Identifier];
-  if (!Module)
-    Module = createLazyModule(Identifier);
-  return *Module;
+// Get a Module for \p FileName from the cache, or load it lazily. A module
+// that failed to load is not retried.
+Module *ModuleLazyLoaderCache::operator()(StringRef Identifier) {
+  auto I = ModuleMap.find(Identifier);
+  if (I == ModuleMap.end())
+    I = ModuleMap.insert(std::make_pair(Identifier,
+                                        createLazyModule(Identifier))).first;
+  return I->second.get();
 }
 } // anonymous namespace
 
@@ -206,10 +209,16 @@ static void GetImportList(Module &DestModule,
     DEBUG(dbgs() << DestModule.getModuleIdentifier() << ": Importing "
                  << CalledFunctionName << " from " << ModuleIdentifier << "\n");
 
-    auto &SrcModule = ModuleLoaderCache(ModuleIdentifier);
+    Module *SrcModule = ModuleLoaderCache(ModuleIdentifier);
+    if (!SrcModule) {
+      DEBUG(dbgs() << DestModule.getModuleIdentifier() << ": Skip import of "
+                   << CalledFunctionName << ", can't load "
+                   << ModuleIdentifier << "\n");
+      continue;
+    }
 
     // The function that we will import!
-    GlobalValue *SGV = SrcModule.getNamedValue(CalledFunctionName);
+    GlobalValue *SGV = SrcModule->getNamedValue(CalledFunctionName);
 
     if (!SGV) {
       // The destination module is referencing function using their renamed name
@@ -219,12 +228,12 @@ static void GetImportList(Module &DestModule,
       // name in the source module.
       std::pair<StringRef, StringRef> Split =
           CalledFunctionName.split(".llvm.");
-      SGV = SrcModule.getNamedValue(Split.first);
+      SGV = SrcModule->getNamedValue(Split.first);
       assert(SGV && "Can't find function to import in source module");
     }
     if (!SGV) {
       report_fatal_error(Twine("Can't load function '") + CalledFunctionName +
-                         "' in Module '" + SrcModule.getModuleIdentifier() +
+                         "' in Module '" + SrcModule->getModuleIdentifier() +
                          "', error in the summary?\n");
     }
 
@@ -244,12 +253,13 @@ static void GetImportList(Module &DestModule,
                    << ": Ignoring import request for weak-any "
                    << (isa<Function>(SGV) ? "function " : "alias ")
                    << CalledFunctionName << " from "
-                   << SrcModule.getModuleIdentifier() << "\n");
+                   << SrcModule->getModuleIdentifier() << "\n");
       continue;
     }
 
     // Add the function to the import list
-    auto &Entry = ModuleToFunctionsToImportMap[SrcModule.getModuleIdentifier()];
+    auto &Entry =
+        ModuleToFunctionsToImportMap[SrcModule->getModuleIdentifier()];
     Entry.insert(F);
 
     // Process the newly imported functions and add callees to the worklist.
@@ -336,26 +346,18 @@ static void diagnosticHandler(const DiagnosticInfo &DI) {
 }
 
 /// Parse the function index out of an IR file and return the function
-/// index object if found, or nullptr if not.
+/// index object if found, or nullptr if not. A function index table is loaded
+/// lazily, only reading the summaries of the functions considered for import.
 static std::unique_ptr<FunctionInfoIndex>
 getFunctionIndexForFile(StringRef Path, std::string &Error,
                         DiagnosticHandlerFunction DiagnosticHandler) {
-  std::unique_ptr<MemoryBuffer> Buffer;
-  ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr =
-      MemoryBuffer::getFile(Path);
-  if (std::error_code EC = BufferOrErr.getError()) {
-    Error = EC.message();
-    return nullptr;
-  }
-  Buffer = std::move(BufferOrErr.get());
-  ErrorOr<std::unique_ptr<object::FunctionIndexObjectFile>> ObjOrErr =
-      object::FunctionIndexObjectFile::create(Buffer->getMemBufferRef(),
-                                              DiagnosticHandler);
-  if (std::error_code EC = ObjOrErr.getError()) {
+  ErrorOr<std::unique_ptr<FunctionInfoIndex>> IndexOrErr =
+      llvm::getFunctionIndexForFile(Path, DiagnosticHandler);
+  if (std::error_code EC = IndexOrErr.getError()) {
     Error = EC.message();
     return nullptr;
   }
-  return (*ObjOrErr)->takeIndex();
+  return std::move(*IndexOrErr);
 }
 
 namespace {
@@ -0,0 +1,612 @@
+//===- ParallelFunctionPasses.cpp - Run function passes on many threads ---===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements runFunctionPassesInParallel.
+//
+// An LLVMContext can't be used from several threads at once, so every
+// partition of the module is optimized in a context of its own: the module is
+// serialized to bitcode once on the calling thread, and each worker thread
+// reads it lazily, materializing only the bodies of its partition, runs the
+// pipeline over them and serializes the result. The globals, types and
+// metadata of the module are still read by every worker. The calling thread
+// then parses the results back in the original context, in partition order,
+// and moves the optimized bodies into the original functions. Globals created
+// by the passes (library call declarations, string literals...) are recreated
+// in the same order and with the same names a sequential run would give them.
+//
+// Identified struct types and distinct metadata nodes can't be uniqued when a
+// result is parsed back, the reader creates new ones. The calling thread
+// therefore numbers the ones of the original module and tags them with their
+// number in the bitcode it writes for the workers: struct types by name,
+// distinct nodes through a named metadata node. The workers keep the tags in
+// their results, and the calling thread maps the tagged copies back to the
+// original types and nodes. It then clears the names of the copied types so
+// that they don't rename later types.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/IPO/ParallelFunctionPasses.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Metadata.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/TypeFinder.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/ValueMapper.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "parallel-function-passes"
+
+/// Run the pipeline over the whole module on the calling thread, exactly like
+/// a FunctionPassManager driven by hand would.
+static bool runSequentially(Module &M, Module::iterator Begin,
+                            const FunctionPassSetupFn &AddPasses) {
+  legacy::FunctionPassManager FPM(&M);
+  AddPasses(FPM, M);
+  bool Changed = FPM.doInitialization();
+  for (Module::iterator I = Begin, E = M.end(); I != E; ++I)
+    Changed |= FPM.run(*I);
+  Changed |= FPM.doFinalization();
+  return Changed;
+}
+
+/// Returns true if optimizing functions of \p M in separate contexts and
+/// moving them back could produce a different module than a sequential run.
+static bool hasStateSharedAcrossFunctions(Module &M) {
+  // blockaddress constants can't refer to a function whose body was dropped
+  // from a partition, and the blocks they refer to are replaced when the
+  // optimized body is moved back.
+  for (Function &F : M)
+    for (BasicBlock &BB : F)
+      if (BB.hasAddressTaken())
+        return true;
+  return false;
+}
+
+/// Prefix of the names that tag the identified struct types of the original
+/// module, in the module given to the workers and in their results.
+static const char StructTagPrefix[] = "parallel-function-passes.struct.";
+
+/// Name of the named metadata that tags the distinct nodes of the original
+/// module, in the module given to the workers and in their results.
+static const char DistinctNodesTagName[] = "parallel-function-passes.distinct";
+
+/// Returns the identified struct types of \p M, in the order they are tagged.
+static std::vector<StructType *> collectStructTypes(Module &M) {
+  TypeFinder StructTypes;
+  StructTypes.run(M, /*OnlyNamed=*/false);
+  std::vector<StructType *> Result;
+  for (StructType *STy : StructTypes)
+    if (!STy->isLiteral())
+      Result.push_back(STy);
+  return Result;
+}
+
+/// Returns the distinct metadata nodes reachable from the functions and named
+/// metadata of \p M, in the order they are tagged.
+static std::vector<MDNode *> collectDistinctNodes(Module &M) {
+  std::vector<MDNode *> Result;
+  SmallPtrSet<MDNode *, 32> Visited;
+  SmallVector<MDNode *, 16> Worklist;
+  auto Visit = [&](Metadata *MD) {
+    auto *Root = dyn_cast_or_null<MDNode>(MD);
+    if (!Root || !Visited.insert(Root).second)
+      return;
+    Worklist.push_back(Root);
+    while (!Worklist.empty()) {
+      MDNode *N = Worklist.pop_back_val();
+      if (N->isDistinct())
+        Result.push_back(N);
+      for (const MDOperand &Op : N->operands())
+        if (auto *Child = dyn_cast_or_null<MDNode>(Op.get()))
+          if (Visited.insert(Child).second)
+            Worklist.push_back(Child);
+    }
+  };
+
+  SmallVector<std::pair<unsigned, MDNode *>, 4> MDs;
+  for (Function &F : M) {
+    F.getAllMetadata(MDs);
+    for (const auto &MD : MDs)
+      Visit(MD.second);
+    for (BasicBlock &BB : F)
+      for (Instruction &I : BB) {
+        I.getAllMetadata(MDs);
+        for (const auto &MD : MDs)
+          Visit(MD.second);
+        for (const Use &Op : I.operands())
+          if (auto *MAV = dyn_cast<MetadataAsValue>(Op))
+            Visit(MAV->getMetadata());
+      }
+  }
+  for (NamedMDNode &NMD : M.named_metadata())
+    for (MDNode *N : NMD.operands())
+      Visit(N);
+  return Result;
+}
+
+namespace {
+/// A contiguous range of functions of the module, by index.
+struct Partition {
+  unsigned Begin;
+  unsigned End;
+};
+
+/// The outcome of optimizing one partition on a worker thread.
+struct PartitionResult {
+  /// The optimized partition, serialized to bitcode.
+  SmallVector<char, 0> BC;
+  bool Changed = false;
+  /// Set if the passes made module-level changes that can't be moved back,
+  /// e.g. created function definitions.
+  bool Unsupported = false;
+};
+} // end anonymous namespace
+
+/// Split the function definitions of \p M in at most \p Count contiguous
+/// partitions of similar instruction count.
+static std::vector<Partition> partitionModule(Module &M, unsigned Count) {
+  std::vector<uint64_t> Sizes;
+  uint64_t TotalSize = 0;
+  for (Function &F : M) {
+    uint64_t Size = 0;
+    for (BasicBlock &BB : F)
+      Size += BB.size();
+    Sizes.push_back(Size);
+    TotalSize += Size;
+  }
+
+  std::vector<Partition> Partitions;
+  unsigned Begin = 0;
+  uint64_t Accumulated = 0;
+  for (unsigned I = 0, E = Sizes.size(); I != E; ++I) {
+    Accumulated += Sizes[I];
+    // Cut once this partition reached its share of the remaining work.
+    if (Partitions.size() + 1 < Count &&
+        Accumulated * Count >= TotalSize * (Partitions.size() + 1)) {
+      Partitions.push_back({Begin, I + 1});
+      Begin = I + 1;
+    }
+  }
+  if (Begin != Sizes.size())
+    Partitions.push_back({Begin, (unsigned)Sizes.size()});
+  return Partitions;
+}
+
+/// Optimize the functions in \p P of the module serialized in \p BC, in a
+/// private context. Only the bodies of the partition are read, the other
+/// functions stay unmaterialized. Runs on a worker thread.
+static void optimizePartition(StringRef BC, Partition P,
+                              const FunctionPassSetupFn &AddPasses,
+                              PartitionResult &Result) {
+  LLVMContext Ctx;
+  ErrorOr<std::unique_ptr<Module>> MOrErr = getLazyBitcodeModule(
+      MemoryBuffer::getMemBuffer(BC, "<parallel-function-passes>",
+                                 /*RequiresNullTerminator=*/false),
+      Ctx);
+  if (!MOrErr)
+    report_fatal_error("Failed to read bitcode");
+  Module &M = **MOrErr;
+
+  std::vector<Function *> Functions;
+  for (Function &F : M)
+    Functions.push_back(&F);
+  for (unsigned I = P.Begin; I != P.End; ++I)
+    if (std::error_code EC = Functions[I]->materialize())
+      report_fatal_error("Failed to read bitcode: " + EC.message());
+  size_t NumGlobals = M.getGlobalList().size();
+  size_t NumAliases = M.alias_size();
+
+  // The copies of the distinct nodes of the original module, in the order the
+  // calling thread tagged them.
+  NamedMDNode *InputTags = M.getNamedMetadata(DistinctNodesTagName);
+  std::vector<MDNode *> DistinctNodes(InputTags->op_begin(),
+                                      InputTags->op_end());
+  M.eraseNamedMetadata(InputTags);
+
+  legacy::FunctionPassManager FPM(&M);
+  AddPasses(FPM, M);
+  Result.Changed = FPM.doInitialization();
+  for (unsigned I = P.Begin; I != P.End; ++I)
+    Result.Changed |= FPM.run(*Functions[I]);
+  Result.Changed |= FPM.doFinalization();
+
+  // Function passes may add declarations and global variables to the module,
+  // anything else can't be reproduced in the original module.
+  if (M.alias_size() != NumAliases) {
+    Result.Unsupported = true;
+    return;
+  }
+  for (auto I = std::next(M.begin(), Functions.size()), E = M.end(); I != E;
+       ++I)
+    if (!I->isDeclaration()) {
+      Result.Unsupported = true;
+      return;
+    }
+
+  // Only the partition and the new globals are read back, strip everything
+  // else to keep the bitcode small.
+  for (unsigned I = 0, E = Functions.size(); I != E; ++I)
+    if ((I < P.Begin || I >= P.End) && !Functions[I]->isDeclaration())
+      Functions[I]->deleteBody();
+  auto GI = M.global_begin();
+  for (size_t I = 0; I != NumGlobals; ++I, ++GI)
+    if (GI->hasInitializer()) {
+      GI->setInitializer(nullptr);
+      GI->setLinkage(GlobalValue::ExternalLinkage);
+    }
+  // The module flags are kept, the reader strips debug info without them.
+  for (auto NI = M.named_metadata_begin(), NE = M.named_metadata_end();
+       NI != NE;) {
+    NamedMDNode &NMD = *NI++;
+    if (NMD.getName() != "llvm.module.flags")
+      M.eraseNamedMetadata(&NMD);
+  }
+
+  // Tag the distinct nodes of the original module that the result still
+  // refers to. The struct types still carry the tags they were read with.
+  std::vector<MDNode *> Reachable = collectDistinctNodes(M);
+  SmallPtrSet<MDNode *, 32> ReachableSet(Reachable.begin(), Reachable.end());
+  SmallVector<Metadata *, 32> Tags;
+  for (MDNode *N : DistinctNodes)
+    Tags.push_back(ReachableSet.count(N) ? N : nullptr);
+  M.getOrInsertNamedMetadata(DistinctNodesTagName)
+      ->addOperand(MDTuple::getDistinct(Ctx, Tags));
+
+  raw_svector_ostream OS(Result.BC);
+  WriteBitcodeToFile(&M, OS, /*ShouldPreserveUseListOrder=*/true);
+}
+
+namespace {
+/// Maps the types of a partition parsed back in the original context to the
+/// types of the original module. The copies of the original struct types are
+/// found by their tag.
+class PartitionTypeMapper : public ValueMapTypeRemapper {
+  LLVMContext &Ctx;
+  ArrayRef<StructType *> OriginalStructs;
+  DenseMap<Type *, Type *> MappedTypes;
+
+  Type *mapStruct(StructType *STy);
+
+public:
+  PartitionTypeMapper(LLVMContext &Ctx, ArrayRef<StructType *> OriginalStructs)
+      : Ctx(Ctx), OriginalStructs(OriginalStructs) {}
+
+  Type *remapType(Type *Ty) override;
+};
+} // end anonymous namespace
+
+Type *PartitionTypeMapper::mapStruct(StructType *STy) {
+  StringRef Name = STy->getName();
+  unsigned Index;
+  if (!Name.startswith(StructTagPrefix) ||
+      Name.drop_front(sizeof(StructTagPrefix) - 1).getAsInteger(10, Index) ||
+      Index >= OriginalStructs.size())
+    return STy;
+  return OriginalStructs[Index];
+}
+
+Type *PartitionTypeMapper::remapType(Type *Ty) {
+  auto I = MappedTypes.find(Ty);
+  if (I != MappedTypes.end())
+    return I->second;
+
+  Type *Result = Ty;
+  if (auto *STy = dyn_cast<StructType>(Ty)) {
+    if (!STy->isLiteral()) {
+      Result = mapStruct(STy);
+    } else {
+      SmallVector<Type *, 8> Elements;
+      for (Type *ElTy : STy->elements())
+        Elements.push_back(remapType(ElTy));
+      if (!std::equal(Elements.begin(), Elements.end(), STy->element_begin()))
+        Result = StructType::get(Ctx, Elements, STy->isPacked());
+    }
+  } else if (auto *PTy = dyn_cast<PointerType>(Ty)) {
+    Type *ElTy = remapType(PTy->getElementType());
+    if (ElTy != PTy->getElementType())
+      Result = PointerType::get(ElTy, PTy->getAddressSpace());
+  } else if (auto *FTy = dyn_cast<FunctionType>(Ty)) {
+    SmallVector<Type *, 8> Params;
+    for (Type *ParamTy : FTy->params())
+      Params.push_back(remapType(ParamTy));
+    Type *RetTy = remapType(FTy->getReturnType());
+    if (RetTy != FTy->getReturnType() ||
+        !std::equal(Params.begin(), Params.end(), FTy->param_begin()))
+      Result = FunctionType::get(RetTy, Params, FTy->isVarArg());
+  } else if (auto *ATy = dyn_cast<ArrayType>(Ty)) {
+    Type *ElTy = remapType(ATy->getElementType());
+    if (ElTy != ATy->getElementType())
+      Result = ArrayType::get(ElTy, ATy->getNumElements());
+  } else if (auto *VTy = dyn_cast<VectorType>(Ty)) {
+    Type *ElTy = remapType(VTy->getElementType());
+    if (ElTy != VTy->getElementType())
+      Result = VectorType::get(ElTy, VTy->getNumElements());
+  }
+  return MappedTypes[Ty] = Result;
+}
+
+namespace {
+/// Moves optimized partitions back into the original module.
+class PartitionMerger {
+  Module &M;
+
+  /// The globals of the module before optimization. Partitions have the same
+  /// globals, in the same order, followed by the ones created by the passes.
+  std::vector<Function *> Functions;
+  std::vector<GlobalVariable *> Globals;
+  std::vector<GlobalAlias *> Aliases;
+
+  /// Attributes of the declarations before optimization, to detect the ones
+  /// passes inferred attributes for.
+  std::vector<AttributeSet> DeclarationAttributes;
+
+  /// The identified struct types and distinct metadata nodes of the module
+  /// before optimization, numbered as the workers number them.
+  std::vector<StructType *> Structs;
+  std::vector<MDNode *> DistinctNodes;
+
+  Constant *getOrCreateDeclaration(Function &PartF, PartitionTypeMapper &TM);
+  GlobalVariable *createGlobal(GlobalVariable &PartGV, Module &PartM,
+                               PartitionTypeMapper &TM);
+
+public:
+  PartitionMerger(Module &M);
+
+  /// Serialize the original module into \p BC for the workers, with its
+  /// identified struct types and distinct metadata nodes tagged.
+  void writeTaggedBitcode(SmallVectorImpl<char> &BC);
+
+  /// Move the functions in \p P from \p PartM into the original module.
+  void merge(Module &PartM, Partition P);
+};
+} // end anonymous namespace
+
+PartitionMerger::PartitionMerger(Module &M) : M(M) {
+  for (Function &F : M) {
+    Functions.push_back(&F);
+    DeclarationAttributes.push_back(F.isDeclaration() ? F.getAttributes()
+                                                      : AttributeSet());
+  }
+  for (GlobalVariable &GV : M.globals())
+    Globals.push_back(&GV);
+  for (GlobalAlias &GA : M.aliases())
+    Aliases.push_back(&GA);
+
+  Structs = collectStructTypes(M);
+  DistinctNodes = collectDistinctNodes(M);
+}
+
+void PartitionMerger::writeTaggedBitcode(SmallVectorImpl<char> &BC) {
+  // Nothing else uses the context while the module is written, so the struct
+  // types can be renamed and the tags added for the time being.
+  std::vector<std::string> Names;
+  for (unsigned I = 0, E = Structs.size(); I != E; ++I) {
+    Names.push_back(Structs[I]->getName());
+    Structs[I]->setName(StructTagPrefix + utostr(I));
+  }
+  NamedMDNode *Tags = M.getOrInsertNamedMetadata(DistinctNodesTagName);
+  for (MDNode *N : DistinctNodes)
+    Tags->addOperand(N);
+
+  raw_svector_ostream OS(BC);
+  WriteBitcodeToFile(&M, OS, /*ShouldPreserveUseListOrder=*/true);
+
+  M.eraseNamedMetadata(Tags);
+  for (unsigned I = 0, E = Structs.size(); I != E; ++I)
+    Structs[I]->setName(Names[I]);
+}
+
+Constant *PartitionMerger::getOrCreateDeclaration(Function &PartF,
+                                                  PartitionTypeMapper &TM) {
+  auto *FTy = cast<FunctionType>(TM.remapType(PartF.getFunctionType()));
+  // An earlier partition may have created the same declaration already, in
+  // which case the sequential run would have reused it as well.
+  if (GlobalValue *Existing = M.getNamedValue(PartF.getName()))
+    return ConstantExpr::getBitCast(Existing, PointerType::getUnqual(FTy));
+
+  Function *F = Function::Create(FTy, PartF.getLinkage(), PartF.getName(), &M);
+  F->copyAttributesFrom(&PartF);
+  return F;
+}
+
+GlobalVariable *PartitionMerger::createGlobal(GlobalVariable &PartGV,
+                                              Module &PartM,
+                                              PartitionTypeMapper &TM) {
+  auto *GV = new GlobalVariable(
+      M, TM.remapType(PartGV.getValueType()), PartGV.isConstant(),
+      PartGV.getLinkage(), nullptr, "", nullptr, PartGV.getThreadLocalMode(),
+      PartGV.getType()->getAddressSpace());
+  GV->copyAttributesFrom(&PartGV);
+  if (const Comdat *C = PartGV.getComdat()) {
+    Comdat *NewC = M.getOrInsertComdat(C->getName());
+    NewC->setSelectionKind(C->getSelectionKind());
+    GV->setComdat(NewC);
+  }
+
+  // If the name was uniqued when the global was created in the partition,
+  // request the original name again so that the module's symbol table uniques
+  // it the way it would have in a sequential run.
+  StringRef Name = PartGV.getName();
+  size_t Dot = Name.rfind('.');
+  if (Dot != StringRef::npos &&
+      Name.substr(Dot + 1).find_first_not_of("0123456789") ==
+          StringRef::npos &&
+      PartM.getNamedValue(Name.substr(0, Dot)))
+    Name = Name.substr(0, Dot);
+  GV->setName(Name);
+  return GV;
+}
+
+void PartitionMerger::merge(Module &PartM, Partition P) {
+  PartitionTypeMapper TM(M.getContext(), Structs);
+  ValueToValueMapTy VMap;
+
+  // The tagged distinct nodes are copies of the original ones.
+  if (NamedMDNode *Tags = PartM.getNamedMetadata(DistinctNodesTagName)) {
+    auto *Tuple = cast<MDTuple>(Tags->getOperand(0));
+    assert(Tuple->getNumOperands() == DistinctNodes.size() &&
+           "Mismatched partition");
+    for (unsigned I = 0, E = Tuple->getNumOperands(); I != E; ++I)
+      if (Metadata *Copy = Tuple->getOperand(I))
+        VMap.MD()[Copy].reset(DistinctNodes[I]);
+    PartM.eraseNamedMetadata(Tags);
+  }
+
+  // Globals that existed before optimization are at the same position.
+  std::vector<Function *> PartFunctions;
+  auto PFI = PartM.begin();
+  for (unsigned I = 0, E = Functions.size(); I != E; ++I) {
+    Function &PartF = *PFI++;
+    Function *F = Functions[I];
+    assert(PartF.getName() == F->getName() && "Mismatched partition");
+    PartFunctions.push_back(&PartF);
+    VMap[&PartF] = F;
+
+    // Passes may infer attributes for library functions they call.
+    if (PartF.isDeclaration() && F->isDeclaration() &&
+        PartF.getAttributes() != DeclarationAttributes[I])
+      F->setAttributes(PartF.getAttributes());
+  }
+  auto PGI = PartM.global_begin();
+  for (GlobalVariable *GV : Globals) {
+    GlobalVariable &PartGV = *PGI++;
+    VMap[&PartGV] = GV;
+    // Passes may raise the alignment of globals they access.
+    if (PartGV.getAlignment() > GV->getAlignment())
+      GV->setAlignment(PartGV.getAlignment());
+  }
+  auto PAI = PartM.alias_begin();
+  for (GlobalAlias *GA : Aliases)
+    VMap[&*PAI++] = GA;
+
+  // Then come the globals created by the passes, in creation order.
+  for (auto E = PartM.end(); PFI != E; ++PFI)
+    VMap[&*PFI] = getOrCreateDeclaration(*PFI, TM);
+  SmallVector<std::pair<GlobalVariable *, GlobalVariable *>, 4> NewGlobals;
+  for (auto E = PartM.global_end(); PGI != E; ++PGI) {
+    GlobalVariable *GV = createGlobal(*PGI, PartM, TM);
+    VMap[&*PGI] = GV;
+    NewGlobals.push_back({&*PGI, GV});
+  }
+
+  // Replace the bodies of the partition.
+  const RemapFlags Flags = RF_IgnoreMissingEntries | RF_MoveDistinctMDs;
+  for (unsigned I = P.Begin; I != P.End; ++I) {
+    Function &F = *Functions[I];
+    Function &PartF = *PartFunctions[I];
+    if (PartF.isDeclaration())
+      continue;
+
+    for (BasicBlock &BB : F)
+      BB.dropAllReferences();
+    while (!F.empty())
+      F.begin()->eraseFromParent();
+
+    for (auto PAI = PartF.arg_begin(), AI = F.arg_begin(), E = F.arg_end();
+         AI != E; ++PAI, ++AI)
+      VMap[&*PAI] = &*AI;
+    F.getBasicBlockList().splice(F.end(), PartF.getBasicBlockList());
+    F.setAttributes(PartF.getAttributes());
+    // The body was replaced outside of a pass manager.
+    F.markChanged();
+
+    for (BasicBlock &BB : F)
+      for (Instruction &Inst : BB)
+        RemapInstruction(&Inst, VMap, Flags, &TM);
+  }
+
+  for (auto &Pair : NewGlobals)
+    if (Pair.first->hasInitializer())
+      Pair.second->setInitializer(
+          MapValue(Pair.first->getInitializer(), VMap, Flags, &TM));
+
+  // Leftover constant expressions still refer to the partition's globals.
+  for (Function &F : PartM)
+    F.removeDeadConstantUsers();
+  for (GlobalVariable &GV : PartM.globals())
+    GV.removeDeadConstantUsers();
+  for (GlobalAlias &GA : PartM.aliases())
+    GA.removeDeadConstantUsers();
+
+  // The copied types stay in the context, release their names for the next
+  // partition and for the types created after this.
+  for (unsigned I = 0, E = Structs.size(); I != E; ++I)
+    if (StructType *Copy = M.getTypeByName(StructTagPrefix + utostr(I)))
+      Copy->setName("");
+}
+
+bool llvm::runFunctionPassesInParallel(Module &M, unsigned ThreadCount,
+                                       const FunctionPassSetupFn &AddPasses) {
+  if (std::error_code EC = M.materializeAll())
+    report_fatal_error("Failed to materialize module: " + EC.message());
+
+  std::vector<Partition> Partitions;
+  if (ThreadCount > 1 && !hasStateSharedAcrossFunctions(M))
+    Partitions = partitionModule(M, ThreadCount);
+  if (Partitions.size() < 2) {
+    DEBUG(dbgs() << "Running function passes sequentially\n");
+    return runSequentially(M, M.begin(), AddPasses);
+  }
+  DEBUG(dbgs() << "Running function passes on " << Partitions.size()
+               << " partitions\n");
+
+  // Serialize the module once, every worker reads the bodies of its partition
+  // from it in its own context.
+  PartitionMerger Merger(M);
+  SmallVector<char, 0> BC;
+  Merger.writeTaggedBitcode(BC);
+  StringRef BCRef(BC.data(), BC.size());
+
+  std::vector<PartitionResult> Results(Partitions.size());
+  std::vector<std::shared_future<ThreadPool::VoidTy>> Futures;
+  ThreadPool Pool(std::min<unsigned>(ThreadCount, Partitions.size()));
+  for (unsigned I = 0, E = Partitions.size(); I != E; ++I)
+    Futures.push_back(Pool.async([&, I] {
+      optimizePartition(BCRef, Partitions[I], AddPasses, Results[I]);
+    }));
+
+  // Merge the partitions in order as soon as they are ready, while the other
+  // ones are still being optimized.
+  bool Changed = false;
+  for (unsigned I = 0, E = Partitions.size(); I != E; ++I) {
+    Futures[I].wait();
+    PartitionResult &Result = Results[I];
+    if (Result.Unsupported) {
+      // This partition and the following ones are still untouched in M.
+      DEBUG(dbgs() << "Partition " << I << " can't be merged, running the "
+                   << "remaining functions sequentially\n");
+      Pool.wait();
+      return runSequentially(
+                 M, std::next(M.begin(), Partitions[I].Begin), AddPasses) ||
+             Changed;
+    }
+
+    ErrorOr<std::unique_ptr<Module>> MOrErr = parseBitcodeFile(
+        MemoryBufferRef(StringRef(Result.BC.data(), Result.BC.size()),
+                        "<parallel-function-passes>"),
+        M.getContext());
+    if (!MOrErr)
+      report_fatal_error("Failed to read bitcode");
+    Merger.merge(**MOrErr, Partitions[I]);
+    Changed |= Result.Changed;
+    Result.BC.clear();
+  }
+  return Changed;
+}
@@ -13,35 +13,99 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/IR/Constant.h"
+#include "llvm/IR/DebugInfo.h"
 #include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/GVMaterializer.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Transforms/Utils/ValueMapper.h"
 #include "llvm-c/Core.h"
 using namespace llvm;
 
+/// Clone the body of Src into the declaration F of the copy of its module.
+static void cloneFunctionBody(Function *F, const Function *Src,
+                              ValueToValueMapTy &VMap) {
+  Function::arg_iterator DestI = F->arg_begin();
+  for (Function::const_arg_iterator J = Src->arg_begin(); J != Src->arg_end();
+       ++J) {
+    DestI->setName(J->getName());
+    VMap[&*J] = &*DestI++;
+  }
+
+  SmallVector<ReturnInst*, 8> Returns;  // Ignore returns cloned.
+  CloneFunctionInto(F, Src, VMap, /*ModuleLevelChanges=*/true, Returns);
+}
+
+namespace {
+/// Materializes the function bodies of a module copied by CloneModuleLazily
+/// by cloning them from the original module.
+class LazyModuleCloner : public GVMaterializer {
+  const Module *Src;
+  Module *Dest;
+  ValueToValueMapTy VMap;
+  /// The source of each function of Dest whose body is not cloned yet.
+  DenseMap<const Function *, const Function *> Bodies;
+  bool StripDebugInfo = false;
+
+public:
+  LazyModuleCloner(const Module *Src, Module *Dest) : Src(Src), Dest(Dest) {}
+
+  ValueToValueMapTy &getValueMap() { return VMap; }
+
+  /// Defer cloning the body of Src into F until F is materialized.
+  void addBody(Function *F, const Function *SrcF) {
+    Bodies[F] = SrcF;
+    F->setIsMaterializable(true);
+  }
+
+  std::error_code materialize(GlobalValue *GV) override {
+    Function *F = dyn_cast<Function>(GV);
+    if (!F || !F->isMaterializable())
+      return std::error_code();
+
+    auto I = Bodies.find(F);
+    assert(I != Bodies.end() && "Function not cloned by this module's cloner");
+    const Function *SrcF = I->second;
+    Bodies.erase(I);
+    F->setIsMaterializable(false);
+    cloneFunctionBody(F, SrcF, VMap);
+    if (StripDebugInfo)
+      stripDebugInfo(*F);
+    return std::error_code();
+  }
+
+  std::error_code materializeModule() override {
+    for (Function &F : *Dest)
+      if (std::error_code EC = materialize(&F))
+        return EC;
+    assert(Bodies.empty() && "Functions left unmaterialized");
+    return std::error_code();
+  }
+
+  // Metadata is cloned along with the globals.
+  std::error_code materializeMetadata() override { return std::error_code(); }
+  void setStripDebugInfo() override { StripDebugInfo = true; }
+
+  std::vector<StructType *> getIdentifiedStructTypes() const override {
+    // The copy shares its types with the original.
+    return Src->getIdentifiedStructTypes();
+  }
+};
+} // end anonymous namespace
+
+/// Copy the contents of M into the empty module New, mapping its values into
+/// VMap.  If Lazy is not null, leave the function bodies to it rather than
+/// cloning them now.
+///
 /// This is not as easy as it might seem because we have to worry about making
 /// copies of global variables and functions, and making their (initializers and
 /// references, respectively) refer to the right globals.
 ///
-std::unique_ptr<Module> llvm::CloneModule(const Module *M) {
-  // Create the value map that maps things from the old module over to the new
-  // module.
-  ValueToValueMapTy VMap;
-  return CloneModule(M, VMap);
-}
-
-std::unique_ptr<Module> llvm::CloneModule(const Module *M,
-                                          ValueToValueMapTy &VMap) {
-  return CloneModule(M, VMap, [](const GlobalValue *GV) { return true; });
-}
-
-std::unique_ptr<Module> llvm::CloneModule(
-    const Module *M, ValueToValueMapTy &VMap,
-    std::function<bool(const GlobalValue *)> ShouldCloneDefinition) {
-  // First off, we need to create the new module.
-  std::unique_ptr<Module> New =
-      llvm::make_unique<Module>(M->getModuleIdentifier(), M->getContext());
+static void
+cloneModuleInto(Module *New, const Module *M, ValueToValueMapTy &VMap,
+                std::function<bool(const GlobalValue *)> ShouldCloneDefinition,
+                LazyModuleCloner *Lazy) {
   New->setDataLayout(M->getDataLayout());
   New->setTargetTriple(M->getTargetTriple());
   New->setModuleInlineAsm(M->getModuleInlineAsm());
@@ -67,7 +131,7 @@ std::unique_ptr<Module> llvm::CloneModule(
   for (Module::const_iterator I = M->begin(), E = M->end(); I != E; ++I) {
     Function *NF =
         Function::Create(cast<FunctionType>(I->getValueType()),
-                         I->getLinkage(), I->getName(), New.get());
+                         I->getLinkage(), I->getName(), New);
     NF->copyAttributesFrom(&*I);
     VMap[&*I] = NF;
   }
@@ -84,7 +148,7 @@ std::unique_ptr<Module> llvm::CloneModule(
       if (I->getValueType()->isFunctionTy())
         GV = Function::Create(cast<FunctionType>(I->getValueType()),
                               GlobalValue::ExternalLinkage, I->getName(),
-                              New.get());
+                              New);
       else
         GV = new GlobalVariable(
             *New, I->getValueType(), false, GlobalValue::ExternalLinkage,
@@ -98,7 +162,7 @@ std::unique_ptr<Module> llvm::CloneModule(
     }
     auto *GA = GlobalAlias::create(I->getValueType(),
                                    I->getType()->getPointerAddressSpace(),
-                                   I->getLinkage(), I->getName(), New.get());
+                                   I->getLinkage(), I->getName(), New);
     GA->copyAttributesFrom(&*I);
     VMap[&*I] = GA;
   }
@@ -129,15 +193,10 @@ std::unique_ptr<Module> llvm::CloneModule(
       continue;
     }
     if (!I->isDeclaration()) {
-      Function::arg_iterator DestI = F->arg_begin();
-      for (Function::const_arg_iterator J = I->arg_begin(); J != I->arg_end();
-           ++J) {
-        DestI->setName(J->getName());
-        VMap[&*J] = &*DestI++;
-      }
-
-      SmallVector<ReturnInst*, 8> Returns;  // Ignore returns cloned.
-      CloneFunctionInto(F, &*I, VMap, /*ModuleLevelChanges=*/true, Returns);
+      if (Lazy)
+        Lazy->addBody(F, &*I);
+      else
+        cloneFunctionBody(F, &*I, VMap);
     }
 
     if (I->hasPersonalityFn())
@@ -163,7 +222,46 @@ std::unique_ptr<Module> llvm::CloneModule(
     for (unsigned i = 0, e = NMD.getNumOperands(); i != e; ++i)
       NewNMD->addOperand(MapMetadata(NMD.getOperand(i), VMap));
   }
+}
+
+std::unique_ptr<Module> llvm::CloneModule(const Module *M) {
+  // Create the value map that maps things from the old module over to the new
+  // module.
+  ValueToValueMapTy VMap;
+  return CloneModule(M, VMap);
+}
+
+std::unique_ptr<Module> llvm::CloneModule(const Module *M,
+                                          ValueToValueMapTy &VMap) {
+  return CloneModule(M, VMap, [](const GlobalValue *GV) { return true; });
+}
+
+std::unique_ptr<Module> llvm::CloneModule(
+    const Module *M, ValueToValueMapTy &VMap,
+    std::function<bool(const GlobalValue *)> ShouldCloneDefinition) {
+  // First off, we need to create the new module.
+  std::unique_ptr<Module> New =
+      llvm::make_unique<Module>(M->getModuleIdentifier(), M->getContext());
+  cloneModuleInto(New.get(), M, VMap, std::move(ShouldCloneDefinition),
+                  nullptr);
+  return New;
+}
+
+std::unique_ptr<Module> llvm::CloneModuleLazily(const Module *M) {
+  return CloneModuleLazily(M, [](const GlobalValue *GV) { return true; });
+}
 
+std::unique_ptr<Module> llvm::CloneModuleLazily(
+    const Module *M,
+    std::function<bool(const GlobalValue *)> ShouldCloneDefinition) {
+  std::unique_ptr<Module> New =
+      llvm::make_unique<Module>(M->getModuleIdentifier(), M->getContext());
+  // The copy owns the cloner, and with it the value map the function bodies
+  // are cloned with.
+  auto *Lazy = new LazyModuleCloner(M, New.get());
+  cloneModuleInto(New.get(), M, Lazy->getValueMap(),
+                  std::move(ShouldCloneDefinition), Lazy);
+  New->setMaterializer(Lazy);
   return New;
 }
 
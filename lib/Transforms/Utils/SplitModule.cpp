@@ -55,12 +55,26 @@ static void addNonConstUser(ClusterMapType &GVtoClusterMap,
   }
 }
 
+// Estimate the code size of GV, used to balance partitions.
+static unsigned getSizeEstimate(const GlobalValue &GV) {
+  const Function *F = dyn_cast<Function>(&GV);
+  if (!F)
+    return 1;
+  unsigned Size = 0;
+  for (const BasicBlock &BB : *F)
+    Size += BB.size();
+  return std::max(Size, 1u);
+}
+
 // Find partitions for module in the way that no locals need to be
 // globalized.
 // Try to balance pack those partitions into N files since this roughly equals
-// thread balancing for the backend codegen step.
+// thread balancing for the backend codegen step. If BalanceBySize is set, all
+// the definitions are assigned a partition and the clusters are weighted by
+// their estimated size, otherwise only the clusters that must be kept together
+// are, weighted by their number of members.
 static void findPartitions(Module *M, ClusterIDMapType &ClusterIDMap,
-                           unsigned N) {
+                           unsigned N, bool BalanceBySize) {
   // At this point module should have the proper mix of globals and locals.
   // As we attempt to partition this module, we must not change any
   // locals to globals.
@@ -69,13 +83,16 @@ static void findPartitions(Module *M, ClusterIDMapType &ClusterIDMap,
   ClusterMapType GVtoClusterMap;
   ComdatMembersType ComdatMembers;
 
-  auto recordGVSet = [&GVtoClusterMap, &ComdatMembers](GlobalValue &GV) {
+  auto recordGVSet = [&](GlobalValue &GV) {
     if (GV.isDeclaration())
       return;
 
     if (!GV.hasName())
       GV.setName("__llvmsplit_unnamed");
 
+    if (BalanceBySize)
+      GVtoClusterMap.insert(&GV);
+
     // Comdat groups must not be partitioned. For comdat groups that contain
     // locals, record all their members here so we can keep them together.
     // Comdat groups that only contain external globals are already handled by
@@ -143,11 +160,16 @@ static void findPartitions(Module *M, ClusterIDMapType &ClusterIDMap,
   // To guarantee determinism, we have to sort SCC according to size.
   // When size is the same, use leader's name.
   for (ClusterMapType::iterator I = GVtoClusterMap.begin(),
-                                E = GVtoClusterMap.end(); I != E; ++I)
-    if (I->isLeader())
-      Sets.push_back(
-          std::make_pair(std::distance(GVtoClusterMap.member_begin(I),
-                                       GVtoClusterMap.member_end()), I));
+                                E = GVtoClusterMap.end(); I != E; ++I) {
+    if (!I->isLeader())
+      continue;
+    unsigned Size = 0;
+    for (ClusterMapType::member_iterator MI = GVtoClusterMap.member_begin(I),
+                                         ME = GVtoClusterMap.member_end();
+         MI != ME; ++MI)
+      Size += BalanceBySize ? getSizeEstimate(**MI) : 1;
+    Sets.push_back(std::make_pair(Size, I));
+  }
 
   std::sort(Sets.begin(), Sets.end(), [](const SortType &a, const SortType &b) {
     if (a.first == b.first)
@@ -173,7 +195,7 @@ static void findPartitions(Module *M, ClusterIDMapType &ClusterIDMap,
                    << ((*MI)->hasLocalLinkage() ? " l " : " e ") << "\n");
       Visited.insert(*MI);
       ClusterIDMap[*MI] = CurrentClusterID;
-      CurrentClusterSize++;
+      CurrentClusterSize += BalanceBySize ? getSizeEstimate(**MI) : 1;
     }
     // Add this set size to the number of entries in this cluster.
     BalancinQueue.push(std::make_pair(CurrentClusterID, CurrentClusterSize));
@@ -217,7 +239,7 @@ static bool isInPartition(const GlobalValue *GV, unsigned I, unsigned N) {
 void llvm::SplitModule(
     std::unique_ptr<Module> M, unsigned N,
     std::function<void(std::unique_ptr<Module> MPart)> ModuleCallback,
-    bool PreserveLocals) {
+    bool PreserveLocals, bool BalanceBySize) {
   if (!PreserveLocals) {
     for (Function &F : *M)
       externalize(&F);
@@ -225,7 +247,9 @@ void llvm::SplitModule(
       externalize(&GV);
     for (GlobalAlias &GA : M->aliases())
       externalize(&GA);
+  }
 
+  if (!PreserveLocals && !BalanceBySize) {
     // FIXME: We should be able to reuse M as the last partition instead of
     // cloning it.
     for (unsigned I = 0; I != N; ++I) {
@@ -242,7 +266,7 @@ void llvm::SplitModule(
     // This performs splitting without a need for externalization, which might not
     // always be possible.
     ClusterIDMapType ClusterIDMap;
-    findPartitions(M.get(), ClusterIDMap, N);
+    findPartitions(M.get(), ClusterIDMap, N, BalanceBySize);
 
     for (unsigned I = 0; I < N; ++I) {
       ValueToValueMapTy VMap;
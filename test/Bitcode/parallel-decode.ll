@@ -0,0 +1,61 @@
+; Check that decoding the function bodies on several threads builds the same
+; module as decoding them serially.
+; RUN: llvm-as -preserve-bc-uselistorder < %s > %t.bc
+; RUN: opt -preserve-ll-uselistorder -S < %t.bc > %t.serial.ll
+; RUN: opt -bitcode-decode-threads=4 -preserve-ll-uselistorder -S < %t.bc \
+; RUN:   > %t.parallel.ll
+; RUN: diff %t.serial.ll %t.parallel.ll
+; RUN: FileCheck %s < %t.parallel.ll
+
+@g = global i8* blockaddress(@jumps, %target)
+
+; CHECK-LABEL: define i32 @constants(
+; CHECK: store [2 x i32] [i32 1, i32 2], [2 x i32]* %p, !tbaa !0
+define i32 @constants([2 x i32]* %p) {
+  store [2 x i32] [i32 1, i32 2], [2 x i32]* %p, !tbaa !0
+  %v = load i32, i32* getelementptr ([2 x i32], [2 x i32]* @a, i32 0, i32 1)
+  ret i32 %v
+}
+
+; CHECK-LABEL: define void @local_metadata(
+; CHECK: call void @llvm.foo(metadata i32 %x)
+define void @local_metadata(i32 %x) {
+  call void @llvm.foo(metadata i32 %x)
+  ret void
+}
+
+; CHECK-LABEL: define i8* @uses_jumps(
+; CHECK: ret i8* blockaddress(@jumps, %target)
+define i8* @uses_jumps() {
+  ret i8* blockaddress(@jumps, %target)
+}
+
+; CHECK-LABEL: define void @jumps(
+; CHECK: indirectbr i8* %addr, [label %target]
+define void @jumps(i8* %addr) {
+entry:
+  indirectbr i8* %addr, [label %target]
+target:
+  ret void
+}
+
+; CHECK-LABEL: define i32 @phis(
+; CHECK: phi i32 [ 0, %entry ], [ %next, %loop ]
+define i32 @phis(i32 %n) {
+entry:
+  br label %loop
+loop:
+  %i = phi i32 [ 0, %entry ], [ %next, %loop ]
+  %next = add i32 %i, 1
+  %done = icmp eq i32 %next, %n
+  br i1 %done, label %exit, label %loop
+exit:
+  ret i32 %i
+}
+
+@a = global [2 x i32] zeroinitializer
+
+declare void @llvm.foo(metadata)
+
+!0 = !{!"int", !1}
+!1 = !{!"root"}
@@ -0,0 +1,48 @@
+; RUN: llvm-as -o %t.bc %s
+; RUN: rm -rf %t.cache
+
+; The first link populates the cache.
+; RUN: llvm-lto -exported-symbol=foo -lto-cache-dir=%t.cache -o %t.o %t.bc
+; RUN: llvm-nm %t.o | FileCheck %s
+; RUN: ls %t.cache | count 1
+
+; A link with the same inputs and options returns the cached object, which is
+; replaced here to tell it apart from a new one.
+; RUN: echo "cached object" > %t.cache/llvmcache-*
+; RUN: llvm-lto -exported-symbol=foo -lto-cache-dir=%t.cache -o %t.hit.o %t.bc
+; RUN: FileCheck --check-prefix=HIT %s < %t.hit.o
+; HIT: cached object
+
+; Changing the options or the exported symbols adds new entries.
+; RUN: llvm-lto -exported-symbol=foo -lto-cache-dir=%t.cache -O1 -o %t.o %t.bc
+; RUN: llvm-nm %t.o | FileCheck %s
+; RUN: llvm-lto -exported-symbol=bar -lto-cache-dir=%t.cache -o %t.o %t.bc
+; RUN: ls %t.cache | count 3
+
+; So does linking another module.
+; RUN: llvm-as -o %t2.bc %p/Inputs/cache.ll
+; RUN: llvm-lto -exported-symbol=foo -lto-cache-dir=%t.cache -o %t.o %t.bc \
+; RUN:   %t2.bc
+; RUN: ls %t.cache | count 4
+
+; Parallel code generation doesn't use the cache.
+; RUN: llvm-lto -exported-symbol=foo -lto-cache-dir=%t.cache -j2 -o %t.o %t.bc
+; RUN: llvm-nm %t.o.0 %t.o.1 | FileCheck %s
+; RUN: ls %t.cache | count 4
+
+; Pruning keeps the entry just added.
+; RUN: llvm-lto -exported-symbol=foo -lto-cache-dir=%t.cache -O3 \
+; RUN:   -lto-cache-max-size=1 -o %t.o %t.bc
+; RUN: ls %t.cache | count 1
+
+target triple = "x86_64-unknown-linux-gnu"
+
+; CHECK: T foo
+define void @foo() {
+  call void @bar()
+  ret void
+}
+
+define void @bar() {
+  ret void
+}
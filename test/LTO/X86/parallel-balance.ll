@@ -0,0 +1,46 @@
+; RUN: llvm-as -o %t.bc %s
+; RUN: llvm-lto -exported-symbol=big -exported-symbol=small0 \
+; RUN:     -exported-symbol=small1 -j2 -time-codegen-partitions -o %t.o %t.bc \
+; RUN:     2>&1 | FileCheck --check-prefix=REPORT %s
+; RUN: llvm-nm %t.o.0 | FileCheck --check-prefix=CHECK0 %s
+; RUN: llvm-nm %t.o.1 | FileCheck --check-prefix=CHECK1 %s
+
+; REPORT: Split module code generation report
+; REPORT: Partition  Instructions
+; REPORT-NEXT: 0 9
+; REPORT-NEXT: 1 5
+; REPORT: Imbalance (slowest / average):
+
+target triple = "x86_64-unknown-linux-gnu"
+
+; The partitions are balanced by instruction count: @big gets a partition of
+; its own.
+
+; CHECK0: T big
+; CHECK0-NOT: T small
+
+; CHECK1-NOT: T big
+; CHECK1: T small0
+; CHECK1: T small1
+define i32 @big(i32 %x) {
+  %a = add i32 %x, 1
+  %b = mul i32 %a, %x
+  %c = add i32 %b, 2
+  %d = mul i32 %c, %b
+  %e = add i32 %d, 3
+  %f = mul i32 %e, %d
+  %g = add i32 %f, 4
+  %h = mul i32 %g, %f
+  ret i32 %h
+}
+
+define i32 @small0(i32 %x) {
+  %a = add i32 %x, 1
+  %b = mul i32 %a, %x
+  ret i32 %b
+}
+
+define i32 @small1(i32 %x) {
+  %a = sub i32 %x, 1
+  ret i32 %a
+}
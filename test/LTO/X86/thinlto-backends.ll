@@ -0,0 +1,35 @@
+; RUN: llvm-as -function-summary %s -o %t1.bc
+; RUN: llvm-as -function-summary %p/Inputs/thinlto-backends.ll -o %t2.bc
+; RUN: llvm-lto -thinlto-backends -j2 -o %t.o %t1.bc %t2.bc
+; RUN: llvm-nm %t.o.0 | FileCheck %s --check-prefix=NM0
+; RUN: llvm-nm %t.o.1 | FileCheck %s --check-prefix=NM1
+
+; Bounding the memory of the backends doesn't change the objects.
+; RUN: llvm-lto -thinlto-backends -j2 -thinlto-max-inflight-size=1 \
+; RUN:     -o %t.bounded.o %t1.bc %t2.bc
+; RUN: cmp %t.o.0 %t.bounded.o.0
+; RUN: cmp %t.o.1 %t.bounded.o.1
+
+; Both callees are imported and inlined, the static variable they access is
+; promoted.
+; NM0-NOT: callee
+; NM0-NOT: usestatic
+; NM0: U counter.llvm.{{[0-9]+}}
+; NM0: T main
+
+; NM1: T callee
+; NM1: B counter.llvm.{{[0-9]+}}
+; NM1: T usestatic
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+define i32 @main() {
+  %a = call i32 @callee(i32 1)
+  %b = call i32 @usestatic()
+  %c = add i32 %a, %b
+  ret i32 %c
+}
+
+declare i32 @callee(i32)
+declare i32 @usestatic()
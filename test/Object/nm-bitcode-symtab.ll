@@ -0,0 +1,62 @@
+; Check that the symbols read from the bitcode symbol table are the ones read
+; from the module.
+; RUN: llvm-as %s -o %t.bc
+; RUN: llvm-as -symbol-table %s -o %t.symtab.bc
+; RUN: llvm-bcanalyzer -dump %t.symtab.bc | FileCheck --check-prefix=BCA %s
+; RUN: llvm-nm %t.bc > %t.nm
+; RUN: llvm-nm %t.symtab.bc > %t.symtab.nm
+; RUN: diff %t.nm %t.symtab.nm
+; RUN: llvm-nm -a -without-aliases -m %t.bc > %t.m.nm
+; RUN: llvm-nm -a -without-aliases -m %t.symtab.bc > %t.symtab.m.nm
+; RUN: diff %t.m.nm %t.symtab.m.nm
+; RUN: FileCheck %s < %t.symtab.nm
+
+; BCA: <SYMTAB_BLOCK
+; BCA: <TRIPLE
+; BCA: </SYMTAB_BLOCK>
+; BCA-NEXT: <MODULE_BLOCK
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+$c = comdat any
+
+; CHECK: T alias
+; CHECK: C common
+; CHECK: D const
+; CHECK: D dalias
+; CHECK: U decl
+; CHECK: U ew
+; CHECK: U ext
+; CHECK: T f
+; CHECK: D g
+; CHECK: D hidden
+; CHECK: W lo
+; CHECK: t local
+; CHECK: W weak
+
+@g = global i32 1
+@const = constant i32 2
+@common = common global [4 x i32] zeroinitializer, align 16
+@hidden = hidden global i32 0
+@weak = weak global i32 0
+@ext = external global i32
+@priv = private global i32 0
+@llvm.used = appending global [1 x i8*] [i8* bitcast (i32* @g to i8*)], section "llvm.metadata"
+@alias = alias void (), void ()* @f
+@dalias = alias i32, i32* @g
+
+define void @f() comdat($c) {
+  ret void
+}
+
+define internal void @local() {
+  ret void
+}
+
+define linkonce_odr void @lo() {
+  ret void
+}
+
+declare void @decl()
+declare extern_weak void @ew()
@@ -0,0 +1,113 @@
+; Running function passes on several threads must give the same module as
+; running them sequentially when the module has debug info, without falling
+; back to a sequential run.
+; RUN: opt -S -instcombine -simplifycfg -gvn %s -o %t.seq
+; RUN: opt -S -function-pass-threads=3 -instcombine -simplifycfg -gvn %s \
+; RUN:     -o %t.par
+; RUN: diff %t.seq %t.par
+; RUN: opt -S -O2 -disable-inlining %s -o %t.seq-O2
+; RUN: opt -S -O2 -disable-inlining -function-pass-threads=3 %s -o %t.par-O2
+; RUN: diff %t.seq-O2 %t.par-O2
+; RUN: FileCheck %s < %t.par
+
+; The subprograms and lexical blocks are the original ones, not copies.
+; CHECK-LABEL: define i32 @sum(
+; CHECK: add nsw i32 {{.*}}, !dbg [[SUM_LOC:![0-9]+]]
+; CHECK-LABEL: define i32 @walk(
+; CHECK: call void @llvm.dbg.value(metadata %struct.list* %l, i64 0, metadata [[L:![0-9]+]], metadata !{{[0-9]+}}), !dbg
+; CHECK-LABEL: define void @hello(
+; CHECK: call i32 @puts(
+; CHECK: [[SUM_SP:![0-9]+]] = distinct !DISubprogram(name: "sum"
+; CHECK-NOT: !DISubprogram(name: "sum"
+; CHECK: [[WALK_SP:![0-9]+]] = distinct !DISubprogram(name: "walk"
+; CHECK: [[L]] = !DILocalVariable(name: "l", arg: 1, scope: [[WALK_SP]]
+; CHECK-NOT: !DISubprogram(name: "sum"
+; CHECK: [[SUM_LOC]] = !DILocation(line: 3, column: 3, scope: [[SUM_SP]])
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+%struct.point = type { i32, i32 }
+%struct.list = type { %struct.list*, %struct.point }
+
+@.str = private unnamed_addr constant [7 x i8] c"hello\0A\00", align 1
+
+declare i32 @printf(i8*, ...)
+declare void @llvm.dbg.value(metadata, i64, metadata, metadata)
+
+define i32 @sum(%struct.point* %p) !dbg !4 {
+entry:
+  %x = getelementptr inbounds %struct.point, %struct.point* %p, i64 0, i32 0
+  %0 = load i32, i32* %x, align 4, !dbg !20
+  %y = getelementptr inbounds %struct.point, %struct.point* %p, i64 0, i32 1
+  %1 = load i32, i32* %y, align 4, !dbg !20
+  %add = add nsw i32 %0, %1, !dbg !21
+  %2 = load i32, i32* %x, align 4, !dbg !21
+  %sub = sub nsw i32 %add, %2, !dbg !21
+  %add2 = add nsw i32 %sub, %2, !dbg !21
+  ret i32 %add2, !dbg !22
+}
+
+define i32 @walk(%struct.list* %l) !dbg !8 {
+entry:
+  call void @llvm.dbg.value(metadata %struct.list* %l, i64 0, metadata !30, metadata !31), !dbg !23
+  %cmp = icmp eq %struct.list* %l, null, !dbg !23
+  br i1 %cmp, label %done, label %next, !dbg !23
+
+next:
+  %n = getelementptr inbounds %struct.list, %struct.list* %l, i64 0, i32 0
+  %nl = load %struct.list*, %struct.list** %n, align 8, !dbg !24
+  %p = getelementptr inbounds %struct.list, %struct.list* %l, i64 0, i32 1
+  %s = call i32 @sum(%struct.point* %p), !dbg !24
+  %r = call i32 @walk(%struct.list* %nl), !dbg !25
+  %t = add i32 %s, %r, !dbg !25
+  br label %done, !dbg !25
+
+done:
+  %v = phi i32 [ 0, %entry ], [ %t, %next ]
+  ret i32 %v, !dbg !26
+}
+
+define void @hello() !dbg !10 {
+entry:
+  %call = call i32 (i8*, ...) @printf(i8* getelementptr inbounds ([7 x i8], [7 x i8]* @.str, i64 0, i64 0)), !dbg !27
+  ret void, !dbg !28
+}
+
+define i32 @twice(i32 %n) !dbg !12 {
+entry:
+  %a = add i32 %n, 0, !dbg !29
+  %b = shl i32 %a, 1, !dbg !29
+  ret i32 %b, !dbg !29
+}
+
+!llvm.dbg.cu = !{!0}
+!llvm.module.flags = !{!17, !18}
+
+!0 = distinct !DICompileUnit(language: DW_LANG_C99, file: !1, producer: "clang", isOptimized: false, runtimeVersion: 0, emissionKind: 1, enums: !2, subprograms: !3)
+!1 = !DIFile(filename: "threads.c", directory: "/tmp")
+!2 = !{}
+!3 = !{!4, !8, !10, !12}
+!4 = distinct !DISubprogram(name: "sum", scope: !1, file: !1, line: 1, type: !5, isLocal: false, isDefinition: true, scopeLine: 1, isOptimized: false, variables: !2)
+!5 = !DISubroutineType(types: !6)
+!6 = !{!7}
+!7 = !DIBasicType(name: "int", size: 32, align: 32, encoding: DW_ATE_signed)
+!8 = distinct !DISubprogram(name: "walk", scope: !1, file: !1, line: 6, type: !5, isLocal: false, isDefinition: true, scopeLine: 6, isOptimized: false, variables: !9)
+!9 = !{!30}
+!10 = distinct !DISubprogram(name: "hello", scope: !1, file: !1, line: 12, type: !5, isLocal: false, isDefinition: true, scopeLine: 12, isOptimized: false, variables: !2)
+!12 = distinct !DISubprogram(name: "twice", scope: !1, file: !1, line: 16, type: !5, isLocal: false, isDefinition: true, scopeLine: 16, isOptimized: false, variables: !2)
+!13 = distinct !DILexicalBlock(scope: !8, file: !1, line: 7, column: 3)
+!17 = !{i32 2, !"Dwarf Version", i32 4}
+!18 = !{i32 2, !"Debug Info Version", i32 3}
+!20 = !DILocation(line: 2, column: 3, scope: !4)
+!21 = !DILocation(line: 3, column: 3, scope: !4)
+!22 = !DILocation(line: 4, column: 3, scope: !4)
+!23 = !DILocation(line: 7, column: 3, scope: !8)
+!24 = !DILocation(line: 8, column: 5, scope: !13)
+!25 = !DILocation(line: 9, column: 5, scope: !13)
+!26 = !DILocation(line: 10, column: 3, scope: !8)
+!27 = !DILocation(line: 13, column: 3, scope: !10)
+!28 = !DILocation(line: 14, column: 1, scope: !10)
+!29 = !DILocation(line: 17, column: 3, scope: !12)
+!30 = !DILocalVariable(name: "l", arg: 1, scope: !8, file: !1, line: 6, type: !7)
+!31 = !DIExpression()
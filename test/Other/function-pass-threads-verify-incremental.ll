@@ -0,0 +1,22 @@
+; The bodies that the threads running function passes moved back into the
+; module must be verified again by the incremental verifier, like the ones a
+; sequential run changed.
+; REQUIRES: asserts
+; RUN: opt -S -verify-incremental -instcombine -stats %s -o /dev/null 2>&1 \
+; RUN:     | FileCheck %s
+; RUN: opt -S -verify-incremental -function-pass-threads=2 -instcombine \
+; RUN:     -stats %s -o /dev/null 2>&1 | FileCheck %s
+
+; Both bodies are verified when the module is loaded, and again after
+; instcombine changed them.
+; CHECK: 4 verify - Number of function bodies verified
+
+define i32 @f(i32 %x) {
+  %y = add i32 %x, 0
+  ret i32 %y
+}
+
+define i32 @g(i32 %x) {
+  %y = mul i32 %x, 1
+  ret i32 %y
+}
@@ -0,0 +1,104 @@
+; Running function passes on several threads must give the same module as
+; running them sequentially.
+; RUN: opt -S -instcombine -simplifycfg -gvn %s -o %t.seq
+; RUN: opt -S -function-pass-threads=3 -instcombine -simplifycfg -gvn %s -o %t.par
+; RUN: diff %t.seq %t.par
+; RUN: opt -S -O1 -disable-inlining %s -o %t.seq-O1
+; RUN: opt -S -O1 -disable-inlining -function-pass-threads=3 %s -o %t.par-O1
+; RUN: diff %t.seq-O1 %t.par-O1
+; RUN: FileCheck %s < %t.par
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+%struct.point = type { i32, i32 }
+%struct.list = type { %struct.list*, %struct.point }
+
+@.str = private unnamed_addr constant [7 x i8] c"hello\0A\00", align 1
+@.str.1 = private unnamed_addr constant [7 x i8] c"world\0A\00", align 1
+@.str.2 = private unnamed_addr constant [6 x i8] c"%s %d\00", align 1
+@g = internal global i32 0, align 4
+
+declare i32 @printf(i8*, ...)
+
+; printf calls get simplified into puts calls on new strings, the names of the
+; strings created by every thread must match the sequential ones.
+; CHECK: @str = private unnamed_addr constant [6 x i8] c"hello\00"
+; CHECK: @str.1 = private unnamed_addr constant [6 x i8] c"world\00"
+
+; CHECK-LABEL: define i32 @sum(
+; CHECK: add nsw i32
+define i32 @sum(%struct.point* %p) {
+entry:
+  %x = getelementptr inbounds %struct.point, %struct.point* %p, i64 0, i32 0
+  %0 = load i32, i32* %x, align 4
+  %y = getelementptr inbounds %struct.point, %struct.point* %p, i64 0, i32 1
+  %1 = load i32, i32* %y, align 4
+  %add = add nsw i32 %0, %1
+  %2 = load i32, i32* %x, align 4
+  %sub = sub nsw i32 %add, %2
+  %add2 = add nsw i32 %sub, %2
+  ret i32 %add2
+}
+
+; CHECK-LABEL: define void @hello(
+; CHECK: call i32 @puts(
+define void @hello() {
+entry:
+  %call = call i32 (i8*, ...) @printf(i8* getelementptr inbounds ([7 x i8], [7 x i8]* @.str, i64 0, i64 0))
+  ret void
+}
+
+; CHECK-LABEL: define i32 @walk(
+define i32 @walk(%struct.list* %l) {
+entry:
+  %cmp = icmp eq %struct.list* %l, null
+  br i1 %cmp, label %done, label %next
+
+next:
+  %n = getelementptr inbounds %struct.list, %struct.list* %l, i64 0, i32 0
+  %nl = load %struct.list*, %struct.list** %n, align 8
+  %p = getelementptr inbounds %struct.list, %struct.list* %l, i64 0, i32 1
+  %s = call i32 @sum(%struct.point* %p)
+  %r = call i32 @walk(%struct.list* %nl)
+  %t = add i32 %s, %r
+  br label %done
+
+done:
+  %v = phi i32 [ 0, %entry ], [ %t, %next ]
+  ret i32 %v
+}
+
+; CHECK-LABEL: define void @world(
+; CHECK: call i32 @puts(
+define void @world(i32 %n) {
+entry:
+  %tobool = icmp ne i32 %n, 0
+  br i1 %tobool, label %if.then, label %if.end
+
+if.then:
+  %call = call i32 (i8*, ...) @printf(i8* getelementptr inbounds ([7 x i8], [7 x i8]* @.str.1, i64 0, i64 0))
+  br label %if.end
+
+if.end:
+  %call1 = call i32 (i8*, ...) @printf(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @.str.2, i64 0, i64 0), i8* getelementptr inbounds ([7 x i8], [7 x i8]* @.str, i64 0, i64 0), i32 %n)
+  ret void
+}
+
+; CHECK-LABEL: define internal i32 @counter(
+define internal i32 @counter() {
+entry:
+  %0 = load i32, i32* @g, align 4
+  %inc = add nsw i32 %0, 1
+  store i32 %inc, i32* @g, align 4
+  %1 = load i32, i32* @g, align 4
+  ret i32 %1
+}
+
+define i32 @use_counter() {
+entry:
+  %c = call i32 @counter()
+  %d = call i32 @counter()
+  %r = add i32 %c, %d
+  ret i32 %r
+}
@@ -0,0 +1,26 @@
+; Check that both pass managers record their pass runs in the pass trace.
+; RUN: opt -instcombine -pass-trace-file=%t.legacy.json -disable-output %s
+; RUN: FileCheck --check-prefix=LEGACY %s < %t.legacy.json
+; RUN: opt -passes=instcombine -pass-trace-file=%t.new.json -disable-output %s
+; RUN: FileCheck --check-prefix=NEW %s < %t.new.json
+
+; LEGACY: {"traceEvents":[
+; LEGACY-DAG: {"name":"Combine redundant instructions","cat":"pass","ph":"X","pid":1,"tid":0,"ts":{{[0-9]+}},"dur":{{[0-9]+}},"args":{"detail":"f","mem_delta":{{-?[0-9]+}}}}
+; LEGACY-DAG: {"name":"Combine redundant instructions","cat":"pass","ph":"X","pid":1,"tid":0,"ts":{{[0-9]+}},"dur":{{[0-9]+}},"args":{"detail":"g","mem_delta":{{-?[0-9]+}}}}
+; LEGACY: ],"displayTimeUnit":"ms"}
+
+; NEW: {"traceEvents":[
+; NEW-DAG: {"name":"InstCombinePass",{{.*}}"args":{"detail":"f",
+; NEW-DAG: {"name":"InstCombinePass",{{.*}}"args":{"detail":"g",
+; NEW-DAG: {"name":"ModuleToFunctionPassAdaptor",{{.*}}"args":{"detail":"{{.*}}pass-trace.ll",
+; NEW: ],"displayTimeUnit":"ms"}
+
+define i32 @f(i32 %x) {
+  %a = add i32 %x, 0
+  ret i32 %a
+}
+
+define i32 @g(i32 %x) {
+  %a = mul i32 %x, 1
+  ret i32 %a
+}
@@ -10,6 +10,11 @@
 ; RUN: opt -function-import -summary-file %t3.thinlto.bc %s -import-instr-limit=5 -S | FileCheck %s --check-prefix=CHECK --check-prefix=INSTLIM5
 ; INSTLIM5-NOT: @staticfunc.llvm.2
 
+; Import the same way from a function index table
+; RUN: llvm-lto -thinlto -thinlto-index-table -o %t3 %t.bc %t2.bc
+; RUN: opt -function-import -summary-file %t3.thinlto.idx %s -S | FileCheck %s --check-prefix=CHECK --check-prefix=INSTLIMDEF
+; RUN: opt -function-import -summary-file %t3.thinlto.idx %s -import-instr-limit=5 -S | FileCheck %s --check-prefix=CHECK --check-prefix=INSTLIM5
+
 define i32 @main() #0 {
 entry:
   call void (...) @weakalias()
@@ -0,0 +1,19 @@
+; Check that pass pipelines run with the verifier only checking the functions
+; changed since they were last verified.
+; RUN: opt -verify-incremental -instcombine -verify -S < %s | FileCheck %s
+; RUN: opt -verify-incremental -passes='verify,function(instcombine),verify' -S < %s | FileCheck %s
+
+; CHECK-LABEL: define i32 @changed(
+; CHECK-NEXT: ret i32 %x
+define i32 @changed(i32 %x) {
+  %y = add i32 %x, 0
+  ret i32 %y
+}
+
+; CHECK-LABEL: define i32 @unchanged(
+; CHECK-NEXT: %y = add i32 %x, 1
+; CHECK-NEXT: ret i32 %y
+define i32 @unchanged(i32 %x) {
+  %y = add i32 %x, 1
+  ret i32 %y
+}
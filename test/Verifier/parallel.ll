@@ -0,0 +1,71 @@
+; Check that verifying the functions of a module on several threads reports
+; the same errors, in the same order, as verifying them serially.
+; RUN: not llvm-as -disable-output %s 2> %t.serial
+; RUN: not llvm-as -verify-threads=4 -disable-output %s 2> %t.parallel
+; RUN: diff %t.serial %t.parallel
+; RUN: FileCheck %s < %t.parallel
+
+; CHECK: assembly parsed, but does not verify as correct!
+declare void @llvm.localescape(...)
+declare i8* @llvm.localrecover(i8*, i8*, i32)
+
+define void @parent() {
+  %a = alloca i8
+  %b = alloca i8
+  call void (...) @llvm.localescape(i8* %a, i8* %b)
+  ret void
+}
+
+define i32 @f1(i32 %x) {
+  %y = add i32 %x, 1
+  ret i32 %y
+}
+
+; CHECK: Instruction does not dominate all uses!
+; CHECK-NEXT: %z = add i32 %x, 2
+; CHECK-NEXT: %y = add i32 %z, 1
+define i32 @f2(i32 %x) {
+  %y = add i32 %z, 1
+  %z = add i32 %x, 2
+  ret i32 %y
+}
+
+define i32 @f3(i32 %x) {
+  %y = mul i32 %x, 3
+  ret i32 %y
+}
+
+define i32 @f4(i32 %x) {
+  %y = sub i32 %x, 4
+  ret i32 %y
+}
+
+; CHECK: PHI nodes not grouped at top of basic block!
+; CHECK-NEXT: %p = phi i32 [ %x, %entry ]
+define i32 @f5(i32 %x) {
+entry:
+  br label %next
+next:
+  %y = add i32 %x, 5
+  %p = phi i32 [ %x, %entry ]
+  ret i32 %p
+}
+
+define i32 @f6(i32 %x) {
+  %y = shl i32 %x, 6
+  ret i32 %y
+}
+
+; The index recovered here must be checked against the llvm.localescape call
+; of @parent, which another thread verifies.
+define void @child(i8* %fp) {
+  call i8* @llvm.localrecover(i8* bitcast (void ()* @parent to i8*), i8* %fp, i32 1)
+  ret void
+}
+
+define i32 @f7(i32 %x) {
+  %y = xor i32 %x, 7
+  ret i32 %y
+}
+
+; CHECK-NOT: llvm.localrecover
@@ -0,0 +1,20 @@
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+@g = weak global i32 2
+
+define linkonce_odr i32 @f() noinline {
+  %v = load i32, i32* @g
+  ret i32 %v
+}
+
+define weak i32 @w() noinline {
+  ret i32 2
+}
+
+define i32 @second() {
+  %a = call i32 @f()
+  %b = call i32 @w()
+  %c = add i32 %a, %b
+  ret i32 %c
+}
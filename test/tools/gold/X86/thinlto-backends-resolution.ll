@@ -0,0 +1,43 @@
+; RUN: llvm-as -function-summary %s -o %t.o
+; RUN: llvm-as -function-summary %p/Inputs/thinlto-backends-resolution.ll -o %t2.o
+
+; RUN: %gold -plugin %llvmshlibdir/LLVMgold.so \
+; RUN:    --plugin-opt=thinlto-backends \
+; RUN:    --plugin-opt=jobs=2 \
+; RUN:    --plugin-opt=obj-path=%t4.o \
+; RUN:    -shared %t.o %t2.o -o %t3
+; RUN: llvm-nm %t4.o0 | FileCheck %s --check-prefix=NM0
+; RUN: llvm-nm %t4.o1 | FileCheck %s --check-prefix=NM1 \
+; RUN:    --implicit-check-not='{{ g$}}'
+
+; The linker picks the definitions of the first file. They are kept, even
+; though linkonce, and the second backend drops its own copies. The first
+; file's @f may still be imported into the second, but isn't emitted there.
+; NM0: W f
+; NM0: V g
+; NM0: W w
+
+; NM1: U f
+; NM1-NEXT: T second
+; NM1-NEXT: U w
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+@g = weak global i32 1
+
+define linkonce_odr i32 @f() noinline {
+  %v = load i32, i32* @g
+  ret i32 %v
+}
+
+define weak i32 @w() noinline {
+  ret i32 1
+}
+
+define i32 @first() {
+  %a = call i32 @f()
+  %b = call i32 @w()
+  %c = add i32 %a, %b
+  ret i32 %c
+}
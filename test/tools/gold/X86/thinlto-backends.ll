@@ -0,0 +1,36 @@
+; RUN: llvm-as -function-summary %s -o %t.o
+; RUN: llvm-as -function-summary %p/Inputs/thinlto-backends.ll -o %t2.o
+
+; RUN: %gold -plugin %llvmshlibdir/LLVMgold.so \
+; RUN:    --plugin-opt=thinlto-backends \
+; RUN:    --plugin-opt=jobs=2 \
+; RUN:    --plugin-opt=obj-path=%t4.o \
+; RUN:    -shared %t.o %t2.o -o %t3
+; RUN: llvm-nm %t4.o0 | FileCheck %s --check-prefix=NM0
+; RUN: llvm-nm %t4.o1 | FileCheck %s --check-prefix=NM1
+; RUN: llvm-nm %t3 | FileCheck %s --check-prefix=NM
+
+; Both callees are imported and inlined into @main.
+; NM0-NOT: callee
+; NM0-NOT: usestatic
+; NM0: T main
+
+; NM1: T callee
+; NM1: T usestatic
+
+; NM: T callee
+; NM: T main
+; NM: T usestatic
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+define i32 @main() {
+  %a = call i32 @callee(i32 1)
+  %b = call i32 @usestatic()
+  %c = add i32 %a, %b
+  ret i32 %c
+}
+
+declare i32 @callee(i32)
+declare i32 @usestatic()
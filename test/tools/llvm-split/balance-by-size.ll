@@ -0,0 +1,46 @@
+; RUN: llvm-split -j=2 -balance-by-size -o %t %s
+; RUN: llvm-dis -o - %t0 | FileCheck --check-prefix=CHECK0 %s
+; RUN: llvm-dis -o - %t1 | FileCheck --check-prefix=CHECK1 %s
+; RUN: llvm-split -j=2 -balance-by-size -preserve-locals -o %t %s
+; RUN: llvm-dis -o - %t0 | FileCheck --check-prefix=CHECK0 %s
+; RUN: llvm-dis -o - %t1 | FileCheck --check-prefix=CHECK1 %s
+
+; The largest function gets a partition of its own, the small ones are packed
+; together in the other partition.
+
+; CHECK0: define i32 @big
+; CHECK0: declare i32 @small0
+; CHECK0: declare i32 @small1
+; CHECK0: declare i32 @small2
+
+; CHECK1: declare i32 @big
+; CHECK1: define i32 @small0
+; CHECK1: define i32 @small1
+; CHECK1: define i32 @small2
+
+define i32 @big(i32 %x) {
+  %a = add i32 %x, 1
+  %b = mul i32 %a, %x
+  %c = add i32 %b, 2
+  %d = mul i32 %c, %b
+  %e = add i32 %d, 3
+  %f = mul i32 %e, %d
+  %g = add i32 %f, 4
+  %h = mul i32 %g, %f
+  ret i32 %h
+}
+
+define i32 @small0(i32 %x) {
+  %a = add i32 %x, 1
+  ret i32 %a
+}
+
+define i32 @small1(i32 %x) {
+  %a = call i32 @small0(i32 %x)
+  ret i32 %a
+}
+
+define i32 @small2(i32 %x) {
+  %a = call i32 @big(i32 %x)
+  ret i32 %a
+}
@@ -14,6 +14,7 @@
 
 #include "llvm/Config/config.h" // plugin-api.h requires HAVE_STDINT_H
 #include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
@@ -29,6 +30,7 @@
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/LTO/ThinLTOCodeGenerator.h"
 #include "llvm/Linker/IRMover.h"
 #include "llvm/MC/SubtargetFeature.h"
 #include "llvm/Object/FunctionIndexObjectFile.h"
@@ -137,6 +139,10 @@ namespace options {
   // the information from intermediate files and write a combined
   // global index for the ThinLTO backends.
   static bool thinlto = false;
+  // When the thinlto-backends plugin option is specified, run the ThinLTO
+  // backends of the intermediate files in process, in parallel with jobs=N,
+  // and link their objects.
+  static bool thinlto_backends = false;
   // Additional options to pass into the code generator.
   // Note: This array will contain all plugin options which are not claimed
   // as plugin exclusive to pass to the code generator.
@@ -168,6 +174,8 @@ namespace options {
       TheOutputType = OT_DISABLE;
     } else if (opt == "thinlto") {
       thinlto = true;
+    } else if (opt == "thinlto-backends") {
+      thinlto_backends = true;
     } else if (opt.size() == 2 && opt[0] == 'O') {
       if (opt[1] < '0' || opt[1] > '3')
         message(LDPL_FATAL, "Optimization level must be between 0 and 3");
@@ -849,6 +857,103 @@ static void codegen(std::unique_ptr<Module> M) {
   }
 }
 
+/// Run the ThinLTO backends of the claimed files, on options::Parallelism
+/// threads, and add the generated objects to the link.
+static void thinLTOBackends() {
+  if (unsigned NumOpts = options::extra.size())
+    cl::ParseCommandLineOptions(NumOpts, &options::extra[0]);
+
+  ThinLTOCodeGenerator CodeGen;
+  CodeGen.setTargetOptions(InitTargetOptionsFromCodeGenFlags());
+  CodeGen.setCodePICModel(RelocationModel);
+  CodeGen.setCpu(options::mcpu);
+  CodeGen.setAttr(join(MAttrs.begin(), MAttrs.end(), ","));
+  CodeGen.setOptLevel(options::OptLevel);
+  CodeGen.setThreadCount(options::Parallelism);
+
+  // The views of the files must stay valid until the backends are done. The
+  // members of an archive share its name, tell them apart by their offset.
+  std::list<PluginInputFile> InputFiles;
+  std::list<std::string> Identifiers;
+  unsigned ModuleIndex = 0;
+  for (claimed_file &F : Modules) {
+    InputFiles.emplace_back(F.handle);
+    ld_plugin_input_file &Info = InputFiles.back().file();
+
+    const void *View;
+    if (get_view(F.handle, &View) != LDPS_OK)
+      message(LDPL_FATAL, "Failed to get a view of file");
+
+    Identifiers.push_back(Info.name);
+    if (Info.offset)
+      Identifiers.back() += "@" + utostr(Info.offset);
+    CodeGen.addModule(Identifiers.back(),
+                      StringRef((const char *)View, Info.filesize));
+
+    // Each backend keeps the definitions that prevail and drops the others.
+    // Definitions that are only used from IR are not internalized, the
+    // objects of the other backends may still refer to them. Common symbols
+    // are left to the final link.
+    if (get_symbols(F.handle, F.syms.size(), F.syms.data()) != LDPS_OK)
+      message(LDPL_FATAL, "Failed to get symbol information");
+    for (ld_plugin_symbol &Sym : F.syms) {
+      if (Sym.def == LDPK_DEF || Sym.def == LDPK_WEAKDEF) {
+        switch ((ld_plugin_symbol_resolution)Sym.resolution) {
+        case LDPR_PREVAILING_DEF:
+        case LDPR_PREVAILING_DEF_IRONLY:
+        case LDPR_PREVAILING_DEF_IRONLY_EXP:
+          CodeGen.setSymbolResolution(ModuleIndex, Sym.name,
+                                      ThinLTOCodeGenerator::PrevailingDef);
+          break;
+        case LDPR_UNDEF:
+        case LDPR_PREEMPTED_REG:
+        case LDPR_PREEMPTED_IR:
+          CodeGen.setSymbolResolution(ModuleIndex, Sym.name,
+                                      ThinLTOCodeGenerator::PreemptedDef);
+          break;
+        default:
+          break;
+        }
+      }
+      freeSymName(Sym);
+    }
+    ++ModuleIndex;
+  }
+
+  std::vector<std::string> Filenames(Modules.size());
+  bool TempOutFile = options::obj_path.empty();
+  std::string ErrMsg;
+  bool Success = CodeGen.run(
+      [&](unsigned I, StringRef Object) {
+        int FD;
+        SmallString<128> Filename;
+        std::error_code EC;
+        if (TempOutFile) {
+          EC = sys::fs::createTemporaryFile("lto-llvm", "o", FD, Filename);
+        } else {
+          Filename = options::obj_path + utostr(I);
+          EC = sys::fs::openFileForWrite(Filename, FD, sys::fs::F_None);
+        }
+        if (EC)
+          message(LDPL_FATAL, "Could not open file: %s", EC.message().c_str());
+        raw_fd_ostream OS(FD, true);
+        OS << Object;
+        Filenames[I] = Filename.str();
+      },
+      ErrMsg);
+  if (!Success)
+    message(LDPL_FATAL, "ThinLTO backend failed: %s", ErrMsg.c_str());
+
+  for (std::string &Filename : Filenames) {
+    if (add_input_file(Filename.c_str()) != LDPS_OK)
+      message(LDPL_FATAL,
+              "Unable to add .o file to the link. File left behind in: %s",
+              Filename.c_str());
+    if (TempOutFile)
+      Cleanup.push_back(Filename);
+  }
+}
+
 /// gold informs us that all symbols have been read. At this point, we use
 /// get_symbols to see if any of our definitions have been overridden by a
 /// native object file. Then, perform optimization and codegen.
@@ -856,6 +961,11 @@ static ld_plugin_status allSymbolsReadHook(raw_fd_ostream *ApiFile) {
   if (Modules.empty())
     return LDPS_OK;
 
+  if (options::thinlto_backends) {
+    thinLTOBackends();
+    return LDPS_OK;
+  }
+
   // If we are doing ThinLTO compilation, simply build the combined
   // function index/summary and emit it. We don't need to parse the modules
   // and link them in this case.
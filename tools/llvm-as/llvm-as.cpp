@@ -48,6 +48,11 @@ static cl::opt<bool>
 EmitFunctionSummary("function-summary", cl::desc("Emit function summary index"),
                     cl::init(false));
 
+static cl::opt<bool>
+EmitSymbolTable("symbol-table",
+                cl::desc("Emit a symbol table readable without the module"),
+                cl::init(false));
+
 static cl::opt<bool>
 DumpAsm("d", cl::desc("Print assembly as parsed"), cl::Hidden);
 
@@ -82,7 +87,7 @@ static void WriteOutputFile(const Module *M) {
 
   if (Force || !CheckBitcodeOutputToConsole(Out->os(), true))
     WriteBitcodeToFile(M, Out->os(), PreserveBitcodeUseListOrder,
-                       EmitFunctionSummary);
+                       EmitFunctionSummary, EmitSymbolTable);
 
   // Declare success.
   Out->keep();
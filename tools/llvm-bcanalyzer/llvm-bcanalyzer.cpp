@@ -120,6 +120,7 @@ static const char *GetBlockName(unsigned BlockID,
   case bitc::FUNCTION_SUMMARY_BLOCK_ID:
                                        return "FUNCTION_SUMMARY_BLOCK";
   case bitc::MODULE_STRTAB_BLOCK_ID:   return "MODULE_STRTAB_BLOCK";
+  case bitc::SYMTAB_BLOCK_ID:          return "SYMTAB_BLOCK";
   }
 }
 
@@ -294,6 +295,14 @@ static const char *GetCodeName(unsigned CodeID, unsigned BlockID,
       STRINGIFY_CODE(FS_CODE, PERMODULE_ENTRY)
       STRINGIFY_CODE(FS_CODE, COMBINED_ENTRY)
     }
+  case bitc::SYMTAB_BLOCK_ID:
+    switch (CodeID) {
+    default:
+      return nullptr;
+      STRINGIFY_CODE(SYMTAB_CODE, STRTAB)
+      STRINGIFY_CODE(SYMTAB_CODE, TRIPLE)
+      STRINGIFY_CODE(SYMTAB_CODE, SYMBOL)
+    }
   case bitc::METADATA_ATTACHMENT_ID:
     switch(CodeID) {
     default:return nullptr;
@@ -12,6 +12,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/CodeGen/CommandFlags.h"
@@ -19,7 +20,9 @@
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/LTO/LTOCodeGenerator.h"
 #include "llvm/LTO/LTOModule.h"
+#include "llvm/LTO/ThinLTOCodeGenerator.h"
 #include "llvm/Object/FunctionIndexObjectFile.h"
+#include "llvm/Object/FunctionIndexTable.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/ManagedStatic.h"
@@ -64,6 +67,21 @@ static cl::opt<bool>
     ThinLTO("thinlto", cl::init(false),
             cl::desc("Only write combined global index for ThinLTO backends"));
 
+static cl::opt<bool> ThinLTOIndexTable(
+    "thinlto-index-table", cl::init(false),
+    cl::desc("With -thinlto, write the combined index as a function index "
+             "table, which can be loaded lazily, to <output>.thinlto.idx"));
+
+static cl::opt<bool> ThinLTOBackends(
+    "thinlto-backends", cl::init(false),
+    cl::desc("Run the ThinLTO backends of the inputs in process, writing the "
+             "object of the Nth input to <output>.N"));
+
+static cl::opt<unsigned long long> ThinLTOMaxInFlightSize(
+    "thinlto-max-inflight-size", cl::init(0),
+    cl::desc("Bound on the total bitcode size of the modules whose ThinLTO "
+             "backends run at the same time (0 = unbounded)"));
+
 static cl::opt<bool>
 SaveModuleFile("save-merged-module", cl::init(false),
                cl::desc("Write merged LTO module to file before CodeGen"));
@@ -102,6 +120,15 @@ static cl::opt<bool> RestoreGlobalsLinkage(
     "restore-linkage", cl::init(false),
     cl::desc("Restore original linkage of globals prior to CodeGen"));
 
+static cl::opt<std::string>
+    CacheDir("lto-cache-dir", cl::init(""),
+             cl::desc("Directory of the cache of generated objects"),
+             cl::value_desc("directory"));
+
+static cl::opt<unsigned long long> CacheMaxSize(
+    "lto-cache-max-size", cl::init(0),
+    cl::desc("Maximum size in bytes of the object cache (0 = unlimited)"));
+
 namespace {
 struct ModuleInfo {
   std::vector<bool> CanBeHidden;
@@ -231,13 +258,57 @@ static void createCombinedFunctionIndex() {
   }
   std::error_code EC;
   assert(!OutputFilename.empty());
-  raw_fd_ostream OS(OutputFilename + ".thinlto.bc", EC,
-                    sys::fs::OpenFlags::F_None);
-  error(EC, "error opening the file '" + OutputFilename + ".thinlto.bc'");
-  WriteFunctionSummaryToFile(CombinedIndex, OS);
+  std::string IndexFilename =
+      OutputFilename + (ThinLTOIndexTable ? ".thinlto.idx" : ".thinlto.bc");
+  raw_fd_ostream OS(IndexFilename, EC, sys::fs::OpenFlags::F_None);
+  error(EC, "error opening the file '" + IndexFilename + "'");
+  if (ThinLTOIndexTable)
+    object::writeFunctionIndexTable(CombinedIndex, OS);
+  else
+    WriteFunctionSummaryToFile(CombinedIndex, OS);
   OS.close();
 }
 
+/// Run the ThinLTO backends of the input files, in parallel with -j.
+///
+/// This is meant to enable testing of the in-process ThinLTO backends, also
+/// available in the gold plugin via -thinlto-backends.
+static void runThinLTOBackends(const TargetOptions &Options) {
+  ThinLTOCodeGenerator CodeGen;
+  std::vector<std::unique_ptr<MemoryBuffer>> Buffers;
+  for (auto &Filename : InputFilenames) {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr =
+        MemoryBuffer::getFile(Filename);
+    error(BufferOrErr, "error loading file '" + Filename + "'");
+    Buffers.push_back(std::move(*BufferOrErr));
+    CodeGen.addModule(Buffers.back()->getBufferIdentifier(),
+                      Buffers.back()->getBuffer());
+  }
+
+  CodeGen.setTargetOptions(Options);
+  CodeGen.setCodePICModel(RelocModel);
+  CodeGen.setCpu(MCPU);
+  CodeGen.setAttr(join(MAttrs.begin(), MAttrs.end(), ","));
+  CodeGen.setOptLevel(OptLevel - '0');
+  if (FileType.getNumOccurrences())
+    CodeGen.setFileType(FileType);
+  CodeGen.setThreadCount(Parallelism);
+  CodeGen.setMaxInFlightSize(ThinLTOMaxInFlightSize);
+
+  std::string ErrMsg;
+  bool Success = CodeGen.run(
+      [](unsigned I, StringRef Object) {
+        std::string PartFilename = OutputFilename + "." + utostr(I);
+        std::error_code EC;
+        raw_fd_ostream OS(PartFilename, EC, sys::fs::F_None);
+        error(EC, "error opening the file '" + PartFilename + "'");
+        OS << Object;
+      },
+      ErrMsg);
+  if (!Success)
+    error(ErrMsg);
+}
+
 int main(int argc, char **argv) {
   // Print a stack trace if we signal out.
   sys::PrintStackTraceOnErrorSignal();
@@ -263,6 +334,13 @@ int main(int argc, char **argv) {
     return 0;
   }
 
+  if (ThinLTOBackends) {
+    if (OutputFilename.empty())
+      error("-thinlto-backends must be specified together with -o");
+    runThinLTOBackends(Options);
+    return 0;
+  }
+
   if (ThinLTO) {
     createCombinedFunctionIndex();
     return 0;
@@ -283,6 +361,8 @@ int main(int argc, char **argv) {
   CodeGen.setDebugInfo(LTO_DEBUG_MODEL_DWARF);
   CodeGen.setTargetOptions(Options);
   CodeGen.setShouldRestoreGlobalsLinkage(RestoreGlobalsLinkage);
+  CodeGen.setCacheDir(CacheDir);
+  CodeGen.setCacheMaxSize(CacheMaxSize);
 
   llvm::StringSet<llvm::MallocAllocator> DSOSymbolsSet;
   for (unsigned i = 0; i < DSOSymbols.size(); ++i)
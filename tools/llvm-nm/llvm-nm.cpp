@@ -16,6 +16,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/GlobalAlias.h"
 #include "llvm/IR/GlobalVariable.h"
@@ -210,10 +211,10 @@ static bool compareSymbolName(const NMSymbol &A, const NMSymbol &B) {
 static char isSymbolList64Bit(SymbolicFile &Obj) {
   if (isa<IRObjectFile>(Obj)) {
     IRObjectFile *IRobj = dyn_cast<IRObjectFile>(&Obj);
-    Module &M = IRobj->getModule();
-    if (M.getTargetTriple().empty())
+    StringRef TargetTriple = IRobj->getTargetTriple();
+    if (TargetTriple.empty())
       return false;
-    Triple T(M.getTargetTriple());
+    Triple T(TargetTriple);
     return T.isArch64Bit();
   }
   if (isa<COFFObjectFile>(Obj))
@@ -799,6 +800,9 @@ static char getSymbolNMTypeChar(const GlobalValue &GV) {
 }
 
 static char getSymbolNMTypeChar(IRObjectFile &Obj, basic_symbol_iterator I) {
+  if (const BitcodeSymbol *Sym =
+          Obj.getSymbolTableEntry(I->getRawDataRefImpl()))
+    return Sym->IsExecutable ? 't' : 'd';
   const GlobalValue *GV = Obj.getSymbolGV(I->getRawDataRefImpl());
   if (!GV)
     return 't';
@@ -924,6 +928,10 @@ static void dumpSymbolNamesFromObject(SymbolicFile &Obj, bool printName,
         const GlobalValue *GV = IR->getSymbolGV(Sym.getRawDataRefImpl());
         if (GV && isa<GlobalAlias>(GV))
           continue;
+        const BitcodeSymbol *Entry =
+            IR->getSymbolTableEntry(Sym.getRawDataRefImpl());
+        if (Entry && Entry->Kind == BitcodeSymbol::Alias)
+          continue;
       }
     }
     // If a "-s segname sectname" option was specified and this is a Mach-O
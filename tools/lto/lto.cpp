@@ -434,3 +434,12 @@ void lto_codegen_set_should_embed_uselists(lto_code_gen_t cg,
                                            lto_bool_t ShouldEmbedUselists) {
   unwrap(cg)->setShouldEmbedUselists(ShouldEmbedUselists);
 }
+
+void lto_codegen_set_cache_dir(lto_code_gen_t cg, const char *cache_dir) {
+  unwrap(cg)->setCacheDir(cache_dir);
+}
+
+void lto_codegen_set_cache_max_size(lto_code_gen_t cg,
+                                    unsigned long long max_size) {
+  unwrap(cg)->setCacheMaxSize(max_size);
+}
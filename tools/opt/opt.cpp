@@ -50,10 +50,12 @@
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Target/TargetMachine.h"
+#include "llvm/Transforms/IPO/ParallelFunctionPasses.h"
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
 #include "llvm/Transforms/Utils/Cloning.h"
 #include <algorithm>
 #include <memory>
+#include <mutex>
 using namespace llvm;
 using namespace opt_tool;
 
@@ -196,6 +198,15 @@ static cl::opt<bool>
              cl::desc("Run all passes twice, re-using the same pass manager."),
              cl::init(false), cl::Hidden);
 
+static cl::opt<unsigned> FunctionPassThreads(
+    "function-pass-threads",
+    cl::desc("Run function pass pipelines concurrently on N threads"),
+    cl::value_desc("N"), cl::init(1));
+
+/// The optimization and size levels of the function pass pipelines added by
+/// AddOptimizationPasses, in order.
+static SmallVector<std::pair<unsigned, unsigned>, 2> FunctionPassLevels;
+
 static inline void addPass(legacy::PassManagerBase &PM, Pass *P) {
   // Add the pass to the pass manager...
   PM.add(P);
@@ -205,16 +216,9 @@ static inline void addPass(legacy::PassManagerBase &PM, Pass *P) {
     PM.add(createVerifierPass());
 }
 
-/// This routine adds optimization passes based on selected optimization level,
-/// OptLevel.
-///
-/// OptLevel - Optimization Level
-static void AddOptimizationPasses(legacy::PassManagerBase &MPM,
-                                  legacy::FunctionPassManager &FPM,
-                                  unsigned OptLevel, unsigned SizeLevel) {
-  FPM.add(createVerifierPass()); // Verify that input is correct
-
-  PassManagerBuilder Builder;
+/// Configure \p Builder for the given optimization and size levels.
+static void InitializeBuilder(PassManagerBuilder &Builder, unsigned OptLevel,
+                              unsigned SizeLevel) {
   Builder.OptLevel = OptLevel;
   Builder.SizeLevel = SizeLevel;
 
@@ -239,9 +243,56 @@ static void AddOptimizationPasses(legacy::PassManagerBase &MPM,
   // When #pragma vectorize is on for SLP, do the same as above
   Builder.SLPVectorize =
       DisableSLPVectorization ? false : OptLevel > 1 && SizeLevel < 2;
+}
 
+/// This routine adds optimization passes based on selected optimization level,
+/// OptLevel.
+///
+/// OptLevel - Optimization Level
+static void AddOptimizationPasses(legacy::PassManagerBase &MPM,
+                                  legacy::FunctionPassManager &FPM,
+                                  unsigned OptLevel, unsigned SizeLevel) {
+  FPM.add(createVerifierPass()); // Verify that input is correct
+
+  PassManagerBuilder Builder;
+  InitializeBuilder(Builder, OptLevel, SizeLevel);
   Builder.populateFunctionPassManager(FPM);
   Builder.populateModulePassManager(MPM);
+  FunctionPassLevels.push_back(std::make_pair(OptLevel, SizeLevel));
+}
+
+/// Adds the function passes AddOptimizationPasses adds to its
+/// FunctionPassManager, for each thread running them concurrently.
+static void AddOptimizationFunctionPasses(legacy::FunctionPassManager &FPM) {
+  for (const auto &Levels : FunctionPassLevels) {
+    FPM.add(createVerifierPass()); // Verify that input is correct
+
+    PassManagerBuilder Builder;
+    InitializeBuilder(Builder, Levels.first, Levels.second);
+    Builder.populateFunctionPassManager(FPM);
+  }
+}
+
+/// Returns true if the passes given on the command line can all be run by
+/// runFunctionPassesInParallel, i.e. they are the whole pipeline and none of
+/// them works on the module as a whole.
+static bool CanRunPassListInParallel(TargetMachine *TM) {
+  if (FunctionPassThreads <= 1 || PassList.empty() || AnalyzeOnly ||
+      PrintEachXForm || PrintBreakpoints || RunTwice || StandardLinkOpts ||
+      OptLevelO1 || OptLevelO2 || OptLevelOs || OptLevelOz || OptLevelO3)
+    return false;
+
+  for (const PassInfo *PassInf : PassList) {
+    std::unique_ptr<Pass> P;
+    if (PassInf->getTargetMachineCtor())
+      P.reset(PassInf->getTargetMachineCtor()(TM));
+    else if (PassInf->getNormalCtor())
+      P.reset(PassInf->getNormalCtor()());
+    if (!P || P->getPassKind() == PT_CallGraphSCC ||
+        P->getPassKind() == PT_Module)
+      return false;
+  }
+  return true;
 }
 
 static void AddStandardLinkPasses(legacy::PassManagerBase &PM) {
@@ -483,8 +534,12 @@ int main(int argc, char **argv) {
     NoOutput = true;
   }
 
+  // When they are the whole pipeline, function passes given on the command
+  // line are run separately, see below.
+  bool ParallelPassList = CanRunPassListInParallel(TM.get());
+
   // Create a new optimization pass for each one specified on the command line
-  for (unsigned i = 0; i < PassList.size(); ++i) {
+  for (unsigned i = 0; i < PassList.size() && !ParallelPassList; ++i) {
     if (StandardLinkOpts &&
         StandardLinkOpts.getPosition() < PassList.getPosition(i)) {
       AddStandardLinkPasses(Passes);
@@ -578,11 +633,56 @@ int main(int argc, char **argv) {
   if (OptLevelO3)
     AddOptimizationPasses(Passes, *FPasses, 3, 0);
 
+  // A TargetMachine can't be shared between threads, every thread running
+  // function passes concurrently gets its own.
+  std::mutex ThreadTMsLock;
+  std::vector<std::unique_ptr<TargetMachine>> ThreadTMs;
+  auto GetThreadTargetMachine = [&]() -> TargetMachine * {
+    if (!TM)
+      return nullptr;
+    std::unique_ptr<TargetMachine> ThreadTM(
+        GetTargetMachine(ModuleTriple, CPUStr, FeaturesStr, Options));
+    std::lock_guard<std::mutex> Lock(ThreadTMsLock);
+    ThreadTMs.push_back(std::move(ThreadTM));
+    return ThreadTMs.back().get();
+  };
+
   if (OptLevelO1 || OptLevelO2 || OptLevelOs || OptLevelOz || OptLevelO3) {
-    FPasses->doInitialization();
-    for (Function &F : *M)
-      FPasses->run(F);
-    FPasses->doFinalization();
+    if (FunctionPassThreads > 1) {
+      runFunctionPassesInParallel(
+          *M, FunctionPassThreads,
+          [&](legacy::FunctionPassManager &ThreadFPasses, Module &) {
+            TargetMachine *ThreadTM = GetThreadTargetMachine();
+            ThreadFPasses.add(new TargetLibraryInfoWrapperPass(TLII));
+            ThreadFPasses.add(createTargetTransformInfoWrapperPass(
+                ThreadTM ? ThreadTM->getTargetIRAnalysis()
+                         : TargetIRAnalysis()));
+            AddOptimizationFunctionPasses(ThreadFPasses);
+          });
+    } else {
+      FPasses->doInitialization();
+      for (Function &F : *M)
+        FPasses->run(F);
+      FPasses->doFinalization();
+    }
+  }
+
+  if (ParallelPassList) {
+    runFunctionPassesInParallel(
+        *M, FunctionPassThreads,
+        [&](legacy::FunctionPassManager &ThreadPasses, Module &) {
+          TargetMachine *ThreadTM = GetThreadTargetMachine();
+          ThreadPasses.add(new TargetLibraryInfoWrapperPass(TLII));
+          ThreadPasses.add(createTargetTransformInfoWrapperPass(
+              ThreadTM ? ThreadTM->getTargetIRAnalysis()
+                       : TargetIRAnalysis()));
+          for (const PassInfo *PassInf : PassList) {
+            if (PassInf->getTargetMachineCtor())
+              addPass(ThreadPasses, PassInf->getTargetMachineCtor()(ThreadTM));
+            else
+              addPass(ThreadPasses, PassInf->getNormalCtor()());
+          }
+        });
   }
 
   // Check that the module is well formed on completion of optimization
@@ -108,6 +108,7 @@ int main(int argc, char **argv) {
   }
 
   yaml::Input YIn(Buf.get()->getBuffer());
+  YIn.setStreaming(true);
 
   int Res = convertYAML(YIn, Out->os(), Convert);
   if (Res == 0)
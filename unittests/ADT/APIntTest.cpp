@@ -1018,6 +1018,57 @@ TEST(APIntTest, SelfMoveAssignment) {
   EXPECT_EQ(0xdeadbeefdeadbeefULL, Raw[0]);
   EXPECT_EQ(0xdeadbeefdeadbeefULL, Raw[1]);
 }
+
+// Values of 65 to 128 bits have fast paths; check them against the generic
+// multiword code used for 192 bits.
+TEST(APIntTest, DoubleWordArithmetic) {
+  uint64_t Seed = 0x9E3779B97F4A7C15ULL;
+  auto Next = [&]() {
+    Seed = Seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return Seed;
+  };
+
+  for (unsigned Width : {65u, 96u, 127u, 128u}) {
+    for (unsigned I = 0; I != 100; ++I) {
+      uint64_t ABits[] = {Next(), Next()};
+      uint64_t BBits[] = {Next(), I % 3 ? Next() : 0};
+      APInt A(Width, ABits), B(Width, BBits);
+      if (!B)
+        B = 1;
+      APInt WA = A.zext(192), WB = B.zext(192);
+      APInt SA = A.sext(192);
+
+      EXPECT_EQ((WA + WB).trunc(Width), A + B);
+      EXPECT_EQ((WA - WB).trunc(Width), A - B);
+      EXPECT_EQ((WA * WB).trunc(Width), A * B);
+      EXPECT_EQ(WA.udiv(WB).trunc(Width), A.udiv(B));
+      EXPECT_EQ(WA.urem(WB).trunc(Width), A.urem(B));
+
+      APInt Q, R;
+      APInt::udivrem(A, B, Q, R);
+      EXPECT_EQ(A.udiv(B), Q);
+      EXPECT_EQ(A.urem(B), R);
+      // The results may alias the operands.
+      APInt X = A, Y = B;
+      APInt::udivrem(X, Y, X, Y);
+      EXPECT_EQ(Q, X);
+      EXPECT_EQ(R, Y);
+
+      APInt C = A;
+      C += B;
+      EXPECT_EQ(A + B, C);
+      C -= B;
+      EXPECT_EQ(A, C);
+      C *= B;
+      EXPECT_EQ(A * B, C);
+
+      unsigned Shift = Next() % Width;
+      EXPECT_EQ(WA.shl(Shift).trunc(Width), A.shl(Shift));
+      EXPECT_EQ(WA.lshr(Shift), A.lshr(Shift).zext(192));
+      EXPECT_EQ(SA.ashr(Shift).trunc(Width), A.ashr(Shift));
+    }
+  }
+}
 #if defined(__clang__)
 #pragma clang diagnostic pop
 #pragma clang diagnostic pop
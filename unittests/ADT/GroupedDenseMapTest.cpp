@@ -0,0 +1,220 @@
+//===- llvm/unittest/ADT/GroupedDenseMapTest.cpp - GroupedDenseMap tests --===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+#include "llvm/ADT/GroupedDenseMap.h"
+#include <map>
+#include <set>
+
+using namespace llvm;
+
+namespace {
+
+/// \brief A test class that tries to check that construction and destruction
+/// occur correctly.
+class CtorTester {
+  static std::set<CtorTester *> Constructed;
+  int Value;
+
+public:
+  explicit CtorTester(int Value = 0) : Value(Value) {
+    EXPECT_TRUE(Constructed.insert(this).second);
+  }
+  CtorTester(const CtorTester &Arg) : Value(Arg.Value) {
+    EXPECT_TRUE(Constructed.insert(this).second);
+  }
+  CtorTester &operator=(const CtorTester &) = default;
+  ~CtorTester() {
+    EXPECT_EQ(1u, Constructed.erase(this));
+  }
+
+  int getValue() const { return Value; }
+  bool operator==(const CtorTester &RHS) const { return Value == RHS.Value; }
+
+  static unsigned getNumConstructed() { return Constructed.size(); }
+};
+
+std::set<CtorTester *> CtorTester::Constructed;
+
+// GroupedDenseMap doesn't need empty or tombstone keys.
+struct CtorTesterMapInfo {
+  static unsigned getHashValue(const CtorTester &Val) {
+    return Val.getValue() * 37u;
+  }
+  static bool isEqual(const CtorTester &LHS, const CtorTester &RHS) {
+    return LHS == RHS;
+  }
+};
+
+// Every key hashes to the same value.
+struct CollidingMapInfo {
+  static unsigned getHashValue(unsigned) { return 0; }
+  static bool isEqual(unsigned LHS, unsigned RHS) { return LHS == RHS; }
+};
+
+int Dummies[8192];
+
+TEST(GroupedDenseMapTest, EmptyMap) {
+  GroupedDenseMap<int *, int> Map;
+  EXPECT_EQ(0u, Map.size());
+  EXPECT_TRUE(Map.empty());
+  EXPECT_TRUE(Map.begin() == Map.end());
+  EXPECT_EQ(0u, Map.count(&Dummies[0]));
+  EXPECT_TRUE(Map.find(&Dummies[0]) == Map.end());
+  EXPECT_EQ(0, Map.lookup(&Dummies[0]));
+  EXPECT_FALSE(Map.erase(&Dummies[0]));
+  EXPECT_EQ(0u, Map.getMemorySize());
+  Map.clear();
+  EXPECT_TRUE(Map.empty());
+}
+
+TEST(GroupedDenseMapTest, SingleEntry) {
+  GroupedDenseMap<int *, int> Map;
+  EXPECT_TRUE(Map.insert(std::make_pair(&Dummies[0], 1)).second);
+  EXPECT_FALSE(Map.insert(std::make_pair(&Dummies[0], 2)).second);
+  EXPECT_EQ(1u, Map.size());
+  EXPECT_EQ(1u, Map.count(&Dummies[0]));
+  EXPECT_EQ(1, Map.lookup(&Dummies[0]));
+  EXPECT_EQ(1, Map[&Dummies[0]]);
+
+  GroupedDenseMap<int *, int>::iterator I = Map.begin();
+  EXPECT_EQ(&Dummies[0], I->first);
+  EXPECT_EQ(1, I->second);
+  EXPECT_TRUE(++I == Map.end());
+  EXPECT_TRUE(Map.find(&Dummies[0]) == Map.begin());
+
+  EXPECT_TRUE(Map.erase(&Dummies[0]));
+  EXPECT_TRUE(Map.empty());
+  EXPECT_TRUE(Map.begin() == Map.end());
+}
+
+TEST(GroupedDenseMapTest, ManyEntries) {
+  GroupedDenseMap<int *, int> Map;
+  for (int I = 0; I != 8192; ++I)
+    Map[&Dummies[I]] = I;
+  EXPECT_EQ(8192u, Map.size());
+  for (int I = 0; I != 8192; ++I)
+    EXPECT_EQ(I, Map.lookup(&Dummies[I]));
+
+  // Every entry is visited exactly once.
+  std::set<int> Seen;
+  for (const auto &KV : Map) {
+    EXPECT_EQ(&Dummies[KV.second], KV.first);
+    EXPECT_TRUE(Seen.insert(KV.second).second);
+  }
+  EXPECT_EQ(8192u, Seen.size());
+
+  for (int I = 0; I < 8192; I += 2)
+    EXPECT_TRUE(Map.erase(&Dummies[I]));
+  EXPECT_EQ(4096u, Map.size());
+  for (int I = 0; I != 8192; ++I)
+    EXPECT_EQ(unsigned(I % 2), Map.count(&Dummies[I]));
+}
+
+TEST(GroupedDenseMapTest, InsertEraseChurn) {
+  // Erasing and inserting keys without growing the map leaves deleted buckets
+  // around, which must be reclaimed.
+  GroupedDenseMap<unsigned, unsigned> Map;
+  std::map<unsigned, unsigned> Ref;
+  for (unsigned I = 0; I != 20000; ++I) {
+    Map[I] = I + 1;
+    Ref[I] = I + 1;
+    if (I >= 100) {
+      EXPECT_TRUE(Map.erase(I - 100));
+      Ref.erase(I - 100);
+    }
+  }
+  EXPECT_EQ(Ref.size(), Map.size());
+  EXPECT_LE(Map.getMemorySize(), 1024u * (sizeof(unsigned) * 2 + 1) + 16);
+  for (const auto &KV : Ref)
+    EXPECT_EQ(KV.second, Map.lookup(KV.first));
+}
+
+TEST(GroupedDenseMapTest, CollidingKeys) {
+  GroupedDenseMap<unsigned, unsigned, CollidingMapInfo> Map;
+  for (unsigned I = 0; I != 100; ++I)
+    Map[I] = I;
+  EXPECT_EQ(100u, Map.size());
+  for (unsigned I = 0; I < 100; I += 3)
+    Map.erase(I);
+  for (unsigned I = 0; I != 100; ++I)
+    EXPECT_EQ(I % 3 ? 1u : 0u, Map.count(I));
+}
+
+TEST(GroupedDenseMapTest, EraseIterator) {
+  GroupedDenseMap<unsigned, unsigned> Map;
+  for (unsigned I = 0; I != 10; ++I)
+    Map[I] = I;
+  Map.erase(Map.find(4));
+  EXPECT_EQ(9u, Map.size());
+  EXPECT_EQ(0u, Map.count(4));
+}
+
+TEST(GroupedDenseMapTest, CopyAndMove) {
+  GroupedDenseMap<unsigned, unsigned> Map;
+  for (unsigned I = 0; I != 100; ++I)
+    Map[I] = I * 2;
+
+  GroupedDenseMap<unsigned, unsigned> Copy(Map);
+  EXPECT_EQ(100u, Copy.size());
+  EXPECT_EQ(198u, Copy.lookup(99));
+
+  GroupedDenseMap<unsigned, unsigned> Moved(std::move(Copy));
+  EXPECT_EQ(100u, Moved.size());
+  EXPECT_TRUE(Copy.empty());
+
+  Copy = Moved;
+  EXPECT_EQ(100u, Copy.size());
+  Moved.clear();
+  EXPECT_TRUE(Moved.empty());
+  EXPECT_EQ(0u, Moved.count(1));
+
+  Moved.swap(Copy);
+  EXPECT_EQ(100u, Moved.size());
+  EXPECT_TRUE(Copy.empty());
+}
+
+TEST(GroupedDenseMapTest, ConstructorsAndDestructors) {
+  {
+    GroupedDenseMap<CtorTester, CtorTester, CtorTesterMapInfo> Map;
+    for (int I = 0; I != 100; ++I)
+      Map.insert(std::make_pair(CtorTester(I), CtorTester(I + 1)));
+    EXPECT_EQ(200u, CtorTester::getNumConstructed());
+    for (int I = 0; I != 100; I += 2)
+      Map.erase(CtorTester(I));
+    EXPECT_EQ(100u, CtorTester::getNumConstructed());
+    GroupedDenseMap<CtorTester, CtorTester, CtorTesterMapInfo> Copy(Map);
+    EXPECT_EQ(200u, CtorTester::getNumConstructed());
+    EXPECT_EQ(2, Copy.find(CtorTester(1))->second.getValue());
+  }
+  EXPECT_EQ(0u, CtorTester::getNumConstructed());
+}
+
+TEST(GroupedDenseMapTest, Resize) {
+  GroupedDenseMap<unsigned, unsigned> Map;
+  Map.resize(1000);
+  const void *Buckets = Map.getPointerIntoBucketsArray();
+  for (unsigned I = 0; I != 800; ++I)
+    Map[I] = I;
+  EXPECT_EQ(Buckets, Map.getPointerIntoBucketsArray());
+  EXPECT_TRUE(Map.isPointerIntoBucketsArray(&Map.find(10)->second));
+}
+
+TEST(GroupedDenseMapTest, ConstIterator) {
+  GroupedDenseMap<unsigned, unsigned> Map;
+  Map[1] = 2;
+  const GroupedDenseMap<unsigned, unsigned> &CMap = Map;
+  GroupedDenseMap<unsigned, unsigned>::const_iterator CI = CMap.find(1);
+  EXPECT_EQ(2u, CI->second);
+  GroupedDenseMap<unsigned, unsigned>::const_iterator CJ = Map.find(1);
+  EXPECT_TRUE(CI == CJ);
+  EXPECT_TRUE(++CI == CMap.end());
+}
+
+} // end anonymous namespace
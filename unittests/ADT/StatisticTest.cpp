@@ -0,0 +1,134 @@
+//===- llvm/unittest/ADT/StatisticTest.cpp - Statistic unit tests ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace llvm;
+
+#define DEBUG_TYPE "unittest"
+STATISTIC(Counter, "Counts things");
+STATISTIC(Counter2, "Counts other \"things\"");
+
+namespace {
+
+// Statistics are only updated in builds with assertions, or with
+// LLVM_ENABLE_STATS.
+#if !defined(NDEBUG) || defined(LLVM_ENABLE_STATS)
+const StatisticValue *findStatistic(const std::vector<StatisticValue> &Stats,
+                                    const char *Desc) {
+  for (const StatisticValue &S : Stats)
+    if (std::strcmp(S.Desc, Desc) == 0)
+      return &S;
+  return nullptr;
+}
+
+TEST(StatisticTest, Count) {
+  EnableStatistics();
+  ResetStatistics();
+
+  Counter = 0;
+  EXPECT_EQ(0u, Counter);
+  Counter++;
+  Counter++;
+  EXPECT_EQ(2u, Counter);
+  Counter += 5;
+  Counter *= 3;
+  --Counter;
+  EXPECT_EQ(20u, Counter);
+  EXPECT_EQ(20u, Counter--);
+  EXPECT_EQ(19u, Counter);
+}
+
+TEST(StatisticTest, SnapshotAndReset) {
+  EnableStatistics();
+  ResetStatistics();
+  EXPECT_TRUE(GetStatistics().empty());
+
+  ++Counter;
+  Counter2 += 3;
+  std::vector<StatisticValue> Stats = GetStatistics();
+  ASSERT_EQ(2u, Stats.size());
+  const StatisticValue *S = findStatistic(Stats, "Counts things");
+  ASSERT_TRUE(S);
+  EXPECT_STREQ("unittest", S->Name);
+  EXPECT_EQ(1u, S->Value);
+  S = findStatistic(Stats, "Counts other \"things\"");
+  ASSERT_TRUE(S);
+  EXPECT_EQ(3u, S->Value);
+
+  std::string JSON;
+  raw_string_ostream OS(JSON);
+  PrintStatisticsJSON(OS);
+  EXPECT_EQ("{\n  \"statistics\": [\n"
+            "    {\"type\": \"unittest\", \"desc\": "
+            "\"Counts other \\\"things\\\"\", \"value\": 3},\n"
+            "    {\"type\": \"unittest\", \"desc\": \"Counts things\", "
+            "\"value\": 1}\n"
+            "  ]\n}\n",
+            OS.str());
+
+  // After a reset, only the statistics updated again are reported.
+  ResetStatistics();
+  EXPECT_EQ(0u, Counter);
+  EXPECT_TRUE(GetStatistics().empty());
+  ++Counter2;
+  Stats = GetStatistics();
+  ASSERT_EQ(1u, Stats.size());
+  EXPECT_EQ(1u, Stats[0].Value);
+  ResetStatistics();
+}
+
+#if LLVM_ENABLE_THREADS
+TEST(StatisticTest, Threads) {
+  EnableStatistics();
+  ResetStatistics();
+
+  std::vector<std::thread> Threads;
+  for (unsigned I = 0; I != 4; ++I)
+    Threads.emplace_back([] {
+      for (unsigned J = 0; J != 10000; ++J)
+        ++Counter;
+    });
+  for (std::thread &T : Threads)
+    T.join();
+  EXPECT_EQ(40000u, Counter);
+
+  std::vector<StatisticValue> Stats = GetStatistics();
+  ASSERT_EQ(1u, Stats.size());
+  EXPECT_EQ(40000u, Stats[0].Value);
+  ResetStatistics();
+}
+#endif
+
+#else
+
+TEST(StatisticTest, Disabled) {
+  EnableStatistics();
+  ResetStatistics();
+
+  ++Counter;
+  Counter2 += 3;
+  EXPECT_EQ(0u, Counter);
+  EXPECT_TRUE(GetStatistics().empty());
+
+  std::string JSON;
+  raw_string_ostream OS(JSON);
+  PrintStatisticsJSON(OS);
+  EXPECT_EQ("{\n  \"statistics\": [\n  ]\n}\n", OS.str());
+}
+
+#endif // !defined(NDEBUG) || defined(LLVM_ENABLE_STATS)
+
+} // end anonymous namespace
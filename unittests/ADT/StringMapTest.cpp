@@ -312,6 +312,27 @@ TEST_F(StringMapTest, MoveAssignment) {
   ASSERT_EQ(B.count("x"), 0u);
 }
 
+TEST_F(StringMapTest, PrecomputedHash) {
+  StringMap<int> Map;
+  unsigned Hash = StringMapImpl::hash("key");
+  EXPECT_TRUE(Map.insert(std::make_pair("key", 1), Hash).second);
+  EXPECT_FALSE(Map.insert(std::make_pair("key", 2), Hash).second);
+  EXPECT_EQ(1, Map.find("key", Hash)->second);
+  EXPECT_EQ(1, Map.lookup("key"));
+  EXPECT_TRUE(Map.find("other", StringMapImpl::hash("other")) == Map.end());
+}
+
+TEST_F(StringMapTest, BumpPtrAllocator) {
+  StringMap<int, BumpPtrAllocator> Map;
+  for (int I = 0; I != 100; ++I)
+    Map[std::to_string(I)] = I;
+  EXPECT_TRUE(Map.erase("42"));
+  EXPECT_EQ(99u, Map.size());
+  EXPECT_EQ(7, Map.lookup("7"));
+  EXPECT_LE(Map.getAllocator().getTotalMemory(), 4096u);
+  EXPECT_GT(Map.getMemorySize(), 99 * sizeof(void *));
+}
+
 struct Countable {
   int &InstanceCount;
   int Number;
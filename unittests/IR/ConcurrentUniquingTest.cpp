@@ -0,0 +1,156 @@
+//===- llvm/unittest/IR/ConcurrentUniquingTest.cpp - Uniquing tests -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/Attributes.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Metadata.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+
+const unsigned NumThreads = 4;
+const unsigned NumValues = 1000;
+
+// Create a mix of types, constants, metadata and attributes for \p I, and
+// record them in \p Out.
+void createEntities(LLVMContext &C, GlobalVariable *GV, unsigned I,
+                    std::vector<const void *> &Out) {
+  IntegerType *Int32Ty = Type::getInt32Ty(C);
+  IntegerType *OddTy = IntegerType::get(C, 17 + I % 5);
+  ConstantInt *Int = ConstantInt::get(Int32Ty, I);
+  Constant *Wide = ConstantInt::get(OddTy, I * 7);
+  Constant *FP = ConstantFP::get(Type::getDoubleTy(C), I * 0.5);
+
+  ArrayType *ArrTy = ArrayType::get(Int32Ty, I % 13 + 1);
+  PointerType *PtrTy = PointerType::get(ArrTy, I % 3);
+  Type *Params[] = {PtrTy, OddTy};
+  FunctionType *FnTy = FunctionType::get(Int32Ty, Params, I % 2);
+  StructType *STy = StructType::get(C, Params);
+
+  Constant *Elts[] = {Int, ConstantInt::get(Int32Ty, I + 1)};
+  Constant *Arr = ConstantArray::get(ArrayType::get(Int32Ty, 2), Elts);
+  Constant *Vec = ConstantVector::get(Elts);
+  Constant *Data = ConstantDataArray::get(C, makeArrayRef(&I, 1));
+  Constant *Expr = ConstantExpr::getAdd(
+      ConstantExpr::getPtrToInt(GV, Int32Ty), Int);
+
+  MDString *Str = MDString::get(C, ("string" + Twine(I % 97)).str());
+  Metadata *Ops[] = {Str, ConstantAsMetadata::get(Int)};
+  MDTuple *Tuple = MDTuple::get(C, Ops);
+  AttrBuilder B;
+  B.addAttribute(Attribute::NonNull).addDereferenceableAttr(I % 64 + 1);
+  AttributeSet Attrs = AttributeSet::get(C, I % 4 + 1, B);
+
+  const void *Entities[] = {OddTy, Int,  Wide, FP,   ArrTy,
+                            PtrTy, FnTy, STy,  Arr,  Vec,
+                            Data,  Expr, Str,  Tuple, Attrs.getRawPointer()};
+  Out.insert(Out.end(), std::begin(Entities), std::end(Entities));
+}
+
+TEST(ConcurrentUniquingTest, Mode) {
+  LLVMContext Default;
+  EXPECT_FALSE(Default.hasConcurrentUniquing());
+  LLVMContext Concurrent(LLVMContext::ConcurrentUniquing);
+  EXPECT_TRUE(Concurrent.hasConcurrentUniquing());
+}
+
+TEST(ConcurrentUniquingTest, SameEntitiesOnAllThreads) {
+  LLVMContext C(LLVMContext::ConcurrentUniquing);
+  Module M("M", C);
+  auto *GV = new GlobalVariable(M, Type::getInt32Ty(C), false,
+                                GlobalValue::ExternalLinkage, nullptr, "g");
+
+  // Every thread creates the same entities, each starting at a different
+  // offset so that both hits and misses race.
+  std::vector<std::vector<const void *>> Results(NumThreads);
+  {
+    ThreadPool Pool(NumThreads);
+    for (unsigned T = 0; T != NumThreads; ++T)
+      Pool.async([&, T] {
+        std::vector<std::vector<const void *>> PerValue(NumValues);
+        for (unsigned N = 0; N != NumValues; ++N) {
+          unsigned I = (N + T * NumValues / NumThreads) % NumValues;
+          createEntities(C, GV, I, PerValue[I]);
+        }
+        for (auto &Entities : PerValue)
+          Results[T].insert(Results[T].end(), Entities.begin(),
+                            Entities.end());
+      });
+    Pool.wait();
+  }
+
+  for (unsigned T = 1; T != NumThreads; ++T)
+    EXPECT_EQ(Results[0], Results[T]);
+
+  // The entities must also be the ones a single thread now finds.
+  std::vector<const void *> Expected;
+  for (unsigned I = 0; I != NumValues; ++I)
+    createEntities(C, GV, I, Expected);
+  EXPECT_EQ(Expected, Results[0]);
+}
+
+// Microbenchmark measuring the throughput of ConstantInt::get and
+// FunctionType::get as the number of threads sharing the context grows. It is
+// not run by default, run it with
+// --gtest_also_run_disabled_tests --gtest_filter=*ContentionBenchmark.
+TEST(ConcurrentUniquingTest, DISABLED_ContentionBenchmark) {
+  const unsigned OpsPerThread = 1 << 20;
+  unsigned MaxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+  SmallVector<unsigned, 8> ThreadCounts;
+  for (unsigned Threads = 1; Threads < MaxThreads; Threads *= 2)
+    ThreadCounts.push_back(Threads);
+  ThreadCounts.push_back(MaxThreads);
+
+  auto Run = [&](LLVMContext &C, unsigned Threads) {
+    ThreadPool Pool(Threads);
+    auto Start = std::chrono::steady_clock::now();
+    for (unsigned T = 0; T != Threads; ++T)
+      Pool.async([&C, T, OpsPerThread] {
+        Type *Int64Ty = Type::getInt64Ty(C);
+        for (unsigned I = 0; I != OpsPerThread; ++I) {
+          // Mostly hits on a working set shared by all threads, with a
+          // thread-private miss every 16 operations.
+          uint64_t V = I % 16 ? I % 4096 : (uint64_t(T) << 32) + I;
+          Constant *CI = ConstantInt::get(Int64Ty, V);
+          if (I % 8 == 0)
+            FunctionType::get(CI->getType(), {Int64Ty, Int64Ty}, false);
+        }
+      });
+    Pool.wait();
+    std::chrono::duration<double> Elapsed =
+        std::chrono::steady_clock::now() - Start;
+    return Threads * OpsPerThread / Elapsed.count() / 1e6;
+  };
+
+  {
+    LLVMContext C;
+    outs() << "single-threaded context: " << format("%.1f", Run(C, 1))
+           << " Mops/s\n";
+  }
+  for (unsigned Threads : ThreadCounts) {
+    LLVMContext C(LLVMContext::ConcurrentUniquing);
+    outs() << "threads: " << Threads << " concurrent context: "
+           << format("%.1f", Run(C, Threads)) << " Mops/s\n";
+  }
+}
+
+} // end anonymous namespace
@@ -346,4 +346,47 @@ TEST_F(PassManagerTest, Basic) {
 
   EXPECT_EQ(1, ModuleAnalysisRuns);
 }
+
+TEST_F(PassManagerTest, MarkChangedFunctions) {
+  auto SetAllVerified = [&] {
+    for (Function &F : *M)
+      F.setIsVerified(true);
+  };
+
+  // Function passes mark the functions they don't preserve all analyses of.
+  SetAllVerified();
+  {
+    ModulePassManager MPM;
+    FunctionPassManager FPM;
+    FPM.addPass(TestInvalidationFunctionPass("g"));
+    MPM.addPass(createModuleToFunctionPassAdaptor(std::move(FPM)));
+    MPM.run(*M);
+  }
+  EXPECT_TRUE(M->getFunction("f")->isVerified());
+  EXPECT_FALSE(M->getFunction("g")->isVerified());
+  EXPECT_TRUE(M->getFunction("h")->isVerified());
+
+  // Module passes preserving the function analysis manager proxy leave the
+  // functions alone, the others mark all of them.
+  SetAllVerified();
+  {
+    ModuleAnalysisManager MAM;
+    int ModuleAnalysisRuns = 0;
+    MAM.registerPass(TestModuleAnalysis(ModuleAnalysisRuns));
+    ModulePassManager MPM;
+    MPM.addPass(TestPreservingModulePass());
+    MPM.addPass(TestMinPreservingModulePass());
+    MPM.run(*M, &MAM);
+  }
+  for (Function &F : *M)
+    EXPECT_TRUE(F.isVerified());
+  {
+    ModulePassManager MPM;
+    int ModulePassRunCount = 0;
+    MPM.addPass(TestModulePass(ModulePassRunCount));
+    MPM.run(*M);
+  }
+  for (Function &F : *M)
+    EXPECT_FALSE(F.isVerified());
+}
 }
@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/IR/Verifier.h"
+#include "llvm/AsmParser/Parser.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/DIBuilder.h"
 #include "llvm/IR/DerivedTypes.h"
@@ -17,6 +18,7 @@
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/SourceMgr.h"
 #include "gtest/gtest.h"
 
 namespace llvm {
@@ -45,6 +47,68 @@ TEST(VerifierTest, Branch_i1) {
   EXPECT_TRUE(verifyFunction(*F));
 }
 
+TEST(VerifierTest, IncrementalSkipsUnchangedFunctions) {
+  LLVMContext &C = getGlobalContext();
+  Module M("M", C);
+  FunctionType *FTy = FunctionType::get(Type::getVoidTy(C), /*isVarArg=*/false);
+  Function *F = cast<Function>(M.getOrInsertFunction("foo", FTy));
+  BasicBlock *Entry = BasicBlock::Create(C, "entry", F);
+  BasicBlock *Exit = BasicBlock::Create(C, "exit", F);
+  ReturnInst::Create(C, Exit);
+  BranchInst *BI =
+      BranchInst::Create(Exit, Exit, ConstantInt::getFalse(C), Entry);
+
+  EXPECT_FALSE(F->isVerified());
+  EXPECT_FALSE(verifyModule(M, nullptr, /*OnlyChanged=*/true));
+  EXPECT_TRUE(F->isVerified());
+
+  // Break the function behind the verifier's back: incremental verification
+  // trusts the earlier result until the function is marked changed.
+  BI->setOperand(0, ConstantInt::get(IntegerType::get(C, 32), 0));
+  EXPECT_FALSE(verifyModule(M, nullptr, /*OnlyChanged=*/true));
+  EXPECT_TRUE(verifyModule(M));
+
+  F->markChanged();
+  EXPECT_TRUE(verifyModule(M, nullptr, /*OnlyChanged=*/true));
+  EXPECT_FALSE(F->isVerified());
+}
+
+TEST(VerifierTest, IncrementalChecksFrameEscapeParents) {
+  LLVMContext C;
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseAssemblyString(
+      "declare void @llvm.localescape(...)\n"
+      "declare i8* @llvm.localrecover(i8*, i8*, i32)\n"
+      "define void @parent() {\n"
+      "  %a = alloca i8\n"
+      "  call void (...) @llvm.localescape(i8* %a)\n"
+      "  ret void\n"
+      "}\n"
+      "define void @child(i8* %fp) {\n"
+      "  call i8* @llvm.localrecover(i8* bitcast (void ()* @parent to i8*), "
+      "i8* %fp, i32 0)\n"
+      "  ret void\n"
+      "}\n",
+      Err, C);
+  ASSERT_TRUE(M != nullptr);
+  EXPECT_FALSE(verifyModule(*M));
+
+  // Checking the index recovered by the child needs the parent, which did not
+  // change.
+  Function *Child = M->getFunction("child");
+  Child->markChanged();
+  EXPECT_FALSE(verifyModule(*M, nullptr, /*OnlyChanged=*/true));
+
+  CallInst *Recover = cast<CallInst>(&Child->front().front());
+  Recover->setArgOperand(2, ConstantInt::get(Type::getInt32Ty(C), 1));
+  Child->markChanged();
+  std::string Error;
+  raw_string_ostream ErrorOS(Error);
+  EXPECT_TRUE(verifyModule(*M, &ErrorOS, /*OnlyChanged=*/true));
+  EXPECT_TRUE(StringRef(ErrorOS.str())
+                  .startswith("all indices passed to llvm.localrecover"));
+}
+
 TEST(VerifierTest, InvalidRetAttribute) {
   LLVMContext &C = getGlobalContext();
   Module M("M", C);
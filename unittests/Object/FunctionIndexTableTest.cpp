@@ -0,0 +1,181 @@
+//===- FunctionIndexTableTest.cpp - Function index table tests ------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Object/FunctionIndexTable.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/IR/FunctionInfo.h"
+#include "llvm/Object/Error.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+#include <thread>
+#include <vector>
+
+using namespace llvm;
+using namespace llvm::object;
+
+namespace {
+
+class FunctionIndexTableTest : public testing::Test {
+protected:
+  FunctionInfoIndex Index;
+  std::string Table;
+
+  void addFunction(StringRef Name, StringRef ModPath, unsigned InstCount,
+                   GlobalValue::LinkageTypes Linkage) {
+    auto Summary = llvm::make_unique<FunctionSummary>(InstCount);
+    Summary->setModulePath(ModPath);
+    Summary->setFunctionLinkage(Linkage);
+    Index.addFunctionInfo(
+        Name, llvm::make_unique<FunctionInfo>(0, std::move(Summary)));
+  }
+
+  void writeTable() {
+    Table.clear();
+    raw_string_ostream OS(Table);
+    writeFunctionIndexTable(Index, OS);
+    OS.flush();
+  }
+
+  void SetUp() override {
+    StringRef A = Index.addModulePath("a.o", 1);
+    StringRef B = Index.addModulePath("b.o", 2);
+    addFunction("foo", A, 10, GlobalValue::ExternalLinkage);
+    addFunction("bar", A, 3, GlobalValue::LinkOnceODRLinkage);
+    addFunction("bar", B, 4, GlobalValue::LinkOnceODRLinkage);
+    writeTable();
+  }
+
+  ErrorOr<std::unique_ptr<FunctionInfoIndex>> read(StringRef Data) {
+    // The copy is aligned, as the buckets are read in place.
+    return createFunctionIndexFromTable(MemoryBuffer::getMemBufferCopy(Data));
+  }
+};
+
+TEST_F(FunctionIndexTableTest, RoundTrip) {
+  EXPECT_TRUE(isFunctionIndexTable(MemoryBufferRef(Table, "table")));
+
+  auto IndexOrErr = read(Table);
+  ASSERT_TRUE(bool(IndexOrErr));
+  FunctionInfoIndex &ReadIndex = **IndexOrErr;
+  EXPECT_EQ(1u, ReadIndex.getModuleId("a.o"));
+  EXPECT_EQ(2u, ReadIndex.getModuleId("b.o"));
+
+  // Only the functions looked up are read.
+  EXPECT_EQ(ReadIndex.begin(), ReadIndex.end());
+
+  auto Foo = ReadIndex.findFunctionInfoList("foo");
+  ASSERT_NE(ReadIndex.end(), Foo);
+  ASSERT_EQ(1u, Foo->second.size());
+  const FunctionSummary *Summary = Foo->second[0]->functionSummary();
+  ASSERT_NE(nullptr, Summary);
+  EXPECT_EQ("a.o", Summary->modulePath());
+  EXPECT_EQ(10u, Summary->instCount());
+  EXPECT_EQ(GlobalValue::ExternalLinkage, Summary->getFunctionLinkage());
+  EXPECT_EQ(0u, Foo->second[0]->bitcodeIndex());
+
+  auto Bar = ReadIndex.findFunctionInfoList("bar");
+  ASSERT_NE(ReadIndex.end(), Bar);
+  ASSERT_EQ(2u, Bar->second.size());
+  EXPECT_EQ("a.o", Bar->second[0]->functionSummary()->modulePath());
+  EXPECT_EQ(3u, Bar->second[0]->functionSummary()->instCount());
+  EXPECT_EQ("b.o", Bar->second[1]->functionSummary()->modulePath());
+  EXPECT_EQ(4u, Bar->second[1]->functionSummary()->instCount());
+  EXPECT_EQ(GlobalValue::LinkOnceODRLinkage,
+            Bar->second[1]->functionSummary()->getFunctionLinkage());
+
+  // Looking a function up again finds the same infos.
+  EXPECT_EQ(Foo, ReadIndex.findFunctionInfoList("foo"));
+  EXPECT_EQ(ReadIndex.end(), ReadIndex.findFunctionInfoList("baz"));
+
+  ReadIndex.materializeAll();
+  unsigned NumFunctions = 0;
+  for (auto I = ReadIndex.begin(), E = ReadIndex.end(); I != E; ++I)
+    ++NumFunctions;
+  EXPECT_EQ(2u, NumFunctions);
+}
+
+TEST_F(FunctionIndexTableTest, NotATable) {
+  auto IndexOrErr = read("BC\xc0\xde");
+  EXPECT_EQ(object_error::invalid_file_type, IndexOrErr.getError());
+  EXPECT_FALSE(isFunctionIndexTable(MemoryBufferRef("BC\xc0\xde", "bc")));
+}
+
+TEST_F(FunctionIndexTableTest, Truncated) {
+  // Everything up to the end of the buckets is needed.
+  for (size_t Size = 8; Size < Table.size(); ++Size)
+    EXPECT_EQ(object_error::parse_failed,
+              read(StringRef(Table).substr(0, Size)).getError())
+        << "size " << Size;
+}
+
+TEST_F(FunctionIndexTableTest, Malformed) {
+  // Unknown version.
+  std::string Data = Table;
+  support::endian::write32le(&Data[8], 2);
+  EXPECT_EQ(object_error::parse_failed, read(Data).getError());
+
+  // Module table past the payload.
+  Data = Table;
+  support::endian::write32le(&Data[12], 3);
+  EXPECT_EQ(object_error::parse_failed, read(Data).getError());
+
+  // Buckets before the payload.
+  Data = Table;
+  support::endian::write64le(&Data[24], 16);
+  EXPECT_EQ(object_error::parse_failed, read(Data).getError());
+
+  // More entries than fit in the payload.
+  Data = Table;
+  uint64_t BucketOffset = support::endian::read64le(&Data[24]);
+  support::endian::write64le(&Data[BucketOffset + 8], 1 << 20);
+  EXPECT_EQ(object_error::parse_failed, read(Data).getError());
+}
+
+#if LLVM_ENABLE_THREADS
+TEST_F(FunctionIndexTableTest, ConcurrentLookups) {
+  // Enough functions for the index to grow if it wasn't sized up front.
+  StringRef A = Index.addModulePath("a.o", 1);
+  for (unsigned I = 0; I != 200; ++I)
+    addFunction("f" + utostr(I), A, I, GlobalValue::ExternalLinkage);
+  writeTable();
+
+  auto IndexOrErr = read(Table);
+  ASSERT_TRUE(bool(IndexOrErr));
+  const FunctionInfoIndex &ReadIndex = **IndexOrErr;
+  auto Foo = ReadIndex.findFunctionInfoList("foo");
+  ASSERT_NE(ReadIndex.end(), Foo);
+
+  std::vector<std::thread> Threads;
+  std::vector<unsigned> NumFound(4);
+  for (unsigned T = 0; T != 4; ++T)
+    Threads.emplace_back([&, T] {
+      for (unsigned I = 0; I != 200; ++I) {
+        // Each thread starts at a different function.
+        unsigned N = (I + T * 50) % 200;
+        auto F = ReadIndex.findFunctionInfoList("f" + utostr(N));
+        if (F != ReadIndex.end() && F->second.size() == 1 &&
+            F->second[0]->functionSummary()->instCount() == N)
+          ++NumFound[T];
+      }
+    });
+  for (std::thread &T : Threads)
+    T.join();
+  for (unsigned T = 0; T != 4; ++T)
+    EXPECT_EQ(200u, NumFound[T]);
+
+  // The iterator returned before the other lookups is still valid.
+  EXPECT_EQ(Foo, ReadIndex.findFunctionInfoList("foo"));
+  EXPECT_EQ(10u, Foo->second[0]->functionSummary()->instCount());
+}
+#endif
+
+} // end anonymous namespace
@@ -10,6 +10,7 @@
 #include "llvm/Support/Allocator.h"
 #include "gtest/gtest.h"
 #include <cstdlib>
+#include <cstring>
 
 using namespace llvm;
 
@@ -185,4 +186,67 @@ TEST(AllocatorTest, TestBigAlignment) {
   EXPECT_GT(MockSlabAllocator::GetLastSlabSize(), 4096u);
 }
 
+class SlabBackingTest
+    : public ::testing::TestWithParam<SlabAllocator::BackingKind> {
+protected:
+  void SetUp() override { SlabAllocator::setBacking(GetParam()); }
+  void TearDown() override { SlabAllocator::setBacking(SlabAllocator::Malloc); }
+};
+
+TEST_P(SlabBackingTest, Allocate) {
+  BumpPtrAllocator Alloc;
+  char *Small = static_cast<char *>(Alloc.Allocate(10, 1));
+  memset(Small, 1, 10);
+  // Larger than a slab.
+  char *Large = static_cast<char *>(Alloc.Allocate(10000, 64));
+  EXPECT_EQ(0u, uintptr_t(Large) & 63);
+  memset(Large, 2, 10000);
+  // Larger than a chunk.
+  char *Huge = static_cast<char *>(Alloc.Allocate(3 << 20, 8));
+  memset(Huge, 3, 3 << 20);
+  EXPECT_EQ(1, Small[9]);
+  EXPECT_EQ(2, Large[9999]);
+  Alloc.Reset();
+  EXPECT_EQ(1u, Alloc.GetNumSlabs());
+}
+
+TEST_P(SlabBackingTest, ReuseSlabs) {
+  // The slabs of an allocator are reused by the next one, as for the
+  // allocators of successive MachineFunctions.
+  {
+    BumpPtrAllocator Alloc;
+    for (int I = 0; I != 100; ++I)
+      Alloc.Allocate(1000, 8);
+  }
+  size_t Mapped = SlabAllocator::getMappedMemory();
+  for (int J = 0; J != 10; ++J) {
+    BumpPtrAllocator Alloc;
+    for (int I = 0; I != 100; ++I)
+      Alloc.Allocate(1000, 8);
+  }
+  EXPECT_EQ(Mapped, SlabAllocator::getMappedMemory());
+}
+
+TEST(AllocatorTest, SlabBackingChange) {
+  // An allocator holding malloc'ed slabs gets mapped ones once the backing
+  // changes, and releases both kinds.
+  BumpPtrAllocator Alloc;
+  for (int I = 0; I != 10; ++I)
+    memset(Alloc.Allocate(1000, 8), 1, 1000);
+  SlabAllocator::setBacking(SlabAllocator::Pages);
+  for (int I = 0; I != 10; ++I)
+    memset(Alloc.Allocate(1000, 8), 2, 1000);
+  memset(Alloc.Allocate(10000, 8), 3, 10000);
+  Alloc.Reset();
+  SlabAllocator::setBacking(SlabAllocator::Malloc);
+  for (int I = 0; I != 10; ++I)
+    memset(Alloc.Allocate(1000, 8), 4, 1000);
+}
+
+INSTANTIATE_TEST_CASE_P(
+    AllocatorTest, SlabBackingTest,
+    ::testing::Values(SlabAllocator::Malloc, SlabAllocator::Pages,
+                      SlabAllocator::TransparentHugePages,
+                      SlabAllocator::ExplicitHugePages));
+
 }  // anonymous namespace
@@ -11,6 +11,7 @@
 #include "llvm/Config/config.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/StringSaver.h"
+#include "llvm/Support/Threading.h"
 #include "gtest/gtest.h"
 #include <stdlib.h>
 #include <string>
@@ -265,4 +266,102 @@ TEST(CommandLineTest, HideUnrelatedOptionsMulti) {
       << "Hid default option that should be visable.";
 }
 
+enum class ContextLevel { Low, High };
+
+TEST(CommandLineTest, OptionContext) {
+  StackOption<unsigned> Threshold("context-threshold", cl::init(10));
+  StackOption<bool> Flag("context-flag");
+  StackOption<ContextLevel> Level(
+      "context-level", cl::init(ContextLevel::Low),
+      cl::values(clEnumValN(ContextLevel::Low, "low", "Low"),
+                 clEnumValN(ContextLevel::High, "high", "High"),
+                 clEnumValEnd));
+  cl::alias Alias("context-alias", cl::aliasopt(Threshold));
+
+  cl::OptionContext Ctx;
+  EXPECT_FALSE(Ctx.setOption("context-threshold", "20"));
+  EXPECT_FALSE(Ctx.setOption("context-flag", "true"));
+  EXPECT_FALSE(Ctx.setOption("context-level", "high"));
+
+  // The context only applies while it is active.
+  EXPECT_EQ(10u, Threshold);
+  EXPECT_FALSE(Flag);
+  EXPECT_EQ(nullptr, cl::OptionContext::getCurrent());
+  {
+    cl::OptionContext::Scope S(Ctx);
+    EXPECT_EQ(&Ctx, cl::OptionContext::getCurrent());
+    EXPECT_EQ(20u, Threshold);
+    EXPECT_TRUE(Flag);
+    EXPECT_EQ(ContextLevel::High, Level);
+
+    // An inner context only overrides the options it sets.
+    cl::OptionContext Inner;
+    EXPECT_FALSE(Inner.setOption("context-alias", "30"));
+    {
+      cl::OptionContext::Scope S2(Inner);
+      EXPECT_EQ(30u, Threshold);
+      EXPECT_FALSE(Flag);
+    }
+    EXPECT_EQ(20u, Threshold);
+
+    // Setting an option again replaces its value.
+    cl::OptionContext Other;
+    EXPECT_FALSE(Other.setOption("context-threshold", "40"));
+    EXPECT_FALSE(Other.setOption("context-threshold", "50"));
+    cl::OptionContext::Scope S3(Other);
+    EXPECT_EQ(50u, Threshold);
+  }
+  EXPECT_EQ(10u, Threshold);
+  EXPECT_EQ(ContextLevel::Low, Level);
+
+  // Values the command line sets show through the options the context does
+  // not set.
+  Threshold.setValue(15);
+  Flag.setValue(true);
+  cl::OptionContext Partial;
+  EXPECT_FALSE(Partial.setOption("context-flag", "false"));
+  cl::OptionContext::Scope S(Partial);
+  EXPECT_EQ(15u, Threshold);
+  EXPECT_FALSE(Flag);
+
+  Alias.removeArgument();
+}
+
+TEST(CommandLineTest, OptionContextErrors) {
+  StackOption<unsigned> Threshold("context-error-threshold");
+  StackOption<std::string> Name("context-error-name");
+
+  cl::OptionContext Ctx;
+  EXPECT_TRUE(Ctx.setOption("context-error-unknown", "1"));
+  EXPECT_TRUE(Ctx.setOption("context-error-threshold", "x"));
+  EXPECT_TRUE(Ctx.setOption("context-error-name", "x"));
+
+  cl::OptionContext::Scope S(Ctx);
+  EXPECT_EQ(0u, Threshold);
+}
+
+#if LLVM_ENABLE_THREADS != 0
+struct OptionContextThreadInfo {
+  StackOption<unsigned> *Threshold;
+  unsigned Value;
+};
+
+static void readThreshold(void *Arg) {
+  auto *Info = static_cast<OptionContextThreadInfo *>(Arg);
+  Info->Value = *Info->Threshold;
+}
+
+TEST(CommandLineTest, OptionContextIsPerThread) {
+  StackOption<unsigned> Threshold("context-thread-threshold", cl::init(10));
+  cl::OptionContext Ctx;
+  EXPECT_FALSE(Ctx.setOption("context-thread-threshold", "20"));
+  cl::OptionContext::Scope S(Ctx);
+
+  OptionContextThreadInfo Info = {&Threshold, 0};
+  llvm_execute_on_thread(readThreshold, &Info);
+  EXPECT_EQ(10u, Info.Value);
+  EXPECT_EQ(20u, Threshold);
+}
+#endif
+
 }  // anonymous namespace
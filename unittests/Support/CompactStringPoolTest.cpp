@@ -0,0 +1,72 @@
+//===- llvm/unittest/Support/CompactStringPoolTest.cpp - Pool tests -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/CompactStringPool.h"
+#include "llvm/ADT/DenseMap.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+TEST(CompactStringPoolTest, Intern) {
+  CompactStringPool Pool;
+  EXPECT_TRUE(Pool.empty());
+  EXPECT_EQ(0u, Pool.getMemorySize());
+
+  std::string Name = "_ZN4llvm5Value4dumpEv";
+  InternedString A = Pool.intern(Name);
+  InternedString B = Pool.intern("_ZN4llvm5Value4dumpEv");
+  InternedString C = Pool.intern("_ZN4llvm5Value5printEv");
+  EXPECT_TRUE(A == B);
+  EXPECT_TRUE(A != C);
+  EXPECT_EQ(2u, Pool.size());
+
+  // The pool owns a copy of the string.
+  Name.clear();
+  EXPECT_EQ("_ZN4llvm5Value4dumpEv", A.str());
+  EXPECT_EQ(A.size(), strlen(A.data()));
+  EXPECT_EQ(StringMapImpl::hash("_ZN4llvm5Value4dumpEv"), A.hash());
+}
+
+TEST(CompactStringPoolTest, Lookup) {
+  CompactStringPool Pool;
+  EXPECT_FALSE(Pool.lookup("a"));
+  InternedString A = Pool.intern("a");
+  EXPECT_TRUE(Pool.lookup("a") == A);
+  EXPECT_FALSE(Pool.lookup("b"));
+  EXPECT_FALSE(InternedString());
+  InternedString Empty = Pool.intern("", StringMapImpl::hash(""));
+  EXPECT_TRUE(Pool.lookup("") == Empty);
+  EXPECT_EQ(0u, Empty.size());
+}
+
+TEST(CompactStringPoolTest, MapKeys) {
+  CompactStringPool Pool;
+  DenseMap<InternedString, unsigned> Map;
+  StringMap<unsigned> Names;
+  for (unsigned I = 0; I != 1000; ++I) {
+    InternedString S = Pool.intern("name" + std::to_string(I));
+    Map[S] = I;
+    Names.insert(std::make_pair(S.str(), I), S.hash());
+  }
+  for (unsigned I = 0; I != 1000; ++I) {
+    InternedString S = Pool.intern("name" + std::to_string(I));
+    EXPECT_EQ(I, Map.lookup(S));
+    EXPECT_EQ(I, Names.find(S.str(), S.hash())->second);
+  }
+  EXPECT_EQ(1000u, Pool.size());
+
+  // The null InternedString is a key too.
+  Map[InternedString()] = 1000;
+  EXPECT_EQ(1000u, Map.lookup(InternedString()));
+  EXPECT_EQ(1001u, Map.size());
+}
+
+} // end anonymous namespace
@@ -222,4 +222,38 @@ TEST_F(MemoryBufferTest, slice) {
   EXPECT_TRUE(BufData2.substr(0x1800,8).equals("abcdefgh"));
   EXPECT_TRUE(BufData2.substr(0x2FF8,8).equals("abcdefgh"));
 }
+
+TEST_F(MemoryBufferTest, adviseAccess) {
+  // Create a file that is large enough to be mapped.
+  int FD;
+  SmallString<64> TestPath;
+  sys::fs::createTemporaryFile("MemoryBufferTest_Advise", "temp", FD,
+                               TestPath);
+  raw_fd_ostream OF(FD, true, /*unbuffered=*/true);
+  for (unsigned i = 0; i < 0x5000 / 8; ++i)
+    OF << "12345678";
+  OF.close();
+
+  ErrorOr<OwningBuffer> MB = MemoryBuffer::getFile(TestPath.str(), -1, false);
+  ASSERT_FALSE(MB.getError());
+  EXPECT_EQ(MemoryBuffer::MemoryBuffer_MMap, MB.get()->getBufferKind());
+
+  // Hints must not change the contents, whatever memory they are given.
+  StringRef BufData = MB.get()->getBuffer();
+  MB.get()->adviseAccess(MemoryBuffer::Access_Sequential);
+  EXPECT_TRUE(BufData.substr(0x4FF8, 8).equals("12345678"));
+  MB.get()->adviseAccess(MemoryBuffer::Access_Random);
+  EXPECT_TRUE(BufData.substr(0x1000, 8).equals("12345678"));
+  MemoryBuffer::prefetch(BufData.substr(0x1003, 0x2000));
+  EXPECT_TRUE(BufData.substr(0x2FF8, 8).equals("12345678"));
+  MB.get()->adviseAccess(MemoryBuffer::Access_Normal);
+
+  OwningBuffer Copy(MemoryBuffer::getMemBufferCopy(BufData));
+  Copy->adviseAccess(MemoryBuffer::Access_Random);
+  MemoryBuffer::prefetch(Copy->getBuffer());
+  MemoryBuffer::prefetch(StringRef());
+  EXPECT_EQ(BufData, Copy->getBuffer());
+
+  sys::fs::remove(TestPath);
+}
 }
@@ -362,4 +362,42 @@ INSTANTIATE_TEST_CASE_P(AllocationTests,
 			MappedMemoryTest,
 			::testing::ValuesIn(MemoryFlags));
 
+TEST(MappedMemoryHintTest, HugePageHint) {
+  std::error_code EC;
+  size_t PageSize = Process::getPageSize();
+  unsigned Flags = Memory::MF_READ | Memory::MF_WRITE | Memory::MF_HUGE_HINT |
+                   Memory::MF_NUMA_LOCAL;
+  MemoryBlock M = Memory::allocateMappedMemory(3 * PageSize, nullptr, Flags,
+                                               EC);
+  EXPECT_EQ(std::error_code(), EC);
+  ASSERT_NE((void*)nullptr, M.base());
+  EXPECT_LE(3 * PageSize, M.size());
+#if defined(__linux__)
+  // The block covers whole huge pages.
+  const uintptr_t HugePageSize = 2 * 1024 * 1024;
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(M.base()) % HugePageSize);
+  EXPECT_EQ(0u, M.size() % HugePageSize);
+#endif
+
+  char *Bytes = static_cast<char *>(M.base());
+  Bytes[0] = 1;
+  Bytes[M.size() - 1] = 2;
+  EXPECT_EQ(1, Bytes[0]);
+  EXPECT_EQ(2, Bytes[M.size() - 1]);
+  EXPECT_FALSE(Memory::releaseMappedMemory(M));
+}
+
+TEST(MappedMemoryHintTest, ExplicitHugePages) {
+  // Explicit huge pages fail when none is reserved, which is the common case;
+  // check that they can be used when they succeed.
+  std::error_code EC;
+  MemoryBlock M = Memory::allocateMappedMemory(
+      16, nullptr,
+      Memory::MF_READ | Memory::MF_WRITE | Memory::MF_HUGE_EXPLICIT, EC);
+  if (!M.base())
+    return;
+  static_cast<char *>(M.base())[15] = 1;
+  EXPECT_FALSE(Memory::releaseMappedMemory(M));
+}
+
 }  // anonymous namespace
@@ -12,8 +12,13 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Triple.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/Host.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <chrono>
 
 #include "gtest/gtest.h"
 
@@ -166,3 +171,120 @@ TEST_F(ThreadPoolTest, PoolDestruction) {
   }
   ASSERT_EQ(5, checked_in);
 }
+
+TEST_F(ThreadPoolTest, GroupWait) {
+  CHECK_UNSUPPORTED();
+  // Test that waiting on a group does not wait on the rest of the pool.
+  ThreadPool Pool(2);
+  std::atomic_int checked_in{0};
+  Pool.async([this, &checked_in] {
+    waitForMainThread();
+    ++checked_in;
+  });
+  std::atomic_int group_checked_in{0};
+  {
+    ThreadPoolTaskGroup Group(Pool);
+    for (size_t i = 0; i < 5; ++i)
+      Group.async([&group_checked_in] { ++group_checked_in; });
+    Group.wait();
+    ASSERT_EQ(5, group_checked_in);
+  }
+  ASSERT_EQ(0, checked_in);
+  setMainThreadReady();
+  Pool.wait();
+  ASSERT_EQ(1, checked_in);
+}
+
+static uint64_t ParallelFib(ThreadPool &Pool, unsigned N) {
+  if (N < 2)
+    return N;
+  uint64_t A, B;
+  ThreadPoolTaskGroup Group(Pool);
+  Group.async([&] { A = ParallelFib(Pool, N - 1); });
+  B = ParallelFib(Pool, N - 2);
+  Group.wait();
+  return A + B;
+}
+
+TEST_F(ThreadPoolTest, NestedGroups) {
+  CHECK_UNSUPPORTED();
+  // Test that tasks waiting on their own subtasks do not deadlock the pool,
+  // even when the nesting is much deeper than the number of threads.
+  ThreadPool Pool(2);
+  uint64_t Result = 0;
+  Pool.async([&] { Result = ParallelFib(Pool, 16); });
+  Pool.wait();
+  ASSERT_EQ(987u, Result);
+}
+
+TEST_F(ThreadPoolTest, NestedAsync) {
+  CHECK_UNSUPPORTED();
+  // Test that ThreadPool::wait() accounts for tasks spawned by tasks.
+  std::atomic_int checked_in{0};
+  ThreadPool Pool(3);
+  for (size_t i = 0; i < 10; ++i) {
+    Pool.async([&Pool, &checked_in] {
+      for (size_t j = 0; j < 10; ++j)
+        Pool.async([&checked_in] { ++checked_in; });
+    });
+  }
+  Pool.wait();
+  ASSERT_EQ(100, checked_in);
+}
+
+static cl::opt<unsigned> PoolTestThreshold("thread-pool-test-threshold",
+                                           cl::init(1));
+
+TEST_F(ThreadPoolTest, OptionContext) {
+  CHECK_UNSUPPORTED();
+  // Test that tasks, and the tasks they spawn, see the option context of the
+  // thread submitting them.
+  cl::OptionContext Ctx;
+  ASSERT_FALSE(Ctx.setOption("thread-pool-test-threshold", "2"));
+  std::atomic_int Sum{0};
+  ThreadPool Pool(3);
+  Pool.async([&] { Sum += PoolTestThreshold; });
+  {
+    cl::OptionContext::Scope S(Ctx);
+    for (size_t i = 0; i < 10; ++i) {
+      Pool.async([&] {
+        ThreadPoolTaskGroup Group(Pool);
+        for (size_t j = 0; j < 10; ++j)
+          Group.async([&] { Sum += PoolTestThreshold * 10; });
+        Group.wait();
+        Sum += PoolTestThreshold * 100;
+      });
+    }
+  }
+  Pool.wait();
+  ASSERT_EQ(1 + 10 * (10 * 20 + 200), Sum);
+  ASSERT_EQ(nullptr, cl::OptionContext::getCurrent());
+}
+
+// Microbenchmark measuring how fine-grained nested parallelism scales with the
+// number of threads. It is not run by default, run it with
+// --gtest_also_run_disabled_tests --gtest_filter=*ScalingBenchmark.
+TEST_F(ThreadPoolTest, DISABLED_ScalingBenchmark) {
+  unsigned MaxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+  SmallVector<unsigned, 8> ThreadCounts;
+  for (unsigned Threads = 1; Threads < MaxThreads; Threads *= 2)
+    ThreadCounts.push_back(Threads);
+  ThreadCounts.push_back(MaxThreads);
+
+  double Baseline = 0;
+  for (unsigned Threads : ThreadCounts) {
+    ThreadPool Pool(Threads);
+    uint64_t Result = 0;
+    auto Start = std::chrono::steady_clock::now();
+    Pool.async([&] { Result = ParallelFib(Pool, 27); });
+    Pool.wait();
+    std::chrono::duration<double> Elapsed =
+        std::chrono::steady_clock::now() - Start;
+    ASSERT_EQ(196418u, Result);
+    if (Threads == 1)
+      Baseline = Elapsed.count();
+    outs() << "threads: " << Threads << " time: "
+           << format("%.3f", Elapsed.count()) << "s speedup: "
+           << format("%.2f", Baseline / Elapsed.count()) << "x\n";
+  }
+}
@@ -2194,3 +2194,210 @@ TEST(YAMLIO, TestWrapFlow) {
     out.clear();
   }
 }
+
+//===----------------------------------------------------------------------===//
+//  Test streaming Input
+//===----------------------------------------------------------------------===//
+
+//
+// Test reading a sequence of mappings one element at a time, with the keys
+// of some mappings in the order they are mapped and of others not.
+//
+TEST(YAMLIO, TestStreamingContainerSequenceMapRead) {
+  FooBarContainer cont;
+  Input yin("---\n"
+            "fbs:\n"
+            " - foo: 3\n"
+            "   bar: 5\n"
+            " - bar: 9\n"
+            "   foo: 7\n"
+            " - { foo: 1, bar: 2 }\n"
+            "...\n");
+  yin.setStreaming(true);
+  yin >> cont;
+
+  EXPECT_FALSE(yin.error());
+  ASSERT_EQ(cont.fbs.size(), 3UL);
+  EXPECT_EQ(cont.fbs[0].foo, 3);
+  EXPECT_EQ(cont.fbs[0].bar, 5);
+  EXPECT_EQ(cont.fbs[1].foo, 7);
+  EXPECT_EQ(cont.fbs[1].bar, 9);
+  EXPECT_EQ(cont.fbs[2].foo, 1);
+  EXPECT_EQ(cont.fbs[2].bar, 2);
+}
+
+TEST(YAMLIO, TestStreamingEmptySequenceRead) {
+  {
+    FooBarContainer cont;
+    Input yin("---\nfbs: []\n...\n");
+    yin.setStreaming(true);
+    yin >> cont;
+    EXPECT_FALSE(yin.error());
+    EXPECT_EQ(cont.fbs.size(), 0UL);
+  }
+
+  {
+    FooBarContainer cont;
+    Input yin("---\nfbs: ~\n...\n");
+    yin.setStreaming(true);
+    yin >> cont;
+    EXPECT_FALSE(yin.error());
+    EXPECT_EQ(cont.fbs.size(), 0UL);
+  }
+}
+
+TEST(YAMLIO, TestStreamingMapErrors) {
+  {
+    FooBarContainer cont;
+    Input yin("---\nfbs:\n - foo: 3\n   bar: 5\n   baz: 6\n - foo: 7\n...\n",
+              nullptr, suppressErrorMessages);
+    yin.setStreaming(true);
+    yin >> cont;
+    // Error: unknown key after the mapped ones.
+    EXPECT_TRUE(!!yin.error());
+  }
+
+  {
+    FooBarContainer cont;
+    Input yin("---\nfbs:\n - foo: 3\n...\n", nullptr, suppressErrorMessages);
+    yin.setStreaming(true);
+    yin >> cont;
+    // Error: missing required key.
+    EXPECT_TRUE(!!yin.error());
+  }
+
+  {
+    FooBarContainer cont;
+    Input yin("---\nfbs:\n   foo: 3\n   bar: 5\n...\n", nullptr,
+              suppressErrorMessages);
+    yin.setStreaming(true);
+    yin >> cont;
+    // Error: fbs is not a sequence.
+    EXPECT_TRUE(!!yin.error());
+    EXPECT_EQ(cont.fbs.size(), 0UL);
+  }
+}
+
+TEST(YAMLIO, TestStreamingFlagsRead) {
+  FlagsMap map;
+  Input yin("---\n"
+            "f3:  []\n"
+            "f1:  [ big ]\n"
+            "f2:  [ round, flat ]\n"
+            "...\n");
+  yin.setStreaming(true);
+  yin >> map;
+
+  EXPECT_FALSE(yin.error());
+  EXPECT_EQ(flagBig,              map.f1);
+  EXPECT_EQ(flagRound|flagFlat,   map.f2);
+  EXPECT_EQ(flagNone,             map.f3);
+  EXPECT_EQ(flagRound,            map.f4);
+}
+
+TEST(YAMLIO, TestStreamingDocListRead) {
+  std::string intermediate;
+  {
+    std::vector<FooBarMap> docList(3);
+    for (int i = 0; i != 3; ++i) {
+      docList[i].foo = i;
+      docList[i].bar = -i;
+    }
+    llvm::raw_string_ostream ostr(intermediate);
+    Output yout(ostr);
+    yout << docList;
+  }
+
+  {
+    Input yin(intermediate);
+    yin.setStreaming(true);
+    std::vector<FooBarMap> docList2;
+    yin >> docList2;
+
+    EXPECT_FALSE(yin.error());
+    ASSERT_EQ(docList2.size(), 3UL);
+    for (int i = 0; i != 3; ++i) {
+      EXPECT_EQ(docList2[i].foo, i);
+      EXPECT_EQ(docList2[i].bar, -i);
+    }
+  }
+}
+
+TEST(YAMLIO, TestStreamingBlockScalarRead) {
+  MultilineStringTypeMap map;
+  Input yin("---\n"
+            "name: |\n  An Item\n"
+            "description: |\n  Hello\n  World\n"
+            "ingredients: |\n  SubItem 1\n\n  SubItem 2\n"
+            "recipes: |\n\n  Test 1\n"
+            "warningLabels: |\n"
+            "documentation: |\n"
+            "price: 350\n"
+            "...\n");
+  yin.setStreaming(true);
+  yin >> map;
+
+  EXPECT_FALSE(yin.error());
+  EXPECT_EQ(map.name.str, "An Item\n");
+  EXPECT_EQ(map.description.str, "Hello\nWorld\n");
+  EXPECT_EQ(map.ingredients.str, "SubItem 1\n\nSubItem 2\n");
+  EXPECT_EQ(map.recipes.str, "\nTest 1\n");
+  EXPECT_TRUE(map.warningLabels.str.empty());
+  EXPECT_TRUE(map.documentation.str.empty());
+  EXPECT_EQ(map.price, 350);
+}
+
+//
+// Test reading a long sequence of sequences, whose elements and nested
+// elements are released as they are read.
+//
+TEST(YAMLIO, TestStreamingSequenceOfSequenceRead) {
+  std::string intermediate;
+  {
+    NameAndNumbersFlow map;
+    map.name = "hello";
+    for (int i = 0; i != 1000; ++i)
+      map.sequenceOfNumbers.push_back({i, -i, 2 * i});
+    llvm::raw_string_ostream ostr(intermediate);
+    Output yout(ostr);
+    yout << map;
+  }
+
+  NameAndNumbersFlow map2;
+  Input yin(intermediate);
+  yin.setStreaming(true);
+  yin >> map2;
+
+  EXPECT_FALSE(yin.error());
+  EXPECT_TRUE(map2.name.equals("hello"));
+  ASSERT_EQ(map2.sequenceOfNumbers.size(), 1000UL);
+  for (int i = 0; i != 1000; ++i) {
+    ASSERT_EQ(map2.sequenceOfNumbers[i].size(), 3UL);
+    EXPECT_EQ(i, map2.sequenceOfNumbers[i][0]);
+    EXPECT_EQ(-i, map2.sequenceOfNumbers[i][1]);
+    EXPECT_EQ(2 * i, map2.sequenceOfNumbers[i][2]);
+  }
+}
+
+//
+// Test that a key appearing twice in a mapping is an error when streaming, and
+// that reading the whole tree keeps its last value.
+//
+TEST(YAMLIO, TestDuplicateKeys) {
+  const char *Docs[] = {"---\nfoo: 1\nfoo: 3\nbar: 2\n...\n",
+                        "---\nfoo: 1\nbar: 2\nfoo: 3\n...\n",
+                        "---\nbar: 4\nbar: 2\nfoo: 3\n...\n"};
+  for (const char *Doc : Docs) {
+    FooBar fb;
+    Input yin(Doc);
+    yin >> fb;
+    EXPECT_FALSE(yin.error()) << Doc;
+    EXPECT_EQ(3, fb.foo) << Doc;
+    EXPECT_EQ(2, fb.bar) << Doc;
+
+    Input ystream(Doc, nullptr, suppressErrorMessages);
+    ystream.setStreaming(true);
+    ystream >> fb;
+    EXPECT_TRUE(!!ystream.error()) << Doc;
+  }
+}
@@ -143,6 +143,18 @@ TEST(raw_ostreamTest, WriteEscaped) {
   EXPECT_EQ("\\001\\010\\200", Str);
 }
 
+TEST(raw_ostreamTest, WriteJSONString) {
+  std::string Str;
+
+  Str = "";
+  raw_string_ostream(Str).write_json_string("hi");
+  EXPECT_EQ("\"hi\"", Str);
+
+  Str = "";
+  raw_string_ostream(Str).write_json_string("\\\"\n\x1f\200");
+  EXPECT_EQ("\"\\\\\\\"\\u000a\\u001f\200\"", Str);
+}
+
 TEST(raw_ostreamTest, Justify) {  
   EXPECT_EQ("xyz   ", printToString(left_justify("xyz", 6), 6));
   EXPECT_EQ("abc",    printToString(left_justify("abc", 3), 3));
@@ -179,6 +191,55 @@ TEST(raw_ostreamTest, FormatDecimal) {
                           printToString(format_decimal(INT64_MAX, 21), 21));
   EXPECT_EQ(" -9223372036854775808", 
                           printToString(format_decimal(INT64_MIN, 21), 21));
+  EXPECT_EQ("0",           printToString(format_decimal(0, 0), 4));
+}
+
+TEST(raw_ostreamTest, Digits) {
+  // Every power of ten and its neighbours, for each number of digits, with
+  // and without room in the buffer.
+  uint64_t N = 1;
+  for (unsigned Digits = 1; Digits != 20; ++Digits, N *= 10) {
+    for (uint64_t V : {N - 1, N, N + 1, N * 9 + N - 1}) {
+      std::string Expected = std::to_string(V);
+      EXPECT_EQ(Expected, printToString(V));
+      EXPECT_EQ(Expected, printToString(V, 3));
+      EXPECT_EQ(Expected, printToStringUnbuffered(V));
+    }
+  }
+  EXPECT_EQ("4294967295", printToString(4294967295UL, 5));
+  EXPECT_EQ("4294967296", printToString(4294967296ULL, 10));
+}
+
+TEST(raw_ostreamTest, WriteHex) {
+  std::string Str;
+  raw_string_ostream OS(Str);
+  OS.write_hex(0) << ' ';
+  OS.write_hex(0xf) << ' ';
+  OS.write_hex(0x10) << ' ';
+  OS.write_hex(0xdeadbeef) << ' ';
+  OS.write_hex(UINT64_MAX);
+  EXPECT_EQ("0 f 10 deadbeef ffffffffffffffff", OS.str());
+  EXPECT_EQ("0xdeadbeef", printToString((void *)0xdeadbeef, 4));
+}
+
+TEST(raw_ostreamTest, Padding) {
+  EXPECT_EQ(std::string(299, ' ') + "0",
+            printToString(format_decimal(0, 300)));
+  EXPECT_EQ("0x" + std::string(22, '0') + "12",
+            printToString(format_hex(0x12, 26), 10));
+
+  std::string Str;
+  raw_string_ostream OS(Str);
+  OS << 'a';
+  OS.indent(3) << 'b';
+  OS.write_zeros(200) << 'c';
+  OS.indent(1000);
+  OS.str();
+  EXPECT_EQ(1206u, Str.size());
+  EXPECT_EQ("a   b", Str.substr(0, 5));
+  EXPECT_EQ(std::string(200, '\0'), Str.substr(5, 200));
+  EXPECT_EQ('c', Str[205]);
+  EXPECT_EQ(std::string(1000, ' '), Str.substr(206));
 }
 
 
@@ -0,0 +1,131 @@
+//===- ParallelFunctionPasses.cpp - Unit tests for parallel function passes ===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/IPO/ParallelFunctionPasses.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/DebugInfoMetadata.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Transforms/Scalar.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+const char *ModuleString =
+    "%struct.point = type { i32, i32 }\n"
+    "define i32 @x(%struct.point* %p) !dbg !3 {\n"
+    "  %a = getelementptr %struct.point, %struct.point* %p, i64 0, i32 0\n"
+    "  %v = load i32, i32* %a, !dbg !7\n"
+    "  %r = add i32 %v, 0, !dbg !8\n"
+    "  ret i32 %r, !dbg !8\n"
+    "}\n"
+    "define i32 @y(%struct.point* %p) !dbg !6 {\n"
+    "  %a = getelementptr %struct.point, %struct.point* %p, i64 0, i32 1\n"
+    "  %v = load i32, i32* %a, !dbg !9\n"
+    "  %r = mul i32 %v, 1, !dbg !9\n"
+    "  ret i32 %r, !dbg !9\n"
+    "}\n"
+    "!llvm.dbg.cu = !{!0}\n"
+    "!llvm.module.flags = !{!10}\n"
+    "!0 = distinct !DICompileUnit(language: DW_LANG_C99, file: !1, "
+    "emissionKind: 1, subprograms: !2)\n"
+    "!1 = !DIFile(filename: \"t.c\", directory: \"/\")\n"
+    "!2 = !{!3, !6}\n"
+    "!3 = distinct !DISubprogram(name: \"x\", scope: !1, file: !1, line: 1, "
+    "type: !4, isDefinition: true)\n"
+    "!4 = !DISubroutineType(types: !5)\n"
+    "!5 = !{null}\n"
+    "!6 = distinct !DISubprogram(name: \"y\", scope: !1, file: !1, line: 5, "
+    "type: !4, isDefinition: true)\n"
+    "!7 = !DILocation(line: 2, scope: !11)\n"
+    "!8 = !DILocation(line: 3, scope: !3)\n"
+    "!9 = !DILocation(line: 6, scope: !6)\n"
+    "!10 = !{i32 2, !\"Debug Info Version\", i32 3}\n"
+    "!11 = distinct !DILexicalBlock(scope: !3, file: !1, line: 2)\n";
+
+std::unique_ptr<Module> parse(LLVMContext &Context) {
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseAssemblyString(ModuleString, Err, Context);
+  if (!M)
+    Err.print("ParallelFunctionPassesTest", errs());
+  return M;
+}
+
+void addPasses(legacy::FunctionPassManager &FPM, Module &) {
+  FPM.add(createInstructionCombiningPass());
+}
+
+TEST(ParallelFunctionPasses, KeepsDistinctMetadata) {
+  LLVMContext Context;
+  std::unique_ptr<Module> M = parse(Context);
+  ASSERT_TRUE(M != nullptr);
+  DISubprogram *X = M->getFunction("x")->getSubprogram();
+  DISubprogram *Y = M->getFunction("y")->getSubprogram();
+  const DILocation *XLoad =
+      M->getFunction("x")->getEntryBlock().begin()->getNextNode()
+          ->getDebugLoc();
+  DILocalScope *Block = XLoad->getScope();
+
+  EXPECT_TRUE(runFunctionPassesInParallel(*M, 2, addPasses));
+  EXPECT_FALSE(verifyModule(*M, &errs()));
+
+  // The bodies refer to the original subprograms and lexical block.
+  Function *F = M->getFunction("x");
+  EXPECT_EQ(X, F->getSubprogram());
+  for (Instruction &I : F->getEntryBlock())
+    if (const DILocation *Loc = I.getDebugLoc())
+      EXPECT_TRUE(Loc->getScope() == X || Loc->getScope() == Block);
+  EXPECT_EQ(Block, F->getEntryBlock().begin()->getNextNode()
+                       ->getDebugLoc()->getScope());
+  F = M->getFunction("y");
+  EXPECT_EQ(Y, F->getSubprogram());
+  for (Instruction &I : F->getEntryBlock())
+    if (const DILocation *Loc = I.getDebugLoc())
+      EXPECT_EQ(Y, Loc->getScope());
+}
+
+/// Returns the name a module parsed after optimizing one in the same context
+/// gives to its copy of %struct.point.
+std::string getNextStructName(bool Parallel) {
+  LLVMContext Context;
+  std::unique_ptr<Module> M = parse(Context);
+  if (!M)
+    return "";
+  if (Parallel) {
+    runFunctionPassesInParallel(*M, 2, addPasses);
+  } else {
+    legacy::FunctionPassManager FPM(M.get());
+    addPasses(FPM, *M);
+    FPM.doInitialization();
+    for (Function &F : *M)
+      FPM.run(F);
+    FPM.doFinalization();
+  }
+  std::unique_ptr<Module> Next = parse(Context);
+  if (!Next)
+    return "";
+  return Next->getFunction("x")
+      ->getFunctionType()
+      ->getParamType(0)
+      ->getPointerElementType()
+      ->getStructName();
+}
+
+TEST(ParallelFunctionPasses, ReleasesStructNames) {
+  // The struct types the partitions are read back with don't take names that
+  // a sequential run leaves free.
+  EXPECT_EQ(getNextStructName(false), getNextStructName(true));
+}
+
+} // end anonymous namespace
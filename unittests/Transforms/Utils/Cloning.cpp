@@ -447,4 +447,48 @@ TEST_F(CloneModule, Verify) {
   EXPECT_FALSE(verifyModule(*NewM));
 }
 
+TEST(CloneModuleLazily, MaterializeOnDemand) {
+  LLVMContext C;
+  Module M("", C);
+  IRBuilder<> IBuilder(C);
+  auto *Int32Ty = IBuilder.getInt32Ty();
+  auto *FuncType = FunctionType::get(Int32Ty, false);
+
+  auto *G = new GlobalVariable(M, Int32Ty, false, GlobalValue::InternalLinkage,
+                               IBuilder.getInt32(1), "g");
+  auto *H = Function::Create(FuncType, GlobalValue::InternalLinkage, "h", &M);
+  IBuilder.SetInsertPoint(BasicBlock::Create(C, "", H));
+  IBuilder.CreateRet(IBuilder.CreateLoad(G));
+  auto *F = Function::Create(FuncType, GlobalValue::ExternalLinkage, "f", &M);
+  IBuilder.SetInsertPoint(BasicBlock::Create(C, "", F));
+  IBuilder.CreateRet(IBuilder.CreateCall(H));
+  Function::Create(FuncType, GlobalValue::ExternalLinkage, "decl", &M);
+
+  std::unique_ptr<Module> NewM = CloneModuleLazily(&M);
+  Function *NewF = NewM->getFunction("f");
+  Function *NewH = NewM->getFunction("h");
+  EXPECT_FALSE(NewM->isMaterialized());
+  EXPECT_TRUE(NewF->isMaterializable());
+  EXPECT_TRUE(NewF->empty());
+  EXPECT_FALSE(NewF->isDeclaration());
+  EXPECT_TRUE(NewM->getFunction("decl")->isDeclaration());
+
+  // Materializing f clones its body, which calls the copy of h.
+  EXPECT_FALSE(NewF->materialize());
+  EXPECT_FALSE(NewF->isMaterializable());
+  auto *Call = cast<CallInst>(&NewF->front().front());
+  EXPECT_EQ(NewH, Call->getCalledFunction());
+  EXPECT_TRUE(NewH->isMaterializable());
+
+  EXPECT_FALSE(NewM->materializeAll());
+  EXPECT_TRUE(NewM->isMaterialized());
+  auto *Load = cast<LoadInst>(&NewH->front().front());
+  EXPECT_EQ(NewM->getNamedGlobal("g"), Load->getPointerOperand());
+  EXPECT_FALSE(verifyModule(*NewM));
+
+  // The original module is unchanged.
+  EXPECT_EQ(H, cast<CallInst>(&F->front().front())->getCalledFunction());
+  EXPECT_FALSE(verifyModule(M));
+}
+
 }
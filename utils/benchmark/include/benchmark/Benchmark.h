@@ -0,0 +1,165 @@
+//===- utils/benchmark/include/benchmark/Benchmark.h - Benchmarks -*- C++ -*-//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// A small microbenchmark framework for the data structures of ADT and Support.
+//
+// A benchmark is a function taking a State, registered with the BENCHMARK
+// macros, which runs the code to measure in a loop:
+//
+//   static void SmallVectorPushBack(benchmark::State &State) {
+//     while (State.keepRunning()) {
+//       SmallVector<int, 8> V;
+//       for (int I = 0; I != State.getArg(); ++I)
+//         V.push_back(I);
+//       benchmark::doNotOptimize(V.data());
+//     }
+//     State.setItemsProcessed(State.getIterations() * State.getArg());
+//   }
+//   BENCHMARK_ARGS(SmallVectorPushBack, 4, 64, 4096);
+//
+// The driver picks the number of iterations so that a run lasts at least
+// -benchmark-min-time seconds, repeats the run -benchmark-repetitions times,
+// and reports the median time per iteration. -benchmark-out writes the
+// results as JSON, for tracking them over time.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_UTILS_BENCHMARK_BENCHMARK_H
+#define LLVM_UTILS_BENCHMARK_BENCHMARK_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/DataTypes.h"
+#include <chrono>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+namespace llvm {
+namespace benchmark {
+
+/// The state of one run of a benchmark.
+class State {
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  State(uint64_t Iterations, int64_t Arg)
+      : Iterations(Iterations), Left(Iterations), Arg(Arg) {}
+
+  /// Return true while the benchmark loop should run another iteration. The
+  /// timer starts at the first call and stops at the last one.
+  bool keepRunning() {
+    if (LLVM_UNLIKELY(!Started)) {
+      Started = true;
+      Begin = Clock::now();
+    }
+    if (LLVM_LIKELY(Left)) {
+      --Left;
+      return true;
+    }
+    stopTiming();
+    return false;
+  }
+
+  /// Stop the timer, e.g. to set up the data of the next iteration.
+  void pauseTiming() { stopTiming(); }
+  void resumeTiming() {
+    Running = true;
+    Begin = Clock::now();
+  }
+
+  uint64_t getIterations() const { return Iterations; }
+  /// The argument the benchmark was registered with, or 0 if none.
+  int64_t getArg() const { return Arg; }
+
+  /// Record the number of items the run processed, to report a throughput.
+  void setItemsProcessed(uint64_t Items) { ItemsProcessed = Items; }
+  uint64_t getItemsProcessed() const { return ItemsProcessed; }
+
+  /// Attach a note to the results of the benchmark, e.g. the memory the data
+  /// structure under test uses.
+  void setLabel(const std::string &L) { Label = L; }
+  const std::string &getLabel() const { return Label; }
+
+  Clock::duration getElapsed() const { return Elapsed; }
+
+private:
+  void stopTiming() {
+    if (Running)
+      Elapsed += Clock::now() - Begin;
+    Running = false;
+  }
+
+  uint64_t Iterations;
+  uint64_t Left;
+  int64_t Arg;
+  uint64_t ItemsProcessed = 0;
+  std::string Label;
+  bool Started = false;
+  bool Running = true;
+  Clock::time_point Begin;
+  Clock::duration Elapsed = Clock::duration::zero();
+};
+
+typedef void (*BenchmarkFn)(State &);
+
+/// Registers a benchmark, once per argument, when constructed at global
+/// scope.
+class Registration {
+public:
+  Registration(const char *Name, BenchmarkFn Fn,
+               std::initializer_list<int64_t> Args = {});
+};
+
+/// A registered benchmark, with one of its arguments.
+struct BenchmarkInfo {
+  std::string Name;
+  BenchmarkFn Fn;
+  int64_t Arg;
+  bool HasArg;
+};
+
+/// Return the registered benchmarks, in registration order.
+ArrayRef<BenchmarkInfo> getRegisteredBenchmarks();
+
+/// Run the benchmarks selected on the command line and report their results.
+/// Return a process exit code.
+int runBenchmarks(const char *Argv0);
+
+/// Prevent the compiler from optimizing away the computation of \p Value.
+template <typename T> inline void doNotOptimize(const T &Value) {
+#if defined(__GNUC__)
+  asm volatile("" : : "r"(&Value) : "memory");
+#else
+  static volatile const void *Sink;
+  Sink = &Value;
+#endif
+}
+
+/// Return \p N pointers to objects of 16 to 128 bytes allocated from
+/// \p Alloc, in a shuffled order, like the Values and Instructions a pass
+/// keys its maps with.
+std::vector<void *> makePointerKeys(BumpPtrAllocator &Alloc, unsigned N);
+
+/// Return \p N distinct symbol names, with the long common prefixes and the
+/// lengths of mangled C++ names.
+std::vector<std::string> makeSymbolNames(unsigned N);
+
+} // end namespace benchmark
+} // end namespace llvm
+
+#define BENCHMARK(Fn)                                                          \
+  static ::llvm::benchmark::Registration Fn##Registration(#Fn, Fn)
+
+#define BENCHMARK_ARGS(Fn, ...)                                                \
+  static ::llvm::benchmark::Registration Fn##Registration(#Fn, Fn,             \
+                                                          {__VA_ARGS__})
+
+#endif
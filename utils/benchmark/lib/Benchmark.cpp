@@ -0,0 +1,248 @@
+//===- utils/benchmark/lib/Benchmark.cpp - Microbenchmark driver ----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/Benchmark.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/Regex.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <ctime>
+#include <random>
+
+using namespace llvm;
+using namespace llvm::benchmark;
+
+static cl::opt<std::string>
+    Filter("benchmark-filter",
+           cl::desc("Only run the benchmarks whose name matches this regex"),
+           cl::init(""));
+
+static cl::opt<double>
+    MinTime("benchmark-min-time",
+            cl::desc("Minimum duration of a run of a benchmark, in seconds"),
+            cl::init(0.2));
+
+static cl::opt<unsigned>
+    Repetitions("benchmark-repetitions",
+                cl::desc("Number of runs of each benchmark"), cl::init(3));
+
+static cl::opt<std::string>
+    OutputFile("benchmark-out",
+               cl::desc("Write the results as JSON to this file"),
+               cl::value_desc("filename"), cl::init(""));
+
+static cl::opt<bool> ListOnly("benchmark-list",
+                              cl::desc("List the benchmarks and exit"));
+
+static ManagedStatic<std::vector<BenchmarkInfo>> Registry;
+
+Registration::Registration(const char *Name, BenchmarkFn Fn,
+                           std::initializer_list<int64_t> Args) {
+  if (Args.size() == 0) {
+    Registry->push_back({Name, Fn, 0, false});
+    return;
+  }
+  for (int64_t Arg : Args)
+    Registry->push_back({std::string(Name) + "/" + std::to_string(Arg), Fn,
+                         Arg, true});
+}
+
+ArrayRef<BenchmarkInfo> benchmark::getRegisteredBenchmarks() {
+  return *Registry;
+}
+
+namespace {
+struct Result {
+  const BenchmarkInfo *Info;
+  uint64_t Iterations;
+  /// Nanoseconds per iteration of each run, sorted.
+  std::vector<double> Times;
+  double ItemsPerSecond;
+  std::string Label;
+
+  double getMedian() const { return Times[Times.size() / 2]; }
+};
+} // end anonymous namespace
+
+/// Run \p B for \p Iterations iterations and return the state of the run.
+static State runOnce(const BenchmarkInfo &B, uint64_t Iterations) {
+  State S(Iterations, B.Arg);
+  B.Fn(S);
+  return S;
+}
+
+static double getSeconds(State::Clock::duration D) {
+  return std::chrono::duration<double>(D).count();
+}
+
+static Result runBenchmark(const BenchmarkInfo &B) {
+  // Find the number of iterations that lasts MinTime, growing it by at most
+  // 10x per attempt.
+  uint64_t Iterations = 1;
+  for (;;) {
+    double Seconds = getSeconds(runOnce(B, Iterations).getElapsed());
+    if (Seconds >= MinTime || Iterations >= 1000000000)
+      break;
+    double Factor = Seconds > 0 ? MinTime * 1.4 / Seconds : 10;
+    Iterations = std::max<uint64_t>(
+        Iterations + 1, Iterations * std::min(Factor, 10.0));
+  }
+
+  Result R = {&B, Iterations, {}, 0, ""};
+  double Items = 0, Seconds = 0;
+  for (unsigned I = 0, E = std::max(1u, unsigned(Repetitions)); I != E; ++I) {
+    State S = runOnce(B, Iterations);
+    double Elapsed = getSeconds(S.getElapsed());
+    R.Times.push_back(Elapsed * 1e9 / Iterations);
+    Items += S.getItemsProcessed();
+    Seconds += Elapsed;
+    R.Label = S.getLabel();
+  }
+  std::sort(R.Times.begin(), R.Times.end());
+  if (Items && Seconds > 0)
+    R.ItemsPerSecond = Items / Seconds;
+  return R;
+}
+
+static void writeJSON(raw_ostream &OS, const char *Argv0,
+                      ArrayRef<Result> Results) {
+  char Date[32];
+  std::time_t Now = std::time(nullptr);
+  std::strftime(Date, sizeof(Date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&Now));
+
+  OS << "{\n  \"context\": {\n    \"executable\": ";
+  OS.write_json_string(Argv0);
+  OS << ",\n    \"date\": \"" << Date << "\",\n    \"host_cpu\": ";
+  OS.write_json_string(sys::getHostCPUName());
+  OS << ",\n    \"triple\": ";
+  OS.write_json_string(sys::getProcessTriple());
+#ifndef NDEBUG
+  OS << ",\n    \"assertions\": true";
+#else
+  OS << ",\n    \"assertions\": false";
+#endif
+  OS << ",\n    \"min_time\": " << format("%g", double(MinTime))
+     << ",\n    \"repetitions\": " << Repetitions << "\n  },\n";
+
+  OS << "  \"benchmarks\": [";
+  for (unsigned I = 0, E = Results.size(); I != E; ++I) {
+    const Result &R = Results[I];
+    OS << (I ? ",\n" : "\n") << "    {\"name\": ";
+    OS.write_json_string(R.Info->Name);
+    if (R.Info->HasArg)
+      OS << ", \"arg\": " << R.Info->Arg;
+    OS << ", \"iterations\": " << R.Iterations
+       << format(", \"median_ns\": %.3f", R.getMedian())
+       << format(", \"min_ns\": %.3f", R.Times.front())
+       << format(", \"max_ns\": %.3f", R.Times.back());
+    if (R.ItemsPerSecond)
+      OS << format(", \"items_per_second\": %.0f", R.ItemsPerSecond);
+    if (!R.Label.empty()) {
+      OS << ", \"label\": ";
+      OS.write_json_string(R.Label);
+    }
+    OS << "}";
+  }
+  OS << "\n  ]\n}\n";
+}
+
+int benchmark::runBenchmarks(const char *Argv0) {
+  Regex FilterRE(Filter.empty() ? StringRef(".") : StringRef(Filter));
+  std::string Error;
+  if (!FilterRE.isValid(Error)) {
+    errs() << Argv0 << ": invalid -benchmark-filter: " << Error << "\n";
+    return 1;
+  }
+
+  std::vector<const BenchmarkInfo *> Selected;
+  for (const BenchmarkInfo &B : getRegisteredBenchmarks())
+    if (FilterRE.match(B.Name))
+      Selected.push_back(&B);
+
+  if (ListOnly) {
+    for (const BenchmarkInfo *B : Selected)
+      outs() << B->Name << "\n";
+    return 0;
+  }
+
+  size_t NameWidth = 9;
+  for (const BenchmarkInfo *B : Selected)
+    NameWidth = std::max(NameWidth, B->Name.size());
+
+  outs() << left_justify("Benchmark", NameWidth)
+         << "  Iterations   Median (ns)      Min (ns)        Items/s\n";
+  std::vector<Result> Results;
+  for (const BenchmarkInfo *B : Selected) {
+    Results.push_back(runBenchmark(*B));
+    const Result &R = Results.back();
+    outs() << left_justify(B->Name, NameWidth) << format("  %10llu",
+                                                         R.Iterations)
+           << format("  %12.2f  %12.2f", R.getMedian(), R.Times.front());
+    if (R.ItemsPerSecond || !R.Label.empty())
+      outs() << format("  %13.4g", R.ItemsPerSecond);
+    if (!R.Label.empty())
+      outs() << "  " << R.Label;
+    outs() << "\n";
+    outs().flush();
+  }
+
+  if (!OutputFile.empty()) {
+    std::error_code EC;
+    raw_fd_ostream OS(OutputFile, EC, sys::fs::F_Text);
+    if (EC) {
+      errs() << Argv0 << ": cannot open " << OutputFile << ": "
+             << EC.message() << "\n";
+      return 1;
+    }
+    writeJSON(OS, Argv0, Results);
+  }
+  return 0;
+}
+
+std::vector<void *> benchmark::makePointerKeys(BumpPtrAllocator &Alloc,
+                                               unsigned N) {
+  std::mt19937 RNG(N);
+  std::uniform_int_distribution<unsigned> Size(2, 16);
+  std::vector<void *> Keys;
+  Keys.reserve(N);
+  for (unsigned I = 0; I != N; ++I)
+    Keys.push_back(Alloc.Allocate(Size(RNG) * 8, 8));
+  std::shuffle(Keys.begin(), Keys.end(), RNG);
+  return Keys;
+}
+
+std::vector<std::string> benchmark::makeSymbolNames(unsigned N) {
+  static const char *const Namespaces[] = {"4llvm", "5clang", "3lld",
+                                           "6detail", "3std"};
+  static const char *const Words[] = {
+      "Value", "Instruction", "Builder", "Pass", "Map", "Analysis",
+      "Function", "Module", "Type", "Constant", "Operand", "Info"};
+  std::mt19937 RNG(N);
+  std::uniform_int_distribution<unsigned> NS(0, 4), Word(0, 11), Count(2, 4);
+
+  std::vector<std::string> Names;
+  Names.reserve(N);
+  for (unsigned I = 0; I != N; ++I) {
+    std::string Name = "_ZN";
+    Name += Namespaces[NS(RNG)];
+    for (unsigned J = 0, E = Count(RNG); J != E; ++J) {
+      std::string Id = std::string(Words[Word(RNG)]) + Words[Word(RNG)];
+      Name += std::to_string(Id.size()) + Id;
+    }
+    // Make the name unique.
+    std::string Suffix = "v" + std::to_string(I);
+    Name += std::to_string(Suffix.size()) + Suffix + "Ev";
+    Names.push_back(std::move(Name));
+  }
+  return Names;
+}